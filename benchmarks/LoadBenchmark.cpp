@@ -0,0 +1,472 @@
+// Times the asset decode paths against what they replaced. Run it from the
+// directory that holds models/ and textures/.
+//
+//   PNG       PngDecoder against stb_image on every PNG, both flipping for upload
+//   parallel  OBJ and glTF geometry decoded on the ThreadPool against one
+//             thread (the files given as arguments, or the level's)
+//   OBJ       the native OBJ parser against tinyobjloader
+//   meshopt   EXT_meshopt_compression vertex and index decode throughput
+//   LZ4       archive block decompression, one thread and on the ThreadPool
+//
+// Each figure is the fastest of BENCHMARK_RUNS runs, so disk and first-touch
+// page faults don't count; files are read (and glTF documents parsed) up front.
+
+#include "Utils/GltfDocument.hpp"
+#include "Utils/GltfLoader.hpp"
+#include "Utils/Lz4.hpp"
+#include "Utils/MeshoptDecoder.hpp"
+#include "Utils/ObjLoader.hpp"
+#include "Utils/PngDecoder.hpp"
+#include "Utils/ThreadPool.hpp"
+#include "stb_image.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+static constexpr int BENCHMARK_RUNS = 5;
+static constexpr size_t LZ4_BLOCK_SIZE = 64 * 1024;     // As in the asset archive
+
+static double timeBest(const std::function<void()>& body)
+{
+    double best = 0.0;
+    for (int run = 0; run < BENCHMARK_RUNS; ++run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+static bool readFile(const std::string& filename, std::vector<unsigned char>& data)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static void benchmarkPng()
+{
+    std::vector<std::string> files;
+    for (const char* folder : { "models", "textures" })
+    {
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(folder, error))
+        {
+            if (entry.path().extension() == ".png")
+            {
+                files.push_back(entry.path().string());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    printf("PNG decode, flipped for upload (%zu files)\n", files.size());
+    printf("  %-60s %10s %10s %8s\n", "file", "stb ms", "native ms", "speedup");
+
+    double stb_total = 0.0;
+    double native_total = 0.0;
+    size_t decoded_bytes = 0;
+    size_t mismatches = 0;
+    for (const std::string& filename : files)
+    {
+        std::vector<unsigned char> data;
+        if (!readFile(filename, data))
+        {
+            continue;
+        }
+
+        // Both decodes must produce the same pixels for the timing to mean anything
+        PngImage native;
+        if (!PngDecoder::decode(data.data(), data.size(), native, true))
+        {
+            printf("  %-60s not supported by PngDecoder, skipped\n", filename.c_str());
+            continue;
+        }
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        stbi_set_flip_vertically_on_load(1);
+        unsigned char* reference = stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &width, &height,
+                                                         &channels, native.channels);
+        const size_t size = static_cast<size_t>(native.width) * native.height * native.channels;
+        if (!reference || width != native.width || height != native.height ||
+            memcmp(reference, native.pixels.get(), size) != 0)
+        {
+            ++mismatches;
+        }
+        stbi_image_free(reference);
+
+        const double stb_ms = timeBest([&]()
+        {
+            int w, h, c;
+            stbi_image_free(stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &w, &h, &c, native.channels));
+        });
+        const double native_ms = timeBest([&]()
+        {
+            PngImage image;
+            PngDecoder::decode(data.data(), data.size(), image, true);
+        });
+
+        stb_total += stb_ms;
+        native_total += native_ms;
+        decoded_bytes += size;
+        printf("  %-60s %10.2f %10.2f %7.2fx\n", filename.c_str(), stb_ms, native_ms, stb_ms / native_ms);
+    }
+    stbi_set_flip_vertically_on_load(0);
+
+    printf("  %-60s %10.2f %10.2f %7.2fx\n", "total", stb_total, native_total,
+           native_total > 0.0 ? stb_total / native_total : 0.0);
+    printf("  %.0f MB/s stb, %.0f MB/s native (decoded pixels); %zu files decoded differently\n\n",
+           decoded_bytes / 1e3 / std::max(stb_total, 1e-9), decoded_bytes / 1e3 / std::max(native_total, 1e-9), mismatches);
+}
+
+static void benchmarkParallelDecode(const std::vector<std::string>& files)
+{
+    printf("Geometry decode, ThreadPool (%zu workers plus the caller) against one thread\n",
+           ThreadPool::get().getThreadCount());
+    printf("  %-32s %10s %10s %10s %8s\n", "file", "vertices", "1 thread", "pool", "speedup");
+
+    for (const std::string& filename : files)
+    {
+        const bool is_obj = std::filesystem::path(filename).extension() == ".obj";
+        size_t vertex_count = 0;
+        std::function<void(bool)> load;
+
+        std::shared_ptr<const GltfDocument> document;
+        if (is_obj)
+        {
+            load = [&](bool multithreaded)
+            {
+                ObjLoaderConfig config;
+                config.verbose_logging = false;
+                config.multithreaded = multithreaded;
+                ObjLoadResult result = ObjLoader::loadObj(filename, config);
+                vertex_count = result.vertex_count;
+            };
+        }
+        else
+        {
+            std::string error;
+            document = GltfDocument::load(filename, error);
+            if (!document)
+            {
+                printf("  %-32s could not be parsed: %s\n", filename.c_str(), error.c_str());
+                continue;
+            }
+
+            load = [&](bool multithreaded)
+            {
+                GltfLoaderConfig config;
+                config.multithreaded = multithreaded;
+                GltfLoadResult result = GltfLoader::loadGltfGeometry(*document, config);
+                vertex_count = result.vertex_count;
+            };
+        }
+
+        const double serial_ms = timeBest([&]() { load(false); });
+        const double parallel_ms = timeBest([&]() { load(true); });
+        printf("  %-32s %10zu %10.2f %10.2f %7.2fx\n", filename.c_str(), vertex_count, serial_ms, parallel_ms,
+               serial_ms / parallel_ms);
+    }
+    printf("\n");
+}
+
+static void benchmarkObjParser()
+{
+    printf("OBJ parse, native parser against tinyobjloader\n");
+    printf("  %-32s %10s %10s %10s %8s\n", "file", "vertices", "tinyobj", "native", "speedup");
+
+    for (const char* filename : { "models/player_character.obj", "models/map_collider.obj" })
+    {
+        ObjLoaderConfig config;
+        config.verbose_logging = false;
+        size_t vertex_count = 0;
+        size_t reference_count = 0;
+
+        const double tinyobj_ms = timeBest([&]()
+        {
+            ObjLoadResult result = ObjLoader::loadObjSafe(filename, config);
+            reference_count = result.vertex_count;
+        });
+        const double native_ms = timeBest([&]()
+        {
+            ObjLoadResult result = ObjLoader::loadObj(filename, config);
+            vertex_count = result.vertex_count;
+        });
+        printf("  %-32s %10zu %10.2f %10.2f %7.2fx%s\n", filename, vertex_count, tinyobj_ms, native_ms,
+               tinyobj_ms / native_ms, vertex_count == reference_count ? "" : "  (vertex counts differ)");
+    }
+    printf("\n");
+}
+
+// The repo only decodes meshopt streams (gltfpack writes them), so the
+// benchmark encodes its own: vertex codec version 0, each byte group in the
+// smallest of the four encodings, and the index sequence codec version 1
+static unsigned char zigzag8(unsigned char delta)
+{
+    return static_cast<unsigned char>((delta << 1) ^ static_cast<unsigned char>(static_cast<signed char>(delta) >> 7));
+}
+
+static std::vector<unsigned char> encodeVertexBuffer(const unsigned char* data, size_t count, size_t stride)
+{
+    std::vector<unsigned char> out = { 0xA0 };
+    const size_t block_size = std::min<size_t>(256, (8192 / stride) & ~size_t(15));
+    std::vector<unsigned char> last(data, data + stride);
+
+    for (size_t first = 0; first < count; first += block_size)
+    {
+        const size_t block_count = std::min(block_size, count - first);
+        const size_t padded = (block_count + 15) & ~size_t(15);
+
+        for (size_t k = 0; k < stride; ++k)
+        {
+            std::vector<unsigned char> deltas(padded, 0);
+            unsigned char previous = last[k];
+            for (size_t i = 0; i < block_count; ++i)
+            {
+                const unsigned char value = data[(first + i) * stride + k];
+                deltas[i] = zigzag8(static_cast<unsigned char>(value - previous));
+                previous = value;
+            }
+
+            const size_t group_count = padded / 16;
+            std::vector<unsigned char> header((group_count + 3) / 4, 0);
+            std::vector<unsigned char> body;
+            for (size_t group = 0; group < group_count; ++group)
+            {
+                const unsigned char* values = &deltas[group * 16];
+                int best_mode = -1;
+                std::vector<unsigned char> best;
+                for (int mode = 0; mode < 4; ++mode)
+                {
+                    const int bits = mode == 0 ? 0 : (mode == 1 ? 2 : (mode == 2 ? 4 : 8));
+                    std::vector<unsigned char> encoded;
+                    if (bits == 0)
+                    {
+                        if (std::any_of(values, values + 16, [](unsigned char v) { return v != 0; }))
+                        {
+                            continue;
+                        }
+                    }
+                    else if (bits == 8)
+                    {
+                        encoded.assign(values, values + 16);
+                    }
+                    else
+                    {
+                        // Values that don't fit are escaped and follow the packed bytes
+                        const int escape = (1 << bits) - 1;
+                        std::vector<unsigned char> escaped;
+                        for (int j = 0; j < 16; j += 8 / bits)
+                        {
+                            unsigned packed = 0;
+                            for (int q = 0; q < 8 / bits; ++q)
+                            {
+                                const int v = values[j + q];
+                                packed = (packed << bits) | static_cast<unsigned>(v >= escape ? escape : v);
+                                if (v >= escape)
+                                {
+                                    escaped.push_back(static_cast<unsigned char>(v));
+                                }
+                            }
+                            encoded.push_back(static_cast<unsigned char>(packed));
+                        }
+                        encoded.insert(encoded.end(), escaped.begin(), escaped.end());
+                    }
+
+                    if (best_mode < 0 || encoded.size() < best.size())
+                    {
+                        best_mode = mode;
+                        best = std::move(encoded);
+                    }
+                }
+                header[group / 4] |= static_cast<unsigned char>(best_mode << ((group % 4) * 2));
+                body.insert(body.end(), best.begin(), best.end());
+            }
+            out.insert(out.end(), header.begin(), header.end());
+            out.insert(out.end(), body.begin(), body.end());
+        }
+
+        for (size_t k = 0; k < stride; ++k)
+        {
+            last[k] = data[(first + block_count - 1) * stride + k];
+        }
+    }
+
+    // Tail: padding, then the first vertex the deltas start from
+    out.insert(out.end(), std::max<size_t>(stride, 32) - stride, 0);
+    out.insert(out.end(), data, data + stride);
+    return out;
+}
+
+static std::vector<unsigned char> encodeIndexSequence(const uint32_t* indices, size_t count)
+{
+    std::vector<unsigned char> out = { 0xD1 };
+    uint32_t last[2] = { 0, 0 };
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t index = indices[i];
+        const int32_t delta0 = static_cast<int32_t>(index - last[0]);
+        const int32_t delta1 = static_cast<int32_t>(index - last[1]);
+        const int base = llabs(delta0) <= llabs(delta1) ? 0 : 1;
+        const int32_t delta = base == 0 ? delta0 : delta1;
+        uint32_t value = ((static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31)) << 1 | base;
+        while (value >= 128)
+        {
+            out.push_back(static_cast<unsigned char>((value & 127) | 128));
+            value >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(value));
+        last[base] = index;
+    }
+    out.insert(out.end(), 4, 0);
+    return out;
+}
+
+static void benchmarkMeshopt()
+{
+    ObjLoaderConfig config;
+    config.verbose_logging = false;
+    ObjLoadResult mesh = ObjLoader::loadObj("models/player_character.obj", config);
+    if (!mesh.success || mesh.vertex_count == 0)
+    {
+        printf("meshopt: models/player_character.obj could not be loaded\n\n");
+        return;
+    }
+
+    // Split into attribute streams like a glTF export; float data, not quantized
+    const size_t count = mesh.vertex_count;
+    std::vector<float> positions(count * 3);
+    std::vector<float> normals(count * 3);
+    std::vector<float> texcoords(count * 2);
+    std::vector<uint32_t> indices(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const vertex& v = mesh.vertices[i];
+        memcpy(&positions[i * 3], &v.vx, 3 * sizeof(float));
+        memcpy(&normals[i * 3], &v.nx, 3 * sizeof(float));
+        memcpy(&texcoords[i * 2], &v.u, 2 * sizeof(float));
+        indices[i] = static_cast<uint32_t>(i);
+    }
+
+    printf("meshopt decode, player_character.obj streams (%zu vertices)\n", count);
+    printf("  %-32s %10s %10s %10s %10s\n", "stream", "raw KB", "encoded KB", "ms", "MB/s");
+
+    struct Stream
+    {
+        const char* name;
+        const void* data;
+        size_t stride;
+        MeshoptMode mode;
+    };
+    const Stream streams[] = {
+        { "POSITION (12 bytes)", positions.data(), 12, MeshoptMode::Attributes },
+        { "NORMAL (12 bytes)", normals.data(), 12, MeshoptMode::Attributes },
+        { "TEXCOORD_0 (8 bytes)", texcoords.data(), 8, MeshoptMode::Attributes },
+        { "indices (sequence, 4 bytes)", indices.data(), 4, MeshoptMode::Indices },
+    };
+
+    for (const Stream& stream : streams)
+    {
+        const std::vector<unsigned char> encoded = stream.mode == MeshoptMode::Attributes
+            ? encodeVertexBuffer(static_cast<const unsigned char*>(stream.data), count, stream.stride)
+            : encodeIndexSequence(static_cast<const uint32_t*>(stream.data), count);
+
+        const size_t raw_size = count * stream.stride;
+        std::vector<unsigned char> decoded(raw_size);
+        bool ok = MeshoptDecoder::decode(decoded.data(), count, stream.stride, encoded.data(), encoded.size(), stream.mode) &&
+            memcmp(decoded.data(), stream.data, raw_size) == 0;
+
+        const double ms = timeBest([&]()
+        {
+            MeshoptDecoder::decode(decoded.data(), count, stream.stride, encoded.data(), encoded.size(), stream.mode);
+        });
+        printf("  %-32s %10.0f %10.0f %10.3f %10.0f%s\n", stream.name, raw_size / 1024.0, encoded.size() / 1024.0, ms,
+               raw_size / 1e3 / ms, ok ? "" : "  (round trip FAILED)");
+    }
+    printf("\n");
+}
+
+static void benchmarkLz4()
+{
+    // Every model and texture, cut into archive blocks
+    std::vector<unsigned char> data;
+    for (const char* folder : { "models", "textures" })
+    {
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(folder, error))
+        {
+            std::vector<unsigned char> file;
+            if (entry.is_regular_file() && readFile(entry.path().string(), file))
+            {
+                data.insert(data.end(), file.begin(), file.end());
+            }
+        }
+    }
+
+    const size_t block_count = (data.size() + LZ4_BLOCK_SIZE - 1) / LZ4_BLOCK_SIZE;
+    std::vector<std::vector<unsigned char>> blocks(block_count);
+    size_t compressed_size = 0;
+    for (size_t i = 0; i < block_count; ++i)
+    {
+        const size_t size = std::min(LZ4_BLOCK_SIZE, data.size() - i * LZ4_BLOCK_SIZE);
+        blocks[i].resize(Lz4::compressBound(size));
+        blocks[i].resize(Lz4::compress(data.data() + i * LZ4_BLOCK_SIZE, size, blocks[i].data(), blocks[i].size()));
+        compressed_size += blocks[i].size();
+    }
+
+    std::vector<unsigned char> decoded(data.size());
+    auto decodeBlock = [&](size_t i)
+    {
+        const size_t size = std::min(LZ4_BLOCK_SIZE, data.size() - i * LZ4_BLOCK_SIZE);
+        Lz4::decompress(blocks[i].data(), blocks[i].size(), decoded.data() + i * LZ4_BLOCK_SIZE, size);
+    };
+
+    const double serial_ms = timeBest([&]()
+    {
+        for (size_t i = 0; i < block_count; ++i)
+        {
+            decodeBlock(i);
+        }
+    });
+    const bool ok = decoded == data;
+    const double parallel_ms = timeBest([&]() { ThreadPool::get().parallelFor(block_count, decodeBlock); });
+
+    printf("LZ4 decompress, models/ and textures/ in %zu blocks of %zu KB\n", block_count, LZ4_BLOCK_SIZE / 1024);
+    printf("  %.1f MB -> %.1f MB (%.1f%%)%s\n", data.size() / 1e6, compressed_size / 1e6,
+           100.0 * compressed_size / std::max<size_t>(data.size(), 1), ok ? "" : "  (round trip FAILED)");
+    printf("  1 thread %.2f ms (%.0f MB/s), pool %.2f ms (%.0f MB/s)\n\n", serial_ms, data.size() / 1e3 / serial_ms,
+           parallel_ms, data.size() / 1e3 / parallel_ms);
+}
+
+// Arguments replace the default geometry files
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> geometry = { "models/player_character.obj", "models/map_collider.obj",
+                                          "models/map.gltf", "models/Character.gltf" };
+    if (argc > 1)
+    {
+        geometry.assign(argv + 1, argv + argc);
+    }
+
+    benchmarkPng();
+    benchmarkParallelDecode(geometry);
+    benchmarkObjParser();
+    benchmarkMeshopt();
+    benchmarkLz4();
+    return 0;
+}
@@ -2,6 +2,7 @@
 
 #include "SDL.h"
 #include "Graphics/RenderAPI.hpp"
+#include "Graphics/TextureManager.hpp"
 #include <stdio.h>
 #include <SDL_syswm.h>
 
@@ -75,6 +76,9 @@ public:
             return false;
         }
 
+        // All texture loads go through the shared registry from here on
+        TextureManager::get().initialize(render_api);
+
         // Input setup
         SDL_SetRelativeMouseMode(SDL_TRUE);
 
@@ -86,6 +90,7 @@ public:
     {
         if (render_api)
         {
+            TextureManager::get().shutdown();
             render_api->shutdown();
             delete render_api;
             render_api = nullptr;
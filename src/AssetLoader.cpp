@@ -0,0 +1,313 @@
+#include "AssetLoader.hpp"
+#include "Components/mesh.hpp"
+#include "Graphics/TextureManager.hpp"
+#include "Utils/BakedMesh.hpp"
+#include "Utils/GltfDocument.hpp"
+#include "Utils/Hash.hpp"
+#include "Utils/ObjLoader.hpp"
+#include "Utils/ThreadPool.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+
+static std::string getExtension(const std::string& filename)
+{
+    size_t dot = filename.find_last_of('.');
+    std::string extension = dot != std::string::npos ? filename.substr(dot + 1) : std::string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+AssetLoader::AssetLoader(IRenderAPI* render_api) : render_api(render_api), main_thread(std::this_thread::get_id())
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    // Coroutines resumed on a worker run until they suspend again, and may
+    // still queue themselves for the main thread until then
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        workers_done.wait(lock, [this]() { return workers_in_flight == 0; });
+        main_thread_queue.clear();
+    }
+
+    // Every suspended coroutine belongs to one of these, through the tasks
+    // it is awaiting, so this frees them all
+    running.clear();
+}
+
+void AssetLoader::start(AssetTask<void> task)
+{
+    if (!task.isValid())
+    {
+        return;
+    }
+
+    // The coroutine may start others, so it runs from its final place
+    running.push_back(std::move(task));
+    running.back().start();
+}
+
+bool AssetLoader::update(float time_budget_ms)
+{
+    using clock = std::chrono::steady_clock;
+    const clock::time_point deadline = clock::now() +
+        std::chrono::microseconds(static_cast<long long>(time_budget_ms * 1000.0f));
+
+    // Always resume at least one coroutine so a tiny budget still makes progress
+    do
+    {
+        std::coroutine_handle<> handle;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (main_thread_queue.empty())
+            {
+                break;
+            }
+            handle = main_thread_queue.front();
+            main_thread_queue.pop_front();
+        }
+
+        handle.resume();
+    } while (clock::now() < deadline);
+
+    running.erase(std::remove_if(running.begin(), running.end(),
+                                 [](const AssetTask<void>& task) { return task.isDone(); }),
+                  running.end());
+    return running.empty();
+}
+
+void AssetLoader::WorkerAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    // This awaiter lives in the coroutine frame, which a worker may resume
+    // (and finish) before submit() even returns
+    AssetLoader* owner = loader;
+    {
+        std::lock_guard<std::mutex> lock(owner->queue_mutex);
+        ++owner->workers_in_flight;
+    }
+
+    ThreadPool::get().submit([owner, handle]()
+    {
+        handle.resume();
+
+        std::lock_guard<std::mutex> lock(owner->queue_mutex);
+        --owner->workers_in_flight;
+        owner->workers_done.notify_all();
+    });
+}
+
+void AssetLoader::MainThreadAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    std::lock_guard<std::mutex> lock(loader->queue_mutex);
+    loader->main_thread_queue.push_back(handle);
+}
+
+AssetTask<MeshAssetHandle> AssetLoader::loadMesh(std::string filename, GltfLoaderConfig gltf_config)
+{
+    // Geometry that is already loaded costs no trip to the workers
+    MeshAssetHandle geometry = MeshAssetManager::get().find(getMeshKey(filename, gltf_config));
+    if (!geometry)
+    {
+        co_await resumeOnWorker();
+        geometry = loadGeometry(filename, gltf_config);
+    }
+    co_await resumeOnMainThread();
+
+    if (!geometry)
+    {
+        fprintf(stderr, "[Asset Loader] Failed to load mesh: %s\n", filename.c_str());
+    }
+    co_return geometry;
+}
+
+AssetTask<std::shared_ptr<const GltfDocument>> AssetLoader::loadDocument(std::string filename)
+{
+    co_await resumeOnWorker();
+    std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    co_await resumeOnMainThread();
+
+    if (!document)
+    {
+        fprintf(stderr, "[Asset Loader] Failed to parse %s: %s\n", filename.c_str(), error.c_str());
+    }
+    co_return document;
+}
+
+AssetTask<TextureHandle> AssetLoader::loadTexture(std::string filename, bool invert_y, bool generate_mipmaps,
+                                                  TextureFormat format)
+{
+    co_await resumeOnMainThread();
+
+    // Decoding only pays off for textures that aren't uploaded yet
+    bool decoded = false;
+    if (!TextureManager::get().isLoaded(filename, invert_y, generate_mipmaps, format))
+    {
+        co_await resumeOnWorker();
+        PngImage image;
+        decoded = TextureManager::decodeImage(filename, invert_y, image);
+        if (decoded)
+        {
+            TextureManager::get().stageImage(filename, invert_y, std::move(image));
+        }
+        co_await resumeOnMainThread();
+
+        if (!decoded)
+        {
+            fprintf(stderr, "[Asset Loader] Failed to decode texture: %s\n", filename.c_str());
+            co_return INVALID_TEXTURE;
+        }
+    }
+
+    TextureHandle texture = TextureManager::get().acquire(filename, invert_y, generate_mipmaps, format);
+    if (decoded)
+    {
+        TextureManager::get().unstageImage(filename, invert_y);
+    }
+    if (texture == INVALID_TEXTURE)
+    {
+        fprintf(stderr, "[Asset Loader] Failed to upload texture: %s\n", filename.c_str());
+    }
+    co_return texture;
+}
+
+AssetTask<std::shared_ptr<const MaterialLoadResult>> AssetLoader::loadMaterials(std::shared_ptr<const GltfDocument> document,
+                                                                                MaterialLoaderConfig config)
+{
+    if (!document)
+    {
+        co_await resumeOnMainThread();
+        co_return nullptr;
+    }
+
+    // Decode every image the materials will ask for, so the main thread only uploads
+    co_await resumeOnWorker();
+    const std::vector<std::string> images = GltfMaterialLoader::getTextureFiles(*document, config);
+    const bool invert_y = config.flip_textures_vertically;
+    std::vector<char> staged(images.size(), 0);
+    ThreadPool::get().parallelFor(images.size(), [&images, &staged, invert_y](size_t i)
+    {
+        PngImage image;
+        if (TextureManager::decodeImage(images[i], invert_y, image))
+        {
+            TextureManager::get().stageImage(images[i], invert_y, std::move(image));
+            staged[i] = 1;
+        }
+        // Failures are left to the upload, which falls back to loading the file and reports it
+    });
+    co_await resumeOnMainThread();
+
+    IRenderAPI* api = render_api;
+    std::shared_ptr<MaterialLoadResult> materials(
+        new MaterialLoadResult(GltfMaterialLoader::loadMaterials(*document, render_api, config)),
+        [api](MaterialLoadResult* result)
+        {
+            if (TextureManager::get().isInitialized())
+            {
+                GltfMaterialLoader::cleanupMaterialTextures(*result, api);
+            }
+            delete result;
+        });
+
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        if (staged[i])
+        {
+            TextureManager::get().unstageImage(images[i], invert_y);
+        }
+    }
+
+    if (!materials->success)
+    {
+        fprintf(stderr, "[Asset Loader] Failed to load materials: %s\n", materials->error_message.c_str());
+    }
+    co_return materials;
+}
+
+std::string AssetLoader::getMeshKey(const std::string& filename, const GltfLoaderConfig& gltf_config)
+{
+    const std::string extension = getExtension(filename);
+    if (extension == "gmesh")
+    {
+        return MeshAssetManager::makeKey(filename, hashString("gmesh"));
+    }
+    if (extension == "obj")
+    {
+        return MeshAssetManager::makeKey(filename, BakedMesh::hashConfig(ObjLoaderConfig()));
+    }
+    return MeshAssetManager::makeKey(filename, BakedMesh::hashConfig(gltf_config));
+}
+
+MeshAssetHandle AssetLoader::loadGeometry(const std::string& filename, const GltfLoaderConfig& gltf_config)
+{
+    // Another coroutine may have loaded it since the caller looked
+    const std::string key = getMeshKey(filename, gltf_config);
+    if (MeshAssetHandle cached = MeshAssetManager::get().find(key))
+    {
+        return cached;
+    }
+
+    const std::string extension = getExtension(filename);
+    if (extension == "gmesh")
+    {
+        std::string error;
+        MeshAssetHandle baked = MeshAssetManager::get().addBaked(key, BakedMesh::open(filename, &error));
+        if (!baked)
+        {
+            fprintf(stderr, "[Asset Loader] %s: %s\n", filename.c_str(), error.c_str());
+        }
+        return baked;
+    }
+
+    if (extension == "obj")
+    {
+        ObjLoaderConfig config;
+        uint64_t config_hash = BakedMesh::hashConfig(config);
+        if (mesh::use_baked_cache)
+        {
+            if (MeshAssetHandle baked = MeshAssetManager::get().addBaked(key, filename, config_hash))
+            {
+                return baked;
+            }
+        }
+
+        ObjLoadResult result = ObjLoader::loadObj(filename, config);
+        if (!result.success)
+        {
+            fprintf(stderr, "[Asset Loader] %s: %s\n", filename.c_str(), result.error_message.c_str());
+            return nullptr;
+        }
+        return MeshAssetManager::get().addLoaded(key, result, filename, config_hash, mesh::use_baked_cache);
+    }
+
+    uint64_t config_hash = BakedMesh::hashConfig(gltf_config);
+    if (mesh::use_baked_cache)
+    {
+        if (MeshAssetHandle baked = MeshAssetManager::get().addBaked(key, filename, config_hash))
+        {
+            return baked;
+        }
+    }
+
+    // Parsed documents are cached, so awaiting load<GltfDocument>() for the
+    // materials as well parses the file once
+    std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    if (!document)
+    {
+        fprintf(stderr, "[Asset Loader] %s: %s\n", filename.c_str(), error.c_str());
+        return nullptr;
+    }
+
+    GltfLoadResult result = GltfLoader::loadGltfGeometry(*document, gltf_config);
+    if (!result.success)
+    {
+        fprintf(stderr, "[Asset Loader] %s: %s\n", filename.c_str(), result.error_message.c_str());
+        return nullptr;
+    }
+    return MeshAssetManager::get().addLoaded(key, result, filename, config_hash, mesh::use_baked_cache);
+}
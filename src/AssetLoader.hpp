@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Graphics/RenderAPI.hpp"
+#include "Utils/AssetTask.hpp"
+#include "Utils/GltfLoader.hpp"
+#include "Utils/GltfMaterialLoader.hpp"
+#include "Utils/MeshAsset.hpp"
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Awaitable asset loading for gameplay code that needs assets after the
+// level has started, without blocking frames or chaining callbacks:
+//
+//   AssetTask<void> spawnCrate(AssetLoader& assets, gameObject& owner)
+//   {
+//       auto document = co_await assets.load<GltfDocument>("models/crate.gltf");
+//       auto geometry = co_await assets.load<MeshAsset>("models/crate.gltf");
+//       auto materials = co_await assets.loadMaterials(document);
+//       // Back on the main thread: create the mesh component, set textures
+//   }
+//
+//   assets.start(spawnCrate(assets, crate));
+//
+// Every load reads and decodes on the shared ThreadPool and resumes the
+// awaiting coroutine on the main thread (the one that created the loader and
+// calls update()), where the render API may be used. Independent loads can
+// run side by side through whenAll(). Failures are logged and come back as
+// empty results (nullptr, INVALID_TEXTURE).
+//
+// Coroutines keep their parameters, not what references point to: pass
+// strings and configs by value, and make sure objects a coroutine refers to
+// outlive it. Destroying the loader cancels everything still running.
+class AssetLoader
+{
+public:
+    explicit AssetLoader(IRenderAPI* render_api);
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // load<MeshAsset>(file)     geometry, as loadMesh() with the default config
+    // load<GltfDocument>(file)  parsed glTF, as loadDocument()
+    template <typename T>
+    auto load(std::string filename);
+
+    // OBJ, glTF or .gmesh geometry, shared through the MeshAssetManager and
+    // the .gmesh cache like the geometry of mesh components
+    AssetTask<MeshAssetHandle> loadMesh(std::string filename, GltfLoaderConfig gltf_config = GltfLoaderConfig());
+
+    AssetTask<std::shared_ptr<const GltfDocument>> loadDocument(std::string filename);
+
+    // Takes a reference in the TextureManager; the caller releases it
+    AssetTask<TextureHandle> loadTexture(std::string filename, bool invert_y = true, bool generate_mipmaps = true,
+                                         TextureFormat format = TextureFormat::Auto);
+
+    // Materials of a parsed document with their textures, decoded on the
+    // workers. The texture references go when the last copy of the result is
+    // dropped, which has to happen on the main thread.
+    AssetTask<std::shared_ptr<const MaterialLoadResult>> loadMaterials(std::shared_ptr<const GltfDocument> document,
+                                                                       MaterialLoaderConfig config = MaterialLoaderConfig());
+
+    // Run a coroutine until it first suspends and keep it until it finishes.
+    // Main thread only.
+    void start(AssetTask<void> task);
+
+    // Continue coroutines waiting for the main thread, for up to
+    // time_budget_ms. Returns true once every started coroutine has finished.
+    bool update(float time_budget_ms = 4.0f);
+
+    size_t getRunningCount() const { return running.size(); }
+
+    struct WorkerAwaiter
+    {
+        AssetLoader* loader;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+    };
+
+    struct MainThreadAwaiter
+    {
+        AssetLoader* loader;
+
+        bool await_ready() const noexcept { return std::this_thread::get_id() == loader->main_thread; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+    };
+
+    // co_await these to move the rest of a coroutine to a worker, or back to
+    // the main thread (free when it is already there)
+    WorkerAwaiter resumeOnWorker() { return WorkerAwaiter{ this }; }
+    MainThreadAwaiter resumeOnMainThread() { return MainThreadAwaiter{ this }; }
+
+private:
+    IRenderAPI* render_api;
+    std::thread::id main_thread;
+    std::vector<AssetTask<void>> running;
+
+    std::deque<std::coroutine_handle<>> main_thread_queue;
+    std::mutex queue_mutex;
+    std::condition_variable workers_done;
+    size_t workers_in_flight = 0;       // Guarded by queue_mutex
+
+    static std::string getMeshKey(const std::string& filename, const GltfLoaderConfig& gltf_config);
+    static MeshAssetHandle loadGeometry(const std::string& filename, const GltfLoaderConfig& gltf_config);
+};
+
+template <typename T>
+auto AssetLoader::load(std::string filename)
+{
+    if constexpr (std::is_same_v<T, MeshAsset>)
+    {
+        return loadMesh(std::move(filename));
+    }
+    else if constexpr (std::is_same_v<T, GltfDocument>)
+    {
+        return loadDocument(std::move(filename));
+    }
+    else
+    {
+        static_assert(sizeof(T) == 0, "AssetLoader::load<T>() supports MeshAsset and GltfDocument");
+    }
+}
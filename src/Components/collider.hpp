@@ -1,6 +1,32 @@
 #pragma once
 
 #include "mesh.hpp"
+#include "Utils/Bvh.hpp"
+#include "TrianglePacket.hpp"
+#include <vector>
+
+// Triangles are grown by this factor around their center for the sphere
+// test, so spheres don't slip through the seams between neighbours
+constexpr float COLLIDER_TRIANGLE_EXTRUSION = 1.3f;
+
+// Collision triangle in world space, with everything the queries need
+// worked out once when the collider is prepared
+struct PhysicsTriangle
+{
+    vector3f v0, v1, v2;
+    vector3f normal;                // Unit length, from the winding
+    vector3f center;
+    vector3f edge1, edge2;          // v1 - v0 and v2 - v0
+
+    // Barycentric test of the extruded triangle: edges (v2 - v0, v1 - v0)
+    // scaled by the extrusion and their dot products
+    vector3f extruded_v0;
+    vector3f extruded_edge_u, extruded_edge_v;
+    float dot_uu, dot_uv, dot_vv, inv_denom;
+
+    // Of the extruded triangle
+    vector3f bounds_min, bounds_max;
+};
 
 class collider : public component
 {
@@ -9,13 +35,205 @@ public:
 
     collider(mesh& m, gameObject& obj) : component(obj), collider_mesh(&m) {};
 
-    bool is_mesh_valid() const 
+    bool is_mesh_valid() const
     {
         return collider_mesh != nullptr && collider_mesh->is_valid;
     }
-    
-    mesh* get_mesh() const 
+
+    mesh* get_mesh() const
     {
         return (collider_mesh != nullptr && collider_mesh->is_valid) ? collider_mesh : nullptr;
     }
-};
\ No newline at end of file
+
+    // World-space triangles of the mesh, rebuilt only when the object's
+    // position, rotation or scale (or the mesh) changed since the last call.
+    // They are stored in the leaf order of get_tree().
+    const std::vector<PhysicsTriangle>& get_triangles()
+    {
+        if (!is_prepared())
+        {
+            build_triangles();
+        }
+        return triangles;
+    }
+
+    // Everything below is only valid after get_triangles()
+
+    // SAH tree over the extruded triangle bounds; leaf positions index get_triangles()
+    const Bvh& get_tree() const { return tree; }
+
+    // The triangles of a leaf of get_tree() in packets of TRIANGLE_PACKET_WIDTH:
+    // lane k of packet j is triangle leaf.first + j * TRIANGLE_PACKET_WIDTH + k
+    const TrianglePacket* get_leaf_packets(uint32_t node) const { return packets.data() + leaf_packets[node]; }
+
+    static uint32_t get_packet_count(uint32_t triangle_count)
+    {
+        return (triangle_count + TRIANGLE_PACKET_WIDTH - 1) / TRIANGLE_PACKET_WIDTH;
+    }
+
+    // Collision triangle from world-space corners
+    static PhysicsTriangle make_triangle(const vector3f& v0, const vector3f& v1, const vector3f& v2)
+    {
+        PhysicsTriangle triangle;
+        triangle.v0 = v0;
+        triangle.v1 = v1;
+        triangle.v2 = v2;
+        triangle.center = (triangle.v0 + triangle.v1 + triangle.v2) / 3.0f;
+        triangle.edge1 = triangle.v1 - triangle.v0;
+        triangle.edge2 = triangle.v2 - triangle.v0;
+        triangle.normal = triangle.edge1.crossProduct(triangle.edge2);
+        triangle.normal.normalize();
+
+        triangle.extruded_v0 = (triangle.v0 - triangle.center) * COLLIDER_TRIANGLE_EXTRUSION + triangle.center;
+        triangle.extruded_edge_u = triangle.edge2 * COLLIDER_TRIANGLE_EXTRUSION;
+        triangle.extruded_edge_v = triangle.edge1 * COLLIDER_TRIANGLE_EXTRUSION;
+        triangle.dot_uu = triangle.extruded_edge_u.dotProduct(triangle.extruded_edge_u);
+        triangle.dot_uv = triangle.extruded_edge_u.dotProduct(triangle.extruded_edge_v);
+        triangle.dot_vv = triangle.extruded_edge_v.dotProduct(triangle.extruded_edge_v);
+        triangle.inv_denom = 1.0f / (triangle.dot_uu * triangle.dot_vv - triangle.dot_uv * triangle.dot_uv);
+
+        const vector3f extruded_v1 = triangle.extruded_v0 + triangle.extruded_edge_v;
+        const vector3f extruded_v2 = triangle.extruded_v0 + triangle.extruded_edge_u;
+        triangle.bounds_min = triangle.extruded_v0;
+        triangle.bounds_max = triangle.extruded_v0;
+        for (const vector3f& corner : { extruded_v1, extruded_v2 })
+        {
+            triangle.bounds_min.X = std::min(triangle.bounds_min.X, corner.X);
+            triangle.bounds_min.Y = std::min(triangle.bounds_min.Y, corner.Y);
+            triangle.bounds_min.Z = std::min(triangle.bounds_min.Z, corner.Z);
+            triangle.bounds_max.X = std::max(triangle.bounds_max.X, corner.X);
+            triangle.bounds_max.Y = std::max(triangle.bounds_max.Y, corner.Y);
+            triangle.bounds_max.Z = std::max(triangle.bounds_max.Z, corner.Z);
+        }
+        return triangle;
+    }
+
+    // Bounds of every extruded triangle
+    const vector3f& get_bounds_min() const { return bounds_min; }
+    const vector3f& get_bounds_max() const { return bounds_max; }
+
+    // Changes with every rebuild and is never reused by another collider
+    uint64_t get_revision() const { return revision; }
+
+private:
+    std::vector<PhysicsTriangle> triangles;
+    Bvh tree;
+    std::vector<TrianglePacket> packets;
+    std::vector<uint32_t> leaf_packets;     // First packet of each leaf node
+    vector3f bounds_min;
+    vector3f bounds_max;
+    uint64_t revision = 0;
+
+    static inline uint64_t last_revision = 0;
+
+    // What the triangles were built from
+    const vertex* built_vertices = nullptr;
+    size_t built_vertex_count = 0;
+    vector3f built_position;
+    vector3f built_rotation;
+    vector3f built_scale;
+    bool built = false;
+
+    bool is_prepared() const
+    {
+        const vertex* vertices = is_mesh_valid() ? collider_mesh->vertices : nullptr;
+        const size_t vertex_count = is_mesh_valid() ? collider_mesh->vertices_len : 0;
+        return built &&
+            built_vertices == vertices && built_vertex_count == vertex_count &&
+            built_position == obj.position && built_rotation == obj.rotation && built_scale == obj.scale;
+    }
+
+    void build_triangles()
+    {
+        triangles.clear();
+        tree.clear();
+        packets.clear();
+        leaf_packets.clear();
+        revision = ++last_revision;
+        bounds_min = obj.position;
+        bounds_max = obj.position;
+
+        built = true;
+        built_vertices = is_mesh_valid() ? collider_mesh->vertices : nullptr;
+        built_vertex_count = is_mesh_valid() ? collider_mesh->vertices_len : 0;
+        built_position = obj.position;
+        built_rotation = obj.rotation;
+        built_scale = obj.scale;
+
+        if (!built_vertices)
+        {
+            return;
+        }
+
+        // Same transform the renderer draws the object with
+        const matrix4f transform = obj.getTransformMatrix();
+
+        triangles.reserve(built_vertex_count / 3);
+        for (size_t i = 0; i + 2 < built_vertex_count; i += 3)
+        {
+            vector3f v0(built_vertices[i].vx, built_vertices[i].vy, built_vertices[i].vz);
+            vector3f v1(built_vertices[i + 1].vx, built_vertices[i + 1].vy, built_vertices[i + 1].vz);
+            vector3f v2(built_vertices[i + 2].vx, built_vertices[i + 2].vy, built_vertices[i + 2].vz);
+            transform.transformVect(v0);
+            transform.transformVect(v1);
+            transform.transformVect(v2);
+
+            PhysicsTriangle triangle = make_triangle(v0, v1, v2);
+
+            if (triangles.empty())
+            {
+                bounds_min = triangle.bounds_min;
+                bounds_max = triangle.bounds_max;
+            }
+            else
+            {
+                bounds_min.X = std::min(bounds_min.X, triangle.bounds_min.X);
+                bounds_min.Y = std::min(bounds_min.Y, triangle.bounds_min.Y);
+                bounds_min.Z = std::min(bounds_min.Z, triangle.bounds_min.Z);
+                bounds_max.X = std::max(bounds_max.X, triangle.bounds_max.X);
+                bounds_max.Y = std::max(bounds_max.Y, triangle.bounds_max.Y);
+                bounds_max.Z = std::max(bounds_max.Z, triangle.bounds_max.Z);
+            }
+            triangles.push_back(triangle);
+        }
+
+        std::vector<BvhBounds> triangle_bounds(triangles.size());
+        for (size_t i = 0; i < triangles.size(); ++i)
+        {
+            triangle_bounds[i].bounds_min = triangles[i].bounds_min;
+            triangle_bounds[i].bounds_max = triangles[i].bounds_max;
+        }
+        tree.build(triangle_bounds, TRIANGLE_PACKET_WIDTH);
+
+        // Leaves then read neighbouring triangles
+        std::vector<PhysicsTriangle> ordered;
+        ordered.reserve(triangles.size());
+        for (uint32_t index : tree.getOrder())
+        {
+            ordered.push_back(triangles[index]);
+        }
+        triangles = std::move(ordered);
+
+        // Packets never span two leaves, so a leaf's last one may have empty lanes
+        const std::vector<BvhNode>& nodes = tree.getNodes();
+        leaf_packets.assign(nodes.size(), 0);
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (!nodes[i].isLeaf())
+            {
+                continue;
+            }
+
+            leaf_packets[i] = static_cast<uint32_t>(packets.size());
+            for (uint32_t first = 0; first < nodes[i].count; first += TRIANGLE_PACKET_WIDTH)
+            {
+                TrianglePacket& packet = packets.emplace_back();
+                packet.clear();
+                for (uint32_t lane = 0; lane < TRIANGLE_PACKET_WIDTH && first + lane < nodes[i].count; ++lane)
+                {
+                    packet.setLane(lane, triangles[nodes[i].first + first + lane]);
+                }
+            }
+        }
+    }
+};
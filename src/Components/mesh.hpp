@@ -2,10 +2,15 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include "gameObject.hpp"
 #include "Graphics/RenderAPI.hpp"
 #include "Utils/ObjLoader.hpp" 
 #include "Utils/GltfLoader.hpp" 
+#include "Utils/BakedMesh.hpp"
+#include "Utils/AssetCatalog.hpp"
+#include "Utils/MeshAsset.hpp"
+#include "Utils/Hash.hpp"
 
 #include <algorithm>
 
@@ -14,17 +19,28 @@ enum class MeshFormat
     OBJ,
     GLTF,
     GLB,
+    Baked,  // Pre-baked .gmesh, memory-mapped and used in place
     Auto  // Detect from file extension
 };
 
 class mesh : public component
 {
 public:
+    // View of the asset's vertices, kept for the renderer and physics
     vertex* vertices;
     size_t vertices_len;
-    bool owns_vertices;
     bool is_valid;
 
+    // Shared geometry: vertex stream, material ranges and scene-graph nodes
+    MeshAssetHandle asset;
+
+    // Load OBJ/glTF through a .gmesh cache next to the source, rebuilt when
+    // the source or the loader settings change
+    static inline bool use_baked_cache = true;
+
+    // Texture per material index; materials without one use texture
+    std::vector<TextureHandle> material_textures;
+
     TextureHandle texture;
     bool texture_set;
 
@@ -35,41 +51,28 @@ public:
     // Constructor for hardcoded vertex arrays (existing functionality)
     mesh(vertex* vertices, size_t vertices_len, gameObject& obj) : component(obj)
     {
-        this->vertices = vertices;
-        this->vertices_len = vertices_len;
-        this->owns_vertices = false;
-        this->is_valid = (vertices != nullptr && vertices_len > 0);
-        visible = true;
-        culling = true;
-        transparent = false;
-        texture_set = false;
-        texture = INVALID_TEXTURE;
+        init_defaults();
+        use_asset(MeshAsset::fromExternal(vertices, vertices_len));
+    };
+
+    // Another instance of already loaded geometry
+    mesh(MeshAssetHandle mesh_asset, gameObject& obj) : component(obj)
+    {
+        init_defaults();
+        use_asset(std::move(mesh_asset));
     };
 
     // Constructor for loading model files - now supports both OBJ and glTF
     mesh(const std::string& filename, gameObject& obj, MeshFormat format = MeshFormat::Auto) : component(obj)
     {
-        vertices = nullptr;
-        vertices_len = 0;
-        owns_vertices = true;
-        is_valid = false;
-        visible = true;
-        culling = true;
-        transparent = false;
-        texture_set = false;
-        texture = INVALID_TEXTURE;
-
+        init_defaults();
         load_model_file(filename, format);
     };
 
     // Destructor
     ~mesh()
     {
-        if (owns_vertices && vertices)
-        {
-            delete[] vertices;
-            vertices = nullptr;
-        }
+        release_vertices();
     }
 
     void set_texture(TextureHandle tex)
@@ -78,6 +81,43 @@ public:
         texture_set = (tex != INVALID_TEXTURE);
     };
 
+    void set_material_textures(std::vector<TextureHandle> textures)
+    {
+        material_textures = std::move(textures);
+    }
+
+    TextureHandle get_material_texture(int material_index) const
+    {
+        if (material_index >= 0 && material_index < (int)material_textures.size() &&
+            material_textures[material_index] != INVALID_TEXTURE)
+        {
+            return material_textures[material_index];
+        }
+        return texture_set ? texture : INVALID_TEXTURE;
+    }
+
+    const std::vector<mesh_node>& get_nodes() const
+    {
+        static const std::vector<mesh_node> no_nodes;
+        return asset ? asset->nodes : no_nodes;
+    }
+
+    const std::vector<mesh_submesh>& get_submeshes() const
+    {
+        static const std::vector<mesh_submesh> no_submeshes;
+        return asset ? asset->submeshes : no_submeshes;
+    }
+
+    // Point this component at shared geometry
+    bool use_asset(MeshAssetHandle mesh_asset)
+    {
+        asset = std::move(mesh_asset);
+        vertices = asset ? const_cast<vertex*>(asset->vertices) : nullptr; // Assets are never written through meshes
+        vertices_len = asset ? asset->vertex_count : 0;
+        is_valid = asset && asset->isValid();
+        return is_valid;
+    }
+
     // Get render state for this mesh
     RenderState getRenderState() const
     {
@@ -111,6 +151,9 @@ public:
         case MeshFormat::GLB:
             return load_gltf_file(filename);
 
+        case MeshFormat::Baked:
+            return load_baked_file(filename);
+
         default:
             printf("Unsupported mesh format for file: %s\n", filename.c_str());
             return false;
@@ -121,12 +164,7 @@ public:
     bool load_obj_file(const std::string& filename, bool use_fast_loader = true)
     {
         // Clean up existing vertices if any
-        if (owns_vertices && vertices)
-        {
-            delete[] vertices;
-            vertices = nullptr;
-            vertices_len = 0;
-        }
+        release_vertices();
 
         // Configure the loader
         ObjLoaderConfig config;
@@ -135,6 +173,17 @@ public:
         config.validate_texcoords = false;  // Set to true for extra safety
         config.triangulate = true;
 
+        uint64_t config_hash = BakedMesh::hashConfig(config);
+        std::string key = MeshAssetManager::makeKey(filename, config_hash);
+        if (use_asset(MeshAssetManager::get().find(key)))
+        {
+            return true;
+        }
+        if (use_baked_cache && use_baked_mesh(MeshAssetManager::get().addBaked(key, filename, config_hash), filename))
+        {
+            return true;
+        }
+
         // Load the OBJ file
         ObjLoadResult result;
         if (use_fast_loader)
@@ -153,15 +202,8 @@ public:
             return false;
         }
 
-        // Take ownership of the loaded data
-        vertices = result.vertices;
-        vertices_len = result.vertex_count;
-        owns_vertices = true;
-        is_valid = true;
-
-        // Prevent the result from cleaning up the vertices (we now own them)
-        result.vertices = nullptr;
-        result.vertex_count = 0;
+        // The asset takes ownership of the loaded data
+        use_asset(MeshAssetManager::get().addLoaded(key, result, filename, config_hash, use_baked_cache));
 
         printf("Successfully loaded OBJ mesh: %s (%zu vertices)\n", filename.c_str(), vertices_len);
         return true;
@@ -171,12 +213,7 @@ public:
     bool load_gltf_file(const std::string& filename)
     {
         // Clean up existing vertices if any
-        if (owns_vertices && vertices)
-        {
-            delete[] vertices;
-            vertices = nullptr;
-            vertices_len = 0;
-        }
+        release_vertices();
 
         // Configure the glTF loader
         GltfLoaderConfig config;
@@ -189,6 +226,17 @@ public:
         config.triangulate = true;
         config.scale = 1.0f;
 
+        uint64_t config_hash = BakedMesh::hashConfig(config);
+        std::string key = MeshAssetManager::makeKey(filename, config_hash);
+        if (use_asset(MeshAssetManager::get().find(key)))
+        {
+            return true;
+        }
+        if (use_baked_cache && use_baked_mesh(MeshAssetManager::get().addBaked(key, filename, config_hash), filename))
+        {
+            return true;
+        }
+
         // Load the glTF file
         GltfLoadResult result = GltfLoader::loadGltf(filename, config);
 
@@ -199,15 +247,8 @@ public:
             return false;
         }
 
-        // Take ownership of the loaded data
-        vertices = result.vertices;
-        vertices_len = result.vertex_count;
-        owns_vertices = true;
-        is_valid = true;
-
-        // Prevent the result from cleaning up the vertices (we now own them)
-        result.vertices = nullptr;
-        result.vertex_count = 0;
+        // The asset takes ownership of the loaded data
+        use_asset(MeshAssetManager::get().addLoaded(key, result, filename, config_hash, use_baked_cache));
 
         printf("Successfully loaded glTF mesh: %s (%zu vertices)\n", filename.c_str(), vertices_len);
 
@@ -225,16 +266,32 @@ public:
         return true;
     }
 
+    // Load a .gmesh directly
+    bool load_baked_file(const std::string& filename)
+    {
+        release_vertices();
+
+        std::string key = MeshAssetManager::makeKey(filename, hashString("gmesh"));
+        if (use_asset(MeshAssetManager::get().find(key)))
+        {
+            return true;
+        }
+
+        std::string error;
+        if (!use_baked_mesh(MeshAssetManager::get().addBaked(key, BakedMesh::open(filename, &error)), filename))
+        {
+            printf("Failed to load mesh from %s: %s\n", filename.c_str(), error.c_str());
+            is_valid = false;
+            return false;
+        }
+        return true;
+    }
+
     // Load specific mesh from glTF file by name
     bool load_gltf_mesh_by_name(const std::string& filename, const std::string& mesh_name)
     {
         // Clean up existing vertices
-        if (owns_vertices && vertices)
-        {
-            delete[] vertices;
-            vertices = nullptr;
-            vertices_len = 0;
-        }
+        release_vertices();
 
         GltfLoaderConfig config;
         config.verbose_logging = true;
@@ -242,6 +299,13 @@ public:
         config.flip_uvs = true;
         config.triangulate = true;
 
+        // Keyed by the selected mesh as well as the file
+        std::string key = MeshAssetManager::makeKey(filename, hashCombine(BakedMesh::hashConfig(config), hashString("mesh:" + mesh_name)));
+        if (use_asset(MeshAssetManager::get().find(key)))
+        {
+            return true;
+        }
+
         GltfLoadResult result = GltfLoader::loadGltfMesh(filename, mesh_name, config);
 
         if (!result.success)
@@ -252,13 +316,8 @@ public:
             return false;
         }
 
-        vertices = result.vertices;
-        vertices_len = result.vertex_count;
-        owns_vertices = true;
-        is_valid = true;
-
-        result.vertices = nullptr;
-        result.vertex_count = 0;
+        // Not baked: the cache holds the whole file, not one of its meshes
+        use_asset(MeshAssetManager::get().addLoaded(key, result, filename, 0, false));
 
         printf("Successfully loaded glTF mesh '%s': %s (%zu vertices)\n",
             mesh_name.c_str(), filename.c_str(), vertices_len);
@@ -269,12 +328,7 @@ public:
     bool load_gltf_mesh_by_index(const std::string& filename, size_t mesh_index)
     {
         // Clean up existing vertices
-        if (owns_vertices && vertices)
-        {
-            delete[] vertices;
-            vertices = nullptr;
-            vertices_len = 0;
-        }
+        release_vertices();
 
         GltfLoaderConfig config;
         config.verbose_logging = true;
@@ -282,6 +336,13 @@ public:
         config.flip_uvs = true;
         config.triangulate = true;
 
+        // Keyed by the selected mesh as well as the file
+        std::string key = MeshAssetManager::makeKey(filename, hashCombine(BakedMesh::hashConfig(config), hashString("mesh#" + std::to_string(mesh_index))));
+        if (use_asset(MeshAssetManager::get().find(key)))
+        {
+            return true;
+        }
+
         GltfLoadResult result = GltfLoader::loadGltfMesh(filename, mesh_index, config);
 
         if (!result.success)
@@ -292,13 +353,8 @@ public:
             return false;
         }
 
-        vertices = result.vertices;
-        vertices_len = result.vertex_count;
-        owns_vertices = true;
-        is_valid = true;
-
-        result.vertices = nullptr;
-        result.vertex_count = 0;
+        // Not baked: the cache holds the whole file, not one of its meshes
+        use_asset(MeshAssetManager::get().addLoaded(key, result, filename, 0, false));
 
         printf("Successfully loaded glTF mesh %zu: %s (%zu vertices)\n",
             mesh_index, filename.c_str(), vertices_len);
@@ -314,6 +370,15 @@ public:
     // Static utility methods for file information
     static bool validate_model_file(const std::string& filename, MeshFormat format = MeshFormat::Auto)
     {
+        // Answer from the asset catalog when it has an up-to-date record
+        if (format == MeshFormat::Auto)
+        {
+            if (const AssetRecord* record = AssetCatalog::get().findCurrent(filename))
+            {
+                return record->valid;
+            }
+        }
+
         MeshFormat detected_format = (format == MeshFormat::Auto) ? detectMeshFormat(filename) : format;
 
         switch (detected_format)
@@ -325,6 +390,9 @@ public:
         case MeshFormat::GLB:
             return GltfLoader::validateGltfFile(filename);
 
+        case MeshFormat::Baked:
+            return BakedMesh::open(filename) != nullptr;
+
         default:
             return false;
         }
@@ -332,6 +400,14 @@ public:
 
     static size_t get_model_vertex_count(const std::string& filename, MeshFormat format = MeshFormat::Auto)
     {
+        if (format == MeshFormat::Auto)
+        {
+            if (const AssetRecord* record = AssetCatalog::get().findCurrent(filename))
+            {
+                return record->valid ? record->vertex_count : 0;
+            }
+        }
+
         MeshFormat detected_format = (format == MeshFormat::Auto) ? detectMeshFormat(filename) : format;
 
         switch (detected_format)
@@ -343,6 +419,12 @@ public:
         case MeshFormat::GLB:
             return GltfLoader::getGltfVertexCount(filename);
 
+        case MeshFormat::Baked:
+        {
+            std::shared_ptr<BakedMesh> baked_file = BakedMesh::open(filename);
+            return baked_file ? baked_file->getVertexCount() : 0;
+        }
+
         default:
             return 0;
         }
@@ -360,6 +442,38 @@ public:
     }
 
 private:
+    void init_defaults()
+    {
+        vertices = nullptr;
+        vertices_len = 0;
+        is_valid = false;
+        visible = true;
+        culling = true;
+        transparent = false;
+        texture_set = false;
+        texture = INVALID_TEXTURE;
+    }
+
+    // Drop this component's reference to its geometry
+    void release_vertices()
+    {
+        use_asset(nullptr);
+    }
+
+    // Use a baked mapping's asset (false if there is none)
+    bool use_baked_mesh(MeshAssetHandle baked_mesh, const std::string& filename)
+    {
+        if (!baked_mesh)
+        {
+            return false;
+        }
+
+        use_asset(std::move(baked_mesh));
+
+        printf("Loaded baked mesh: %s (%zu vertices)\n", filename.c_str(), vertices_len);
+        return is_valid;
+    }
+
     // Detect mesh format from file extension
     static MeshFormat detectMeshFormat(const std::string& filename)
     {
@@ -380,6 +494,10 @@ private:
         {
             return MeshFormat::GLB;
         }
+        else if (extension == "gmesh")
+        {
+            return MeshFormat::Baked;
+        }
 
         // Default to OBJ for unknown extensions (maintain backward compatibility)
         return MeshFormat::OBJ;
@@ -6,6 +6,7 @@
 #include "InputManager.hpp"
 #include "SDL.h"
 
+#include <cmath>
 #include <cstring>
 #include "irrlicht/vector3.h"
 #include "irrlicht/matrix4.h"
@@ -27,6 +28,11 @@ public:
     float jump_force;
     float mouse_sensitivity;
 
+    // The tick the friction and camera follow were tuned at; they are scaled
+    // by how many of these a tick lasts, so the feel does not change with the
+    // tick rate
+    static constexpr float TUNED_DELTA = 0.16f;
+
     // updated by the world class whilst colliding
     vector3f ground_normal;
     bool grounded;
@@ -91,10 +97,11 @@ public:
         bool wishJump = input_manager->is_key_held(SDL_SCANCODE_SPACE);
         bool jump = wishJump && grounded;   // conditions for jumping
         
+        const float tuned_ticks = delta / TUNED_DELTA;
         player_rb.velocity += wish_dir * speed * delta;
         if (grounded)
         {
-            player_rb.velocity *= 0.6f; // friction
+            player_rb.velocity *= powf(0.6f, tuned_ticks); // friction
             if (jump)
                 player_rb.velocity.Y = jump_force;
             else
@@ -102,11 +109,12 @@ public:
         }
         else
         {
-            player_rb.velocity *= 0.7f; // air friction
+            player_rb.velocity *= powf(0.7f, tuned_ticks); // air friction
             player_rb.velocity.Y -= 2.0f * delta;
         }
         
-        player_camera.position = obj.position.getInterpolated(player_camera.position, delta);
+        const float follow = 1.0f - powf(1.0f - TUNED_DELTA, tuned_ticks);
+        player_camera.position = obj.position.getInterpolated(player_camera.position, follow);
     }
     
     // Legacy methods for backward compatibility
@@ -3,18 +3,42 @@
 #include <vector>
 #include "gameObject.hpp"
 
+// What a body collides with other bodies as; sizes are in world units and
+// centered on the object's position, turned by its rotation but not scaled
+enum class BodyShape
+{
+    None,       // Doesn't collide with other bodies
+    Sphere,     // radius
+    Capsule,    // radius around a segment of half_height each way along local Y
+    Box         // half_extents
+};
+
 class rigidbody : public component
 {
 public:
     vector3f velocity;
     vector3f force;
-    float mass;
-    
+    float mass;                 // 0 makes the body immovable by other bodies
+
     bool apply_gravity;
 
+    // Radius of the sphere swept against colliders when the body moves fast
+    // enough to pass through thin geometry in one step; 0 turns that off
+    float ccd_radius;
+
+    BodyShape shape;
+    float radius;
+    float half_height;
+    vector3f half_extents;
+
     rigidbody(gameObject& obj) : component(obj)
     {
         mass = 1;
         apply_gravity = true;
+        ccd_radius = 0;
+        shape = BodyShape::None;
+        radius = 0.5f;
+        half_height = 0.5f;
+        half_extents = vector3f(0.5f, 0.5f, 0.5f);
     };
-};
\ No newline at end of file
+};
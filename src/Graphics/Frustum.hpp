@@ -0,0 +1,81 @@
+#pragma once
+
+#include "RenderAPI.hpp"
+#include "Components/camera.hpp"
+#include <cmath>
+
+// Axis-aligned box enclosing box [min, max] after transform
+inline void transformBox(const matrix4f& transform, const vector3f& min, const vector3f& max,
+                         vector3f& out_min, vector3f& out_max)
+{
+    const vector3f center = (min + max) * 0.5f;
+    const vector3f extent = (max - min) * 0.5f;
+
+    vector3f new_center;
+    transform.transformVect(new_center, center);
+
+    // Each output axis grows by the absolute contribution of every input axis
+    const float* m = transform.pointer();
+    vector3f new_extent(
+        std::fabs(m[0]) * extent.X + std::fabs(m[4]) * extent.Y + std::fabs(m[8]) * extent.Z,
+        std::fabs(m[1]) * extent.X + std::fabs(m[5]) * extent.Y + std::fabs(m[9]) * extent.Z,
+        std::fabs(m[2]) * extent.X + std::fabs(m[6]) * extent.Y + std::fabs(m[10]) * extent.Z);
+
+    out_min = new_center - new_extent;
+    out_max = new_center + new_extent;
+}
+
+// The six planes of a camera's view volume, normals pointing inwards.
+// Built from the same look-at and perspective parameters the render API
+// uses, so it matches what ends up on screen.
+class Frustum
+{
+public:
+    static Frustum fromCamera(const camera& cam, const ProjectionSettings& projection)
+    {
+        vector3f position = cam.getPosition();
+        vector3f forward = (cam.getTarget() - position).normalize();
+        vector3f right = forward.crossProduct(cam.getUpVector()).normalize();
+        vector3f up = right.crossProduct(forward);
+
+        const float tan_v = std::tan(projection.fov_degrees * 0.5f * 3.14159265f / 180.0f);
+        const float tan_h = tan_v * projection.aspect;
+
+        Frustum frustum;
+        frustum.setPlane(0, forward, position + forward * projection.near_plane);
+        frustum.setPlane(1, -forward, position + forward * projection.far_plane);
+        frustum.setPlane(2, right + forward * tan_h, position);
+        frustum.setPlane(3, -right + forward * tan_h, position);
+        frustum.setPlane(4, up + forward * tan_v, position);
+        frustum.setPlane(5, -up + forward * tan_v, position);
+        return frustum;
+    }
+
+    // False only when the box is certainly outside
+    bool intersectsBox(const vector3f& min, const vector3f& max) const
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            // Corner furthest along the plane normal
+            vector3f corner(normals[i].X >= 0.0f ? max.X : min.X,
+                            normals[i].Y >= 0.0f ? max.Y : min.Y,
+                            normals[i].Z >= 0.0f ? max.Z : min.Z);
+            if (normals[i].dotProduct(corner) + distances[i] < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    vector3f normals[6];
+    float distances[6] = {};
+
+    void setPlane(int index, vector3f normal, const vector3f& point)
+    {
+        normal.normalize();
+        normals[index] = normal;
+        distances[index] = -normal.dotProduct(point);
+    }
+};
@@ -1,7 +1,11 @@
 #include "OpenGLRenderAPI.hpp"
 #include "Components/mesh.hpp"
 #include "Components/camera.hpp"
+#include "Utils/PngDecoder.hpp"
+#include "Utils/AssetFile.hpp"
 #include <stdio.h>
+#include <vector>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -11,7 +15,7 @@
 #include "stb_image.h"
 
 OpenGLRenderAPI::OpenGLRenderAPI()
-    : window_handle(nullptr), gl_context(nullptr), viewport_width(0), viewport_height(0), field_of_view(75.0f)
+    : window_handle(nullptr), gl_context(nullptr), viewport_width(0), viewport_height(0)
 {
 }
 
@@ -25,7 +29,7 @@ bool OpenGLRenderAPI::initialize(WindowHandle window, int width, int height, flo
     window_handle = window;
     viewport_width = width;
     viewport_height = height;
-    field_of_view = fov;
+    projection.fov_degrees = fov;
 
     if (!createOpenGLContext(window))
     {
@@ -60,12 +64,12 @@ void OpenGLRenderAPI::resize(int width, int height)
     viewport_width = width;
     viewport_height = height;
 
-    float ratio = (float)width / (float)height;
+    projection.aspect = (float)width / (float)height;
 
     // Set up projection matrix
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
-    gluPerspective(field_of_view, ratio, 0.1, 200.0);
+    gluPerspective(projection.fov_degrees, projection.aspect, projection.near_plane, projection.far_plane);
 
     // Set up viewport
     glViewport(0, 0, width, height);
@@ -154,6 +158,9 @@ void OpenGLRenderAPI::setupOpenGLDefaults()
     // Shading model
     glShadeModel(GL_SMOOTH);
 
+    // Scaled transforms (objects and glTF nodes) would otherwise scale the lighting
+    glEnable(GL_NORMALIZE);
+
     // Enable vertex arrays
     glEnableClientState(GL_VERTEX_ARRAY);
     glEnableClientState(GL_NORMAL_ARRAY);
@@ -235,57 +242,200 @@ void OpenGLRenderAPI::rotate(const matrix4f& rotation)
     glMultMatrixf(rotation.pointer());
 }
 
-TextureHandle OpenGLRenderAPI::loadTexture(const std::string& filename, bool invert_y, bool generate_mipmaps)
+// GL 1.x storage for each texture format. Single/dual channel formats map onto
+// luminance (+alpha), which the fixed-function pipeline expands to RGB(A).
+struct GLTextureFormat
 {
-    int width, height, channels;
+    GLint internal_format;
+    GLenum format;
+    int channels;
+};
 
-    stbi_set_flip_vertically_on_load(invert_y);
+static GLTextureFormat getGLTextureFormat(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::R8:     return { GL_LUMINANCE8, GL_LUMINANCE, 1 };
+    case TextureFormat::RG8:    return { GL_LUMINANCE8_ALPHA8, GL_LUMINANCE_ALPHA, 2 };
+    case TextureFormat::RGB8:   return { GL_RGB8, GL_RGB, 3 };
+    case TextureFormat::RGB565: return { GL_RGB5, GL_RGB, 3 };
+    case TextureFormat::RGBA4:  return { GL_RGBA4, GL_RGBA, 4 };
+    case TextureFormat::RGBA8:
+    default:                    return { GL_RGBA8, GL_RGBA, 4 };
+    }
+}
 
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &channels, 0);
-    if (!data)
+// Pick the smallest lossless layout for Auto/Auto16 by looking at the pixels
+static TextureFormat resolveAutoFormat(const unsigned char* pixels, size_t pixel_count, int channels, bool use_16bit)
+{
+    bool has_alpha = false;
+    bool is_gray = (channels <= 2);
+
+    if (channels == 2 || channels == 4)
     {
-        fprintf(stderr, "Failed to load texture: %s\n", filename.c_str());
-        return INVALID_TEXTURE;
+        for (size_t i = 0; i < pixel_count && !has_alpha; ++i)
+        {
+            has_alpha = pixels[i * channels + channels - 1] != 255;
+        }
     }
 
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    if (channels >= 3)
+    {
+        is_gray = true;
+        for (size_t i = 0; i < pixel_count && is_gray; ++i)
+        {
+            const unsigned char* p = pixels + i * channels;
+            is_gray = (p[0] == p[1] && p[1] == p[2]);
+        }
+    }
 
-    // Determine format based on channels
-    GLenum format;
-    GLenum internal_format;
-    switch (channels)
+    if (is_gray)
+    {
+        return has_alpha ? TextureFormat::RG8 : TextureFormat::R8;
+    }
+
+    if (has_alpha)
+    {
+        return use_16bit ? TextureFormat::RGBA4 : TextureFormat::RGBA8;
+    }
+
+    return use_16bit ? TextureFormat::RGB565 : TextureFormat::RGB8;
+}
+
+// Rearrange decoded pixels into the channel layout of the upload format.
+// Gray sources are replicated into RGB; a two-channel target takes
+// luminance+alpha from gray-alpha images and R+G (e.g. normal XY) otherwise.
+static std::vector<unsigned char> repackChannels(const unsigned char* pixels, size_t pixel_count,
+                                                 int src_channels, int dst_channels, bool gray_alpha)
+{
+    int channel_map[4] = { 0, 0, 0, -1 }; // -1 = constant 255
+
+    bool src_gray = (src_channels <= 2);
+    bool src_alpha = (src_channels == 2 || src_channels == 4);
+    int alpha_index = src_alpha ? src_channels - 1 : -1;
+
+    switch (dst_channels)
     {
     case 1:
-        format = GL_LUMINANCE;
-        internal_format = GL_LUMINANCE;
+        channel_map[0] = 0;
+        break;
+    case 2:
+        channel_map[0] = 0;
+        channel_map[1] = (gray_alpha || src_gray) ? alpha_index : 1;
         break;
     case 3:
-        format = GL_RGB;
-        internal_format = GL_RGB;
+        channel_map[0] = 0;
+        channel_map[1] = src_gray ? 0 : 1;
+        channel_map[2] = src_gray ? 0 : 2;
         break;
     case 4:
-        format = GL_RGBA;
-        internal_format = GL_RGBA;
+        channel_map[0] = 0;
+        channel_map[1] = src_gray ? 0 : 1;
+        channel_map[2] = src_gray ? 0 : 2;
+        channel_map[3] = alpha_index;
         break;
-    default:
+    }
+
+    std::vector<unsigned char> out(pixel_count * dst_channels);
+    for (size_t i = 0; i < pixel_count; ++i)
+    {
+        const unsigned char* src = pixels + i * src_channels;
+        unsigned char* dst = out.data() + i * dst_channels;
+        for (int c = 0; c < dst_channels; ++c)
+        {
+            dst[c] = channel_map[c] >= 0 ? src[channel_map[c]] : 255;
+        }
+    }
+
+    return out;
+}
+
+TextureHandle OpenGLRenderAPI::loadTexture(const std::string& filename, bool invert_y, bool generate_mipmaps,
+                                           TextureFormat format)
+{
+    // Most of our textures are plain 8-bit PNGs, which the fast decoder handles;
+    // everything else goes through stb_image
+    AssetFile file;
+    if (!file.open(filename))
+    {
+        fprintf(stderr, "Failed to load texture: %s\n", filename.c_str());
+        return INVALID_TEXTURE;
+    }
+
+    PngImage png;
+    if (PngDecoder::decode(file.data(), file.size(), png, invert_y))
+    {
+        return createTexture(png.pixels.get(), png.width, png.height, png.channels, generate_mipmaps, format);
+    }
+
+    int width, height, channels;
+
+    stbi_set_flip_vertically_on_load(invert_y);
+
+    unsigned char* data = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, 0);
+    if (!data)
+    {
+        fprintf(stderr, "Failed to load texture: %s\n", filename.c_str());
+        return INVALID_TEXTURE;
+    }
+
+    TextureHandle texture = createTexture(data, width, height, channels, generate_mipmaps, format);
+    stbi_image_free(data);
+
+    return texture;
+}
+
+TextureHandle OpenGLRenderAPI::createTexture(const unsigned char* pixels, int width, int height, int channels,
+                                             bool generate_mipmaps, TextureFormat format)
+{
+    if (!pixels || width <= 0 || height <= 0)
+    {
+        return INVALID_TEXTURE;
+    }
+
+    if (channels < 1 || channels > 4)
+    {
         fprintf(stderr, "Unsupported number of channels: %d\n", channels);
-        stbi_image_free(data);
-        glDeleteTextures(1, &texture);
         return INVALID_TEXTURE;
     }
 
+    size_t pixel_count = (size_t)width * (size_t)height;
+
+    bool gray_alpha = false;
+    if (format == TextureFormat::Auto || format == TextureFormat::Auto16)
+    {
+        format = resolveAutoFormat(pixels, pixel_count, channels, format == TextureFormat::Auto16);
+        gray_alpha = (format == TextureFormat::RG8);
+    }
+
+    GLTextureFormat gl_format = getGLTextureFormat(format);
+
+    // Only copy when the upload layout differs from the decoded one
+    std::vector<unsigned char> repacked;
+    const unsigned char* upload = pixels;
+    if (gl_format.channels != channels)
+    {
+        repacked = repackChannels(pixels, pixel_count, channels, gl_format.channels, gray_alpha);
+        upload = repacked.data();
+    }
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    // Rows of 1- and 3-channel images are not 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
     // Generate mipmaps if requested
     if (generate_mipmaps)
     {
-        gluBuild2DMipmaps(GL_TEXTURE_2D, internal_format, width, height, format, GL_UNSIGNED_BYTE, data);
+        gluBuild2DMipmaps(GL_TEXTURE_2D, gl_format.internal_format, width, height, gl_format.format, GL_UNSIGNED_BYTE, upload);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     }
     else
     {
-        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, gl_format.internal_format, width, height, 0, gl_format.format, GL_UNSIGNED_BYTE, upload);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     }
@@ -294,7 +444,7 @@ TextureHandle OpenGLRenderAPI::loadTexture(const std::string& filename, bool inv
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-    stbi_image_free(data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glBindTexture(GL_TEXTURE_2D, 0);
 
     return (TextureHandle)texture;
@@ -329,8 +479,15 @@ void OpenGLRenderAPI::deleteTexture(TextureHandle texture)
 }
 
 void OpenGLRenderAPI::renderMesh(const mesh& m, const RenderState& state)
+{
+    renderMeshRange(m, 0, m.vertices_len, state);
+}
+
+void OpenGLRenderAPI::renderMeshRange(const mesh& m, size_t first_vertex, size_t vertex_count, const RenderState& state)
 {
     if (!m.visible || !m.is_valid || m.vertices_len == 0) return;
+    if (first_vertex >= m.vertices_len || vertex_count == 0) return;
+    vertex_count = std::min(vertex_count, m.vertices_len - first_vertex);
 
     // Apply render state before rendering
     applyRenderState(state);
@@ -347,7 +504,7 @@ void OpenGLRenderAPI::renderMesh(const mesh& m, const RenderState& state)
     glColor3f(1.0f, 1.0f, 1.0f);
 
     // Draw the mesh
-    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m.vertices_len));
+    glDrawArrays(GL_TRIANGLES, static_cast<GLint>(first_vertex), static_cast<GLsizei>(vertex_count));
 
     // Reset some states after rendering to prevent bleeding
     if (state.blend_mode != BlendMode::None)
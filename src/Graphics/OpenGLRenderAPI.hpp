@@ -24,7 +24,7 @@ private:
     OpenGLContext gl_context;
     int viewport_width;
     int viewport_height;
-    float field_of_view;
+    ProjectionSettings projection;
     RenderState current_state;
 
     // Internal helper methods
@@ -56,13 +56,19 @@ public:
     virtual void translate(const vector3f& pos) override;
     virtual void rotate(const matrix4f& rotation) override;
     virtual void multiplyMatrix(const matrix4f& matrix) override;
+    virtual ProjectionSettings getProjection() const override { return projection; }
 
-    virtual TextureHandle loadTexture(const std::string& filename, bool invert_y = false, bool generate_mipmaps = true) override;
+    virtual TextureHandle loadTexture(const std::string& filename, bool invert_y = false, bool generate_mipmaps = true,
+                                      TextureFormat format = TextureFormat::Auto) override;
+    virtual TextureHandle createTexture(const unsigned char* pixels, int width, int height, int channels,
+                                        bool generate_mipmaps = true, TextureFormat format = TextureFormat::Auto) override;
     virtual void bindTexture(TextureHandle texture) override;
     virtual void unbindTexture() override;
     virtual void deleteTexture(TextureHandle texture) override;
 
     virtual void renderMesh(const mesh& m, const RenderState& state = RenderState()) override;
+    virtual void renderMeshRange(const mesh& m, size_t first_vertex, size_t vertex_count,
+                                 const RenderState& state = RenderState()) override;
 
     virtual void setRenderState(const RenderState& state) override;
     virtual void enableLighting(bool enable) override;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstring>          // Before irrlicht, whose matrix4.h uses memcpy and memset
 #include "irrlicht/vector3.h"
 #include "irrlicht/matrix4.h"
 #include <string>
@@ -41,6 +42,22 @@ enum class DepthTest
     LessEqual
 };
 
+// Storage format for texture uploads. Auto keeps whatever the image needs
+// losslessly: grayscale becomes one channel and an all-opaque alpha channel is
+// dropped. The fixed-function path has no R/RG formats, so single- and
+// two-channel textures are stored as luminance / luminance-alpha.
+enum class TextureFormat
+{
+    Auto,
+    Auto16,     // Like Auto, but color is stored as RGB565 / RGBA4
+    R8,         // Single channel (gloss, specular, occlusion)
+    RG8,        // Two channels (normal XY; Z has to be rebuilt when sampled)
+    RGB8,
+    RGBA8,
+    RGB565,
+    RGBA4
+};
+
 struct RenderState
 {
     CullMode cull_mode = CullMode::Back;
@@ -51,6 +68,15 @@ struct RenderState
     vector3f color = vector3f(1.0f, 1.0f, 1.0f);
 };
 
+// Perspective the scene is drawn with
+struct ProjectionSettings
+{
+    float fov_degrees = 75.0f;  // Vertical
+    float aspect = 1.0f;
+    float near_plane = 0.1f;
+    float far_plane = 200.0f;
+};
+
 // Abstract rendering API interface
 class IRenderAPI
 {
@@ -75,15 +101,23 @@ public:
     virtual void translate(const vector3f& pos) = 0;
     virtual void rotate(const matrix4f& rotation) = 0;
     virtual void multiplyMatrix(const matrix4f& matrix) = 0;
+    virtual ProjectionSettings getProjection() const = 0;
 
     // Texture management
-    virtual TextureHandle loadTexture(const std::string& filename, bool invert_y = false, bool generate_mipmaps = true) = 0;
+    virtual TextureHandle loadTexture(const std::string& filename, bool invert_y = false, bool generate_mipmaps = true,
+                                      TextureFormat format = TextureFormat::Auto) = 0;
+    // Upload already decoded 8-bit pixels (rows tightly packed, 1-4 channels)
+    virtual TextureHandle createTexture(const unsigned char* pixels, int width, int height, int channels,
+                                        bool generate_mipmaps = true, TextureFormat format = TextureFormat::Auto) = 0;
     virtual void bindTexture(TextureHandle texture) = 0;
     virtual void unbindTexture() = 0;
     virtual void deleteTexture(TextureHandle texture) = 0;
 
     // Mesh rendering
     virtual void renderMesh(const mesh& m, const RenderState& state = RenderState()) = 0;
+    // Draw vertices [first_vertex, first_vertex + vertex_count) of the mesh
+    virtual void renderMeshRange(const mesh& m, size_t first_vertex, size_t vertex_count,
+                                 const RenderState& state = RenderState()) = 0;
 
     // State management
     virtual void setRenderState(const RenderState& state) = 0;
@@ -0,0 +1,371 @@
+#include "TextureManager.hpp"
+#include "Utils/AssetFile.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+#include "stb_image.h"
+
+TextureManager& TextureManager::get()
+{
+    static TextureManager instance;
+    return instance;
+}
+
+void TextureManager::initialize(IRenderAPI* api)
+{
+    render_api = api;
+}
+
+void TextureManager::shutdown()
+{
+    if (render_api)
+    {
+        for (const auto& entry : entries)
+        {
+            render_api->deleteTexture(entry.first);
+        }
+    }
+
+    entries.clear();
+    handles_by_key.clear();
+    pending_deletes.clear();
+    clearStagedImages();
+    render_api = nullptr;
+}
+
+TextureHandle TextureManager::acquire(const std::string& filename, bool invert_y, bool generate_mipmaps,
+                                     TextureFormat format)
+{
+    if (!render_api)
+    {
+        fprintf(stderr, "TextureManager used before initialization: %s\n", filename.c_str());
+        return INVALID_TEXTURE;
+    }
+
+    std::string key = makeKey(canonicalizePath(filename), invert_y, generate_mipmaps, format);
+
+    TextureHandle handle = findAndAddRef(key);
+    if (handle != INVALID_TEXTURE)
+    {
+        return handle;
+    }
+
+    std::shared_ptr<const PngImage> staged = findStagedImage(canonicalizePath(filename), invert_y);
+    if (staged)
+    {
+        handle = render_api->createTexture(staged->pixels.get(), staged->width, staged->height, staged->channels,
+                                           generate_mipmaps, format);
+    }
+    else
+    {
+        handle = render_api->loadTexture(filename, invert_y, generate_mipmaps, format);
+    }
+
+    if (handle != INVALID_TEXTURE)
+    {
+        registerTexture(key, handle);
+    }
+
+    return handle;
+}
+
+TextureHandle TextureManager::acquirePacked(const std::vector<TextureChannelSource>& sources, bool invert_y,
+                                           bool generate_mipmaps, TextureFormat format)
+{
+    if (!render_api || sources.empty() || sources.size() > 4)
+    {
+        return INVALID_TEXTURE;
+    }
+
+    std::string packed_name = "packed:";
+    for (const auto& source : sources)
+    {
+        packed_name += canonicalizePath(source.filename) + "#" + std::to_string(source.channel) + ";";
+    }
+    std::string key = makeKey(packed_name, invert_y, generate_mipmaps, format);
+
+    TextureHandle handle = findAndAddRef(key);
+    if (handle != INVALID_TEXTURE)
+    {
+        return handle;
+    }
+
+    // Decode every distinct source image once
+    std::unordered_map<std::string, std::shared_ptr<const PngImage>> images;
+
+    int width = 0;
+    int height = 0;
+
+    for (const auto& source : sources)
+    {
+        if (images.count(source.filename))
+        {
+            continue;
+        }
+
+        std::shared_ptr<const PngImage> image = findStagedImage(canonicalizePath(source.filename), invert_y);
+        if (!image)
+        {
+            auto decoded = std::make_shared<PngImage>();
+            if (!decodeImage(source.filename, invert_y, *decoded))
+            {
+                fprintf(stderr, "Failed to load texture for packing: %s\n", source.filename.c_str());
+                return INVALID_TEXTURE;
+            }
+            image = std::move(decoded);
+        }
+
+        if (images.empty())
+        {
+            width = image->width;
+            height = image->height;
+        }
+
+        if (image->width != width || image->height != height)
+        {
+            fprintf(stderr, "Cannot pack textures of different sizes: %s\n", source.filename.c_str());
+            return INVALID_TEXTURE;
+        }
+
+        images[source.filename] = std::move(image);
+    }
+
+    const int channels = static_cast<int>(sources.size());
+    const size_t pixel_count = (size_t)width * (size_t)height;
+    std::vector<unsigned char> packed(pixel_count * channels);
+
+    for (int c = 0; c < channels; ++c)
+    {
+        const PngImage& image = *images[sources[c].filename];
+
+        // Gray images answer every color channel with their single value
+        int src_channel = sources[c].channel;
+        if (image.channels <= 2)
+        {
+            src_channel = (src_channel == 3 && image.channels == 2) ? 1 : 0;
+        }
+
+        if (src_channel >= image.channels)
+        {
+            for (size_t i = 0; i < pixel_count; ++i)
+            {
+                packed[i * channels + c] = 255;
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < pixel_count; ++i)
+        {
+            packed[i * channels + c] = image.pixels[i * image.channels + src_channel];
+        }
+    }
+
+    handle = render_api->createTexture(packed.data(), width, height, channels, generate_mipmaps, format);
+    if (handle != INVALID_TEXTURE)
+    {
+        registerTexture(key, handle);
+    }
+
+    return handle;
+}
+
+TextureHandle TextureManager::findAndAddRef(const std::string& key)
+{
+    auto it = handles_by_key.find(key);
+    if (it == handles_by_key.end())
+    {
+        return INVALID_TEXTURE;
+    }
+
+    // A pending delete is simply revived by bumping the count again
+    entries[it->second].ref_count++;
+    return it->second;
+}
+
+void TextureManager::registerTexture(const std::string& key, TextureHandle handle)
+{
+    TextureEntry entry;
+    entry.key = key;
+    entry.handle = handle;
+    entry.ref_count = 1;
+
+    handles_by_key[key] = handle;
+    entries[handle] = std::move(entry);
+}
+
+bool TextureManager::isLoaded(const std::string& filename, bool invert_y, bool generate_mipmaps,
+                              TextureFormat format) const
+{
+    return handles_by_key.count(makeKey(canonicalizePath(filename), invert_y, generate_mipmaps, format)) > 0;
+}
+
+void TextureManager::addRef(TextureHandle texture)
+{
+    auto it = entries.find(texture);
+    if (it != entries.end())
+    {
+        it->second.ref_count++;
+    }
+}
+
+void TextureManager::release(TextureHandle texture)
+{
+    auto it = entries.find(texture);
+    if (it == entries.end() || it->second.ref_count <= 0)
+    {
+        return;
+    }
+
+    if (--it->second.ref_count == 0)
+    {
+        pending_deletes.push_back(texture);
+    }
+}
+
+void TextureManager::collectGarbage()
+{
+    if (pending_deletes.empty())
+    {
+        return;
+    }
+
+    for (TextureHandle texture : pending_deletes)
+    {
+        auto it = entries.find(texture);
+        if (it == entries.end() || it->second.ref_count > 0)
+        {
+            continue; // Re-acquired since it was queued
+        }
+
+        if (render_api)
+        {
+            render_api->deleteTexture(texture);
+        }
+
+        handles_by_key.erase(it->second.key);
+        entries.erase(it);
+    }
+
+    pending_deletes.clear();
+}
+
+bool TextureManager::decodeImage(const std::string& filename, bool invert_y, PngImage& image)
+{
+    AssetFile file;
+    if (!file.open(filename))
+    {
+        return false;
+    }
+
+    if (PngDecoder::decode(file.data(), file.size(), image, invert_y))
+    {
+        return true;
+    }
+
+    // The per-thread flip flag keeps concurrent decodes from racing on stb's global one
+    stbi_set_flip_vertically_on_load_thread(invert_y);
+    unsigned char* pixels = stbi_load_from_memory(file.data(), static_cast<int>(file.size()),
+                                                  &image.width, &image.height, &image.channels, 0);
+    if (!pixels)
+    {
+        return false;
+    }
+
+    size_t size = (size_t)image.width * (size_t)image.height * (size_t)image.channels;
+    image.pixels.reset(new unsigned char[size]);
+    memcpy(image.pixels.get(), pixels, size);
+    stbi_image_free(pixels);
+    return true;
+}
+
+void TextureManager::stageImage(const std::string& filename, bool invert_y, PngImage image)
+{
+    std::string key = makeStagedKey(canonicalizePath(filename), invert_y);
+    auto staged = std::make_shared<const PngImage>(std::move(image));
+
+    // A second decode of the same file is dropped; the first one is identical
+    std::lock_guard<std::mutex> lock(staged_mutex);
+    StagedImage& entry = staged_images[key];
+    if (!entry.image)
+    {
+        entry.image = std::move(staged);
+    }
+    ++entry.stage_count;
+}
+
+void TextureManager::unstageImage(const std::string& filename, bool invert_y)
+{
+    std::string key = makeStagedKey(canonicalizePath(filename), invert_y);
+
+    std::lock_guard<std::mutex> lock(staged_mutex);
+    auto it = staged_images.find(key);
+    if (it != staged_images.end() && --it->second.stage_count <= 0)
+    {
+        staged_images.erase(it);
+    }
+}
+
+void TextureManager::clearStagedImages()
+{
+    std::lock_guard<std::mutex> lock(staged_mutex);
+    staged_images.clear();
+}
+
+size_t TextureManager::getStagedImageCount() const
+{
+    std::lock_guard<std::mutex> lock(staged_mutex);
+    return staged_images.size();
+}
+
+std::shared_ptr<const PngImage> TextureManager::findStagedImage(const std::string& canonical_path, bool invert_y) const
+{
+    std::lock_guard<std::mutex> lock(staged_mutex);
+    auto it = staged_images.find(makeStagedKey(canonical_path, invert_y));
+    return it != staged_images.end() ? it->second.image : nullptr;
+}
+
+std::string TextureManager::canonicalizePath(const std::string& filename)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    fs::path path = fs::weakly_canonical(fs::path(filename), ec);
+    if (ec)
+    {
+        path = fs::path(filename).lexically_normal();
+    }
+
+    std::string canonical = path.generic_string();
+
+#ifdef _WIN32
+    // NTFS is case-insensitive, so "Models/A.png" and "models/a.png" are the same image
+    std::transform(canonical.begin(), canonical.end(), canonical.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+#endif
+
+    return canonical;
+}
+
+int TextureManager::getRefCount(TextureHandle texture) const
+{
+    auto it = entries.find(texture);
+    return it != entries.end() ? it->second.ref_count : 0;
+}
+
+std::string TextureManager::makeKey(const std::string& canonical_path, bool invert_y, bool generate_mipmaps,
+                                    TextureFormat format)
+{
+    std::string key = canonical_path;
+    key += invert_y ? "|flip" : "|noflip";
+    key += generate_mipmaps ? "|mips" : "|nomips";
+    key += "|fmt" + std::to_string(static_cast<int>(format));
+    return key;
+}
+
+std::string TextureManager::makeStagedKey(const std::string& canonical_path, bool invert_y)
+{
+    return canonical_path + (invert_y ? "|flip" : "|noflip");
+}
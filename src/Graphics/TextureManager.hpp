@@ -0,0 +1,107 @@
+#pragma once
+
+#include "RenderAPI.hpp"
+#include "Utils/PngDecoder.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One output channel of a channel-packed texture: take `channel` of `filename`
+struct TextureChannelSource
+{
+    std::string filename;
+    int channel = 0;
+};
+
+// Process-wide texture registry that sits in front of IRenderAPI::loadTexture.
+// Textures are keyed by canonical path plus load flags so the same image is
+// only uploaded once, no matter which loader asks for it. Every acquire() must
+// be paired with a release(); textures whose count drops to zero are queued
+// and only deleted by collectGarbage(), so a release followed by a re-acquire
+// in the same frame (e.g. reloading a model) does not hit the disk again.
+class TextureManager
+{
+public:
+    static TextureManager& get();
+
+    void initialize(IRenderAPI* api);
+    void shutdown();
+    bool isInitialized() const { return render_api != nullptr; }
+
+    // Load (or reuse) a texture and take a reference to it
+    TextureHandle acquire(const std::string& filename, bool invert_y = false, bool generate_mipmaps = true,
+                          TextureFormat format = TextureFormat::Auto);
+
+    // Build one texture whose channel i comes from sources[i] (1-4 sources,
+    // all images must have the same size). Shared like any other texture.
+    TextureHandle acquirePacked(const std::vector<TextureChannelSource>& sources, bool invert_y = false,
+                                bool generate_mipmaps = true, TextureFormat format = TextureFormat::Auto);
+
+    // True if acquire() with these arguments would reuse an uploaded texture
+    bool isLoaded(const std::string& filename, bool invert_y = false, bool generate_mipmaps = true,
+                  TextureFormat format = TextureFormat::Auto) const;
+
+    // Reference counting for handles obtained from acquire()
+    void addRef(TextureHandle texture);
+    void release(TextureHandle texture);
+
+    // Delete textures that have been unreferenced since the last collection
+    void collectGarbage();
+
+    // Decode an image file to 8-bit pixels without touching the render API.
+    // Safe to call from any thread.
+    static bool decodeImage(const std::string& filename, bool invert_y, PngImage& image);
+
+    // Hand over pixels decoded off the render thread (thread-safe). Until
+    // unstaged, acquire() and acquirePacked() upload staged pixels for the
+    // same file and orientation instead of reading the file again. Staging is
+    // counted, so loaders running side by side each unstage exactly what they
+    // staged without dropping images another one still needs.
+    void stageImage(const std::string& filename, bool invert_y, PngImage image);
+    void unstageImage(const std::string& filename, bool invert_y);
+    void clearStagedImages();
+    size_t getStagedImageCount() const;
+
+    // Utility
+    static std::string canonicalizePath(const std::string& filename);
+    int getRefCount(TextureHandle texture) const;
+    size_t getTextureCount() const { return entries.size(); }
+    size_t getPendingDeleteCount() const { return pending_deletes.size(); }
+
+private:
+    struct TextureEntry
+    {
+        std::string key;
+        TextureHandle handle = INVALID_TEXTURE;
+        int ref_count = 0;
+    };
+
+    IRenderAPI* render_api = nullptr;
+    std::unordered_map<std::string, TextureHandle> handles_by_key;
+    std::unordered_map<TextureHandle, TextureEntry> entries;
+    std::vector<TextureHandle> pending_deletes;
+
+    struct StagedImage
+    {
+        std::shared_ptr<const PngImage> image;
+        int stage_count = 0;
+    };
+
+    // Decoded images keyed by canonical path and orientation
+    std::unordered_map<std::string, StagedImage> staged_images;
+    mutable std::mutex staged_mutex;
+
+    TextureManager() = default;
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    TextureHandle findAndAddRef(const std::string& key);
+    void registerTexture(const std::string& key, TextureHandle handle);
+    std::shared_ptr<const PngImage> findStagedImage(const std::string& canonical_path, bool invert_y) const;
+
+    static std::string makeKey(const std::string& canonical_path, bool invert_y, bool generate_mipmaps,
+                               TextureFormat format);
+    static std::string makeStagedKey(const std::string& canonical_path, bool invert_y);
+};
@@ -4,6 +4,7 @@
 #include "Components/gameObject.hpp"
 #include "Components/mesh.hpp"
 #include "RenderAPI.hpp"
+#include "Frustum.hpp"
 #include <vector>
 
 class renderer
@@ -17,7 +18,7 @@ public:
 
     void setRenderAPI(IRenderAPI* api) { render_api = api; }
 
-    static void render_mesh_with_api(mesh& m, IRenderAPI* api)
+    static void render_mesh_with_api(mesh& m, IRenderAPI* api, const Frustum* frustum = nullptr)
     {
         if (!m.visible || !api) return;
         
@@ -29,22 +30,73 @@ public:
         api->multiplyMatrix(transform);
 
         // Bind texture if available
-        if (m.texture_set && m.texture != INVALID_TEXTURE)
+        TextureHandle bound_texture = m.texture_set ? m.texture : INVALID_TEXTURE;
+        bind_texture(api, bound_texture);
+
+        // Get render state from mesh and render
+        RenderState state = m.getRenderState();
+        if (!m.get_nodes().empty())
+        {
+            for (const mesh_node& node : m.get_nodes())
+            {
+                if (frustum)
+                {
+                    vector3f world_min, world_max;
+                    transformBox(transform, node.bounds_min, node.bounds_max, world_min, world_max);
+                    if (!frustum->intersectsBox(world_min, world_max))
+                    {
+                        continue;
+                    }
+                }
+
+                // Nodes are sorted by material, so this only rebinds between materials
+                TextureHandle node_texture = m.get_material_texture(node.material_index);
+                if (node_texture != bound_texture)
+                {
+                    bind_texture(api, node_texture);
+                    bound_texture = node_texture;
+                }
+
+                api->pushMatrix();
+                api->multiplyMatrix(node.transform);
+                api->renderMeshRange(m, node.first_vertex, node.vertex_count, state);
+                api->popMatrix();
+            }
+        }
+        else if (!m.get_submeshes().empty())
         {
-            api->bindTexture(m.texture);
+            for (const mesh_submesh& submesh : m.get_submeshes())
+            {
+                TextureHandle submesh_texture = m.get_material_texture(submesh.material_index);
+                if (submesh_texture != bound_texture)
+                {
+                    bind_texture(api, submesh_texture);
+                    bound_texture = submesh_texture;
+                }
+
+                api->renderMeshRange(m, submesh.first_vertex, submesh.vertex_count, state);
+            }
         }
         else
         {
-            api->unbindTexture();
+            api->renderMesh(m, state);
         }
 
-        // Get render state from mesh and render
-        RenderState state = m.getRenderState();
-        api->renderMesh(m, state);
-
         api->popMatrix();
     };
 
+    static void bind_texture(IRenderAPI* api, TextureHandle texture)
+    {
+        if (texture != INVALID_TEXTURE)
+        {
+            api->bindTexture(texture);
+        }
+        else
+        {
+            api->unbindTexture();
+        }
+    };
+
     void render_scene(camera& c)
     {
         if (!render_api)
@@ -72,12 +124,14 @@ public:
         // Render all meshes
         if (p_meshes && !p_meshes->empty())
         {
+            Frustum frustum = Frustum::fromCamera(c, render_api->getProjection());
+
             for (std::vector<mesh*>::iterator i = p_meshes->begin(); i != p_meshes->end(); i++)
             {
                 mesh* m = *i;
                 if (m && m->visible)
                 {
-                    render_mesh_with_api(*m, render_api);
+                    render_mesh_with_api(*m, render_api, &frustum);
                 }
             }
         }
@@ -0,0 +1,433 @@
+#include "LevelLoader.hpp"
+#include "Graphics/TextureManager.hpp"
+#include "Utils/AssetCatalog.hpp"
+#include "Utils/MeshAsset.hpp"
+#include "Utils/ThreadPool.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+LevelAsset& LevelManifest::addMesh(const std::string& filename, gameObject& owner)
+{
+    LevelAsset& asset = assets.emplace_back();
+    asset.type = LevelAssetType::Mesh;
+    asset.filename = filename;
+    asset.owner = &owner;
+    return asset;
+}
+
+LevelAsset& LevelManifest::addModel(const std::string& filename, gameObject& owner)
+{
+    LevelAsset& asset = assets.emplace_back();
+    asset.type = LevelAssetType::Model;
+    asset.filename = filename;
+    asset.owner = &owner;
+    return asset;
+}
+
+LevelAsset& LevelManifest::addTexture(const std::string& filename, bool invert_y, bool generate_mipmaps)
+{
+    LevelAsset& asset = assets.emplace_back();
+    asset.type = LevelAssetType::Texture;
+    asset.filename = filename;
+    asset.invert_y = invert_y;
+    asset.generate_mipmaps = generate_mipmaps;
+    return asset;
+}
+
+LevelLoader::LevelLoader(IRenderAPI* render_api) : render_api(render_api)
+{
+}
+
+LevelLoader::~LevelLoader()
+{
+    // Workers write into the asset states, so they have to be done first
+    {
+        std::unique_lock<std::mutex> lock(jobs_mutex);
+        jobs_posted.wait(lock, [this]() { return workers_in_flight == 0; });
+    }
+
+    for (auto& state : assets)
+    {
+        if (state->gltf_result.materials_loaded)
+        {
+            GltfMaterialLoader::cleanupMaterialTextures(state->gltf_result.material_data, render_api);
+        }
+    }
+
+    if (TextureManager::get().isInitialized())
+    {
+        // Assets still waiting for the main thread when a streamed cell is dropped
+        for (auto& state : assets)
+        {
+            for (const auto& image : state->staged_images)
+            {
+                TextureManager::get().unstageImage(image.first, image.second);
+            }
+        }
+
+        for (TextureHandle texture : texture_references)
+        {
+            TextureManager::get().release(texture);
+        }
+    }
+}
+
+bool LevelLoader::begin(const LevelManifest& manifest)
+{
+    if (started)
+    {
+        fprintf(stderr, "[Level Loader] begin() called twice\n");
+        return false;
+    }
+
+    if (!render_api || !TextureManager::get().isInitialized())
+    {
+        fprintf(stderr, "[Level Loader] Render API and texture manager must be initialized first\n");
+        return false;
+    }
+
+    started = true;
+    progress = LevelLoadProgress();
+    progress.total = manifest.getAssets().size();
+
+    for (const LevelAsset& asset : manifest.getAssets())
+    {
+        auto state = std::make_unique<AssetState>();
+        state->asset = asset;
+        assets_by_name[asset.getName()] = state.get();
+        assets.push_back(std::move(state));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        workers_in_flight = assets.size();
+    }
+
+    // Start the most expensive assets first so the slowest one does not start
+    // last; the cost estimate comes from the asset catalog when it knows the file
+    std::vector<std::pair<size_t, AssetState*>> order;
+    for (auto& state : assets)
+    {
+        order.emplace_back(estimateCost(state->asset), state.get());
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (const auto& entry : order)
+    {
+        AssetState* asset_state = entry.second;
+        ThreadPool::get().submit([this, asset_state]() { runWorker(asset_state); });
+    }
+
+    printf("[Level Loader] Loading %zu assets on %zu worker threads\n",
+           assets.size(), ThreadPool::get().getThreadCount());
+    return true;
+}
+
+bool LevelLoader::update(float time_budget_ms)
+{
+    if (!started)
+    {
+        return false;
+    }
+
+    using clock = std::chrono::steady_clock;
+    const clock::time_point deadline = clock::now() +
+        std::chrono::microseconds(static_cast<long long>(time_budget_ms * 1000.0f));
+
+    // Always run at least one job so a tiny budget still makes progress
+    do
+    {
+        std::function<void()> job;
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            if (main_thread_jobs.empty())
+            {
+                break;
+            }
+            job = std::move(main_thread_jobs.front());
+            main_thread_jobs.pop_front();
+        }
+
+        job();
+    } while (clock::now() < deadline);
+
+    if (isFinished() && !completion_reported)
+    {
+        completion_reported = true;
+        printf("[Level Loader] Finished loading %zu assets (%zu errors)\n", progress.total, errors.size());
+        if (completion_callback)
+        {
+            completion_callback(errors.empty());
+        }
+    }
+
+    return isFinished();
+}
+
+void LevelLoader::finish()
+{
+    while (!update(1000.0f))
+    {
+        std::unique_lock<std::mutex> lock(jobs_mutex);
+        jobs_posted.wait(lock, [this]() { return !main_thread_jobs.empty(); });
+    }
+}
+
+mesh* LevelLoader::getMesh(const std::string& name) const
+{
+    auto it = assets_by_name.find(name);
+    return it != assets_by_name.end() ? it->second->loaded_mesh.get() : nullptr;
+}
+
+TextureHandle LevelLoader::getTexture(const std::string& name) const
+{
+    auto it = textures.find(name);
+    return it != textures.end() ? it->second : INVALID_TEXTURE;
+}
+
+const MaterialLoadResult* LevelLoader::getMaterials(const std::string& name) const
+{
+    auto it = assets_by_name.find(name);
+    if (it == assets_by_name.end() || !it->second->gltf_result.materials_loaded)
+    {
+        return nullptr;
+    }
+    return &it->second->gltf_result.material_data;
+}
+
+size_t LevelLoader::estimateCost(const LevelAsset& asset)
+{
+    const AssetRecord* record = AssetCatalog::get().findCurrent(asset.filename);
+    if (!record)
+    {
+        return 0;
+    }
+
+    size_t cost = record->vertex_count + static_cast<size_t>(record->width) * record->height;
+    for (const auto& dependency : record->dependencies)
+    {
+        // Images a model references are decoded as part of it
+        if (const AssetRecord* image = AssetCatalog::get().findCurrent(dependency))
+        {
+            cost += static_cast<size_t>(image->width) * image->height;
+        }
+    }
+    return cost;
+}
+
+std::string LevelLoader::getGeometryKey(const LevelAsset& asset)
+{
+    return MeshAssetManager::makeKey(asset.filename, BakedMesh::hashConfig(asset.gltf_config));
+}
+
+void LevelLoader::runWorker(AssetState* state)
+{
+    switch (state->asset.type)
+    {
+    case LevelAssetType::Mesh:
+        loadMesh(state);
+        break;
+    case LevelAssetType::Model:
+        loadModel(state);
+        break;
+    case LevelAssetType::Texture:
+        loadTexture(state);
+        break;
+    }
+
+    // Posting and the in-flight count change together, so the destructor
+    // never sees a worker that still has to touch this loader
+    std::lock_guard<std::mutex> lock(jobs_mutex);
+    main_thread_jobs.push_back([this, state]()
+    {
+        if (state->error.empty())
+        {
+            if (state->asset.type == LevelAssetType::Model)
+            {
+                finishModel(state);
+            }
+            else if (state->asset.type == LevelAssetType::Texture)
+            {
+                finishTexture(state);
+            }
+        }
+        completeAsset(state);
+    });
+    --workers_in_flight;
+    jobs_posted.notify_all();
+}
+
+void LevelLoader::loadMesh(AssetState* state)
+{
+    auto loaded = std::make_unique<mesh>(state->asset.filename, *state->asset.owner);
+    if (!loaded->is_valid)
+    {
+        state->error = "Failed to load mesh: " + state->asset.filename;
+        return;
+    }
+    state->loaded_mesh = std::move(loaded);
+}
+
+void LevelLoader::loadModel(AssetState* state)
+{
+    const LevelAsset& asset = state->asset;
+
+    std::string error;
+    state->document = GltfDocument::load(asset.filename, error);
+    if (!state->document)
+    {
+        state->error = "Failed to parse " + asset.filename + ": " + error;
+        return;
+    }
+
+    // Other objects may already show this model; only its materials are needed then
+    const std::string key = getGeometryKey(asset);
+    const uint64_t config_hash = BakedMesh::hashConfig(asset.gltf_config);
+    state->geometry = MeshAssetManager::get().find(key);
+    if (!state->geometry && mesh::use_baked_cache)
+    {
+        state->geometry = MeshAssetManager::get().addBaked(key, asset.filename, config_hash);
+    }
+    if (!state->geometry)
+    {
+        state->gltf_result = GltfLoader::loadGltfGeometry(*state->document, asset.gltf_config);
+        if (!state->gltf_result.success)
+        {
+            state->error = "Failed to load " + asset.filename + ": " + state->gltf_result.error_message;
+            return;
+        }
+        state->geometry = MeshAssetManager::get().addLoaded(key, state->gltf_result, asset.filename, config_hash,
+                                                            mesh::use_baked_cache);
+    }
+
+    // Decode every image the materials will ask for, so the main thread only uploads
+    std::vector<std::pair<std::string, bool>> images;
+    for (const std::string& file : GltfMaterialLoader::getTextureFiles(*state->document, asset.material_config))
+    {
+        images.emplace_back(file, asset.material_config.flip_textures_vertically);
+    }
+    if (!asset.fallback_texture.empty())
+    {
+        images.emplace_back(asset.fallback_texture, asset.invert_y);
+    }
+
+    std::vector<char> staged(images.size(), 0);
+    ThreadPool::get().parallelFor(images.size(), [&images, &staged](size_t i)
+    {
+        PngImage image;
+        if (TextureManager::decodeImage(images[i].first, images[i].second, image))
+        {
+            TextureManager::get().stageImage(images[i].first, images[i].second, std::move(image));
+            staged[i] = 1;
+        }
+        // Failures are left to the upload, which falls back to loading the file and reports it
+    });
+
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        if (staged[i])
+        {
+            state->staged_images.push_back(std::move(images[i]));
+        }
+    }
+}
+
+void LevelLoader::loadTexture(AssetState* state)
+{
+    PngImage image;
+    if (!TextureManager::decodeImage(state->asset.filename, state->asset.invert_y, image))
+    {
+        state->error = "Failed to decode texture: " + state->asset.filename;
+        return;
+    }
+    TextureManager::get().stageImage(state->asset.filename, state->asset.invert_y, std::move(image));
+    state->staged_images.emplace_back(state->asset.filename, state->asset.invert_y);
+}
+
+void LevelLoader::finishModel(AssetState* state)
+{
+    const LevelAsset& asset = state->asset;
+    GltfLoadResult& result = state->gltf_result;
+
+    GltfLoader::loadMaterialsIntoResult(result, *state->document, render_api, asset.material_config);
+    state->document.reset();
+
+    state->loaded_mesh = std::make_unique<mesh>(std::move(state->geometry), *asset.owner);
+
+    // Every material draws with its own texture; the first one found is also
+    // the default for primitives whose material has none
+    TextureHandle default_texture = INVALID_TEXTURE;
+    if (result.materials_loaded)
+    {
+        std::vector<TextureHandle> material_textures;
+        for (const auto& material : result.material_data.materials)
+        {
+            TextureHandle primary_texture = material.getPrimaryTextureHandle();
+            material_textures.push_back(primary_texture);
+            if (default_texture == INVALID_TEXTURE)
+            {
+                default_texture = primary_texture;
+            }
+        }
+        state->loaded_mesh->set_material_textures(std::move(material_textures));
+    }
+
+    if (default_texture == INVALID_TEXTURE && !asset.fallback_texture.empty())
+    {
+        printf("[Level Loader] No material texture in %s, using %s\n",
+               asset.filename.c_str(), asset.fallback_texture.c_str());
+        default_texture = TextureManager::get().acquire(asset.fallback_texture, asset.invert_y,
+                                                        asset.generate_mipmaps, asset.format);
+        if (default_texture != INVALID_TEXTURE)
+        {
+            texture_references.push_back(default_texture);
+        }
+    }
+
+    if (default_texture != INVALID_TEXTURE)
+    {
+        state->loaded_mesh->set_texture(default_texture);
+    }
+}
+
+void LevelLoader::finishTexture(AssetState* state)
+{
+    const LevelAsset& asset = state->asset;
+    TextureHandle texture = TextureManager::get().acquire(asset.filename, asset.invert_y,
+                                                          asset.generate_mipmaps, asset.format);
+    if (texture == INVALID_TEXTURE)
+    {
+        state->error = "Failed to upload texture: " + asset.filename;
+        return;
+    }
+
+    texture_references.push_back(texture);
+    textures[asset.getName()] = texture;
+}
+
+void LevelLoader::completeAsset(AssetState* state)
+{
+    // Uploaded by now, or failed; other loaders keep their own stagings
+    for (const auto& image : state->staged_images)
+    {
+        TextureManager::get().unstageImage(image.first, image.second);
+    }
+    state->staged_images.clear();
+
+    if (!state->error.empty())
+    {
+        fprintf(stderr, "[Level Loader] %s\n", state->error.c_str());
+        errors.push_back(state->error);
+    }
+
+    ++progress.completed;
+    progress.last_asset = state->asset.getName();
+
+    if (progress_callback)
+    {
+        progress_callback(progress);
+    }
+}
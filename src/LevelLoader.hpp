@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Components/mesh.hpp"
+#include "Graphics/RenderAPI.hpp"
+#include "Utils/GltfLoader.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class LevelAssetType
+{
+    Mesh,       // Geometry only (OBJ, glTF or .gmesh), through mesh::load_model_file
+    Model,      // glTF geometry plus materials; the mesh gets the first material texture
+    Texture
+};
+
+struct LevelAsset
+{
+    LevelAssetType type = LevelAssetType::Mesh;
+    std::string name;               // Lookup key once loaded, the filename when empty
+    std::string filename;
+    gameObject* owner = nullptr;    // Mesh and Model: object the mesh is attached to
+
+    // Texture
+    bool invert_y = true;
+    bool generate_mipmaps = true;
+    TextureFormat format = TextureFormat::Auto;
+
+    // Model
+    GltfLoaderConfig gltf_config;
+    MaterialLoaderConfig material_config;
+    std::string fallback_texture;   // Used when no material has a texture
+
+    const std::string& getName() const { return name.empty() ? filename : name; }
+};
+
+// Everything a level needs before its first frame. References returned by
+// the add functions stay valid while more assets are added.
+class LevelManifest
+{
+public:
+    LevelAsset& addMesh(const std::string& filename, gameObject& owner);
+    LevelAsset& addModel(const std::string& filename, gameObject& owner);
+    LevelAsset& addTexture(const std::string& filename, bool invert_y = true, bool generate_mipmaps = true);
+
+    const std::deque<LevelAsset>& getAssets() const { return assets; }
+
+private:
+    std::deque<LevelAsset> assets;
+};
+
+struct LevelLoadProgress
+{
+    size_t completed = 0;
+    size_t total = 0;
+    std::string last_asset;         // Most recently finished asset
+
+    float getFraction() const { return total > 0 ? static_cast<float>(completed) / total : 1.0f; }
+};
+
+// Loads a manifest concurrently. File I/O, parsing and image decoding run as
+// jobs on the shared ThreadPool; everything that needs the render API (texture
+// uploads, glTF material setup) is queued back and runs inside update(), which
+// must be called from the thread that owns the GL context. Callbacks are only
+// ever invoked from update(), so a loading screen can draw between calls.
+//
+// Per asset the job graph is:
+//   Mesh     load geometry (worker)                                -> finish (main)
+//   Model    parse + geometry (worker) -> decode its images (workers) -> materials + mesh (main)
+//   Texture  decode (worker)                                       -> upload (main)
+//
+// The loader owns the meshes and texture references it produced.
+class LevelLoader
+{
+public:
+    using ProgressCallback = std::function<void(const LevelLoadProgress&)>;
+    using CompletionCallback = std::function<void(bool success)>;
+
+    explicit LevelLoader(IRenderAPI* render_api);
+    ~LevelLoader();
+
+    LevelLoader(const LevelLoader&) = delete;
+    LevelLoader& operator=(const LevelLoader&) = delete;
+
+    void setProgressCallback(ProgressCallback callback) { progress_callback = std::move(callback); }
+    void setCompletionCallback(CompletionCallback callback) { completion_callback = std::move(callback); }
+
+    // Start loading (the manifest is copied)
+    bool begin(const LevelManifest& manifest);
+
+    // Run queued main-thread work for up to time_budget_ms. Returns true once
+    // every asset has finished.
+    bool update(float time_budget_ms = 8.0f);
+
+    // Block until everything has loaded
+    void finish();
+
+    bool isFinished() const { return started && progress.completed == progress.total; }
+    const LevelLoadProgress& getProgress() const { return progress; }
+    const std::vector<std::string>& getErrors() const { return errors; }
+
+    // Results, by asset name
+    mesh* getMesh(const std::string& name) const;
+    TextureHandle getTexture(const std::string& name) const;
+    const MaterialLoadResult* getMaterials(const std::string& name) const;
+
+private:
+    struct AssetState
+    {
+        LevelAsset asset;
+        std::unique_ptr<mesh> loaded_mesh;
+        MeshAssetHandle geometry;           // Models: shared, baked or freshly loaded
+        GltfLoadResult gltf_result;
+        std::shared_ptr<const GltfDocument> document;
+        std::vector<std::pair<std::string, bool>> staged_images;   // Filename and invert_y, unstaged once finished
+        std::string error;
+    };
+
+    IRenderAPI* render_api;
+    std::vector<std::unique_ptr<AssetState>> assets;
+    std::unordered_map<std::string, AssetState*> assets_by_name;
+    std::unordered_map<std::string, TextureHandle> textures;
+    std::vector<TextureHandle> texture_references;
+
+    // Main-thread jobs posted by workers
+    std::deque<std::function<void()>> main_thread_jobs;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_posted;
+    size_t workers_in_flight = 0;       // Guarded by jobs_mutex
+
+    LevelLoadProgress progress;
+    std::vector<std::string> errors;
+    ProgressCallback progress_callback;
+    CompletionCallback completion_callback;
+    bool started = false;
+    bool completion_reported = false;
+
+    static size_t estimateCost(const LevelAsset& asset);
+    static std::string getGeometryKey(const LevelAsset& asset);
+    void runWorker(AssetState* state);
+    void postMainThreadJob(std::function<void()> job);
+    void loadMesh(AssetState* state);
+    void loadModel(AssetState* state);
+    void loadTexture(AssetState* state);
+    void finishModel(AssetState* state);
+    void finishTexture(AssetState* state);
+    void completeAsset(AssetState* state);
+};
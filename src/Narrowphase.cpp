@@ -0,0 +1,328 @@
+#include "Narrowphase.hpp"
+#include <algorithm>
+#include <cmath>
+
+static constexpr int CAPSULE_BOX_ITERATIONS = 32;     // Ternary search steps along the capsule's segment
+
+// A body's shape in world space
+struct BodyVolume
+{
+    BodyShape shape;
+    vector3f center;
+    vector3f axes[3];           // Local X, Y, Z turned by the rotation
+    vector3f segment_start;     // Spheres and capsules
+    vector3f segment_end;
+    float radius;
+    vector3f half_extents;      // Boxes
+};
+
+static float getAxis(const vector3f& v, int axis)
+{
+    return axis == 0 ? v.X : (axis == 1 ? v.Y : v.Z);
+}
+
+static BodyVolume getVolume(const rigidbody& body)
+{
+    BodyVolume volume;
+    volume.shape = body.shape;
+    volume.center = body.obj.position;
+    volume.radius = body.radius;
+    volume.half_extents = body.half_extents;
+
+    matrix4f rotation;
+    rotation.setRotationDegrees(body.obj.rotation);
+    volume.axes[0] = vector3f(1, 0, 0);
+    volume.axes[1] = vector3f(0, 1, 0);
+    volume.axes[2] = vector3f(0, 0, 1);
+    for (vector3f& axis : volume.axes)
+    {
+        rotation.rotateVect(axis);
+    }
+
+    vector3f half_segment = body.shape == BodyShape::Capsule ? volume.axes[1] * body.half_height : vector3f(0, 0, 0);
+    volume.segment_start = volume.center - half_segment;
+    volume.segment_end = volume.center + half_segment;
+    return volume;
+}
+
+BvhBounds getBodyBounds(const rigidbody& body)
+{
+    const BodyVolume volume = getVolume(body);
+    BvhBounds bounds;
+
+    if (volume.shape == BodyShape::Box)
+    {
+        vector3f extent(0, 0, 0);
+        for (int i = 0; i < 3; ++i)
+        {
+            const float half = getAxis(volume.half_extents, i);
+            extent.X += std::abs(volume.axes[i].X) * half;
+            extent.Y += std::abs(volume.axes[i].Y) * half;
+            extent.Z += std::abs(volume.axes[i].Z) * half;
+        }
+        bounds.bounds_min = volume.center - extent;
+        bounds.bounds_max = volume.center + extent;
+        return bounds;
+    }
+
+    const vector3f grow(volume.radius, volume.radius, volume.radius);
+    bounds.bounds_min = vector3f(std::min(volume.segment_start.X, volume.segment_end.X),
+                                 std::min(volume.segment_start.Y, volume.segment_end.Y),
+                                 std::min(volume.segment_start.Z, volume.segment_end.Z)) - grow;
+    bounds.bounds_max = vector3f(std::max(volume.segment_start.X, volume.segment_end.X),
+                                 std::max(volume.segment_start.Y, volume.segment_end.Y),
+                                 std::max(volume.segment_start.Z, volume.segment_end.Z)) + grow;
+    return bounds;
+}
+
+// Closest points of two segments (Ericson, Real-Time Collision Detection 5.1.9)
+static void getClosestPointsOfSegments(const vector3f& p1, const vector3f& q1, const vector3f& p2, const vector3f& q2,
+                                       vector3f& c1, vector3f& c2)
+{
+    const float epsilon = 1e-12f;
+    vector3f d1 = q1 - p1;
+    vector3f d2 = q2 - p2;
+    vector3f r = p1 - p2;
+    float a = d1.dotProduct(d1);
+    float e = d2.dotProduct(d2);
+    float f = d2.dotProduct(r);
+    float s = 0;
+    float t = 0;
+
+    if (a <= epsilon && e <= epsilon)
+    {
+        c1 = p1;
+        c2 = p2;
+        return;
+    }
+
+    if (a <= epsilon)
+    {
+        t = std::clamp(f / e, 0.0f, 1.0f);
+    }
+    else
+    {
+        float c = d1.dotProduct(r);
+        if (e <= epsilon)
+        {
+            s = std::clamp(-c / a, 0.0f, 1.0f);
+        }
+        else
+        {
+            float b = d1.dotProduct(d2);
+            float denom = a * e - b * b;
+            s = denom != 0 ? std::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+            t = (b * s + f) / e;
+            if (t < 0)
+            {
+                t = 0;
+                s = std::clamp(-c / a, 0.0f, 1.0f);
+            }
+            else if (t > 1)
+            {
+                t = 1;
+                s = std::clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+}
+
+// Normal of the contact from a to b when their centers are on top of each other
+static vector3f getFallbackNormal(const BodyVolume& a, const BodyVolume& b)
+{
+    vector3f normal = b.center - a.center;
+    if (normal.getLengthSQ() <= 1e-12f)
+        return vector3f(0, 1, 0);
+    return normal.normalize();
+}
+
+static bool getRoundContact(const BodyVolume& a, const BodyVolume& b, BodyContact& contact)
+{
+    vector3f closestA;
+    vector3f closestB;
+    getClosestPointsOfSegments(a.segment_start, a.segment_end, b.segment_start, b.segment_end, closestA, closestB);
+
+    vector3f offset = closestB - closestA;
+    float distanceSQ = offset.getLengthSQ();
+    float radii = a.radius + b.radius;
+    if (distanceSQ >= radii * radii)
+        return false;
+
+    float distance = std::sqrt(distanceSQ);
+    contact.normal = distance > 1e-6f ? offset / distance : getFallbackNormal(a, b);
+    contact.depth = radii - distance;
+    return true;
+}
+
+// Contact of a box with a sphere or capsule; the normal points from the box
+static bool getBoxRoundContact(const BodyVolume& box, const BodyVolume& round, BodyContact& contact)
+{
+    // Work in the box's frame, where it is [-half_extents, half_extents]
+    auto toLocal = [&box](const vector3f& p)
+    {
+        vector3f offset = p - box.center;
+        return vector3f(offset.dotProduct(box.axes[0]), offset.dotProduct(box.axes[1]), offset.dotProduct(box.axes[2]));
+    };
+    auto clampToBox = [&box](const vector3f& p)
+    {
+        return vector3f(std::clamp(p.X, -box.half_extents.X, box.half_extents.X),
+                        std::clamp(p.Y, -box.half_extents.Y, box.half_extents.Y),
+                        std::clamp(p.Z, -box.half_extents.Z, box.half_extents.Z));
+    };
+
+    const vector3f start = toLocal(round.segment_start);
+    const vector3f segment = toLocal(round.segment_end) - start;
+    auto getDistanceSQ = [&](float t)
+    {
+        vector3f p = start + segment * t;
+        return (p - clampToBox(p)).getLengthSQ();
+    };
+
+    // The distance from the box along the segment is convex, so a ternary
+    // search finds the closest segment point; a sphere has just the one
+    float low = 0;
+    float high = segment.getLengthSQ() > 0 ? 1.0f : 0.0f;
+    for (int i = 0; i < CAPSULE_BOX_ITERATIONS && high > low; ++i)
+    {
+        float third = (high - low) / 3.0f;
+        if (getDistanceSQ(low + third) < getDistanceSQ(high - third))
+            high -= third;
+        else
+            low += third;
+    }
+    const vector3f onSegment = start + segment * ((low + high) * 0.5f);
+    const vector3f offset = onSegment - clampToBox(onSegment);
+    const float distanceSQ = offset.getLengthSQ();
+    if (distanceSQ >= round.radius * round.radius)
+        return false;
+
+    vector3f localNormal;
+    if (distanceSQ > 1e-8f)
+    {
+        float distance = std::sqrt(distanceSQ);
+        localNormal = offset / distance;
+        contact.depth = round.radius - distance;
+    }
+    else
+    {
+        // The segment reaches into the box: separate the two along the axis
+        // of least overlap (box faces, and the segment crossed with the box's
+        // edges), then by the radius
+        const vector3f center = start + segment * 0.5f;
+        bool found = false;
+        auto testAxis = [&](vector3f axis)
+        {
+            float lengthSQ = axis.getLengthSQ();
+            if (lengthSQ < 1e-6f)
+                return;
+            axis /= std::sqrt(lengthSQ);
+
+            float boxExtent = box.half_extents.X * std::abs(axis.X) + box.half_extents.Y * std::abs(axis.Y) +
+                box.half_extents.Z * std::abs(axis.Z);
+            float segmentExtent = std::abs(segment.dotProduct(axis)) * 0.5f;
+            float distance = center.dotProduct(axis);
+            float overlap = boxExtent + segmentExtent - std::abs(distance);
+            if (!found || overlap < contact.depth)
+            {
+                localNormal = distance < 0 ? -axis : axis;
+                contact.depth = overlap;
+                found = true;
+            }
+        };
+
+        const vector3f localAxes[3] = { vector3f(1, 0, 0), vector3f(0, 1, 0), vector3f(0, 0, 1) };
+        for (const vector3f& axis : localAxes)
+        {
+            testAxis(axis);
+        }
+        for (const vector3f& axis : localAxes)
+        {
+            testAxis(segment.crossProduct(axis));
+        }
+        contact.depth += round.radius;
+    }
+
+    contact.normal = box.axes[0] * localNormal.X + box.axes[1] * localNormal.Y + box.axes[2] * localNormal.Z;
+    return true;
+}
+
+static bool getBoxContact(const BodyVolume& a, const BodyVolume& b, BodyContact& contact)
+{
+    const vector3f between = b.center - a.center;
+    bool found = false;
+
+    auto testAxis = [&](vector3f axis, bool isEdge)
+    {
+        float lengthSQ = axis.getLengthSQ();
+        if (lengthSQ < 1e-6f)
+            return true; // Parallel edges; the face axes cover it
+        axis /= std::sqrt(lengthSQ);
+
+        float extentA = 0;
+        float extentB = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            extentA += getAxis(a.half_extents, i) * std::abs(a.axes[i].dotProduct(axis));
+            extentB += getAxis(b.half_extents, i) * std::abs(b.axes[i].dotProduct(axis));
+        }
+
+        float distance = between.dotProduct(axis);
+        float overlap = extentA + extentB - std::abs(distance);
+        if (overlap <= 0)
+            return false;
+
+        // Edge axes have to win clearly, or resting boxes would jitter between them and the faces
+        if (!found || overlap < (isEdge ? contact.depth * 0.95f : contact.depth))
+        {
+            contact.normal = distance < 0 ? -axis : axis;
+            contact.depth = overlap;
+            found = true;
+        }
+        return true;
+    };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (!testAxis(a.axes[i], false) || !testAxis(b.axes[i], false))
+            return false;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            if (!testAxis(a.axes[i].crossProduct(b.axes[j]), true))
+                return false;
+        }
+    }
+    return found;
+}
+
+bool getBodyContact(const rigidbody& a, const rigidbody& b, BodyContact& contact)
+{
+    if (a.shape == BodyShape::None || b.shape == BodyShape::None)
+        return false;
+
+    const BodyVolume volumeA = getVolume(a);
+    const BodyVolume volumeB = getVolume(b);
+    const bool boxA = a.shape == BodyShape::Box;
+    const bool boxB = b.shape == BodyShape::Box;
+
+    if (boxA && boxB)
+        return getBoxContact(volumeA, volumeB, contact);
+
+    if (boxA)
+        return getBoxRoundContact(volumeA, volumeB, contact);
+
+    if (boxB)
+    {
+        if (!getBoxRoundContact(volumeB, volumeA, contact))
+            return false;
+        contact.normal = -contact.normal;
+        return true;
+    }
+
+    return getRoundContact(volumeA, volumeB, contact);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Components/rigidbody.hpp"
+#include "Utils/Bvh.hpp"
+
+// Overlap of two bodies' shapes: moving b by normal * depth, or a by the
+// opposite, separates them
+struct BodyContact
+{
+    vector3f normal;        // Unit length, from a towards b
+    float depth;
+};
+
+// World-space box around a body's shape
+BvhBounds getBodyBounds(const rigidbody& body);
+
+// Contact between any two of sphere, capsule and box. Spheres and capsules
+// are radii around a segment (a point for spheres). Pairs of those go by the
+// closest points of their segments; a box and a sphere or capsule by the
+// segment point closest to the box, or when the segment reaches into the box
+// by the axis of least overlap, as two boxes do (SAT).
+bool getBodyContact(const rigidbody& a, const rigidbody& b, BodyContact& contact);
@@ -1,18 +1,26 @@
 #include "PhysicsSystem.hpp"
 #include "Components/playerEntity.hpp"
+#include "Narrowphase.hpp"
 #include <stdio.h>
+#include <algorithm>
 #include <cmath>
 
+static constexpr float CCD_MOTION_FRACTION = 0.5f;     // Of the radius per step, before a body is swept
+static constexpr float CCD_SKIN = 0.001f;              // Kept between a swept body and what it hit
+static constexpr int CCD_MAX_SLIDES = 3;
+
 PhysicsSystem::PhysicsSystem(const vector3f& gravityVector, float deltaTime)
     : gravity(gravityVector), fixed_delta(deltaTime)
 {
 }
 
-void PhysicsSystem::stepPhysics(std::vector<rigidbody*>& rigidbodies)
+void PhysicsSystem::stepPhysics(std::vector<rigidbody*>& rigidbodies, std::vector<collider*>& colliders)
 {
     // Explicit Euler integration for all rigidbodies
     if (!rigidbodies.empty())
     {
+        prepareColliders(colliders);
+
         for (auto& rb : rigidbodies)
         {
             if (!rb) continue;
@@ -24,13 +32,97 @@ void PhysicsSystem::stepPhysics(std::vector<rigidbody*>& rigidbodies)
             // Integrate velocity
             rb->velocity += rb->force * fixed_delta;
 
-            // Integrate position
-            rb->obj.position += rb->velocity * fixed_delta;
+            // Integrate position; a fast body could step over thin geometry,
+            // so it is swept to the first surface instead
+            vector3f displacement = rb->velocity * fixed_delta;
+            float sweepThreshold = rb->ccd_radius * CCD_MOTION_FRACTION;
+            if (rb->ccd_radius > 0 && displacement.getLengthSQ() > sweepThreshold * sweepThreshold)
+                moveSwept(*rb, displacement);
+            else
+                rb->obj.position += displacement;
 
             // Reset forces for next frame
             rb->force = vector3f(0, 0, 0);
         }
+
+        resolveBodyContacts(rigidbodies);
+    }
+}
+
+void PhysicsSystem::resolveBodyContacts(std::vector<rigidbody*>& rigidbodies)
+{
+    // Broadphase ids are positions in this list
+    shaped_bodies.clear();
+    for (rigidbody* rb : rigidbodies)
+    {
+        if (rb && rb->shape != BodyShape::None)
+            shaped_bodies.push_back(rb);
+    }
+
+    body_bounds.resize(shaped_bodies.size());
+    for (size_t i = 0; i < shaped_bodies.size(); ++i)
+    {
+        body_bounds[i] = getBodyBounds(*shaped_bodies[i]);
+    }
+    body_broadphase.update(body_bounds);
+
+    // One pass over the pairs; each sees the corrections of the ones before
+    for (const auto& pair : body_broadphase.getPairs())
+    {
+        rigidbody& a = *shaped_bodies[pair.first];
+        rigidbody& b = *shaped_bodies[pair.second];
+
+        float inverseMassA = a.mass > 0 ? 1.0f / a.mass : 0.0f;
+        float inverseMassB = b.mass > 0 ? 1.0f / b.mass : 0.0f;
+        float inverseMassSum = inverseMassA + inverseMassB;
+        if (inverseMassSum <= 0) continue;
+
+        BodyContact contact;
+        if (!getBodyContact(a, b, contact)) continue;
+
+        // Move them apart, the lighter one further
+        vector3f correction = contact.normal * (contact.depth / inverseMassSum);
+        a.obj.position -= correction * inverseMassA;
+        b.obj.position += correction * inverseMassB;
+
+        // Take away the velocity that brings them together (no bounce)
+        float approach = (b.velocity - a.velocity).dotProduct(contact.normal);
+        if (approach < 0)
+        {
+            vector3f impulse = contact.normal * (-approach / inverseMassSum);
+            a.velocity -= impulse * inverseMassA;
+            b.velocity += impulse * inverseMassB;
+        }
+    }
+}
+
+void PhysicsSystem::moveSwept(rigidbody& rb, vector3f displacement)
+{
+    // Collide and slide: stop at the first surface, drop the part of the
+    // motion going into it and carry on with the rest
+    for (int slide = 0; slide < CCD_MAX_SLIDES; ++slide)
+    {
+        float distance = displacement.getLength();
+        if (distance <= 0.0f)
+            return;
+
+        vector3f direction = displacement / distance;
+        float hitDistance;
+        vector3f hitNormal;
+        if (!sweepSphere(rb.obj.position, rb.ccd_radius, direction, distance, hitDistance, hitNormal))
+        {
+            rb.obj.position += displacement;
+            return;
+        }
+
+        // Off the surface by the skin, so the next sweep doesn't start overlapping it
+        rb.obj.position += direction * hitDistance + hitNormal * CCD_SKIN;
+
+        displacement = direction * (distance - hitDistance);
+        displacement -= hitNormal * std::min(0.0f, displacement.dotProduct(hitNormal));
+        rb.velocity -= hitNormal * std::min(0.0f, rb.velocity.dotProduct(hitNormal));
     }
+    // Motion left after the last slide is dropped rather than moved unchecked
 }
 
 void PhysicsSystem::handlePlayerCollisions(rigidbody& playerRigidbody, float sphereRadius,
@@ -45,66 +137,55 @@ void PhysicsSystem::handlePlayerCollisions(rigidbody& playerRigidbody, float sph
     if (colliders.empty()) return;
 
     vector3f sphereCenter = playerRigidbody.obj.position;
+    vector3f sphereMin = sphereCenter - vector3f(sphereRadius, sphereRadius, sphereRadius);
+    vector3f sphereMax = sphereCenter + vector3f(sphereRadius, sphereRadius, sphereRadius);
 
-    // Check collision with each collider
-    for (auto& collider : colliders)
-    {
-        if (!collider || !collider->is_mesh_valid())
-            continue;
+    vector3f gravityNormal = -gravity;
+    gravityNormal.normalize();
 
-        mesh* colliderMesh = collider->get_mesh();
-        if (!colliderMesh)
-            continue;
+    prepareColliders(colliders);
+
+    collider_tree.queryBounds(sphereMin, sphereMax, [&](uint32_t colliderIndex)
+    {
+        collider* collider = tree_colliders[colliderIndex];
+        const std::vector<PhysicsTriangle>& triangles = collider->get_triangles();
 
-        // Check collision with each triangle in the mesh
-        for (size_t i = 0; i < colliderMesh->vertices_len; i += 3)
+        // A sphere can only touch an extruded triangle from inside its bounds
+        const Bvh& tree = collider->get_tree();
+        tree.queryBoundsLeaves(sphereMin, sphereMax, [&](uint32_t leaf)
         {
-            if (i + 2 >= colliderMesh->vertices_len)
-                break;
-
-            // Create triangle from vertices
-            PhysicsTriangle triangle = createTriangleFromVertices(
-                colliderMesh->vertices[i],
-                colliderMesh->vertices[i + 1],
-                colliderMesh->vertices[i + 2]
-            );
-
-            // Transform triangle to world space
-            transformTriangle(triangle, collider->obj.getRotationMatrix(), collider->obj.position);
-
-            // Extrude triangle slightly for better collision detection
-            extrudeTriangle(triangle);
-
-            // Check if sphere is facing the triangle
-            vector3f dirToSphere = sphereCenter - triangle.center;
-            dirToSphere.normalize();
-            float facingDot = triangle.normal.dotProduct(dirToSphere);
-
-            if (facingDot <= 0)
-                continue; // Sphere is behind the triangle
-
-            // Check for collision
-            vector3f collisionNormal;
-            float penetrationDepth;
-            if (checkSphereTriangleCollision(sphereCenter, sphereRadius, triangle,
-                collisionNormal, penetrationDepth))
-            {
-                printf("Collision detected! Penetration: %f\n", penetrationDepth);
+            const BvhNode& node = tree.getNodes()[leaf];
+            const TrianglePacket* packets = collider->get_leaf_packets(leaf);
+            const uint32_t packetCount = collider->get_packet_count(node.count);
 
-                // Resolve collision by moving sphere out of triangle
-                playerRigidbody.obj.position += collisionNormal * penetrationDepth;
+            for (uint32_t p = 0; p < packetCount; ++p)
+            {
+                // Same test as checkSphereTriangleCollision, for a packet at a
+                // time; only spheres in front of a triangle hit it
+                float depths[TRIANGLE_PACKET_WIDTH];
+                uint32_t hits = intersectSpherePacket(packets[p], sphereCenter, sphereRadius, depths);
 
-                // Update ground state if this surface can be considered ground
-                vector3f gravityNormal = -gravity;
-                gravityNormal.normalize();
-                if (triangle.normal.dotProduct(gravityNormal) > 0.5f) // Angle threshold for "ground"
+                for (int lane = 0; hits != 0; ++lane, hits >>= 1)
                 {
-                    player->update_grounded(true);
-                    player->update_ground_normal(triangle.normal);
+                    if (!(hits & 1)) continue;
+
+                    const PhysicsTriangle& triangle = triangles[node.first + p * TRIANGLE_PACKET_WIDTH + lane];
+                    float penetrationDepth = depths[lane];
+                    printf("Collision detected! Penetration: %f\n", penetrationDepth);
+
+                    // Resolve collision by moving sphere out of triangle
+                    playerRigidbody.obj.position += triangle.normal * penetrationDepth;
+
+                    // Update ground state if this surface can be considered ground
+                    if (triangle.normal.dotProduct(gravityNormal) > 0.5f) // Angle threshold for "ground"
+                    {
+                        player->update_grounded(true);
+                        player->update_ground_normal(triangle.normal);
+                    }
                 }
             }
-        }
-    }
+        });
+    });
 }
 
 bool PhysicsSystem::checkSphereTriangleCollision(const vector3f& sphereCenter, float sphereRadius,
@@ -135,68 +216,17 @@ bool PhysicsSystem::checkSphereTriangleCollision(const vector3f& sphereCenter, f
     return true;
 }
 
-PhysicsTriangle PhysicsSystem::createTriangleFromVertices(const vertex& v0, const vertex& v1, const vertex& v2)
-{
-    PhysicsTriangle triangle;
-    triangle.v0 = vector3f(v0.vx, v0.vy, v0.vz);
-    triangle.v1 = vector3f(v1.vx, v1.vy, v1.vz);
-    triangle.v2 = vector3f(v2.vx, v2.vy, v2.vz);
-    triangle.center = (triangle.v0 + triangle.v1 + triangle.v2) / 3.0f;
-    triangle.normal = calculateSurfaceNormal(triangle);
-    return triangle;
-}
-
-vector3f PhysicsSystem::calculateSurfaceNormal(const PhysicsTriangle& triangle)
-{
-    vector3f edge1 = triangle.v1 - triangle.v0;
-    vector3f edge2 = triangle.v2 - triangle.v0;
-    vector3f normal = edge1.crossProduct(edge2);
-    normal.normalize();
-    return normal;
-}
-
-void PhysicsSystem::transformTriangle(PhysicsTriangle& triangle, const matrix4f& rotation, const vector3f& position)
-{
-    // Apply rotation
-    rotation.transformVect(triangle.v0);
-    rotation.transformVect(triangle.v1);
-    rotation.transformVect(triangle.v2);
-    rotation.transformVect(triangle.normal);
-
-    // Apply translation
-    triangle.v0 += position;
-    triangle.v1 += position;
-    triangle.v2 += position;
-
-    // Recalculate center
-    triangle.center = (triangle.v0 + triangle.v1 + triangle.v2) / 3.0f;
-}
-
-void PhysicsSystem::extrudeTriangle(PhysicsTriangle& triangle, float factor)
-{
-    triangle.v0 = (triangle.v0 - triangle.center) * factor + triangle.center;
-    triangle.v1 = (triangle.v1 - triangle.center) * factor + triangle.center;
-    triangle.v2 = (triangle.v2 - triangle.center) * factor + triangle.center;
-}
-
 bool PhysicsSystem::isPointInsideTriangle(const vector3f& point, const PhysicsTriangle& triangle,
     vector3f& barycentricCoords)
 {
-    // Barycentric coordinate calculation
-    // Express point as weighted sum of triangle vertices
-    vector3f v0 = triangle.v2 - triangle.v0;
-    vector3f v1 = triangle.v1 - triangle.v0;
-    vector3f v2 = point - triangle.v0;
-
-    float dot00 = v0.dotProduct(v0);
-    float dot01 = v0.dotProduct(v1);
-    float dot02 = v0.dotProduct(v2);
-    float dot11 = v1.dotProduct(v1);
-    float dot12 = v1.dotProduct(v2);
-
-    float invDenom = 1.0f / (dot00 * dot11 - dot01 * dot01);
-    float u = (dot11 * dot02 - dot01 * dot12) * invDenom;
-    float v = (dot00 * dot12 - dot01 * dot02) * invDenom;
+    // Barycentric coordinates in the extruded triangle; everything that
+    // only depends on the triangle was computed when the collider was prepared
+    vector3f toPoint = point - triangle.extruded_v0;
+    float dotUP = triangle.extruded_edge_u.dotProduct(toPoint);
+    float dotVP = triangle.extruded_edge_v.dotProduct(toPoint);
+
+    float u = (triangle.dot_vv * dotUP - triangle.dot_uv * dotVP) * triangle.inv_denom;
+    float v = (triangle.dot_uu * dotVP - triangle.dot_uv * dotUP) * triangle.inv_denom;
 
     // Store barycentric coordinates
     barycentricCoords = vector3f(1.0f - u - v, v, u);
@@ -213,84 +243,308 @@ bool PhysicsSystem::raycast(const vector3f& origin, const vector3f& direction, f
     vector3f normalizedDirection = direction;
     normalizedDirection.normalize();
 
-    for (auto& collider : colliders)
-    {
-        if (!collider || !collider->is_mesh_valid())
-            continue;
+    prepareColliders(colliders);
 
-        mesh* colliderMesh = collider->get_mesh();
-        if (!colliderMesh)
-            continue;
+    // Both walks stop descending past the closest hit found so far
+    collider_tree.queryRay(origin, normalizedDirection, closestDistance, [&](uint32_t colliderIndex)
+    {
+        collider* collider = tree_colliders[colliderIndex];
+        const std::vector<PhysicsTriangle>& triangles = collider->get_triangles();
 
-        // Check ray against each triangle
-        for (size_t i = 0; i < colliderMesh->vertices_len; i += 3)
+        const Bvh& tree = collider->get_tree();
+        tree.queryRayLeaves(origin, normalizedDirection, closestDistance, [&](uint32_t leaf)
         {
-            if (i + 2 >= colliderMesh->vertices_len)
-                break;
+            const BvhNode& node = tree.getNodes()[leaf];
+            const TrianglePacket* packets = collider->get_leaf_packets(leaf);
+            const uint32_t packetCount = collider->get_packet_count(node.count);
 
-            PhysicsTriangle triangle = createTriangleFromVertices(
-                colliderMesh->vertices[i],
-                colliderMesh->vertices[i + 1],
-                colliderMesh->vertices[i + 2]
-            );
+            for (uint32_t p = 0; p < packetCount; ++p)
+            {
+                // Ray-triangle intersection using Möller-Trumbore algorithm, a packet at a time
+                float distances[TRIANGLE_PACKET_WIDTH];
+                uint32_t hits = intersectRayPacket(packets[p], origin, normalizedDirection, closestDistance, distances);
 
-            transformTriangle(triangle, collider->obj.getRotationMatrix(), collider->obj.position);
+                for (int lane = 0; hits != 0; ++lane, hits >>= 1)
+                {
+                    if (!(hits & 1) || distances[lane] >= closestDistance) continue;
 
-            // Ray-triangle intersection using Möller-Trumbore algorithm
-            vector3f edge1 = triangle.v1 - triangle.v0;
-            vector3f edge2 = triangle.v2 - triangle.v0;
-            vector3f h = normalizedDirection.crossProduct(edge2);
-            float a = edge1.dotProduct(h);
+                    float t = distances[lane];
 
-            if (a > -0.00001f && a < 0.00001f)
-                continue; // Ray is parallel to triangle
+                    closestDistance = t;
+                    hitPoint = origin + normalizedDirection * t;
+                    hitNormal = triangles[node.first + p * TRIANGLE_PACKET_WIDTH + lane].normal;
+                    hit = true;
+                }
+            }
+        });
+    });
 
-            float f = 1.0f / a;
-            vector3f s = origin - triangle.v0;
-            float u = f * s.dotProduct(h);
+    return hit;
+}
 
-            if (u < 0.0f || u > 1.0f)
-                continue;
+void PhysicsSystem::prepareColliders(std::vector<collider*>& colliders)
+{
+    // Bring every collider's triangles up to date; any rebuild or change to
+    // the list invalidates the tree over them
+    bool changed = colliders.size() != tree_source.size();
+    tree_revisions.resize(colliders.size());
+    for (size_t i = 0; i < colliders.size(); ++i)
+    {
+        collider* collider = colliders[i];
+        uint64_t revision = 0;
+        if (collider && collider->is_mesh_valid())
+        {
+            collider->get_triangles();
+            revision = collider->get_revision();
+        }
 
-            vector3f q = s.crossProduct(edge1);
-            float v = f * normalizedDirection.dotProduct(q);
+        if (changed || tree_source[i] != collider || tree_revisions[i] != revision)
+        {
+            changed = true;
+            tree_revisions[i] = revision;
+        }
+    }
 
-            if (v < 0.0f || u + v > 1.0f)
-                continue;
+    if (!changed)
+        return;
 
-            float t = f * edge2.dotProduct(q);
+    tree_source = colliders;
 
-            if (t > 0.00001f && t < closestDistance)
-            {
-                closestDistance = t;
-                hitPoint = origin + normalizedDirection * t;
-                hitNormal = triangle.normal;
-                hit = true;
-            }
-        }
+    std::vector<collider*> candidates;
+    std::vector<BvhBounds> bounds;
+    for (collider* collider : colliders)
+    {
+        if (!collider || !collider->is_mesh_valid() || collider->get_triangles().empty())
+            continue;
+
+        candidates.push_back(collider);
+        BvhBounds& collider_bounds = bounds.emplace_back();
+        collider_bounds.bounds_min = collider->get_bounds_min();
+        collider_bounds.bounds_max = collider->get_bounds_max();
     }
 
-    return hit;
+    collider_tree.build(bounds);
+    tree_colliders.clear();
+    for (uint32_t index : collider_tree.getOrder())
+    {
+        tree_colliders.push_back(candidates[index]);
+    }
 }
 
 bool PhysicsSystem::spherecast(const vector3f& origin, float radius, const vector3f& direction,
     float maxDistance, std::vector<collider*>& colliders,
     vector3f& hitPoint, vector3f& hitNormal)
 {
-    // Simple implementation: perform multiple raycasts around the sphere
     vector3f normalizedDirection = direction;
     normalizedDirection.normalize();
+    if (normalizedDirection.getLengthSQ() == 0)
+        return false;
+
+    if (radius <= 0)
+        return raycast(origin, direction, maxDistance, colliders, hitPoint, hitNormal);
+
+    prepareColliders(colliders);
+
+    float hitDistance;
+    if (!sweepSphere(origin, radius, normalizedDirection, maxDistance, hitDistance, hitNormal))
+        return false;
+
+    hitPoint = origin + normalizedDirection * hitDistance;
+    return true;
+}
+
+bool PhysicsSystem::sweepSphere(const vector3f& origin, float radius, const vector3f& direction, float maxDistance,
+    float& hitDistance, vector3f& hitNormal)
+{
+    float closestDistance = maxDistance;
+    bool hit = false;
+
+    // Both walks stop descending past the closest hit found so far
+    collider_tree.querySweep(origin, direction, radius, closestDistance, [&](uint32_t colliderIndex)
+    {
+        collider* collider = tree_colliders[colliderIndex];
+        const std::vector<PhysicsTriangle>& triangles = collider->get_triangles();
+
+        collider->get_tree().querySweep(origin, direction, radius, closestDistance, [&](uint32_t triangleIndex)
+        {
+            float distance;
+            vector3f normal;
+            vector3f point;
+            if (sweepSphereTriangle(origin, radius, direction, closestDistance, triangles[triangleIndex],
+                distance, normal, point))
+            {
+                closestDistance = distance;
+                hitDistance = distance;
+                hitNormal = normal;
+                hit = true;
+            }
+        });
+    });
+
+    return hit;
+}
+
+// Point of the triangle closest to p (Ericson, Real-Time Collision Detection 5.1.5)
+static vector3f getClosestPointOnTriangle(const vector3f& p, const PhysicsTriangle& triangle)
+{
+    const vector3f& a = triangle.v0;
+    const vector3f& b = triangle.v1;
+    const vector3f& c = triangle.v2;
+    vector3f ab = triangle.edge1;
+    vector3f ac = triangle.edge2;
+
+    vector3f ap = p - a;
+    float d1 = ab.dotProduct(ap);
+    float d2 = ac.dotProduct(ap);
+    if (d1 <= 0 && d2 <= 0) return a;
+
+    vector3f bp = p - b;
+    float d3 = ab.dotProduct(bp);
+    float d4 = ac.dotProduct(bp);
+    if (d3 >= 0 && d4 <= d3) return b;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0)
+        return a + ab * (d1 / (d1 - d3));
+
+    vector3f cp = p - c;
+    float d5 = ab.dotProduct(cp);
+    float d6 = ac.dotProduct(cp);
+    if (d6 >= 0 && d5 <= d6) return c;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0)
+        return a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// Entry root of a*t^2 + b*t + c = 0 (a > 0) if it lies in [0, maxRoot]
+static bool getEntryRoot(float a, float b, float c, float maxRoot, float& root)
+{
+    float discriminant = b * b - 4.0f * a * c;
+    if (discriminant < 0)
+        return false;
+
+    float entry = (-b - std::sqrt(discriminant)) / (2.0f * a);
+    if (entry < 0 || entry > maxRoot)
+        return false;
 
-    // Primary raycast along the center
-    if (raycast(origin, direction, maxDistance, colliders, hitPoint, hitNormal))
+    root = entry;
+    return true;
+}
+
+bool PhysicsSystem::sweepSphereTriangle(const vector3f& origin, float radius, const vector3f& direction, float maxDistance,
+    const PhysicsTriangle& triangle, float& hitDistance, vector3f& hitNormal, vector3f& hitPoint)
+{
+    // A sphere that starts overlapping the triangle hits it right away if it
+    // moves further in, and never otherwise
+    vector3f closest = getClosestPointOnTriangle(origin, triangle);
+    vector3f fromClosest = origin - closest;
+    if (fromClosest.getLengthSQ() < radius * radius)
     {
-        // Adjust hit point to account for sphere radius
-        hitPoint -= normalizedDirection * radius;
+        if (fromClosest.dotProduct(direction) >= 0)
+            return false;
+
+        hitDistance = 0;
+        hitNormal = fromClosest;
+        hitNormal.normalize();
+        hitPoint = closest;
         return true;
     }
 
-    // Additional raycasts could be added here for more accurate spherecasting
-    // For now, this simple implementation should suffice
+    // Face: the sphere touches the plane on the side it starts on. If that
+    // point is inside the triangle nothing else can be touched first.
+    vector3f normal = triangle.normal;
+    float distanceToPlane = normal.dotProduct(origin - triangle.v0);
+    if (distanceToPlane < 0)
+    {
+        normal = -normal;
+        distanceToPlane = -distanceToPlane;
+    }
 
-    return false;
-}
\ No newline at end of file
+    float approach = normal.dotProduct(direction);
+    if (approach < 0)
+    {
+        float t = (distanceToPlane - radius) / -approach;
+        if (t >= 0 && t <= maxDistance)
+        {
+            vector3f contact = origin + direction * t - normal * radius;
+
+            vector3f toContact = contact - triangle.v0;
+            float d00 = triangle.edge1.dotProduct(triangle.edge1);
+            float d01 = triangle.edge1.dotProduct(triangle.edge2);
+            float d11 = triangle.edge2.dotProduct(triangle.edge2);
+            float d20 = toContact.dotProduct(triangle.edge1);
+            float d21 = toContact.dotProduct(triangle.edge2);
+            float denom = d00 * d11 - d01 * d01;
+            float v = (d11 * d20 - d01 * d21);
+            float w = (d00 * d21 - d01 * d20);
+            if (denom > 0 && v >= 0 && w >= 0 && v + w <= denom)
+            {
+                hitDistance = t;
+                hitNormal = normal;
+                hitPoint = contact;
+                return true;
+            }
+        }
+    }
+
+    // Otherwise the first of the edges (cylinders) and vertices (spheres) it runs into
+    bool hit = false;
+    float closestDistance = maxDistance;
+    const vector3f* vertices[3] = { &triangle.v0, &triangle.v1, &triangle.v2 };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const vector3f& vertex = *vertices[i];
+        vector3f toOrigin = origin - vertex;
+
+        float t;
+        if (getEntryRoot(1.0f, 2.0f * toOrigin.dotProduct(direction), toOrigin.getLengthSQ() - radius * radius,
+            closestDistance, t))
+        {
+            closestDistance = t;
+            hitPoint = vertex;
+            hit = true;
+        }
+
+        // Distance of the center from the edge's line is the radius where
+        // |w|^2 * |e|^2 - (w.e)^2 = r^2 * |e|^2, with w = center - start
+        vector3f edge = *vertices[(i + 1) % 3] - vertex;
+        float edgeSQ = edge.getLengthSQ();
+        float edgeDirection = edge.dotProduct(direction);
+        float edgeOrigin = edge.dotProduct(toOrigin);
+
+        float a = edgeSQ - edgeDirection * edgeDirection;
+        if (a <= 1e-8f * edgeSQ)
+            continue; // Moving along the edge; its vertices are hit first
+
+        float b = 2.0f * (edgeSQ * toOrigin.dotProduct(direction) - edgeOrigin * edgeDirection);
+        float c = edgeSQ * (toOrigin.getLengthSQ() - radius * radius) - edgeOrigin * edgeOrigin;
+        if (getEntryRoot(a, b, c, closestDistance, t))
+        {
+            // Only between the vertices; past them the vertex spheres take over
+            float along = (edgeOrigin + edgeDirection * t) / edgeSQ;
+            if (along >= 0 && along <= 1)
+            {
+                closestDistance = t;
+                hitPoint = vertex + edge * along;
+                hit = true;
+            }
+        }
+    }
+
+    if (!hit)
+        return false;
+
+    hitDistance = closestDistance;
+    hitNormal = origin + direction * closestDistance - hitPoint;
+    hitNormal.normalize();
+    return true;
+}
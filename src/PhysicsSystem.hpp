@@ -1,10 +1,13 @@
 #pragma once
 
+#include <cstring>
 #include "irrlicht/vector3.h"
 #include "irrlicht/matrix4.h"
 #include "Components/rigidbody.hpp"
 #include "Components/collider.hpp"
 #include "Components/mesh.hpp"
+#include "Utils/Bvh.hpp"
+#include "Utils/SpatialHashGrid.hpp"
 #include <vector>
 
 using namespace irr;
@@ -13,25 +16,37 @@ using namespace core;
 // Forward declaration
 class playerEntity;
 
-struct PhysicsTriangle
-{
-    vector3f v0, v1, v2;
-    vector3f normal;
-    vector3f center;
-};
-
 class PhysicsSystem
 {
 private:
     vector3f gravity;
     float fixed_delta;
 
+    // Top-level tree over the colliders of the last query, rebuilt when the
+    // list changes or one of its colliders was rebuilt
+    Bvh collider_tree;
+    std::vector<collider*> tree_colliders;      // In the tree's leaf order
+    std::vector<collider*> tree_source;         // As passed to the query
+    std::vector<uint64_t> tree_revisions;
+
+    void prepareColliders(std::vector<collider*>& colliders);
+
+    // Broadphase over the bodies with a shape; kept to reuse the memory
+    SpatialHashGrid body_broadphase;
+    std::vector<rigidbody*> shaped_bodies;
+    std::vector<BvhBounds> body_bounds;
+
+    void resolveBodyContacts(std::vector<rigidbody*>& rigidbodies);
+
+    // Closest swept-sphere hit against colliders already prepared; direction is normalized
+    bool sweepSphere(const vector3f& origin, float radius, const vector3f& direction, float maxDistance,
+        float& hitDistance, vector3f& hitNormal);
+
+    // Move a body by displacement, stopping at surfaces and sliding along them
+    void moveSwept(rigidbody& rb, vector3f displacement);
+
     // Helper methods
-    vector3f calculateSurfaceNormal(const PhysicsTriangle& triangle);
-    void transformTriangle(PhysicsTriangle& triangle, const matrix4f& rotation, const vector3f& position);
-    void extrudeTriangle(PhysicsTriangle& triangle, float factor = 1.3f);
     bool isPointInsideTriangle(const vector3f& point, const PhysicsTriangle& triangle, vector3f& barycentricCoords);
-    PhysicsTriangle createTriangleFromVertices(const vertex& v0, const vertex& v1, const vertex& v2);
 
 public:
     PhysicsSystem(const vector3f& gravityVector = vector3f(0, -1, 0), float deltaTime = 0.16f);
@@ -44,22 +59,34 @@ public:
     void setFixedDelta(float deltaTime) { fixed_delta = deltaTime; }
     float getFixedDelta() const { return fixed_delta; }
 
-    // Main physics update
-    void stepPhysics(std::vector<rigidbody*>& rigidbodies);
+    // Main physics update. Bodies with a ccd_radius that move more than half
+    // of it in one step are swept against the colliders instead of teleported;
+    // bodies with a shape are then pushed apart from each other.
+    void stepPhysics(std::vector<rigidbody*>& rigidbodies, std::vector<collider*>& colliders);
 
     // Collision detection and response
     void handlePlayerCollisions(rigidbody& playerRigidbody, float sphereRadius,
         std::vector<collider*>& colliders, playerEntity* player);
 
-    // Sphere-triangle collision detection
+    // Sphere-triangle collision detection against the extruded triangle
     bool checkSphereTriangleCollision(const vector3f& sphereCenter, float sphereRadius,
         const PhysicsTriangle& triangle, vector3f& collisionNormal,
         float& penetrationDepth);
 
-    // General collision queries
+    // First contact of a sphere moving along a normalized direction with the
+    // triangle's face, edges or vertices, within maxDistance. A sphere that
+    // already overlaps the triangle hits it at distance 0 when moving towards
+    // it and not at all when moving away, so resting contacts don't stop
+    // sliding; pushing out of overlaps is left to the collision response.
+    bool sweepSphereTriangle(const vector3f& origin, float radius, const vector3f& direction, float maxDistance,
+        const PhysicsTriangle& triangle, float& hitDistance, vector3f& hitNormal, vector3f& hitPoint);
+
+    // General collision queries. They walk the tree over colliders, then each
+    // collider's tree over its cached world-space triangles.
     bool raycast(const vector3f& origin, const vector3f& direction, float maxDistance,
         std::vector<collider*>& colliders, vector3f& hitPoint, vector3f& hitNormal);
 
+    // hitPoint: where the center of the sphere is when it first touches
     bool spherecast(const vector3f& origin, float radius, const vector3f& direction,
         float maxDistance, std::vector<collider*>& colliders,
         vector3f& hitPoint, vector3f& hitNormal);
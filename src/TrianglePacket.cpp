@@ -0,0 +1,372 @@
+#include "TrianglePacket.hpp"
+#include "Components/collider.hpp"
+#include <cmath>
+#include <cstring>
+
+static constexpr float RAY_EPSILON = 0.00001f;
+
+void TrianglePacket::clear()
+{
+    memset(this, 0, sizeof(TrianglePacket));
+}
+
+void TrianglePacket::setLane(int lane, const PhysicsTriangle& triangle)
+{
+    v0_x[lane] = triangle.v0.X;
+    v0_y[lane] = triangle.v0.Y;
+    v0_z[lane] = triangle.v0.Z;
+    edge1_x[lane] = triangle.edge1.X;
+    edge1_y[lane] = triangle.edge1.Y;
+    edge1_z[lane] = triangle.edge1.Z;
+    edge2_x[lane] = triangle.edge2.X;
+    edge2_y[lane] = triangle.edge2.Y;
+    edge2_z[lane] = triangle.edge2.Z;
+
+    normal_x[lane] = triangle.normal.X;
+    normal_y[lane] = triangle.normal.Y;
+    normal_z[lane] = triangle.normal.Z;
+    center_x[lane] = triangle.center.X;
+    center_y[lane] = triangle.center.Y;
+    center_z[lane] = triangle.center.Z;
+    extruded_x[lane] = triangle.extruded_v0.X;
+    extruded_y[lane] = triangle.extruded_v0.Y;
+    extruded_z[lane] = triangle.extruded_v0.Z;
+    edge_u_x[lane] = triangle.extruded_edge_u.X;
+    edge_u_y[lane] = triangle.extruded_edge_u.Y;
+    edge_u_z[lane] = triangle.extruded_edge_u.Z;
+    edge_v_x[lane] = triangle.extruded_edge_v.X;
+    edge_v_y[lane] = triangle.extruded_edge_v.Y;
+    edge_v_z[lane] = triangle.extruded_edge_v.Z;
+    dot_uu[lane] = triangle.dot_uu;
+    dot_uv[lane] = triangle.dot_uv;
+    dot_vv[lane] = triangle.dot_vv;
+    inv_denom[lane] = triangle.inv_denom;
+}
+
+uint32_t intersectSpherePacketScalar(const TrianglePacket& p, const vector3f& center, float radius, float depths[4])
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < TRIANGLE_PACKET_WIDTH; ++i)
+    {
+        // Distance of the center from the plane; only spheres in front count
+        float toCenterX = center.X - p.center_x[i];
+        float toCenterY = center.Y - p.center_y[i];
+        float toCenterZ = center.Z - p.center_z[i];
+        float distance = p.normal_x[i] * toCenterX + p.normal_y[i] * toCenterY + p.normal_z[i] * toCenterZ;
+
+        // Barycentric coordinates of the projected center in the extruded triangle
+        float toPointX = (center.X - p.normal_x[i] * distance) - p.extruded_x[i];
+        float toPointY = (center.Y - p.normal_y[i] * distance) - p.extruded_y[i];
+        float toPointZ = (center.Z - p.normal_z[i] * distance) - p.extruded_z[i];
+        float dotUP = p.edge_u_x[i] * toPointX + p.edge_u_y[i] * toPointY + p.edge_u_z[i] * toPointZ;
+        float dotVP = p.edge_v_x[i] * toPointX + p.edge_v_y[i] * toPointY + p.edge_v_z[i] * toPointZ;
+        float u = (p.dot_vv[i] * dotUP - p.dot_uv[i] * dotVP) * p.inv_denom[i];
+        float v = (p.dot_uu[i] * dotVP - p.dot_uv[i] * dotUP) * p.inv_denom[i];
+
+        float absDistance = std::fabs(distance);
+        bool hit = distance > 0.0f && u >= 0.0f && v >= 0.0f && u + v <= 1.0f && absDistance <= radius;
+        if (hit)
+        {
+            depths[i] = radius - absDistance;
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+uint32_t intersectRayPacketScalar(const TrianglePacket& p, const vector3f& origin, const vector3f& direction,
+                                  float max_distance, float distances[4])
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < TRIANGLE_PACKET_WIDTH; ++i)
+    {
+        // Möller-Trumbore
+        float hX = direction.Y * p.edge2_z[i] - direction.Z * p.edge2_y[i];
+        float hY = direction.Z * p.edge2_x[i] - direction.X * p.edge2_z[i];
+        float hZ = direction.X * p.edge2_y[i] - direction.Y * p.edge2_x[i];
+        float a = p.edge1_x[i] * hX + p.edge1_y[i] * hY + p.edge1_z[i] * hZ;
+        bool notParallel = a <= -RAY_EPSILON || a >= RAY_EPSILON;
+
+        float f = 1.0f / a;
+        float sX = origin.X - p.v0_x[i];
+        float sY = origin.Y - p.v0_y[i];
+        float sZ = origin.Z - p.v0_z[i];
+        float u = f * (sX * hX + sY * hY + sZ * hZ);
+
+        float qX = sY * p.edge1_z[i] - sZ * p.edge1_y[i];
+        float qY = sZ * p.edge1_x[i] - sX * p.edge1_z[i];
+        float qZ = sX * p.edge1_y[i] - sY * p.edge1_x[i];
+        float v = f * (direction.X * qX + direction.Y * qY + direction.Z * qZ);
+        float t = f * (p.edge2_x[i] * qX + p.edge2_y[i] * qY + p.edge2_z[i] * qZ);
+
+        bool hit = notParallel && u >= 0.0f && u <= 1.0f && v >= 0.0f && u + v <= 1.0f &&
+            t > RAY_EPSILON && t < max_distance;
+        if (hit)
+        {
+            distances[i] = t;
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+#if defined(TRIANGLE_PACKET_SSE2)
+
+// Separate multiplies and adds in the scalar order; SSE2 has no fused form
+
+static inline __m128 dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+uint32_t intersectSpherePacket(const TrianglePacket& p, const vector3f& center, float radius, float depths[4])
+{
+    const __m128 centerX = _mm_set1_ps(center.X);
+    const __m128 centerY = _mm_set1_ps(center.Y);
+    const __m128 centerZ = _mm_set1_ps(center.Z);
+    const __m128 normalX = _mm_load_ps(p.normal_x);
+    const __m128 normalY = _mm_load_ps(p.normal_y);
+    const __m128 normalZ = _mm_load_ps(p.normal_z);
+
+    __m128 distance = dot3(normalX, normalY, normalZ,
+                           _mm_sub_ps(centerX, _mm_load_ps(p.center_x)),
+                           _mm_sub_ps(centerY, _mm_load_ps(p.center_y)),
+                           _mm_sub_ps(centerZ, _mm_load_ps(p.center_z)));
+
+    __m128 toPointX = _mm_sub_ps(_mm_sub_ps(centerX, _mm_mul_ps(normalX, distance)), _mm_load_ps(p.extruded_x));
+    __m128 toPointY = _mm_sub_ps(_mm_sub_ps(centerY, _mm_mul_ps(normalY, distance)), _mm_load_ps(p.extruded_y));
+    __m128 toPointZ = _mm_sub_ps(_mm_sub_ps(centerZ, _mm_mul_ps(normalZ, distance)), _mm_load_ps(p.extruded_z));
+    __m128 dotUP = dot3(_mm_load_ps(p.edge_u_x), _mm_load_ps(p.edge_u_y), _mm_load_ps(p.edge_u_z),
+                        toPointX, toPointY, toPointZ);
+    __m128 dotVP = dot3(_mm_load_ps(p.edge_v_x), _mm_load_ps(p.edge_v_y), _mm_load_ps(p.edge_v_z),
+                        toPointX, toPointY, toPointZ);
+
+    const __m128 dotUU = _mm_load_ps(p.dot_uu);
+    const __m128 dotUV = _mm_load_ps(p.dot_uv);
+    const __m128 dotVV = _mm_load_ps(p.dot_vv);
+    const __m128 invDenom = _mm_load_ps(p.inv_denom);
+    __m128 u = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(dotVV, dotUP), _mm_mul_ps(dotUV, dotVP)), invDenom);
+    __m128 v = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(dotUU, dotVP), _mm_mul_ps(dotUV, dotUP)), invDenom);
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 radiusV = _mm_set1_ps(radius);
+    __m128 absDistance = _mm_andnot_ps(_mm_set1_ps(-0.0f), distance);
+
+    __m128 hit = _mm_cmpgt_ps(distance, zero);
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(absDistance, radiusV));
+
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(hit));
+    if (mask)
+    {
+        alignas(16) float results[4];
+        _mm_store_ps(results, _mm_sub_ps(radiusV, absDistance));
+        for (int i = 0; i < TRIANGLE_PACKET_WIDTH; ++i)
+        {
+            if (mask & (1u << i))
+                depths[i] = results[i];
+        }
+    }
+    return mask;
+}
+
+uint32_t intersectRayPacket(const TrianglePacket& p, const vector3f& origin, const vector3f& direction,
+                            float max_distance, float distances[4])
+{
+    const __m128 directionX = _mm_set1_ps(direction.X);
+    const __m128 directionY = _mm_set1_ps(direction.Y);
+    const __m128 directionZ = _mm_set1_ps(direction.Z);
+    const __m128 edge1X = _mm_load_ps(p.edge1_x);
+    const __m128 edge1Y = _mm_load_ps(p.edge1_y);
+    const __m128 edge1Z = _mm_load_ps(p.edge1_z);
+    const __m128 edge2X = _mm_load_ps(p.edge2_x);
+    const __m128 edge2Y = _mm_load_ps(p.edge2_y);
+    const __m128 edge2Z = _mm_load_ps(p.edge2_z);
+
+    __m128 hX = _mm_sub_ps(_mm_mul_ps(directionY, edge2Z), _mm_mul_ps(directionZ, edge2Y));
+    __m128 hY = _mm_sub_ps(_mm_mul_ps(directionZ, edge2X), _mm_mul_ps(directionX, edge2Z));
+    __m128 hZ = _mm_sub_ps(_mm_mul_ps(directionX, edge2Y), _mm_mul_ps(directionY, edge2X));
+    __m128 a = dot3(edge1X, edge1Y, edge1Z, hX, hY, hZ);
+
+    const __m128 epsilon = _mm_set1_ps(RAY_EPSILON);
+    __m128 hit = _mm_or_ps(_mm_cmple_ps(a, _mm_set1_ps(-RAY_EPSILON)), _mm_cmpge_ps(a, epsilon));
+
+    // A real division: an approximate reciprocal would move the hits
+    __m128 f = _mm_div_ps(_mm_set1_ps(1.0f), a);
+    __m128 sX = _mm_sub_ps(_mm_set1_ps(origin.X), _mm_load_ps(p.v0_x));
+    __m128 sY = _mm_sub_ps(_mm_set1_ps(origin.Y), _mm_load_ps(p.v0_y));
+    __m128 sZ = _mm_sub_ps(_mm_set1_ps(origin.Z), _mm_load_ps(p.v0_z));
+    __m128 u = _mm_mul_ps(f, dot3(sX, sY, sZ, hX, hY, hZ));
+
+    __m128 qX = _mm_sub_ps(_mm_mul_ps(sY, edge1Z), _mm_mul_ps(sZ, edge1Y));
+    __m128 qY = _mm_sub_ps(_mm_mul_ps(sZ, edge1X), _mm_mul_ps(sX, edge1Z));
+    __m128 qZ = _mm_sub_ps(_mm_mul_ps(sX, edge1Y), _mm_mul_ps(sY, edge1X));
+    __m128 v = _mm_mul_ps(f, dot3(directionX, directionY, directionZ, qX, qY, qZ));
+    __m128 t = _mm_mul_ps(f, dot3(edge2X, edge2Y, edge2Z, qX, qY, qZ));
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(u, one));
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+    hit = _mm_and_ps(hit, _mm_cmpgt_ps(t, epsilon));
+    hit = _mm_and_ps(hit, _mm_cmplt_ps(t, _mm_set1_ps(max_distance)));
+
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(hit));
+    if (mask)
+    {
+        alignas(16) float results[4];
+        _mm_store_ps(results, t);
+        for (int i = 0; i < TRIANGLE_PACKET_WIDTH; ++i)
+        {
+            if (mask & (1u << i))
+                distances[i] = results[i];
+        }
+    }
+    return mask;
+}
+
+#elif defined(TRIANGLE_PACKET_NEON)
+
+// vmulq/vaddq rather than vmlaq/vfmaq, which would round differently from the scalar code
+
+static inline float32x4_t dot3(float32x4_t ax, float32x4_t ay, float32x4_t az,
+                               float32x4_t bx, float32x4_t by, float32x4_t bz)
+{
+    return vaddq_f32(vaddq_f32(vmulq_f32(ax, bx), vmulq_f32(ay, by)), vmulq_f32(az, bz));
+}
+
+static inline uint32_t getLaneMask(uint32x4_t hit)
+{
+    static const uint32_t bits[4] = { 1, 2, 4, 8 };
+    return vaddvq_u32(vandq_u32(hit, vld1q_u32(bits)));
+}
+
+uint32_t intersectSpherePacket(const TrianglePacket& p, const vector3f& center, float radius, float depths[4])
+{
+    const float32x4_t centerX = vdupq_n_f32(center.X);
+    const float32x4_t centerY = vdupq_n_f32(center.Y);
+    const float32x4_t centerZ = vdupq_n_f32(center.Z);
+    const float32x4_t normalX = vld1q_f32(p.normal_x);
+    const float32x4_t normalY = vld1q_f32(p.normal_y);
+    const float32x4_t normalZ = vld1q_f32(p.normal_z);
+
+    float32x4_t distance = dot3(normalX, normalY, normalZ,
+                                vsubq_f32(centerX, vld1q_f32(p.center_x)),
+                                vsubq_f32(centerY, vld1q_f32(p.center_y)),
+                                vsubq_f32(centerZ, vld1q_f32(p.center_z)));
+
+    float32x4_t toPointX = vsubq_f32(vsubq_f32(centerX, vmulq_f32(normalX, distance)), vld1q_f32(p.extruded_x));
+    float32x4_t toPointY = vsubq_f32(vsubq_f32(centerY, vmulq_f32(normalY, distance)), vld1q_f32(p.extruded_y));
+    float32x4_t toPointZ = vsubq_f32(vsubq_f32(centerZ, vmulq_f32(normalZ, distance)), vld1q_f32(p.extruded_z));
+    float32x4_t dotUP = dot3(vld1q_f32(p.edge_u_x), vld1q_f32(p.edge_u_y), vld1q_f32(p.edge_u_z),
+                             toPointX, toPointY, toPointZ);
+    float32x4_t dotVP = dot3(vld1q_f32(p.edge_v_x), vld1q_f32(p.edge_v_y), vld1q_f32(p.edge_v_z),
+                             toPointX, toPointY, toPointZ);
+
+    const float32x4_t dotUU = vld1q_f32(p.dot_uu);
+    const float32x4_t dotUV = vld1q_f32(p.dot_uv);
+    const float32x4_t dotVV = vld1q_f32(p.dot_vv);
+    const float32x4_t invDenom = vld1q_f32(p.inv_denom);
+    float32x4_t u = vmulq_f32(vsubq_f32(vmulq_f32(dotVV, dotUP), vmulq_f32(dotUV, dotVP)), invDenom);
+    float32x4_t v = vmulq_f32(vsubq_f32(vmulq_f32(dotUU, dotVP), vmulq_f32(dotUV, dotUP)), invDenom);
+
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t radiusV = vdupq_n_f32(radius);
+    float32x4_t absDistance = vabsq_f32(distance);
+
+    uint32x4_t hit = vcgtq_f32(distance, zero);
+    hit = vandq_u32(hit, vcgeq_f32(u, zero));
+    hit = vandq_u32(hit, vcgeq_f32(v, zero));
+    hit = vandq_u32(hit, vcleq_f32(vaddq_f32(u, v), vdupq_n_f32(1.0f)));
+    hit = vandq_u32(hit, vcleq_f32(absDistance, radiusV));
+
+    uint32_t mask = getLaneMask(hit);
+    if (mask)
+    {
+        float results[4];
+        vst1q_f32(results, vsubq_f32(radiusV, absDistance));
+        for (int i = 0; i < TRIANGLE_PACKET_WIDTH; ++i)
+        {
+            if (mask & (1u << i))
+                depths[i] = results[i];
+        }
+    }
+    return mask;
+}
+
+uint32_t intersectRayPacket(const TrianglePacket& p, const vector3f& origin, const vector3f& direction,
+                            float max_distance, float distances[4])
+{
+    const float32x4_t directionX = vdupq_n_f32(direction.X);
+    const float32x4_t directionY = vdupq_n_f32(direction.Y);
+    const float32x4_t directionZ = vdupq_n_f32(direction.Z);
+    const float32x4_t edge1X = vld1q_f32(p.edge1_x);
+    const float32x4_t edge1Y = vld1q_f32(p.edge1_y);
+    const float32x4_t edge1Z = vld1q_f32(p.edge1_z);
+    const float32x4_t edge2X = vld1q_f32(p.edge2_x);
+    const float32x4_t edge2Y = vld1q_f32(p.edge2_y);
+    const float32x4_t edge2Z = vld1q_f32(p.edge2_z);
+
+    float32x4_t hX = vsubq_f32(vmulq_f32(directionY, edge2Z), vmulq_f32(directionZ, edge2Y));
+    float32x4_t hY = vsubq_f32(vmulq_f32(directionZ, edge2X), vmulq_f32(directionX, edge2Z));
+    float32x4_t hZ = vsubq_f32(vmulq_f32(directionX, edge2Y), vmulq_f32(directionY, edge2X));
+    float32x4_t a = dot3(edge1X, edge1Y, edge1Z, hX, hY, hZ);
+
+    const float32x4_t epsilon = vdupq_n_f32(RAY_EPSILON);
+    uint32x4_t hit = vorrq_u32(vcleq_f32(a, vdupq_n_f32(-RAY_EPSILON)), vcgeq_f32(a, epsilon));
+
+    // A real division: an approximate reciprocal would move the hits
+    float32x4_t f = vdivq_f32(vdupq_n_f32(1.0f), a);
+    float32x4_t sX = vsubq_f32(vdupq_n_f32(origin.X), vld1q_f32(p.v0_x));
+    float32x4_t sY = vsubq_f32(vdupq_n_f32(origin.Y), vld1q_f32(p.v0_y));
+    float32x4_t sZ = vsubq_f32(vdupq_n_f32(origin.Z), vld1q_f32(p.v0_z));
+    float32x4_t u = vmulq_f32(f, dot3(sX, sY, sZ, hX, hY, hZ));
+
+    float32x4_t qX = vsubq_f32(vmulq_f32(sY, edge1Z), vmulq_f32(sZ, edge1Y));
+    float32x4_t qY = vsubq_f32(vmulq_f32(sZ, edge1X), vmulq_f32(sX, edge1Z));
+    float32x4_t qZ = vsubq_f32(vmulq_f32(sX, edge1Y), vmulq_f32(sY, edge1X));
+    float32x4_t v = vmulq_f32(f, dot3(directionX, directionY, directionZ, qX, qY, qZ));
+    float32x4_t t = vmulq_f32(f, dot3(edge2X, edge2Y, edge2Z, qX, qY, qZ));
+
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    hit = vandq_u32(hit, vcgeq_f32(u, zero));
+    hit = vandq_u32(hit, vcleq_f32(u, one));
+    hit = vandq_u32(hit, vcgeq_f32(v, zero));
+    hit = vandq_u32(hit, vcleq_f32(vaddq_f32(u, v), one));
+    hit = vandq_u32(hit, vcgtq_f32(t, epsilon));
+    hit = vandq_u32(hit, vcltq_f32(t, vdupq_n_f32(max_distance)));
+
+    uint32_t mask = getLaneMask(hit);
+    if (mask)
+    {
+        float results[4];
+        vst1q_f32(results, t);
+        for (int i = 0; i < TRIANGLE_PACKET_WIDTH; ++i)
+        {
+            if (mask & (1u << i))
+                distances[i] = results[i];
+        }
+    }
+    return mask;
+}
+
+#else
+
+uint32_t intersectSpherePacket(const TrianglePacket& packet, const vector3f& center, float radius, float depths[4])
+{
+    return intersectSpherePacketScalar(packet, center, radius, depths);
+}
+
+uint32_t intersectRayPacket(const TrianglePacket& packet, const vector3f& origin, const vector3f& direction,
+                            float max_distance, float distances[4])
+{
+    return intersectRayPacketScalar(packet, origin, direction, max_distance, distances);
+}
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "irrlicht/vector3.h"
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRIANGLE_PACKET_SSE2 1
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#define TRIANGLE_PACKET_NEON 1
+#include <arm_neon.h>
+#endif
+
+using namespace irr;
+using namespace core;
+
+struct PhysicsTriangle;
+
+constexpr int TRIANGLE_PACKET_WIDTH = 4;
+
+// Four collision triangles in structure-of-arrays form, so one SIMD
+// instruction works on the same value of every triangle. Unused lanes are
+// zero, which no query can hit (zero normal, zero edges).
+struct alignas(16) TrianglePacket
+{
+    // Ray test (Möller-Trumbore)
+    float v0_x[4], v0_y[4], v0_z[4];
+    float edge1_x[4], edge1_y[4], edge1_z[4];
+    float edge2_x[4], edge2_y[4], edge2_z[4];
+
+    // Sphere test against the extruded triangle
+    float normal_x[4], normal_y[4], normal_z[4];
+    float center_x[4], center_y[4], center_z[4];
+    float extruded_x[4], extruded_y[4], extruded_z[4];
+    float edge_u_x[4], edge_u_y[4], edge_u_z[4];
+    float edge_v_x[4], edge_v_y[4], edge_v_z[4];
+    float dot_uu[4], dot_uv[4], dot_vv[4], inv_denom[4];
+
+    void clear();
+    void setLane(int lane, const PhysicsTriangle& triangle);
+};
+
+// Both kernels return a bit per lane that hits and write that lane's result.
+// They are the per-triangle tests of PhysicsSystem (sphere in front of the
+// triangle, within radius of its plane, projecting into the extruded
+// triangle; Möller-Trumbore with the same epsilons), evaluated in the same
+// order, so the SIMD and scalar versions agree bit for bit as long as the
+// compiler doesn't fuse multiply-adds.
+
+// depths: how far the sphere would have to move along the normal to clear
+// the triangle
+uint32_t intersectSpherePacket(const TrianglePacket& packet, const vector3f& center, float radius, float depths[4]);
+uint32_t intersectSpherePacketScalar(const TrianglePacket& packet, const vector3f& center, float radius, float depths[4]);
+
+// direction must be normalized; distances: along the ray, in (epsilon, max_distance)
+uint32_t intersectRayPacket(const TrianglePacket& packet, const vector3f& origin, const vector3f& direction,
+                            float max_distance, float distances[4]);
+uint32_t intersectRayPacketScalar(const TrianglePacket& packet, const vector3f& origin, const vector3f& direction,
+                                  float max_distance, float distances[4]);
@@ -0,0 +1,514 @@
+#include "AssetArchive.hpp"
+#include "Hash.hpp"
+#include "Lz4.hpp"
+#include "ThreadPool.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+
+namespace
+{
+    constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+    // Entries that shrink by less than this are stored, so they can be mapped
+    constexpr double MIN_COMPRESSION_GAIN = 0.05;
+
+    uint64_t alignSection(uint64_t offset)
+    {
+        return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    bool sectionFits(uint64_t offset, uint64_t count, uint64_t element_size, uint64_t file_size)
+    {
+        if (offset % SECTION_ALIGNMENT != 0 || offset > file_size)
+        {
+            return false;
+        }
+        return count <= (file_size - offset) / element_size;
+    }
+
+    bool rangeFits(uint64_t offset, uint64_t size, uint64_t file_size)
+    {
+        return offset <= file_size && size <= file_size - offset;
+    }
+
+    // Formats that are compressed already; LZ4 would only cost load time
+    bool isPrecompressed(const std::string& path)
+    {
+        std::string extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg" ||
+               extension == ".webp" || extension == ".ktx2" || extension == ".ogg" ||
+               extension == ".mp3" || extension == ".gz" || extension == ".zip" || extension == ".gpak";
+    }
+
+    bool writePadding(FILE* file, uint64_t& position, uint64_t target)
+    {
+        static const unsigned char zeros[SECTION_ALIGNMENT] = {};
+        while (position < target)
+        {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(target - position, SECTION_ALIGNMENT));
+            if (fwrite(zeros, 1, count, file) != count)
+            {
+                return false;
+            }
+            position += count;
+        }
+        return true;
+    }
+
+    bool writeBytes(FILE* file, uint64_t& position, const void* data, size_t size)
+    {
+        if (size > 0 && fwrite(data, 1, size, file) != size)
+        {
+            return false;
+        }
+        position += size;
+        return true;
+    }
+}
+
+std::shared_ptr<AssetArchive> AssetArchive::open(const std::string& filename, std::string* error)
+{
+    std::string message;
+    std::shared_ptr<AssetArchive> archive(new AssetArchive());
+
+    if (!archive->file.open(filename))
+    {
+        message = "Cannot open asset archive: " + filename;
+    }
+    else if (!archive->validate(message))
+    {
+        message = filename + ": " + message;
+    }
+    else
+    {
+        const unsigned char* base = archive->file.data();
+        archive->header = reinterpret_cast<const AssetArchiveHeader*>(base);
+        archive->slots = reinterpret_cast<const uint32_t*>(base + archive->header->slot_offset);
+        archive->entries = reinterpret_cast<const AssetArchiveEntry*>(base + archive->header->entry_offset);
+        archive->blocks = reinterpret_cast<const AssetArchiveBlock*>(base + archive->header->block_offset);
+        archive->string_table = reinterpret_cast<const char*>(base + archive->header->string_table_offset);
+        archive->filename = filename;
+        return archive;
+    }
+
+    if (error)
+    {
+        *error = message;
+    }
+    return nullptr;
+}
+
+const AssetArchiveEntry* AssetArchive::find(const std::string& path) const
+{
+    const uint64_t hash = hashString(path);
+    const uint32_t mask = header->slot_count - 1;
+
+    // validate() made sure at least one slot is empty, so this terminates
+    for (uint32_t slot = static_cast<uint32_t>(hash) & mask; slots[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const AssetArchiveEntry& entry = entries[slots[slot] - 1];
+        if (entry.path_hash == hash && entry.path_length == path.size() &&
+            memcmp(string_table + entry.path, path.data(), path.size()) == 0)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const unsigned char* AssetArchive::getStoredData(const AssetArchiveEntry& entry) const
+{
+    return entry.block_count == 0 ? file.data() + entry.offset : nullptr;
+}
+
+bool AssetArchive::extract(const AssetArchiveEntry& entry, unsigned char* destination) const
+{
+    if (entry.block_count == 0)
+    {
+        if (entry.size > 0)
+        {
+            memcpy(destination, file.data() + entry.offset, static_cast<size_t>(entry.size));
+        }
+        return true;
+    }
+
+    // Every block but the last is block_size bytes, so each one knows where it goes
+    std::atomic<bool> failed(false);
+    auto decode_block = [&](size_t i)
+    {
+        const AssetArchiveBlock& block = blocks[entry.first_block + i];
+        unsigned char* target = destination + i * header->block_size;
+        const unsigned char* source = file.data() + block.offset;
+
+        if (block.stored_size == block.size)
+        {
+            memcpy(target, source, block.size);
+        }
+        else if (Lz4::decompress(source, block.stored_size, target, block.size) != block.size)
+        {
+            failed = true;
+        }
+    };
+
+    if (entry.block_count == 1)
+    {
+        decode_block(0);
+    }
+    else
+    {
+        ThreadPool::get().parallelFor(entry.block_count, decode_block);
+    }
+
+    if (failed)
+    {
+        fprintf(stderr, "[Asset Archive] Corrupt block in %s: %s\n", filename.c_str(), getPath(entry).c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string AssetArchive::getPath(const AssetArchiveEntry& entry) const
+{
+    return std::string(string_table + entry.path, entry.path_length);
+}
+
+bool AssetArchive::validate(std::string& error) const
+{
+    const uint64_t file_size = file.size();
+    if (file_size < sizeof(AssetArchiveHeader))
+    {
+        error = "File too small";
+        return false;
+    }
+
+    const unsigned char* base = file.data();
+    const AssetArchiveHeader* h = reinterpret_cast<const AssetArchiveHeader*>(base);
+    if (h->magic != ASSET_ARCHIVE_MAGIC)
+    {
+        error = "Not an asset archive";
+        return false;
+    }
+    if (h->version != ASSET_ARCHIVE_VERSION)
+    {
+        error = "Unsupported version " + std::to_string(h->version);
+        return false;
+    }
+    if (h->file_size != file_size)
+    {
+        error = "Truncated file";
+        return false;
+    }
+    if (h->block_size == 0 || h->slot_count == 0 || (h->slot_count & (h->slot_count - 1)) != 0 ||
+        h->slot_count <= h->entry_count)
+    {
+        error = "Invalid table of contents";
+        return false;
+    }
+
+    if (!sectionFits(h->slot_offset, h->slot_count, sizeof(uint32_t), file_size) ||
+        !sectionFits(h->entry_offset, h->entry_count, sizeof(AssetArchiveEntry), file_size) ||
+        !sectionFits(h->block_offset, h->block_count, sizeof(AssetArchiveBlock), file_size) ||
+        !sectionFits(h->string_table_offset, h->string_table_size, 1, file_size))
+    {
+        error = "Section out of bounds";
+        return false;
+    }
+
+    // The table of contents is small, so it is checked in full; entry data
+    // is only touched when an entry is opened
+    if (hashBytes(base + h->slot_offset, file_size - h->slot_offset) != h->toc_hash)
+    {
+        error = "Table of contents checksum mismatch";
+        return false;
+    }
+
+    const uint32_t* toc_slots = reinterpret_cast<const uint32_t*>(base + h->slot_offset);
+    for (uint32_t i = 0; i < h->slot_count; ++i)
+    {
+        if (toc_slots[i] > h->entry_count)
+        {
+            error = "Slot references a missing entry";
+            return false;
+        }
+    }
+
+    const AssetArchiveEntry* toc_entries = reinterpret_cast<const AssetArchiveEntry*>(base + h->entry_offset);
+    const AssetArchiveBlock* toc_blocks = reinterpret_cast<const AssetArchiveBlock*>(base + h->block_offset);
+    const char* strings = reinterpret_cast<const char*>(base + h->string_table_offset);
+    for (uint32_t i = 0; i < h->entry_count; ++i)
+    {
+        const AssetArchiveEntry& entry = toc_entries[i];
+        if (!rangeFits(entry.path, entry.path_length + 1ull, h->string_table_size) ||
+            strings[entry.path + entry.path_length] != '\0')
+        {
+            error = "Entry path out of bounds";
+            return false;
+        }
+
+        if (entry.block_count == 0)
+        {
+            if (!rangeFits(entry.offset, entry.size, file_size))
+            {
+                error = "Entry data out of bounds: " + std::string(strings + entry.path);
+                return false;
+            }
+            continue;
+        }
+
+        if (!rangeFits(entry.first_block, entry.block_count, h->block_count) ||
+            entry.size > static_cast<uint64_t>(entry.block_count) * h->block_size)
+        {
+            error = "Entry blocks out of bounds: " + std::string(strings + entry.path);
+            return false;
+        }
+
+        uint64_t total = 0;
+        for (uint32_t b = 0; b < entry.block_count; ++b)
+        {
+            const AssetArchiveBlock& block = toc_blocks[entry.first_block + b];
+            bool last = b + 1 == entry.block_count;
+            if ((last ? block.size > h->block_size : block.size != h->block_size) ||
+                block.stored_size > block.size || !rangeFits(block.offset, block.stored_size, file_size))
+            {
+                error = "Invalid block in " + std::string(strings + entry.path);
+                return false;
+            }
+            total += block.size;
+        }
+        if (total != entry.size)
+        {
+            error = "Block sizes don't add up: " + std::string(strings + entry.path);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AssetArchiveWriter::addFile(const std::string& archive_path, const std::string& source_path, AssetArchiveMode mode)
+{
+    for (const PendingFile& file : files)
+    {
+        if (file.archive_path == archive_path)
+        {
+            return false;
+        }
+    }
+    files.push_back({ archive_path, source_path, mode });
+    return true;
+}
+
+bool AssetArchiveWriter::write(const std::string& filename, std::string& error)
+{
+    raw_size = 0;
+    stored_size = 0;
+    compressed_count = 0;
+
+    // Write to a temporary file and rename, so a crash never leaves a half-written archive
+    std::string temp_path = filename + ".tmp";
+    FILE* output = fopen(temp_path.c_str(), "wb");
+    if (!output)
+    {
+        error = "Cannot write " + temp_path;
+        return false;
+    }
+
+    std::vector<AssetArchiveEntry> entries;
+    std::vector<AssetArchiveBlock> blocks;
+    std::string string_table;
+    entries.reserve(files.size());
+
+    AssetArchiveHeader header = {};
+    uint64_t position = 0;
+    bool ok = writeBytes(output, position, &header, sizeof(header));
+
+    for (size_t i = 0; ok && i < files.size(); ++i)
+    {
+        const PendingFile& pending = files[i];
+
+        MappedFile source;
+        std::error_code ec;
+        if (!source.open(pending.source_path) && std::filesystem::file_size(pending.source_path, ec) != 0)
+        {
+            // MappedFile refuses empty files, those are simply stored empty
+            error = "Cannot read " + pending.source_path;
+            ok = false;
+            break;
+        }
+
+        const unsigned char* data = source.data();
+        const size_t size = source.size();
+
+        AssetArchiveEntry entry = {};
+        entry.path_hash = hashString(pending.archive_path);
+        entry.path = static_cast<uint32_t>(string_table.size());
+        entry.path_length = static_cast<uint32_t>(pending.archive_path.size());
+        entry.size = size;
+        entry.content_hash = hashBytes(data, size);
+        string_table += pending.archive_path;
+        string_table += '\0';
+
+        // Compress every block on its own, in parallel; blocks that don't shrink stay raw
+        bool compress = size > 0 && (pending.mode == AssetArchiveMode::Compress ||
+                        (pending.mode == AssetArchiveMode::Auto && !isPrecompressed(pending.archive_path)));
+        const size_t block_count = (size + ASSET_ARCHIVE_BLOCK_SIZE - 1) / ASSET_ARCHIVE_BLOCK_SIZE;
+        std::vector<std::vector<unsigned char>> packed;
+        uint64_t packed_size = 0;
+        if (compress)
+        {
+            packed.resize(block_count);
+            ThreadPool::get().parallelFor(block_count, [&](size_t b)
+            {
+                size_t offset = b * ASSET_ARCHIVE_BLOCK_SIZE;
+                size_t length = std::min<size_t>(size - offset, ASSET_ARCHIVE_BLOCK_SIZE);
+                std::vector<unsigned char>& out = packed[b];
+                out.resize(Lz4::compressBound(length));
+                size_t compressed = Lz4::compress(data + offset, length, out.data(), out.size());
+                out.resize(compressed > 0 && compressed < length ? compressed : 0);
+            });
+
+            for (size_t b = 0; b < block_count; ++b)
+            {
+                size_t length = std::min<size_t>(size - b * ASSET_ARCHIVE_BLOCK_SIZE, ASSET_ARCHIVE_BLOCK_SIZE);
+                packed_size += packed[b].empty() ? length : packed[b].size();
+            }
+
+            if (pending.mode == AssetArchiveMode::Auto && packed_size > size * (1.0 - MIN_COMPRESSION_GAIN))
+            {
+                compress = false;
+            }
+        }
+
+        if (compress)
+        {
+            entry.first_block = static_cast<uint32_t>(blocks.size());
+            entry.block_count = static_cast<uint32_t>(block_count);
+            for (size_t b = 0; ok && b < block_count; ++b)
+            {
+                size_t offset = b * ASSET_ARCHIVE_BLOCK_SIZE;
+                size_t length = std::min<size_t>(size - offset, ASSET_ARCHIVE_BLOCK_SIZE);
+
+                AssetArchiveBlock block;
+                block.offset = position;
+                block.size = static_cast<uint32_t>(length);
+                if (packed[b].empty())
+                {
+                    block.stored_size = block.size;
+                    ok = writeBytes(output, position, data + offset, length);
+                }
+                else
+                {
+                    block.stored_size = static_cast<uint32_t>(packed[b].size());
+                    ok = writeBytes(output, position, packed[b].data(), packed[b].size());
+                }
+                blocks.push_back(block);
+            }
+            ++compressed_count;
+        }
+        else
+        {
+            ok = writePadding(output, position, alignSection(position));
+            entry.offset = position;
+            ok = ok && writeBytes(output, position, data, size);
+        }
+
+        raw_size += size;
+        stored_size += compress ? packed_size : size;
+        entries.push_back(entry);
+    }
+
+    if (ok)
+    {
+        // Hash table at most half full, so probes stay short and always hit an empty slot
+        uint32_t slot_count = 2;
+        while (slot_count < entries.size() * 2)
+        {
+            slot_count *= 2;
+        }
+        std::vector<uint32_t> slots(slot_count, 0);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            uint32_t slot = static_cast<uint32_t>(entries[i].path_hash) & (slot_count - 1);
+            while (slots[slot] != 0)
+            {
+                slot = (slot + 1) & (slot_count - 1);
+            }
+            slots[slot] = static_cast<uint32_t>(i + 1);
+        }
+
+        header.magic = ASSET_ARCHIVE_MAGIC;
+        header.version = ASSET_ARCHIVE_VERSION;
+        header.entry_count = static_cast<uint32_t>(entries.size());
+        header.slot_count = slot_count;
+        header.block_count = static_cast<uint32_t>(blocks.size());
+        header.block_size = ASSET_ARCHIVE_BLOCK_SIZE;
+        header.string_table_size = static_cast<uint32_t>(string_table.size());
+
+        header.slot_offset = alignSection(position);
+        header.entry_offset = alignSection(header.slot_offset + slots.size() * sizeof(uint32_t));
+        header.block_offset = alignSection(header.entry_offset + entries.size() * sizeof(AssetArchiveEntry));
+        header.string_table_offset = alignSection(header.block_offset + blocks.size() * sizeof(AssetArchiveBlock));
+        header.file_size = header.string_table_offset + string_table.size();
+
+        std::vector<unsigned char> toc(header.file_size - header.slot_offset, 0);
+        memcpy(toc.data(), slots.data(), slots.size() * sizeof(uint32_t));
+        if (!entries.empty())
+        {
+            memcpy(toc.data() + (header.entry_offset - header.slot_offset), entries.data(),
+                   entries.size() * sizeof(AssetArchiveEntry));
+        }
+        if (!blocks.empty())
+        {
+            memcpy(toc.data() + (header.block_offset - header.slot_offset), blocks.data(),
+                   blocks.size() * sizeof(AssetArchiveBlock));
+        }
+        if (!string_table.empty())
+        {
+            memcpy(toc.data() + (header.string_table_offset - header.slot_offset), string_table.data(),
+                   string_table.size());
+        }
+        header.toc_hash = hashBytes(toc.data(), toc.size());
+
+        ok = writePadding(output, position, header.slot_offset) &&
+             writeBytes(output, position, toc.data(), toc.size()) &&
+             fseek(output, 0, SEEK_SET) == 0 &&
+             fwrite(&header, 1, sizeof(header), output) == sizeof(header);
+        if (!ok)
+        {
+            error = "Short write to " + temp_path;
+        }
+    }
+    else if (error.empty())
+    {
+        error = "Short write to " + temp_path;
+    }
+
+    ok = fclose(output) == 0 && ok;
+
+    std::error_code ec;
+    if (!ok)
+    {
+        std::filesystem::remove(temp_path, ec);
+        if (error.empty())
+        {
+            error = "Cannot write " + temp_path;
+        }
+        return false;
+    }
+
+    std::filesystem::rename(temp_path, filename, ec);
+    if (ec)
+    {
+        // The old archive may still be mapped (Windows won't replace it)
+        std::filesystem::remove(temp_path, ec);
+        error = "Cannot replace " + filename;
+        return false;
+    }
+
+    return true;
+}
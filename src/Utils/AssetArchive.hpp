@@ -0,0 +1,143 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "MappedFile.hpp"
+
+// .gpak layout (little-endian):
+//
+//   AssetArchiveHeader
+//   entry data       stored entries on 16 byte boundaries, compressed blocks packed
+//   slots            uint32_t[slot_count]                 entry index + 1, 0 = empty
+//   entries          AssetArchiveEntry[entry_count]
+//   blocks           AssetArchiveBlock[block_count]
+//   string table     archive paths, null terminated
+//
+// The slots are an open-addressing hash table over the hashed archive path
+// (linear probing, at most half full), so a lookup touches one or two slots
+// and never the data. Entries are either stored, and then used in place from
+// the mapping, or split into blocks of block_size bytes that are LZ4
+// compressed independently and decompress in parallel. A block whose
+// stored_size equals its size did not shrink and is kept raw.
+//
+// Archive paths are relative, '/' separated and lexically normal
+// ("textures/grass.png"), see AssetFileSystem::normalizePath.
+constexpr uint32_t ASSET_ARCHIVE_MAGIC = 0x4B415047; // "GPAK"
+constexpr uint32_t ASSET_ARCHIVE_VERSION = 1;
+constexpr uint32_t ASSET_ARCHIVE_BLOCK_SIZE = 64 * 1024;
+
+struct AssetArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t file_size;
+    uint64_t toc_hash;          // Slots, entries, blocks and string table
+
+    uint32_t entry_count;
+    uint32_t slot_count;        // Power of two
+    uint32_t block_count;
+    uint32_t block_size;
+    uint32_t string_table_size;
+    uint32_t reserved;
+
+    uint64_t slot_offset;
+    uint64_t entry_offset;
+    uint64_t block_offset;
+    uint64_t string_table_offset;
+};
+static_assert(sizeof(AssetArchiveHeader) == 80, "AssetArchiveHeader layout changed");
+
+struct AssetArchiveEntry
+{
+    uint64_t path_hash;
+    uint32_t path;              // String table offset
+    uint32_t path_length;
+    uint64_t size;              // Uncompressed size
+    uint64_t offset;            // Data offset of a stored entry, 0 for compressed ones
+    uint32_t first_block;
+    uint32_t block_count;       // 0 for stored entries
+    uint64_t content_hash;      // hashBytes of the uncompressed data
+};
+static_assert(sizeof(AssetArchiveEntry) == 48, "AssetArchiveEntry layout changed");
+
+struct AssetArchiveBlock
+{
+    uint64_t offset;
+    uint32_t stored_size;
+    uint32_t size;
+};
+static_assert(sizeof(AssetArchiveBlock) == 16, "AssetArchiveBlock layout changed");
+
+// An opened, validated .gpak. The table of contents is used in place from the
+// mapping; entries stay valid for as long as the archive is alive.
+class AssetArchive
+{
+public:
+    static std::shared_ptr<AssetArchive> open(const std::string& filename, std::string* error = nullptr);
+
+    // Look up a normalized archive path, nullptr if the archive doesn't have it
+    const AssetArchiveEntry* find(const std::string& path) const;
+
+    // Data of a stored entry straight from the mapping, nullptr for compressed ones
+    const unsigned char* getStoredData(const AssetArchiveEntry& entry) const;
+
+    // Decompress (or copy) an entry into destination, which must hold entry.size bytes
+    bool extract(const AssetArchiveEntry& entry, unsigned char* destination) const;
+
+    const std::string& getFilename() const { return filename; }
+    size_t getEntryCount() const { return header->entry_count; }
+    const AssetArchiveEntry& getEntry(size_t index) const { return entries[index]; }
+    std::string getPath(const AssetArchiveEntry& entry) const;
+
+private:
+    std::string filename;
+    MappedFile file;
+    const AssetArchiveHeader* header = nullptr;
+    const uint32_t* slots = nullptr;
+    const AssetArchiveEntry* entries = nullptr;
+    const AssetArchiveBlock* blocks = nullptr;
+    const char* string_table = nullptr;
+
+    bool validate(std::string& error) const;
+};
+
+enum class AssetArchiveMode
+{
+    Auto,       // Compress unless the format already is (PNG, JPEG, ...) or it barely shrinks
+    Store,
+    Compress
+};
+
+// Collects files and writes them into a new archive. Files are read and
+// compressed in write(), block by block on the thread pool.
+class AssetArchiveWriter
+{
+public:
+    // Returns false if archive_path was already added
+    bool addFile(const std::string& archive_path, const std::string& source_path,
+                 AssetArchiveMode mode = AssetArchiveMode::Auto);
+
+    bool write(const std::string& filename, std::string& error);
+
+    size_t getFileCount() const { return files.size(); }
+
+    // Totals of the last write()
+    uint64_t getRawSize() const { return raw_size; }
+    uint64_t getStoredSize() const { return stored_size; }
+    size_t getCompressedCount() const { return compressed_count; }
+
+private:
+    struct PendingFile
+    {
+        std::string archive_path;
+        std::string source_path;
+        AssetArchiveMode mode;
+    };
+
+    std::vector<PendingFile> files;
+    uint64_t raw_size = 0;
+    uint64_t stored_size = 0;
+    size_t compressed_count = 0;
+};
@@ -0,0 +1,813 @@
+#include "AssetCatalog.hpp"
+#include "BakedMesh.hpp"
+#include "GltfDocument.hpp"
+#include "GltfLoader.hpp"
+#include "Hash.hpp"
+#include "MappedFile.hpp"
+#include "ObjLoader.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <filesystem>
+
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#include <tiny_gltf.h>
+
+#include "stb_image.h"
+
+namespace
+{
+    std::string lowerExtension(const std::string& path)
+    {
+        std::string extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
+    }
+
+    void addUnique(std::vector<std::string>& list, const std::string& value)
+    {
+        if (std::find(list.begin(), list.end(), value) == list.end())
+        {
+            list.push_back(value);
+        }
+    }
+
+    // Path of a file referenced from source (glTF URIs and OBJ mtllib are relative to it)
+    std::string resolveReference(const std::string& source, const std::string& reference)
+    {
+        std::filesystem::path directory = std::filesystem::path(source).parent_path();
+        return AssetCatalog::makeKey((directory / reference).string());
+    }
+
+    void computeBounds(const vertex* vertices, size_t count, AssetRecord& record)
+    {
+        if (!vertices || count == 0)
+        {
+            return;
+        }
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            record.bounds_min[axis] = FLT_MAX;
+            record.bounds_max[axis] = -FLT_MAX;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float position[3] = { vertices[i].vx, vertices[i].vy, vertices[i].vz };
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                record.bounds_min[axis] = std::min(record.bounds_min[axis], position[axis]);
+                record.bounds_max[axis] = std::max(record.bounds_max[axis], position[axis]);
+            }
+        }
+        record.has_bounds = true;
+    }
+
+    // mtllib and usemtl lines; the geometry itself comes from ObjLoader
+    void indexObjReferences(const std::string& path, const MappedFile& file, AssetRecord& record)
+    {
+        const char* p = reinterpret_cast<const char*>(file.data());
+        const char* end = p + file.size();
+
+        while (p < end)
+        {
+            const void* newline = memchr(p, '\n', static_cast<size_t>(end - p));
+            const char* line_end = newline ? static_cast<const char*>(newline) : end;
+
+            while (p < line_end && (*p == ' ' || *p == '\t'))
+            {
+                ++p;
+            }
+
+            const bool is_mtllib = (line_end - p > 7 && memcmp(p, "mtllib", 6) == 0 && (p[6] == ' ' || p[6] == '\t'));
+            const bool is_usemtl = (line_end - p > 7 && memcmp(p, "usemtl", 6) == 0 && (p[6] == ' ' || p[6] == '\t'));
+            if (is_mtllib || is_usemtl)
+            {
+                const char* name = p + 7;
+                const char* name_end = line_end;
+                while (name < name_end && (*name == ' ' || *name == '\t'))
+                {
+                    ++name;
+                }
+                while (name_end > name && std::isspace(static_cast<unsigned char>(name_end[-1])))
+                {
+                    --name_end;
+                }
+
+                if (name < name_end)
+                {
+                    std::string value(name, name_end);
+                    if (is_mtllib)
+                    {
+                        addUnique(record.dependencies, resolveReference(path, value));
+                    }
+                    else
+                    {
+                        addUnique(record.material_names, value);
+                    }
+                }
+            }
+
+            p = line_end + 1;
+        }
+    }
+
+    void indexObj(const std::string& path, const MappedFile& file, AssetRecord& record, std::string& error)
+    {
+        indexObjReferences(path, file, record);
+
+        ObjLoaderConfig config;
+        config.verbose_logging = false;
+        ObjLoadResult result = ObjLoader::loadObj(path, config);
+        if (!result.success)
+        {
+            error = result.error_message;
+            return; // Recorded as invalid
+        }
+
+        record.valid = true;
+        record.vertex_count = result.vertex_count;
+        computeBounds(result.vertices, result.vertex_count, record);
+    }
+
+    // Every "uri" string of a .gltf, read from the raw JSON. Used when the
+    // document does not load (typically a missing buffer), so the record still
+    // goes stale once the referenced files appear.
+    void indexGltfReferences(const std::string& path, const MappedFile& file, AssetRecord& record)
+    {
+        const char* p = reinterpret_cast<const char*>(file.data());
+        const char* end = p + file.size();
+        const char key[] = "\"uri\"";
+        const size_t key_length = sizeof(key) - 1;
+
+        while (static_cast<size_t>(end - p) > key_length)
+        {
+            const char* found = std::search(p, end, key, key + key_length);
+            if (found == end)
+            {
+                break;
+            }
+
+            p = found + key_length;
+            while (p < end && (std::isspace(static_cast<unsigned char>(*p)) || *p == ':'))
+            {
+                ++p;
+            }
+            if (p >= end || *p != '"')
+            {
+                continue;
+            }
+
+            const char* value = ++p;
+            while (p < end && *p != '"')
+            {
+                p += (*p == '\\' && p + 1 < end) ? 2 : 1;
+            }
+            if (p >= end)
+            {
+                break;
+            }
+
+            std::string uri(value, p);
+            if (!uri.empty() && uri.compare(0, 5, "data:") != 0)
+            {
+                addUnique(record.dependencies, resolveReference(path, uri));
+            }
+        }
+    }
+
+    void indexGltf(const std::string& path, const MappedFile& file, AssetRecord& record, std::string& error)
+    {
+        std::shared_ptr<const GltfDocument> document = GltfDocument::load(path, error);
+        if (!document)
+        {
+            if (record.kind == AssetKind::Gltf)
+            {
+                indexGltfReferences(path, file, record);
+            }
+            return; // Recorded as invalid
+        }
+
+        const tinygltf::Model& model = document->getModel();
+        record.valid = true;
+        record.vertex_count = GltfLoader::getGltfVertexCount(*document);
+
+        for (const auto& gltf_mesh : model.meshes)
+        {
+            record.mesh_names.push_back(gltf_mesh.name);
+            for (const auto& primitive : gltf_mesh.primitives)
+            {
+                if (primitive.indices >= 0 && primitive.indices < static_cast<int>(model.accessors.size()))
+                {
+                    record.index_count += model.accessors[primitive.indices].count;
+                }
+            }
+        }
+
+        for (const auto& material : model.materials)
+        {
+            record.material_names.push_back(material.name);
+        }
+
+        for (const auto& image : model.images)
+        {
+            record.texture_uris.push_back(image.uri);
+            if (!image.uri.empty() && image.uri.compare(0, 5, "data:") != 0)
+            {
+                addUnique(record.dependencies, resolveReference(path, image.uri));
+            }
+        }
+
+        for (const auto& buffer : model.buffers)
+        {
+            if (!buffer.uri.empty() && buffer.uri.compare(0, 5, "data:") != 0)
+            {
+                addUnique(record.dependencies, resolveReference(path, buffer.uri));
+            }
+        }
+
+        // Bounds of what the loader actually produces (node traversal, scale, generated data)
+        GltfLoaderConfig config;
+        GltfLoadResult result = GltfLoader::loadGltfGeometry(*document, config);
+        if (result.success)
+        {
+            computeBounds(result.vertices, result.vertex_count, record);
+        }
+    }
+
+    void indexBakedMesh(const std::string& path, AssetRecord& record, std::string& error)
+    {
+        std::shared_ptr<BakedMesh> baked = BakedMesh::open(path, &error);
+        if (!baked)
+        {
+            return; // Recorded as invalid
+        }
+
+        const BakedMeshHeader& header = baked->getHeader();
+        record.valid = true;
+        record.vertex_count = header.vertex_count;
+        record.index_count = header.index_count;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            record.bounds_min[axis] = header.bounds_min[axis];
+            record.bounds_max[axis] = header.bounds_max[axis];
+        }
+        record.has_bounds = true;
+
+        for (size_t i = 0; i < baked->getSubmeshCount(); ++i)
+        {
+            const char* name = baked->getMaterialName(baked->getSubmeshes()[i]);
+            if (name[0] != '\0')
+            {
+                addUnique(record.material_names, name);
+            }
+        }
+    }
+
+    void indexTexture(const MappedFile& file, AssetRecord& record, std::string& error)
+    {
+        // Header only; nothing is decoded
+        int width = 0, height = 0, channels = 0;
+        if (file.size() > INT32_MAX ||
+            !stbi_info_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels))
+        {
+            error = stbi_failure_reason() ? stbi_failure_reason() : "unknown image format";
+            return; // Recorded as invalid
+        }
+
+        record.valid = true;
+        record.width = width;
+        record.height = height;
+        record.channels = channels;
+    }
+
+    // Catalog writing: strings are stored once and referenced by offset
+    struct StringTableBuilder
+    {
+        std::string table;
+        std::unordered_map<std::string, uint32_t> offsets;
+
+        uint32_t add(const std::string& value)
+        {
+            auto it = offsets.find(value);
+            if (it != offsets.end())
+            {
+                return it->second;
+            }
+
+            uint32_t offset = static_cast<uint32_t>(table.size());
+            table += value;
+            table += '\0';
+            offsets.emplace(value, offset);
+            return offset;
+        }
+    };
+
+    AssetCatalogList addNameList(const std::vector<std::string>& names, StringTableBuilder& strings,
+                                 std::vector<uint32_t>& name_offsets)
+    {
+        AssetCatalogList list;
+        list.first = static_cast<uint32_t>(name_offsets.size());
+        list.count = static_cast<uint32_t>(names.size());
+        for (const auto& name : names)
+        {
+            name_offsets.push_back(strings.add(name));
+        }
+        return list;
+    }
+
+    bool sectionFits(uint64_t offset, uint64_t count, uint64_t element_size, uint64_t file_size)
+    {
+        if (offset > file_size)
+        {
+            return false;
+        }
+        return count <= (file_size - offset) / element_size;
+    }
+}
+
+AssetCatalog& AssetCatalog::get()
+{
+    static AssetCatalog instance;
+    return instance;
+}
+
+bool AssetCatalog::open(const std::string& filename)
+{
+    clear();
+    catalog_path = filename;
+
+    std::error_code ec;
+    if (!std::filesystem::exists(filename, ec))
+    {
+        // Starts empty and is written on the first save()
+        return true;
+    }
+
+    std::string error;
+    if (!read(filename, error))
+    {
+        printf("[Asset Catalog] Discarding %s: %s\n", filename.c_str(), error.c_str());
+        records.clear();
+        dirty = true;
+        return false;
+    }
+
+    printf("[Asset Catalog] Loaded %s (%zu assets)\n", filename.c_str(), records.size());
+    return true;
+}
+
+bool AssetCatalog::save()
+{
+    if (catalog_path.empty())
+    {
+        printf("[Asset Catalog ERROR] save() without open()\n");
+        return false;
+    }
+    return !dirty || save(catalog_path);
+}
+
+bool AssetCatalog::save(const std::string& filename)
+{
+    // Sorted by path so the same catalog always produces the same file
+    std::vector<const AssetRecord*> sorted;
+    sorted.reserve(records.size());
+    for (const auto& entry : records)
+    {
+        sorted.push_back(&entry.second);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const AssetRecord* a, const AssetRecord* b) { return a->path < b->path; });
+
+    StringTableBuilder strings;
+    std::vector<uint32_t> name_offsets;
+    std::vector<AssetCatalogRecord> disk_records;
+    disk_records.reserve(sorted.size());
+
+    for (const AssetRecord* record : sorted)
+    {
+        AssetCatalogRecord disk = {};
+        disk.path = strings.add(record->path);
+        disk.kind = static_cast<uint32_t>(record->kind);
+        disk.source_size = record->source_size;
+        disk.source_mtime = record->source_mtime;
+        disk.content_hash = record->content_hash;
+        disk.dependency_hash = record->dependency_hash;
+        disk.flags = (record->valid ? ASSET_RECORD_VALID : 0) | (record->has_bounds ? ASSET_RECORD_HAS_BOUNDS : 0);
+        disk.vertex_count = static_cast<uint32_t>(std::min<size_t>(record->vertex_count, UINT32_MAX));
+        disk.index_count = static_cast<uint32_t>(std::min<size_t>(record->index_count, UINT32_MAX));
+        disk.width = static_cast<uint32_t>(record->width);
+        disk.height = static_cast<uint32_t>(record->height);
+        disk.channels = static_cast<uint32_t>(record->channels);
+        memcpy(disk.bounds_min, record->bounds_min, sizeof(disk.bounds_min));
+        memcpy(disk.bounds_max, record->bounds_max, sizeof(disk.bounds_max));
+        disk.mesh_names = addNameList(record->mesh_names, strings, name_offsets);
+        disk.material_names = addNameList(record->material_names, strings, name_offsets);
+        disk.texture_uris = addNameList(record->texture_uris, strings, name_offsets);
+        disk.dependencies = addNameList(record->dependencies, strings, name_offsets);
+        disk_records.push_back(disk);
+    }
+
+    AssetCatalogHeader header = {};
+    header.magic = ASSET_CATALOG_MAGIC;
+    header.version = ASSET_CATALOG_VERSION;
+    header.record_count = static_cast<uint32_t>(disk_records.size());
+    header.name_count = static_cast<uint32_t>(name_offsets.size());
+    header.string_table_size = static_cast<uint32_t>(strings.table.size());
+    header.record_offset = sizeof(AssetCatalogHeader);
+    header.name_offset = header.record_offset + disk_records.size() * sizeof(AssetCatalogRecord);
+    header.string_table_offset = header.name_offset + name_offsets.size() * sizeof(uint32_t);
+    header.file_size = header.string_table_offset + strings.table.size();
+
+    std::vector<unsigned char> image(header.file_size, 0);
+    if (!disk_records.empty())
+    {
+        memcpy(image.data() + header.record_offset, disk_records.data(), disk_records.size() * sizeof(AssetCatalogRecord));
+    }
+    if (!name_offsets.empty())
+    {
+        memcpy(image.data() + header.name_offset, name_offsets.data(), name_offsets.size() * sizeof(uint32_t));
+    }
+    if (!strings.table.empty())
+    {
+        memcpy(image.data() + header.string_table_offset, strings.table.data(), strings.table.size());
+    }
+
+    header.content_hash = hashBytes(image.data() + sizeof(AssetCatalogHeader), image.size() - sizeof(AssetCatalogHeader));
+    memcpy(image.data(), &header, sizeof(AssetCatalogHeader));
+
+    // Write to a temporary file and rename, so a crash never leaves a half-written catalog
+    std::string temp_path = filename + ".tmp";
+    FILE* file = fopen(temp_path.c_str(), "wb");
+    if (!file)
+    {
+        printf("[Asset Catalog ERROR] Cannot write %s\n", temp_path.c_str());
+        return false;
+    }
+
+    size_t written = fwrite(image.data(), 1, image.size(), file);
+    fclose(file);
+
+    std::error_code ec;
+    if (written == image.size())
+    {
+        std::filesystem::rename(temp_path, filename, ec);
+    }
+    if (written != image.size() || ec)
+    {
+        std::filesystem::remove(temp_path, ec);
+        printf("[Asset Catalog ERROR] Cannot replace %s\n", filename.c_str());
+        return false;
+    }
+
+    if (filename == catalog_path)
+    {
+        dirty = false;
+    }
+    printf("[Asset Catalog] Wrote %s (%zu assets)\n", filename.c_str(), records.size());
+    return true;
+}
+
+void AssetCatalog::clear()
+{
+    records.clear();
+    catalog_path.clear();
+    dirty = false;
+}
+
+const AssetRecord* AssetCatalog::find(const std::string& path) const
+{
+    auto it = records.find(makeKey(path));
+    return it != records.end() ? &it->second : nullptr;
+}
+
+const AssetRecord* AssetCatalog::findCurrent(const std::string& path) const
+{
+    const AssetRecord* record = find(path);
+    return record && isCurrent(*record) ? record : nullptr;
+}
+
+const AssetRecord* AssetCatalog::update(const std::string& path)
+{
+    std::string key = makeKey(path);
+
+    auto it = records.find(key);
+    if (it != records.end() && isCurrent(it->second))
+    {
+        return &it->second;
+    }
+
+    AssetRecord record;
+    std::string error;
+    if (!indexAsset(key, record, error))
+    {
+        printf("[Asset Catalog ERROR] %s: %s\n", key.c_str(), error.c_str());
+        if (it != records.end())
+        {
+            records.erase(it);
+            dirty = true;
+        }
+        return nullptr;
+    }
+
+    if (!record.valid)
+    {
+        printf("[Asset Catalog] %s cannot be loaded: %s\n", key.c_str(), error.c_str());
+    }
+
+    dirty = true;
+    AssetRecord& stored = records[key];
+    stored = std::move(record);
+    return &stored;
+}
+
+size_t AssetCatalog::scan(const std::string& directory)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec))
+    {
+        printf("[Asset Catalog ERROR] Not a directory: %s\n", directory.c_str());
+        return 0;
+    }
+
+    size_t indexed = 0;
+    for (fs::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (!it->is_regular_file(ec))
+        {
+            continue;
+        }
+
+        std::string path = makeKey(it->path().string());
+        AssetKind kind = detectKind(path);
+        if (kind == AssetKind::Unknown)
+        {
+            continue;
+        }
+
+        // .gmesh caches next to their source are indexed through the source
+        if (kind == AssetKind::BakedMesh && fs::exists(path.substr(0, path.size() - 6), ec))
+        {
+            continue;
+        }
+
+        const AssetRecord* before = find(path);
+        if (before && isCurrent(*before))
+        {
+            continue;
+        }
+
+        if (update(path))
+        {
+            ++indexed;
+        }
+    }
+
+    // Drop records of files that disappeared from the directory
+    std::string prefix = makeKey(directory);
+    if (!prefix.empty() && prefix.back() != '/')
+    {
+        prefix += '/';
+    }
+    for (auto it = records.begin(); it != records.end();)
+    {
+        if (it->first.compare(0, prefix.size(), prefix) == 0 && !fs::exists(it->first, ec))
+        {
+            it = records.erase(it);
+            dirty = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    printf("[Asset Catalog] Scanned %s: %zu assets re-indexed\n", directory.c_str(), indexed);
+    return indexed;
+}
+
+void AssetCatalog::remove(const std::string& path)
+{
+    if (records.erase(makeKey(path)) > 0)
+    {
+        dirty = true;
+    }
+}
+
+bool AssetCatalog::indexAsset(const std::string& path, AssetRecord& record, std::string& error)
+{
+    record = AssetRecord();
+    record.path = makeKey(path);
+    record.kind = detectKind(path);
+
+    if (!BakedMesh::getSourceStamp(path, record.source_size, record.source_mtime))
+    {
+        error = "Cannot stat " + path;
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.open(path))
+    {
+        error = "Cannot open " + path;
+        return false;
+    }
+    record.content_hash = hashBytes(file.data(), file.size());
+
+    switch (record.kind)
+    {
+    case AssetKind::Obj:
+        indexObj(path, file, record, error);
+        break;
+    case AssetKind::Gltf:
+    case AssetKind::Glb:
+        indexGltf(path, file, record, error);
+        break;
+    case AssetKind::BakedMesh:
+        indexBakedMesh(path, record, error);
+        break;
+    case AssetKind::Texture:
+        indexTexture(file, record, error);
+        break;
+    default:
+        error = "Unsupported asset type";
+        break;
+    }
+
+    record.dependency_hash = hashDependencies(record.dependencies);
+    return true;
+}
+
+AssetKind AssetCatalog::detectKind(const std::string& path)
+{
+    std::string extension = lowerExtension(path);
+
+    if (extension == ".obj") return AssetKind::Obj;
+    if (extension == ".gltf") return AssetKind::Gltf;
+    if (extension == ".glb") return AssetKind::Glb;
+    if (extension == ".gmesh") return AssetKind::BakedMesh;
+    if (extension == ".png" || extension == ".bmp" || extension == ".jpg" || extension == ".jpeg" ||
+        extension == ".tga" || extension == ".psd" || extension == ".gif" || extension == ".hdr")
+    {
+        return AssetKind::Texture;
+    }
+    return AssetKind::Unknown;
+}
+
+std::string AssetCatalog::makeKey(const std::string& path)
+{
+    // Purely lexical, so lookups never touch the disk
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+uint64_t AssetCatalog::hashDependencies(const std::vector<std::string>& dependencies)
+{
+    uint64_t hash = HASH_SEED;
+    for (const auto& dependency : dependencies)
+    {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        BakedMesh::getSourceStamp(dependency, size, mtime); // A missing file hashes as 0/0
+        hash = hashCombine(hash, hashString(dependency));
+        hash = hashCombine(hash, size);
+        hash = hashCombine(hash, static_cast<uint64_t>(mtime));
+    }
+    return hash;
+}
+
+bool AssetCatalog::isCurrent(const AssetRecord& record) const
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if (!BakedMesh::getSourceStamp(record.path, size, mtime) ||
+        size != record.source_size || mtime != record.source_mtime)
+    {
+        return false;
+    }
+    return record.dependencies.empty() || hashDependencies(record.dependencies) == record.dependency_hash;
+}
+
+bool AssetCatalog::read(const std::string& filename, std::string& error)
+{
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        error = "cannot open";
+        return false;
+    }
+
+    const size_t size = file.size();
+    if (size < sizeof(AssetCatalogHeader))
+    {
+        error = "file too small";
+        return false;
+    }
+
+    AssetCatalogHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+
+    if (header.magic != ASSET_CATALOG_MAGIC)
+    {
+        error = "not an asset catalog";
+        return false;
+    }
+    if (header.version != ASSET_CATALOG_VERSION)
+    {
+        error = "version " + std::to_string(header.version) + ", expected " + std::to_string(ASSET_CATALOG_VERSION);
+        return false;
+    }
+    if (header.file_size != size)
+    {
+        error = "truncated";
+        return false;
+    }
+    if (!sectionFits(header.record_offset, header.record_count, sizeof(AssetCatalogRecord), size) ||
+        !sectionFits(header.name_offset, header.name_count, sizeof(uint32_t), size) ||
+        !sectionFits(header.string_table_offset, header.string_table_size, 1, size))
+    {
+        error = "section out of bounds";
+        return false;
+    }
+    if (hashBytes(file.data() + sizeof(AssetCatalogHeader), size - sizeof(AssetCatalogHeader)) != header.content_hash)
+    {
+        error = "content hash mismatch";
+        return false;
+    }
+
+    const char* string_table = reinterpret_cast<const char*>(file.data() + header.string_table_offset);
+    auto readString = [&](uint32_t offset, std::string& value) {
+        if (offset >= header.string_table_size)
+        {
+            return false;
+        }
+        const void* terminator = memchr(string_table + offset, '\0', header.string_table_size - offset);
+        if (!terminator)
+        {
+            return false;
+        }
+        value.assign(string_table + offset, static_cast<const char*>(terminator));
+        return true;
+    };
+
+    auto readList = [&](const AssetCatalogList& list, std::vector<std::string>& values) {
+        if (list.first > header.name_count || list.count > header.name_count - list.first)
+        {
+            return false;
+        }
+        values.resize(list.count);
+        for (uint32_t i = 0; i < list.count; ++i)
+        {
+            uint32_t offset;
+            memcpy(&offset, file.data() + header.name_offset + (size_t(list.first) + i) * sizeof(uint32_t), sizeof(offset));
+            if (!readString(offset, values[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    records.reserve(header.record_count);
+    for (uint32_t i = 0; i < header.record_count; ++i)
+    {
+        AssetCatalogRecord disk;
+        memcpy(&disk, file.data() + header.record_offset + size_t(i) * sizeof(AssetCatalogRecord), sizeof(disk));
+
+        AssetRecord record;
+        if (!readString(disk.path, record.path) ||
+            !readList(disk.mesh_names, record.mesh_names) ||
+            !readList(disk.material_names, record.material_names) ||
+            !readList(disk.texture_uris, record.texture_uris) ||
+            !readList(disk.dependencies, record.dependencies))
+        {
+            error = "bad string reference in record " + std::to_string(i);
+            return false;
+        }
+
+        record.kind = disk.kind <= static_cast<uint32_t>(AssetKind::Texture) ? static_cast<AssetKind>(disk.kind)
+                                                                             : AssetKind::Unknown;
+        record.source_size = disk.source_size;
+        record.source_mtime = disk.source_mtime;
+        record.content_hash = disk.content_hash;
+        record.dependency_hash = disk.dependency_hash;
+        record.valid = (disk.flags & ASSET_RECORD_VALID) != 0;
+        record.has_bounds = (disk.flags & ASSET_RECORD_HAS_BOUNDS) != 0;
+        record.vertex_count = disk.vertex_count;
+        record.index_count = disk.index_count;
+        record.width = static_cast<int>(disk.width);
+        record.height = static_cast<int>(disk.height);
+        record.channels = static_cast<int>(disk.channels);
+        memcpy(record.bounds_min, disk.bounds_min, sizeof(record.bounds_min));
+        memcpy(record.bounds_max, disk.bounds_max, sizeof(record.bounds_max));
+
+        std::string key = record.path;
+        records[key] = std::move(record);
+    }
+
+    return true;
+}
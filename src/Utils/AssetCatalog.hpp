@@ -0,0 +1,177 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+// .gcat layout (little-endian):
+//
+//   AssetCatalogHeader
+//   records        AssetCatalogRecord[record_count]
+//   name lists     uint32_t[name_count]     string table offsets, sliced by the records
+//   string table   null terminated
+//
+// One record per source asset: its size, write time and content hash, a
+// hash of the size and write time of every file it depends on, and the
+// metadata the engine otherwise parses the source for (vertex and index
+// counts, bounds, mesh, material and texture names, image size). The file is
+// read once into a hash map, so lookups are O(1) and never touch the source.
+constexpr uint32_t ASSET_CATALOG_MAGIC = 0x54414347; // "GCAT"
+constexpr uint32_t ASSET_CATALOG_VERSION = 1;
+
+enum class AssetKind : uint32_t
+{
+    Unknown,
+    Obj,
+    Gltf,
+    Glb,
+    BakedMesh,
+    Texture
+};
+
+struct AssetCatalogList
+{
+    uint32_t first;
+    uint32_t count;
+};
+
+struct AssetCatalogHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t file_size;
+    uint64_t content_hash;      // Everything after the header
+
+    uint32_t record_count;
+    uint32_t name_count;
+    uint32_t string_table_size;
+    uint32_t reserved;
+
+    uint64_t record_offset;
+    uint64_t name_offset;
+    uint64_t string_table_offset;
+};
+static_assert(sizeof(AssetCatalogHeader) == 64, "AssetCatalogHeader layout changed");
+
+struct AssetCatalogRecord
+{
+    uint32_t path;              // String table offset
+    uint32_t kind;              // AssetKind
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t content_hash;
+    uint64_t dependency_hash;
+
+    uint32_t flags;             // ASSET_RECORD_*
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+
+    float bounds_min[3];
+    float bounds_max[3];
+
+    AssetCatalogList mesh_names;
+    AssetCatalogList material_names;
+    AssetCatalogList texture_uris;
+    AssetCatalogList dependencies;
+    uint32_t reserved[2];
+};
+static_assert(sizeof(AssetCatalogRecord) == 128, "AssetCatalogRecord layout changed");
+
+constexpr uint32_t ASSET_RECORD_VALID = 1;          // The engine's loader accepts the file
+constexpr uint32_t ASSET_RECORD_HAS_BOUNDS = 2;
+
+// Metadata of one indexed asset
+struct AssetRecord
+{
+    std::string path;
+    AssetKind kind = AssetKind::Unknown;
+    uint64_t source_size = 0;
+    int64_t source_mtime = 0;
+    uint64_t content_hash = 0;
+    uint64_t dependency_hash = 0;
+
+    bool valid = false;
+    bool has_bounds = false;
+
+    // Meshes: vertices the loader produces (what mesh::get_model_vertex_count
+    // reports) and indices stored in the source (0 for OBJ)
+    size_t vertex_count = 0;
+    size_t index_count = 0;
+    float bounds_min[3] = { 0.0f, 0.0f, 0.0f };
+    float bounds_max[3] = { 0.0f, 0.0f, 0.0f };
+
+    // Textures
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+
+    std::vector<std::string> mesh_names;        // glTF meshes, unnamed ones as ""
+    std::vector<std::string> material_names;    // glTF materials, OBJ usemtl, baked submeshes
+    std::vector<std::string> texture_uris;      // glTF images, embedded ones as ""
+    std::vector<std::string> dependencies;      // Other files read when loading (buffers, images, mtllib)
+
+    bool isGltf() const { return kind == AssetKind::Gltf || kind == AssetKind::Glb; }
+};
+
+// Process-wide index of asset metadata. open() reads a catalog from disk;
+// update() and scan() re-index only the sources whose size, write time or
+// dependencies changed since they were recorded, and save() writes the
+// catalog back when anything did. Metadata queries go through
+// findCurrent(), which costs a few stat calls instead of a parse.
+//
+// Not thread-safe: build and query it from one thread.
+class AssetCatalog
+{
+public:
+    static AssetCatalog& get();
+
+    // Read filename if it exists and remember it for save()
+    bool open(const std::string& filename);
+    bool save();
+    bool save(const std::string& filename);
+    void clear();
+
+    // Record for path, without checking the source (nullptr if not indexed)
+    const AssetRecord* find(const std::string& path) const;
+
+    // Record for path, or nullptr if it is missing or the source (or one of
+    // its dependencies) changed since it was indexed
+    const AssetRecord* findCurrent(const std::string& path) const;
+
+    // Re-index path if its record is missing or out of date
+    const AssetRecord* update(const std::string& path);
+
+    // update() every asset under directory and drop records of files that no
+    // longer exist there. Returns how many assets were (re-)indexed.
+    size_t scan(const std::string& directory);
+
+    void remove(const std::string& path);
+
+    size_t getRecordCount() const { return records.size(); }
+    bool isOpen() const { return !catalog_path.empty(); }
+    bool isDirty() const { return dirty; }
+
+    // Read metadata straight from the source file
+    static bool indexAsset(const std::string& path, AssetRecord& record, std::string& error);
+
+    // Utility
+    static AssetKind detectKind(const std::string& path);
+    static std::string makeKey(const std::string& path);
+    static uint64_t hashDependencies(const std::vector<std::string>& dependencies);
+
+private:
+    std::unordered_map<std::string, AssetRecord> records;
+    std::string catalog_path;
+    bool dirty = false;
+
+    AssetCatalog() = default;
+    AssetCatalog(const AssetCatalog&) = delete;
+    AssetCatalog& operator=(const AssetCatalog&) = delete;
+
+    bool read(const std::string& filename, std::string& error);
+    bool isCurrent(const AssetRecord& record) const;
+};
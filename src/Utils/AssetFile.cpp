@@ -0,0 +1,147 @@
+#include "AssetFile.hpp"
+#include "AssetArchive.hpp"
+#include "MappedFile.hpp"
+#include <stdio.h>
+#include <filesystem>
+
+bool AssetFile::open(const std::string& filename)
+{
+    close();
+    return AssetFileSystem::get().open(filename, *this);
+}
+
+void AssetFile::close()
+{
+    storage.reset();
+    bytes = nullptr;
+    byte_count = 0;
+    archived = false;
+}
+
+AssetFileSystem& AssetFileSystem::get()
+{
+    static AssetFileSystem instance;
+    return instance;
+}
+
+bool AssetFileSystem::mount(const std::string& archive_filename)
+{
+    std::string error;
+    std::shared_ptr<AssetArchive> archive = AssetArchive::open(archive_filename, &error);
+    if (!archive)
+    {
+        fprintf(stderr, "[Asset File System] %s\n", error.c_str());
+        return false;
+    }
+
+    printf("[Asset File System] Mounted %s (%zu entries)\n", archive_filename.c_str(), archive->getEntryCount());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    archives.insert(archives.begin(), std::move(archive));
+    return true;
+}
+
+void AssetFileSystem::unmountAll()
+{
+    // Files already opened from an archive keep it mapped until they close
+    std::lock_guard<std::mutex> lock(mutex);
+    archives.clear();
+}
+
+bool AssetFileSystem::exists(const std::string& path) const
+{
+    uint64_t size;
+    int64_t mtime;
+    return stat(path, size, mtime);
+}
+
+bool AssetFileSystem::open(const std::string& path, AssetFile& file) const
+{
+    file.close();
+
+    const std::string normalized = normalizePath(path);
+    for (const std::shared_ptr<AssetArchive>& archive : getArchives())
+    {
+        const AssetArchiveEntry* entry = archive->find(normalized);
+        if (!entry)
+        {
+            continue;
+        }
+
+        if (const unsigned char* stored = archive->getStoredData(*entry))
+        {
+            file.storage = archive;
+            file.bytes = stored;
+        }
+        else
+        {
+            std::shared_ptr<unsigned char[]> buffer(new unsigned char[entry->size]);
+            if (!archive->extract(*entry, buffer.get()))
+            {
+                return false;
+            }
+            file.bytes = buffer.get();
+            file.storage = std::move(buffer);
+        }
+        file.byte_count = static_cast<size_t>(entry->size);
+        file.archived = true;
+        return true;
+    }
+
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->open(path))
+    {
+        return false;
+    }
+    file.bytes = mapping->data();
+    file.byte_count = mapping->size();
+    file.storage = std::move(mapping);
+    return true;
+}
+
+bool AssetFileSystem::stat(const std::string& path, uint64_t& size, int64_t& mtime) const
+{
+    const std::string normalized = normalizePath(path);
+    for (const std::shared_ptr<AssetArchive>& archive : getArchives())
+    {
+        if (const AssetArchiveEntry* entry = archive->find(normalized))
+        {
+            size = entry->size;
+            mtime = static_cast<int64_t>(entry->content_hash);
+            return true;
+        }
+    }
+
+    std::error_code ec;
+    uintmax_t file_size = std::filesystem::file_size(path, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    auto write_time = std::filesystem::last_write_time(path, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    size = static_cast<uint64_t>(file_size);
+    mtime = static_cast<int64_t>(write_time.time_since_epoch().count());
+    return true;
+}
+
+std::string AssetFileSystem::normalizePath(const std::string& path)
+{
+    std::string normalized = std::filesystem::path(path).lexically_normal().generic_string();
+    while (normalized.compare(0, 2, "./") == 0)
+    {
+        normalized.erase(0, 2);
+    }
+    return normalized;
+}
+
+std::vector<std::shared_ptr<AssetArchive>> AssetFileSystem::getArchives() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return archives;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+class AssetArchive;
+
+// Read-only view of an asset, wherever it lives: a stored archive entry is
+// used in place from the archive mapping, a compressed one is decompressed
+// into memory, and anything not in a mounted archive is mapped from disk.
+// Same interface as MappedFile, but copies share the data.
+class AssetFile
+{
+public:
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const { return storage != nullptr; }
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return byte_count; }
+
+    // True if the data came out of an archive rather than a loose file
+    bool isArchived() const { return archived; }
+
+private:
+    friend class AssetFileSystem;
+
+    std::shared_ptr<const void> storage;    // Keeps the mapping or buffer alive
+    const unsigned char* bytes = nullptr;
+    size_t byte_count = 0;
+    bool archived = false;
+};
+
+// Process-wide lookup of asset paths. Mounted archives are searched first,
+// most recently mounted first, then the path is tried as a loose file. A path
+// found in an archive costs a hash lookup and no system call, which is what
+// makes cold starts from slow disks fast; loose files keep working for
+// anything that isn't packed.
+class AssetFileSystem
+{
+public:
+    static AssetFileSystem& get();
+
+    bool mount(const std::string& archive_filename);
+    void unmountAll();
+
+    bool exists(const std::string& path) const;
+    bool open(const std::string& path, AssetFile& file) const;
+
+    // Size and a change stamp for cache validation: the write time of loose
+    // files, the content hash of archived ones, so caches packed next to
+    // their source stay valid however often the archive is rebuilt.
+    bool stat(const std::string& path, uint64_t& size, int64_t& mtime) const;
+
+    // Archive form of a path: relative, '/' separated, without "." or ".." parts
+    static std::string normalizePath(const std::string& path);
+
+private:
+    AssetFileSystem() = default;
+
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<AssetArchive>> archives;
+
+    std::vector<std::shared_ptr<AssetArchive>> getArchives() const;
+};
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <stddef.h>
+
+template <typename T>
+class AssetTask;
+
+// Hands control back to whoever awaited the task once its body has finished
+struct AssetTaskFinalAwaiter
+{
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept
+    {
+        std::coroutine_handle<> continuation = finished.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct AssetTaskPromiseBase
+{
+    std::coroutine_handle<> continuation;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    AssetTaskFinalAwaiter final_suspend() const noexcept { return {}; }
+
+    // Loaders report failures through their results, never by throwing
+    void unhandled_exception() const noexcept { std::terminate(); }
+};
+
+template <typename T>
+struct AssetTaskPromise : AssetTaskPromiseBase
+{
+    std::optional<T> value;
+
+    AssetTask<T> get_return_object() noexcept;
+    void return_value(T result) { value = std::move(result); }
+    T takeResult() { return std::move(*value); }
+};
+
+template <>
+struct AssetTaskPromise<void> : AssetTaskPromiseBase
+{
+    AssetTask<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+    void takeResult() const noexcept {}
+};
+
+// Result of a coroutine that loads something. Tasks are lazy: the body only
+// starts once the task is awaited (or handed to AssetLoader::start()), and
+// the awaiting coroutine continues on whichever thread the body finished on.
+// The task owns the coroutine frame, so dropping an unfinished task cancels
+// it; a task may only be awaited once.
+template <typename T>
+class AssetTask
+{
+public:
+    using promise_type = AssetTaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    AssetTask() = default;
+    explicit AssetTask(Handle handle) : handle(handle) {}
+    AssetTask(AssetTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    ~AssetTask() { reset(); }
+
+    AssetTask& operator=(AssetTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    AssetTask(const AssetTask&) = delete;
+    AssetTask& operator=(const AssetTask&) = delete;
+
+    bool isValid() const { return static_cast<bool>(handle); }
+    bool isDone() const { return !handle || handle.done(); }
+
+    bool await_ready() const noexcept { return isDone(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() { return handle.promise().takeResult(); }
+
+    // Awaitable that runs the task but leaves the result in it (see whenAll)
+    auto completion() noexcept
+    {
+        struct CompletionAwaiter
+        {
+            Handle handle;
+
+            bool await_ready() const noexcept { return handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return CompletionAwaiter{ handle };
+    }
+
+    // Result of a finished task, moved out
+    T takeResult() { return handle.promise().takeResult(); }
+
+    // Run the body up to its first suspension without anyone awaiting it
+    void start()
+    {
+        // The body may move this task (e.g. into a growing vector) while it runs
+        Handle started = handle;
+        started.resume();
+    }
+
+private:
+    Handle handle;
+
+    void reset()
+    {
+        if (handle)
+        {
+            handle.destroy();
+            handle = nullptr;
+        }
+    }
+};
+
+template <typename T>
+AssetTask<T> AssetTaskPromise<T>::get_return_object() noexcept
+{
+    return AssetTask<T>(AssetTask<T>::Handle::from_promise(*this));
+}
+
+inline AssetTask<void> AssetTaskPromise<void>::get_return_object() noexcept
+{
+    return AssetTask<void>(AssetTask<void>::Handle::from_promise(*this));
+}
+
+// Shared by the children of one whenAll(): the last one to finish resumes it
+struct AssetTaskJoin
+{
+    std::atomic<size_t> remaining{0};
+    std::coroutine_handle<> awaiting;
+};
+
+// Coroutine that runs one child of whenAll() and counts it off. It stays
+// suspended at the end until its owner, the whenAll() frame, frees it, so
+// destroying an unfinished whenAll() frees the drivers with the children.
+class AssetTaskDriver
+{
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    // Counts the driver off once it is suspended for good; the last one
+    // hands over to the whenAll() straight away
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(Handle finished) noexcept
+        {
+            // Once the count drops the whenAll() may finish and free the join
+            AssetTaskJoin& join = *finished.promise().join;
+            std::coroutine_handle<> awaiting = join.awaiting;
+            return join.remaining.fetch_sub(1) == 1 ? awaiting : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type
+    {
+        AssetTaskJoin* join = nullptr;
+
+        AssetTaskDriver get_return_object() noexcept { return AssetTaskDriver(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    explicit AssetTaskDriver(Handle handle) : handle(handle) {}
+    AssetTaskDriver(AssetTaskDriver&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    ~AssetTaskDriver()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    AssetTaskDriver(const AssetTaskDriver&) = delete;
+    AssetTaskDriver& operator=(const AssetTaskDriver&) = delete;
+    AssetTaskDriver& operator=(AssetTaskDriver&&) = delete;
+
+    void start(AssetTaskJoin& join)
+    {
+        handle.promise().join = &join;
+        handle.resume();
+    }
+
+private:
+    Handle handle;
+};
+
+template <typename T>
+AssetTaskDriver driveAssetTask(AssetTask<T>& task)
+{
+    co_await task.completion();
+}
+
+template <typename T>
+struct AssetTaskJoinAwaiter
+{
+    std::vector<AssetTask<T>>& tasks;
+    std::vector<AssetTaskDriver> drivers;
+    AssetTaskJoin join;
+
+    explicit AssetTaskJoinAwaiter(std::vector<AssetTask<T>>& tasks) : tasks(tasks) {}
+
+    bool await_ready() const noexcept { return tasks.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        drivers.reserve(tasks.size());
+        for (AssetTask<T>& task : tasks)
+        {
+            drivers.push_back(driveAssetTask(task));
+        }
+
+        // One extra count for this function, so no child can resume the
+        // awaiting coroutine before every child has been started
+        join.awaiting = awaiting;
+        join.remaining = tasks.size() + 1;
+        for (AssetTaskDriver& driver : drivers)
+        {
+            driver.start(join);
+        }
+
+        // If every child finished while being started, carry on right here
+        return join.remaining.fetch_sub(1) != 1;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+// Run all tasks concurrently; resumes once the last one has finished, with
+// the results in the order of the tasks
+template <typename T>
+AssetTask<std::vector<T>> whenAll(std::vector<AssetTask<T>> tasks)
+{
+    co_await AssetTaskJoinAwaiter<T>{ tasks };
+
+    std::vector<T> results;
+    results.reserve(tasks.size());
+    for (AssetTask<T>& task : tasks)
+    {
+        results.push_back(task.takeResult());
+    }
+    co_return results;
+}
+
+inline AssetTask<void> whenAll(std::vector<AssetTask<void>> tasks)
+{
+    co_await AssetTaskJoinAwaiter<void>{ tasks };
+}
@@ -0,0 +1,350 @@
+#include "BakedMesh.hpp"
+#include "Hash.hpp"
+#include "AssetFile.hpp"
+#include "ObjLoader.hpp"
+#include "GltfLoader.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <cfloat>
+#include <filesystem>
+
+namespace
+{
+    constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+    uint64_t alignSection(uint64_t offset)
+    {
+        return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    bool sectionFits(uint64_t offset, uint64_t count, uint64_t element_size, uint64_t file_size)
+    {
+        if (offset % SECTION_ALIGNMENT != 0 || offset > file_size)
+        {
+            return false;
+        }
+        return count <= (file_size - offset) / element_size;
+    }
+}
+
+std::shared_ptr<BakedMesh> BakedMesh::open(const std::string& filename, std::string* error, bool verify_contents)
+{
+    std::string message;
+    std::shared_ptr<BakedMesh> baked(new BakedMesh());
+
+    if (!baked->file.open(filename))
+    {
+        message = "Cannot open baked mesh: " + filename;
+    }
+    else if (!baked->validate(verify_contents, message))
+    {
+        message = filename + ": " + message;
+    }
+    else
+    {
+        const unsigned char* base = baked->file.data();
+        baked->header = reinterpret_cast<const BakedMeshHeader*>(base);
+        baked->vertices = reinterpret_cast<const vertex*>(base + baked->header->vertex_offset);
+        baked->indices = reinterpret_cast<const uint32_t*>(base + baked->header->index_offset);
+        baked->submeshes = reinterpret_cast<const BakedSubmesh*>(base + baked->header->submesh_offset);
+        baked->string_table = reinterpret_cast<const char*>(base + baked->header->string_table_offset);
+        return baked;
+    }
+
+    if (error)
+    {
+        *error = message;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<BakedMesh> BakedMesh::openIfCurrent(const std::string& source_path, uint64_t config_hash)
+{
+    // Cooked builds ship the cache without its source; the cache is all there is then
+    uint64_t source_size = 0;
+    int64_t source_mtime = 0;
+    const bool has_source = getSourceStamp(source_path, source_size, source_mtime);
+
+    std::string cache_path = getCachePath(source_path);
+    if (!AssetFileSystem::get().exists(cache_path))
+    {
+        return nullptr;
+    }
+
+    std::string error;
+    std::shared_ptr<BakedMesh> baked = open(cache_path, &error);
+    if (!baked)
+    {
+        printf("[Baked Mesh] Discarding cache: %s\n", error.c_str());
+        return nullptr;
+    }
+
+    const BakedMeshHeader& header = baked->getHeader();
+    const bool cooked = (header.flags & BAKED_MESH_COOKED) != 0 && baked->file.isArchived();
+    const bool source_changed = has_source &&
+        (header.source_size != source_size || (!cooked && header.source_mtime != source_mtime));
+    if (header.config_hash != config_hash || source_changed)
+    {
+        printf("[Baked Mesh] Cache out of date: %s\n", cache_path.c_str());
+        return nullptr;
+    }
+
+    return baked;
+}
+
+bool BakedMesh::bake(const std::string& source_path, uint64_t config_hash,
+                     const vertex* vertices, size_t vertex_count,
+                     const std::vector<BakedSubmeshSource>& submeshes,
+                     const std::vector<uint32_t>& indices)
+{
+    BakedMeshHeader stamp = {};
+    stamp.config_hash = config_hash;
+    if (!getSourceStamp(source_path, stamp.source_size, stamp.source_mtime))
+    {
+        return false;
+    }
+
+    std::string cache_path = getCachePath(source_path);
+    std::string error;
+    if (!write(cache_path, stamp, vertices, vertex_count, indices, submeshes, error))
+    {
+        printf("[Baked Mesh ERROR] %s\n", error.c_str());
+        return false;
+    }
+
+    printf("[Baked Mesh] Wrote %s (%zu vertices)\n", cache_path.c_str(), vertex_count);
+    return true;
+}
+
+bool BakedMesh::write(const std::string& filename, const BakedMeshHeader& stamp,
+                      const vertex* vertices, size_t vertex_count,
+                      const std::vector<uint32_t>& indices,
+                      const std::vector<BakedSubmeshSource>& submeshes,
+                      std::string& error)
+{
+    if (!vertices || vertex_count == 0 || vertex_count > UINT32_MAX || indices.size() > UINT32_MAX)
+    {
+        error = "Nothing to bake for " + filename;
+        return false;
+    }
+
+    // String table: one entry per distinct material name
+    std::string string_table;
+    std::vector<uint32_t> name_offsets;
+    for (const auto& submesh : submeshes)
+    {
+        if (submesh.material_name.empty())
+        {
+            name_offsets.push_back(BAKED_MESH_NO_NAME);
+            continue;
+        }
+
+        size_t found = string_table.find(submesh.material_name + '\0');
+        bool at_entry_start = (found == 0) || (found != std::string::npos && string_table[found - 1] == '\0');
+        if (found != std::string::npos && at_entry_start)
+        {
+            name_offsets.push_back(static_cast<uint32_t>(found));
+        }
+        else
+        {
+            name_offsets.push_back(static_cast<uint32_t>(string_table.size()));
+            string_table += submesh.material_name;
+            string_table += '\0';
+        }
+    }
+
+    BakedMeshHeader header = stamp;
+    header.magic = BAKED_MESH_MAGIC;
+    header.version = BAKED_MESH_VERSION;
+    header.vertex_count = static_cast<uint32_t>(vertex_count);
+    header.index_count = static_cast<uint32_t>(indices.size());
+    header.submesh_count = static_cast<uint32_t>(submeshes.size());
+    header.string_table_size = static_cast<uint32_t>(string_table.size());
+
+    header.vertex_offset = alignSection(sizeof(BakedMeshHeader));
+    header.index_offset = alignSection(header.vertex_offset + vertex_count * sizeof(vertex));
+    header.submesh_offset = alignSection(header.index_offset + indices.size() * sizeof(uint32_t));
+    header.string_table_offset = alignSection(header.submesh_offset + submeshes.size() * sizeof(BakedSubmesh));
+    header.file_size = header.string_table_offset + string_table.size();
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        header.bounds_min[axis] = FLT_MAX;
+        header.bounds_max[axis] = -FLT_MAX;
+    }
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        const float position[3] = { vertices[i].vx, vertices[i].vy, vertices[i].vz };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (position[axis] < header.bounds_min[axis]) header.bounds_min[axis] = position[axis];
+            if (position[axis] > header.bounds_max[axis]) header.bounds_max[axis] = position[axis];
+        }
+    }
+
+    std::vector<unsigned char> image(header.file_size, 0);
+    memcpy(image.data() + header.vertex_offset, vertices, vertex_count * sizeof(vertex));
+    if (!indices.empty())
+    {
+        memcpy(image.data() + header.index_offset, indices.data(), indices.size() * sizeof(uint32_t));
+    }
+    for (size_t i = 0; i < submeshes.size(); ++i)
+    {
+        BakedSubmesh baked_submesh;
+        baked_submesh.first = submeshes[i].first;
+        baked_submesh.count = submeshes[i].count;
+        baked_submesh.material_index = submeshes[i].material_index;
+        baked_submesh.material_name = name_offsets[i];
+        memcpy(image.data() + header.submesh_offset + i * sizeof(BakedSubmesh), &baked_submesh, sizeof(BakedSubmesh));
+    }
+    if (!string_table.empty())
+    {
+        memcpy(image.data() + header.string_table_offset, string_table.data(), string_table.size());
+    }
+
+    header.vertex_hash = hashBytes(vertices, vertex_count * sizeof(vertex));
+    header.content_hash = hashBytes(image.data() + sizeof(BakedMeshHeader), image.size() - sizeof(BakedMeshHeader));
+    memcpy(image.data(), &header, sizeof(BakedMeshHeader));
+
+    // Write to a temporary file and rename, so a crash never leaves a half-written cache
+    std::string temp_path = filename + ".tmp";
+    FILE* file = fopen(temp_path.c_str(), "wb");
+    if (!file)
+    {
+        error = "Cannot write " + temp_path;
+        return false;
+    }
+
+    size_t written = fwrite(image.data(), 1, image.size(), file);
+    fclose(file);
+
+    std::error_code ec;
+    if (written != image.size())
+    {
+        std::filesystem::remove(temp_path, ec);
+        error = "Short write to " + temp_path;
+        return false;
+    }
+
+    std::filesystem::rename(temp_path, filename, ec);
+    if (ec)
+    {
+        // The old cache may still be mapped by a live mesh (Windows won't replace it)
+        std::filesystem::remove(temp_path, ec);
+        error = "Cannot replace " + filename;
+        return false;
+    }
+
+    return true;
+}
+
+std::string BakedMesh::getCachePath(const std::string& source_path)
+{
+    return source_path + ".gmesh";
+}
+
+bool BakedMesh::getSourceStamp(const std::string& source_path, uint64_t& size, int64_t& mtime)
+{
+    return AssetFileSystem::get().stat(source_path, size, mtime);
+}
+
+uint64_t BakedMesh::hashConfig(const ObjLoaderConfig& config)
+{
+    // Only settings that change the produced geometry belong here
+    uint64_t hash = hashCombine(HASH_SEED, BAKED_MESH_VERSION);
+    hash = hashCombine(hash, hashString("obj"));
+    hash = hashCombine(hash, config.triangulate);
+    hash = hashCombine(hash, config.validate_normals);
+    hash = hashCombine(hash, config.validate_texcoords);
+    return hash;
+}
+
+uint64_t BakedMesh::hashConfig(const GltfLoaderConfig& config)
+{
+    // Unlike the OBJ loader's, glTF validation only reports bad vertices
+    uint64_t scale_bits = 0;
+    memcpy(&scale_bits, &config.scale, sizeof(config.scale));
+
+    uint64_t hash = hashCombine(HASH_SEED, BAKED_MESH_VERSION);
+    hash = hashCombine(hash, hashString("gltf"));
+    hash = hashCombine(hash, config.generate_normals_if_missing);
+    hash = hashCombine(hash, config.generate_texcoords_if_missing);
+    hash = hashCombine(hash, config.flip_uvs);
+    hash = hashCombine(hash, config.triangulate);
+    hash = hashCombine(hash, scale_bits);
+    hash = hashCombine(hash, config.preserve_hierarchy);
+    return hash;
+}
+
+const char* BakedMesh::getMaterialName(const BakedSubmesh& submesh) const
+{
+    if (submesh.material_name == BAKED_MESH_NO_NAME || submesh.material_name >= header->string_table_size)
+    {
+        return "";
+    }
+    return string_table + submesh.material_name;
+}
+
+bool BakedMesh::validate(bool verify_contents, std::string& error) const
+{
+    const size_t size = file.size();
+    if (size < sizeof(BakedMeshHeader))
+    {
+        error = "file too small";
+        return false;
+    }
+
+    BakedMeshHeader h;
+    memcpy(&h, file.data(), sizeof(h));
+
+    if (h.magic != BAKED_MESH_MAGIC)
+    {
+        error = "not a baked mesh";
+        return false;
+    }
+    if (h.version != BAKED_MESH_VERSION)
+    {
+        error = "version " + std::to_string(h.version) + ", expected " + std::to_string(BAKED_MESH_VERSION);
+        return false;
+    }
+    if (h.file_size != size)
+    {
+        error = "truncated";
+        return false;
+    }
+
+    if (!sectionFits(h.vertex_offset, h.vertex_count, sizeof(vertex), size) ||
+        !sectionFits(h.index_offset, h.index_count, sizeof(uint32_t), size) ||
+        !sectionFits(h.submesh_offset, h.submesh_count, sizeof(BakedSubmesh), size) ||
+        !sectionFits(h.string_table_offset, h.string_table_size, 1, size))
+    {
+        error = "section out of range";
+        return false;
+    }
+
+    if (h.string_table_size > 0 && file.data()[h.string_table_offset + h.string_table_size - 1] != '\0')
+    {
+        error = "unterminated string table";
+        return false;
+    }
+
+    if (verify_contents && hashBytes(file.data() + sizeof(BakedMeshHeader), size - sizeof(BakedMeshHeader)) != h.content_hash)
+    {
+        error = "content hash mismatch";
+        return false;
+    }
+
+    // Submesh ranges must stay inside the stream they index
+    const BakedSubmesh* ranges = reinterpret_cast<const BakedSubmesh*>(file.data() + h.submesh_offset);
+    const uint64_t limit = h.index_count > 0 ? h.index_count : h.vertex_count;
+    for (uint32_t i = 0; i < h.submesh_count; ++i)
+    {
+        if ((uint64_t)ranges[i].first + ranges[i].count > limit)
+        {
+            error = "submesh out of range";
+            return false;
+        }
+    }
+
+    return true;
+}
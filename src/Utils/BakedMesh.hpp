@@ -0,0 +1,133 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "Vertex.hpp"
+#include "AssetFile.hpp"
+
+struct ObjLoaderConfig;
+struct GltfLoaderConfig;
+
+// .gmesh layout (little-endian, every section starts on a 16 byte boundary):
+//
+//   BakedMeshHeader
+//   vertex stream     vertex[vertex_count]         drawn in place from the mapping
+//   index stream      uint32_t[index_count]        empty for triangle-soup meshes
+//   submeshes         BakedSubmesh[submesh_count]  vertex (or index) ranges
+//   string table      material names, null terminated
+//
+// The header records the source file's size and write time plus a hash of the
+// loader settings, so a cache next to its source is rebuilt as soon as either
+// changes. content_hash covers everything after the header; only garden-cook
+// checks it, opening a cache only checks that the sections are in range.
+// vertex_hash is what MeshAssetManager finds identical vertex streams by.
+constexpr uint32_t BAKED_MESH_MAGIC = 0x48534D47; // "GMSH"
+constexpr uint32_t BAKED_MESH_VERSION = 4;     // 2: config hash covers the OBJ validation flags, 3: flags, 4: vertex_hash
+constexpr uint32_t BAKED_MESH_NO_NAME = 0xFFFFFFFF;
+
+// BakedMeshHeader::flags
+constexpr uint32_t BAKED_MESH_COOKED = 1;      // Written by garden-cook; source_mtime is the source's content hash
+
+struct BakedMeshHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t file_size;
+    uint64_t content_hash;
+    uint64_t config_hash;
+    uint64_t source_size;
+    int64_t source_mtime;
+
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t submesh_count;
+    uint32_t string_table_size;
+
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    uint64_t submesh_offset;
+    uint64_t string_table_offset;
+
+    float bounds_min[3];
+    float bounds_max[3];
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t vertex_hash;       // hashBytes of the vertex stream
+};
+static_assert(sizeof(BakedMeshHeader) == 136, "BakedMeshHeader layout changed");
+
+struct BakedSubmesh
+{
+    uint32_t first;             // First vertex, or first index when the mesh is indexed
+    uint32_t count;
+    int32_t material_index;     // Material index in the source file, -1 for none
+    uint32_t material_name;     // Offset into the string table, BAKED_MESH_NO_NAME for none
+};
+static_assert(sizeof(BakedSubmesh) == 16, "BakedSubmesh layout changed");
+
+// Submesh description handed to the writer
+struct BakedSubmeshSource
+{
+    uint32_t first = 0;
+    uint32_t count = 0;
+    int material_index = -1;
+    std::string material_name;
+};
+
+// An opened, validated .gmesh. All accessors point straight into the mapping
+// (or the archive entry), so the object has to outlive anything using its
+// vertex data.
+class BakedMesh
+{
+public:
+    // Open a .gmesh file directly (MeshFormat::Baked). verify_contents also
+    // checks content_hash, which reads the whole file.
+    static std::shared_ptr<BakedMesh> open(const std::string& filename, std::string* error = nullptr,
+                                           bool verify_contents = false);
+
+    // Open the cache that belongs to source_path, or nullptr if it is missing or
+    // stale. Without the source (a cooked build) only the settings are checked.
+    // An archived cache from garden-cook is stamped with its source's content
+    // hash, so next to a loose copy of the source only the size is compared;
+    // sources edited in place need another cook.
+    static std::shared_ptr<BakedMesh> openIfCurrent(const std::string& source_path, uint64_t config_hash);
+
+    // Write the cache for source_path from freshly loaded geometry
+    static bool bake(const std::string& source_path, uint64_t config_hash,
+                     const vertex* vertices, size_t vertex_count,
+                     const std::vector<BakedSubmeshSource>& submeshes,
+                     const std::vector<uint32_t>& indices = std::vector<uint32_t>());
+
+    static bool write(const std::string& filename, const BakedMeshHeader& stamp,
+                      const vertex* vertices, size_t vertex_count,
+                      const std::vector<uint32_t>& indices,
+                      const std::vector<BakedSubmeshSource>& submeshes,
+                      std::string& error);
+
+    // Utility
+    static std::string getCachePath(const std::string& source_path);
+    static bool getSourceStamp(const std::string& source_path, uint64_t& size, int64_t& mtime);
+    static uint64_t hashConfig(const ObjLoaderConfig& config);
+    static uint64_t hashConfig(const GltfLoaderConfig& config);
+
+    const BakedMeshHeader& getHeader() const { return *header; }
+    const vertex* getVertices() const { return vertices; }
+    size_t getVertexCount() const { return header->vertex_count; }
+    const uint32_t* getIndices() const { return indices; }
+    size_t getIndexCount() const { return header->index_count; }
+    const BakedSubmesh* getSubmeshes() const { return submeshes; }
+    size_t getSubmeshCount() const { return header->submesh_count; }
+    const char* getMaterialName(const BakedSubmesh& submesh) const;
+
+private:
+    AssetFile file;
+    const BakedMeshHeader* header = nullptr;
+    const vertex* vertices = nullptr;
+    const uint32_t* indices = nullptr;
+    const BakedSubmesh* submeshes = nullptr;
+    const char* string_table = nullptr;
+
+    bool validate(bool verify_contents, std::string& error) const;
+};
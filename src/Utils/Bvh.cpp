@@ -0,0 +1,226 @@
+#include "Bvh.hpp"
+#include <numeric>
+
+static constexpr int SAH_BIN_COUNT = 16;
+static constexpr float SAH_TRAVERSAL_COST = 1.0f;      // Relative to testing one primitive (or batch)
+
+static void growBounds(vector3f& bounds_min, vector3f& bounds_max, const vector3f& point_min, const vector3f& point_max)
+{
+    bounds_min.X = std::min(bounds_min.X, point_min.X);
+    bounds_min.Y = std::min(bounds_min.Y, point_min.Y);
+    bounds_min.Z = std::min(bounds_min.Z, point_min.Z);
+    bounds_max.X = std::max(bounds_max.X, point_max.X);
+    bounds_max.Y = std::max(bounds_max.Y, point_max.Y);
+    bounds_max.Z = std::max(bounds_max.Z, point_max.Z);
+}
+
+// Half the surface area, which is all SAH needs
+static float getArea(const vector3f& bounds_min, const vector3f& bounds_max)
+{
+    vector3f extent = bounds_max - bounds_min;
+    return extent.X * extent.Y + extent.Y * extent.Z + extent.Z * extent.X;
+}
+
+static float getAxis(const vector3f& v, int axis)
+{
+    return axis == 0 ? v.X : (axis == 1 ? v.Y : v.Z);
+}
+
+void Bvh::build(const std::vector<BvhBounds>& primitives, uint32_t leaf_batch)
+{
+    clear();
+    batch_size = std::max(leaf_batch, 1u);
+    if (primitives.empty())
+    {
+        return;
+    }
+
+    order.resize(primitives.size());
+    std::iota(order.begin(), order.end(), 0u);
+
+    std::vector<vector3f> centroids;
+    centroids.reserve(primitives.size());
+    for (const BvhBounds& primitive : primitives)
+    {
+        centroids.push_back((primitive.bounds_min + primitive.bounds_max) * 0.5f);
+    }
+
+    // A binary tree with one primitive per leaf at most has 2n - 1 nodes, so
+    // node references stay valid while the tree grows
+    nodes.reserve(primitives.size() * 2 - 1);
+    BvhNode& root = nodes.emplace_back();
+    root.first = 0;
+    root.count = static_cast<uint32_t>(primitives.size());
+    subdivide(0, primitives, centroids, 0);
+}
+
+void Bvh::clear()
+{
+    nodes.clear();
+    order.clear();
+}
+
+void Bvh::subdivide(uint32_t node_index, const std::vector<BvhBounds>& primitives,
+                    const std::vector<vector3f>& centroids, size_t depth)
+{
+    BvhNode& node = nodes[node_index];
+    const uint32_t first = node.first;
+    const uint32_t count = node.count;
+
+    node.bounds_min = primitives[order[first]].bounds_min;
+    node.bounds_max = primitives[order[first]].bounds_max;
+    vector3f centroid_min = centroids[order[first]];
+    vector3f centroid_max = centroid_min;
+    for (uint32_t i = first + 1; i < first + count; ++i)
+    {
+        growBounds(node.bounds_min, node.bounds_max, primitives[order[i]].bounds_min, primitives[order[i]].bounds_max);
+        growBounds(centroid_min, centroid_max, centroids[order[i]], centroids[order[i]]);
+    }
+
+    if (count == 1 || depth >= MAX_DEPTH)
+    {
+        return;
+    }
+
+    // Bin the centroids along each axis and take the cheapest split between bins
+    struct Bin
+    {
+        vector3f bounds_min;
+        vector3f bounds_max;
+        uint32_t count = 0;
+    };
+
+    float best_cost = 0.0f;
+    int best_axis = -1;
+    int best_split = 0;     // Bins [0, best_split] go left
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float axis_min = getAxis(centroid_min, axis);
+        const float extent = getAxis(centroid_max, axis) - axis_min;
+        if (extent <= 0.0f)
+        {
+            continue;
+        }
+
+        Bin bins[SAH_BIN_COUNT];
+        const float scale = SAH_BIN_COUNT / extent;
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            int bin = std::min(SAH_BIN_COUNT - 1, static_cast<int>((getAxis(centroids[order[i]], axis) - axis_min) * scale));
+            const BvhBounds& primitive = primitives[order[i]];
+            if (bins[bin].count++ == 0)
+            {
+                bins[bin].bounds_min = primitive.bounds_min;
+                bins[bin].bounds_max = primitive.bounds_max;
+            }
+            else
+            {
+                growBounds(bins[bin].bounds_min, bins[bin].bounds_max, primitive.bounds_min, primitive.bounds_max);
+            }
+        }
+
+        // Area times count of everything right of each split, swept from the right
+        float right_cost[SAH_BIN_COUNT];
+        uint32_t right_count = 0;
+        vector3f right_min;
+        vector3f right_max;
+        for (int bin = SAH_BIN_COUNT - 1; bin > 0; --bin)
+        {
+            if (bins[bin].count > 0)
+            {
+                if (right_count == 0)
+                {
+                    right_min = bins[bin].bounds_min;
+                    right_max = bins[bin].bounds_max;
+                }
+                else
+                {
+                    growBounds(right_min, right_max, bins[bin].bounds_min, bins[bin].bounds_max);
+                }
+                right_count += bins[bin].count;
+            }
+            right_cost[bin - 1] = right_count > 0 ? getLeafCost(right_count) * getArea(right_min, right_max) : -1.0f;
+        }
+
+        uint32_t left_count = 0;
+        vector3f left_min;
+        vector3f left_max;
+        for (int split = 0; split < SAH_BIN_COUNT - 1; ++split)
+        {
+            if (bins[split].count > 0)
+            {
+                if (left_count == 0)
+                {
+                    left_min = bins[split].bounds_min;
+                    left_max = bins[split].bounds_max;
+                }
+                else
+                {
+                    growBounds(left_min, left_max, bins[split].bounds_min, bins[split].bounds_max);
+                }
+                left_count += bins[split].count;
+            }
+
+            if (left_count == 0 || right_cost[split] < 0.0f)
+            {
+                continue;
+            }
+
+            float cost = getLeafCost(left_count) * getArea(left_min, left_max) + right_cost[split];
+            if (best_axis < 0 || cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = split;
+            }
+        }
+    }
+
+    // Costs are scaled by the node's area: a leaf tests every primitive (batch), a
+    // split pays for one more box test plus the children weighted by area
+    const float area = getArea(node.bounds_min, node.bounds_max);
+    const bool split_pays = best_axis >= 0 && SAH_TRAVERSAL_COST * area + best_cost < getLeafCost(count) * area;
+    if (!split_pays && count <= MAX_LEAF_SIZE)
+    {
+        return;
+    }
+
+    uint32_t middle;
+    if (best_axis >= 0)
+    {
+        const int axis = best_axis;
+        const float axis_min = getAxis(centroid_min, axis);
+        const float scale = SAH_BIN_COUNT / (getAxis(centroid_max, axis) - axis_min);
+        auto split_point = std::partition(order.begin() + first, order.begin() + first + count, [&](uint32_t primitive)
+        {
+            int bin = std::min(SAH_BIN_COUNT - 1, static_cast<int>((getAxis(centroids[primitive], axis) - axis_min) * scale));
+            return bin <= best_split;
+        });
+        middle = static_cast<uint32_t>(split_point - order.begin());
+    }
+    else
+    {
+        // Every centroid is in the same place; any split shrinks the leaves
+        middle = first + count / 2;
+    }
+
+    if (middle == first || middle == first + count)
+    {
+        middle = first + count / 2;
+    }
+
+    const uint32_t left = static_cast<uint32_t>(nodes.size());
+    BvhNode& left_node = nodes.emplace_back();
+    left_node.first = first;
+    left_node.count = middle - first;
+    BvhNode& right_node = nodes.emplace_back();
+    right_node.first = middle;
+    right_node.count = first + count - middle;
+
+    nodes[node_index].first = left;
+    nodes[node_index].count = 0;
+
+    subdivide(left, primitives, centroids, depth + 1);
+    subdivide(left + 1, primitives, centroids, depth + 1);
+}
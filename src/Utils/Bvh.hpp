@@ -0,0 +1,283 @@
+#pragma once
+
+#include "irrlicht/vector3.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace irr;
+using namespace core;
+
+// 32 bytes, two to a cache line. Interior nodes keep their children next to
+// each other, so one index finds both.
+struct BvhNode
+{
+    vector3f bounds_min;
+    uint32_t first;         // Leaf: first primitive; interior: left child (the right one follows)
+    vector3f bounds_max;
+    uint32_t count;         // Leaf: number of primitives; 0 for interior nodes
+
+    bool isLeaf() const { return count > 0; }
+};
+
+static_assert(sizeof(BvhNode) == 32, "BvhNode layout changed");
+
+struct BvhBounds
+{
+    vector3f bounds_min;
+    vector3f bounds_max;
+};
+
+// Bounding volume hierarchy over axis-aligned boxes, built top-down with
+// binned SAH splits. Leaves refer to primitives by their position in
+// getOrder(): callers either store their primitives in that order (so leaves
+// read consecutive memory) or map positions back through it.
+class Bvh
+{
+public:
+    // leaf_batch: how many primitives the caller tests at once (e.g. with SIMD);
+    // SAH then costs a leaf by its batches, so leaves fill up to that size
+    void build(const std::vector<BvhBounds>& primitives, uint32_t leaf_batch = 1);
+    void clear();
+
+    bool isEmpty() const { return nodes.empty(); }
+    const std::vector<BvhNode>& getNodes() const { return nodes; }
+    const std::vector<uint32_t>& getOrder() const { return order; }    // Input index of each leaf position
+
+    // Call visit(position) for every primitive whose box overlaps [query_min, query_max]
+    template <typename Visitor>
+    void queryBounds(const vector3f& query_min, const vector3f& query_max, Visitor&& visit) const;
+
+    // Call visit(position) for every primitive whose box the ray enters
+    // before max_distance, nearest nodes first. The visitor may shorten
+    // max_distance (e.g. on a hit) to prune the rest of the walk.
+    // direction doesn't need to be normalized; distances are in its units.
+    template <typename Visitor>
+    void queryRay(const vector3f& origin, const vector3f& direction, float& max_distance, Visitor&& visit) const;
+
+    // The same walks, calling visit(node) once per leaf instead of once per
+    // primitive, for callers that test a leaf's primitives together
+    template <typename Visitor>
+    void queryBoundsLeaves(const vector3f& query_min, const vector3f& query_max, Visitor&& visit) const;
+
+    template <typename Visitor>
+    void queryRayLeaves(const vector3f& origin, const vector3f& direction, float& max_distance, Visitor&& visit) const;
+
+    // queryRay for a sphere of the given radius moving along the ray: boxes
+    // are grown by the radius, which covers everything the sphere can touch
+    template <typename Visitor>
+    void querySweep(const vector3f& origin, const vector3f& direction, float radius, float& max_distance, Visitor&& visit) const;
+
+    template <typename Visitor>
+    void querySweepLeaves(const vector3f& origin, const vector3f& direction, float radius, float& max_distance,
+                          Visitor&& visit) const;
+
+    // Entry distance of the ray into a box, or false if it misses before max_distance
+    static bool intersectRay(const vector3f& origin, const vector3f& inverse_direction, float max_distance,
+                             const vector3f& bounds_min, const vector3f& bounds_max, float& entry);
+
+    // Large finite values instead of infinity for (near) zero components,
+    // so the slab test never computes 0 * inf
+    static vector3f getInverseDirection(const vector3f& direction);
+
+private:
+    static constexpr size_t MAX_DEPTH = 60;         // Traversal keeps a fixed stack
+    static constexpr uint32_t MAX_LEAF_SIZE = 8;    // Bigger leaves are split even when SAH disagrees
+
+    std::vector<BvhNode> nodes;
+    std::vector<uint32_t> order;
+    uint32_t batch_size = 1;
+
+    float getLeafCost(uint32_t count) const { return static_cast<float>((count + batch_size - 1) / batch_size); }
+
+    void subdivide(uint32_t node_index, const std::vector<BvhBounds>& primitives,
+                   const std::vector<vector3f>& centroids, size_t depth);
+};
+
+template <typename Visitor>
+void Bvh::queryBounds(const vector3f& query_min, const vector3f& query_max, Visitor&& visit) const
+{
+    queryBoundsLeaves(query_min, query_max, [&](uint32_t leaf)
+    {
+        const BvhNode& node = nodes[leaf];
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            visit(i);
+        }
+    });
+}
+
+template <typename Visitor>
+void Bvh::queryRay(const vector3f& origin, const vector3f& direction, float& max_distance, Visitor&& visit) const
+{
+    queryRayLeaves(origin, direction, max_distance, [&](uint32_t leaf)
+    {
+        const BvhNode& node = nodes[leaf];
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            visit(i);
+        }
+    });
+}
+
+template <typename Visitor>
+void Bvh::queryBoundsLeaves(const vector3f& query_min, const vector3f& query_max, Visitor&& visit) const
+{
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    uint32_t stack[MAX_DEPTH + 4];
+    size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0)
+    {
+        const uint32_t node_index = stack[--stack_size];
+        const BvhNode& node = nodes[node_index];
+        if (node.bounds_min.X > query_max.X || node.bounds_max.X < query_min.X ||
+            node.bounds_min.Y > query_max.Y || node.bounds_max.Y < query_min.Y ||
+            node.bounds_min.Z > query_max.Z || node.bounds_max.Z < query_min.Z)
+        {
+            continue;
+        }
+
+        if (node.isLeaf())
+        {
+            visit(node_index);
+        }
+        else
+        {
+            stack[stack_size++] = node.first + 1;
+            stack[stack_size++] = node.first;
+        }
+    }
+}
+
+template <typename Visitor>
+void Bvh::querySweep(const vector3f& origin, const vector3f& direction, float radius, float& max_distance, Visitor&& visit) const
+{
+    querySweepLeaves(origin, direction, radius, max_distance, [&](uint32_t leaf)
+    {
+        const BvhNode& node = nodes[leaf];
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            visit(i);
+        }
+    });
+}
+
+template <typename Visitor>
+void Bvh::queryRayLeaves(const vector3f& origin, const vector3f& direction, float& max_distance, Visitor&& visit) const
+{
+    querySweepLeaves(origin, direction, 0.0f, max_distance, std::forward<Visitor>(visit));
+}
+
+template <typename Visitor>
+void Bvh::querySweepLeaves(const vector3f& origin, const vector3f& direction, float radius, float& max_distance,
+                           Visitor&& visit) const
+{
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    const vector3f inverse_direction = getInverseDirection(direction);
+    const vector3f grow(radius, radius, radius);
+
+    // Entry distances travel with the nodes, so pushed nodes that end up
+    // beyond a closer hit are dropped without testing their boxes again
+    struct Entry
+    {
+        uint32_t node;
+        float distance;
+    };
+    Entry stack[MAX_DEPTH + 4];
+    size_t stack_size = 0;
+
+    float root_entry;
+    if (!intersectRay(origin, inverse_direction, max_distance, nodes[0].bounds_min - grow, nodes[0].bounds_max + grow, root_entry))
+    {
+        return;
+    }
+    stack[stack_size++] = { 0, root_entry };
+
+    while (stack_size > 0)
+    {
+        const Entry entry = stack[--stack_size];
+        if (entry.distance > max_distance)
+        {
+            continue;
+        }
+
+        const BvhNode& node = nodes[entry.node];
+        if (node.isLeaf())
+        {
+            visit(entry.node);
+            continue;
+        }
+
+        const uint32_t left = node.first;
+        const uint32_t right = node.first + 1;
+        float left_entry;
+        float right_entry;
+        const bool hit_left = intersectRay(origin, inverse_direction, max_distance,
+                                           nodes[left].bounds_min - grow, nodes[left].bounds_max + grow, left_entry);
+        const bool hit_right = intersectRay(origin, inverse_direction, max_distance,
+                                            nodes[right].bounds_min - grow, nodes[right].bounds_max + grow, right_entry);
+
+        // Nearer child on top of the stack
+        if (hit_left && hit_right)
+        {
+            if (left_entry <= right_entry)
+            {
+                stack[stack_size++] = { right, right_entry };
+                stack[stack_size++] = { left, left_entry };
+            }
+            else
+            {
+                stack[stack_size++] = { left, left_entry };
+                stack[stack_size++] = { right, right_entry };
+            }
+        }
+        else if (hit_left)
+        {
+            stack[stack_size++] = { left, left_entry };
+        }
+        else if (hit_right)
+        {
+            stack[stack_size++] = { right, right_entry };
+        }
+    }
+}
+
+inline bool Bvh::intersectRay(const vector3f& origin, const vector3f& inverse_direction, float max_distance,
+                              const vector3f& bounds_min, const vector3f& bounds_max, float& entry)
+{
+    float tx0 = (bounds_min.X - origin.X) * inverse_direction.X;
+    float tx1 = (bounds_max.X - origin.X) * inverse_direction.X;
+    float ty0 = (bounds_min.Y - origin.Y) * inverse_direction.Y;
+    float ty1 = (bounds_max.Y - origin.Y) * inverse_direction.Y;
+    float tz0 = (bounds_min.Z - origin.Z) * inverse_direction.Z;
+    float tz1 = (bounds_max.Z - origin.Z) * inverse_direction.Z;
+
+    float t_min = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+    float t_max = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), max_distance));
+
+    entry = t_min;
+    return t_min <= t_max;
+}
+
+inline vector3f Bvh::getInverseDirection(const vector3f& direction)
+{
+    auto inverse = [](float value)
+    {
+        const float huge = 1e30f;
+        return std::abs(value) > 1.0f / huge ? 1.0f / value : (std::signbit(value) ? -huge : huge);
+    };
+    return vector3f(inverse(direction.X), inverse(direction.Y), inverse(direction.Z));
+}
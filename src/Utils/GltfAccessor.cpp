@@ -0,0 +1,72 @@
+#include "GltfAccessor.hpp"
+#include "GltfDocument.hpp"
+
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#include <tiny_gltf.h>
+
+namespace
+{
+    bool fail(std::string* error, const std::string& message)
+    {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    }
+}
+
+bool GltfAccessorView::create(const GltfDocument& document, int accessor_index,
+    GltfAccessorView& view, std::string* error)
+{
+    view = GltfAccessorView();
+    const tinygltf::Model& model = document.getModel();
+
+    if (accessor_index < 0 || accessor_index >= model.accessors.size()) {
+        return fail(error, "Accessor index out of range: " + std::to_string(accessor_index));
+    }
+
+    const auto& accessor = model.accessors[accessor_index];
+    if (accessor.bufferView < 0 || accessor.bufferView >= model.bufferViews.size()) {
+        return fail(error, "Accessor " + std::to_string(accessor_index) + " has no buffer view");
+    }
+
+    const auto& buffer_view = model.bufferViews[accessor.bufferView];
+    if (buffer_view.buffer < 0 || buffer_view.buffer >= model.buffers.size()) {
+        return fail(error, "Buffer view " + std::to_string(accessor.bufferView) + " has no buffer");
+    }
+
+    size_t buffer_size = 0;
+    const unsigned char* buffer_data = document.getBufferData(buffer_view.buffer, buffer_size);
+
+    int component_size = tinygltf::GetComponentSizeInBytes(static_cast<uint32_t>(accessor.componentType));
+    int components = tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+    int stride = accessor.ByteStride(buffer_view);
+    if (component_size <= 0 || components <= 0 || components > 4 || stride <= 0) {
+        return fail(error, "Accessor " + std::to_string(accessor_index) + " has an unsupported layout");
+    }
+
+    // Every element has to lie inside the buffer view, and the view inside the buffer
+    const size_t element_size = static_cast<size_t>(component_size) * components;
+    const size_t view_end = buffer_view.byteOffset + buffer_view.byteLength;
+    if (view_end > buffer_size || buffer_view.byteOffset > view_end) {
+        return fail(error, "Buffer view " + std::to_string(accessor.bufferView) + " exceeds its buffer");
+    }
+
+    const size_t view_size = buffer_view.byteLength;
+    if (accessor.count > 0) {
+        const size_t last_element = accessor.byteOffset + (accessor.count - 1) * static_cast<size_t>(stride);
+        if (accessor.byteOffset > view_size || (accessor.count - 1) > view_size / stride ||
+            last_element > view_size || element_size > view_size - last_element) {
+            return fail(error, "Accessor " + std::to_string(accessor_index) + " exceeds its buffer view");
+        }
+    }
+
+    // Sparse substitutions are not applied; the base values are read as-is
+    view.data = buffer_data + buffer_view.byteOffset + accessor.byteOffset;
+    view.count = accessor.count;
+    view.stride = static_cast<size_t>(stride);
+    view.components = components;
+    view.component_type = accessor.componentType;
+    view.normalized = accessor.normalized;
+    return true;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+class GltfDocument;
+
+// Component types (same values as the glTF / GL enums)
+constexpr int GLTF_COMPONENT_BYTE = 5120;
+constexpr int GLTF_COMPONENT_UNSIGNED_BYTE = 5121;
+constexpr int GLTF_COMPONENT_SHORT = 5122;
+constexpr int GLTF_COMPONENT_UNSIGNED_SHORT = 5123;
+constexpr int GLTF_COMPONENT_UNSIGNED_INT = 5125;
+constexpr int GLTF_COMPONENT_FLOAT = 5126;
+
+// Read-only strided window onto one accessor's elements inside a document
+// buffer, which may be a mapped file. Nothing is copied: elements are decoded on demand, straight into
+// the caller's storage, from whatever component type the file uses. That
+// covers plain float data as well as normalized and unnormalized integer
+// attributes (KHR_mesh_quantization).
+//
+// create() checks that every element lies inside its buffer view, so the
+// decode functions below never read out of bounds as long as the element
+// indices handed to them are below count.
+struct GltfAccessorView
+{
+    const unsigned char* data = nullptr;  // First element
+    size_t count = 0;
+    size_t stride = 0;                    // Bytes between elements
+    int components = 0;                   // 1 (SCALAR) to 4 (VEC4)
+    int component_type = 0;               // GLTF_COMPONENT_*
+    bool normalized = false;
+
+    static bool create(const GltfDocument& document, int accessor_index,
+        GltfAccessorView& view, std::string* error = nullptr);
+
+    bool isFloat() const { return component_type == GLTF_COMPONENT_FLOAT; }
+};
+
+namespace GltfAccessorDetail
+{
+    // Normalized integer to float, as defined by the glTF specification
+    inline float normalize(int8_t value) { float f = value / 127.0f; return f < -1.0f ? -1.0f : f; }
+    inline float normalize(uint8_t value) { return value / 255.0f; }
+    inline float normalize(int16_t value) { float f = value / 32767.0f; return f < -1.0f ? -1.0f : f; }
+    inline float normalize(uint16_t value) { return value / 65535.0f; }
+    inline float normalize(uint32_t value) { return static_cast<float>(value / 4294967295.0); }
+    inline float normalize(float value) { return value; }
+
+    template<typename T, int Components, bool Normalized>
+    void decodeElements(const GltfAccessorView& view, const uint32_t* indices, size_t count,
+        float* out, size_t out_stride, float scale)
+    {
+        unsigned char* dst = reinterpret_cast<unsigned char*>(out);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t element = indices ? indices[i] : i;
+            const unsigned char* src = view.data + element * view.stride;
+            float* values = reinterpret_cast<float*>(dst + i * out_stride);
+
+            for (int c = 0; c < Components; ++c)
+            {
+                T value;
+                memcpy(&value, src + c * sizeof(T), sizeof(T)); // Elements need not be aligned
+                values[c] = (Normalized ? normalize(value) : static_cast<float>(value)) * scale;
+            }
+        }
+    }
+
+    template<typename T, int Components>
+    void decodeElements(const GltfAccessorView& view, const uint32_t* indices, size_t count,
+        float* out, size_t out_stride, float scale)
+    {
+        if (view.normalized) {
+            decodeElements<T, Components, true>(view, indices, count, out, out_stride, scale);
+        }
+        else {
+            decodeElements<T, Components, false>(view, indices, count, out, out_stride, scale);
+        }
+    }
+
+    template<int Components>
+    bool decodeElements(const GltfAccessorView& view, const uint32_t* indices, size_t count,
+        float* out, size_t out_stride, float scale)
+    {
+        switch (view.component_type) {
+        case GLTF_COMPONENT_FLOAT:
+            decodeElements<float, Components, false>(view, indices, count, out, out_stride, scale);
+            return true;
+        case GLTF_COMPONENT_BYTE:
+            decodeElements<int8_t, Components>(view, indices, count, out, out_stride, scale);
+            return true;
+        case GLTF_COMPONENT_UNSIGNED_BYTE:
+            decodeElements<uint8_t, Components>(view, indices, count, out, out_stride, scale);
+            return true;
+        case GLTF_COMPONENT_SHORT:
+            decodeElements<int16_t, Components>(view, indices, count, out, out_stride, scale);
+            return true;
+        case GLTF_COMPONENT_UNSIGNED_SHORT:
+            decodeElements<uint16_t, Components>(view, indices, count, out, out_stride, scale);
+            return true;
+        case GLTF_COMPONENT_UNSIGNED_INT:
+            decodeElements<uint32_t, Components>(view, indices, count, out, out_stride, scale);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    template<typename T>
+    void decodeIndices(const GltfAccessorView& view, uint32_t* out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            T value;
+            memcpy(&value, view.data + i * view.stride, sizeof(T));
+            out[i] = static_cast<uint32_t>(value);
+        }
+    }
+}
+
+// Decode count elements as floats, multiplied by scale. Element i is written to
+// out + i * out_stride bytes, so the destination can be a field of an
+// interleaved vertex array. indices selects which elements to read (nullptr
+// reads 0..count-1); every index must be below view.count.
+inline bool decodeAccessorFloats(const GltfAccessorView& view, const uint32_t* indices, size_t count,
+    float* out, size_t out_stride, float scale = 1.0f)
+{
+    switch (view.components) {
+    case 1: return GltfAccessorDetail::decodeElements<1>(view, indices, count, out, out_stride, scale);
+    case 2: return GltfAccessorDetail::decodeElements<2>(view, indices, count, out, out_stride, scale);
+    case 3: return GltfAccessorDetail::decodeElements<3>(view, indices, count, out, out_stride, scale);
+    case 4: return GltfAccessorDetail::decodeElements<4>(view, indices, count, out, out_stride, scale);
+    default: return false;
+    }
+}
+
+// Decode the first count elements of a SCALAR index accessor
+inline bool decodeAccessorIndices(const GltfAccessorView& view, uint32_t* out, size_t count)
+{
+    if (view.components != 1 || count > view.count) {
+        return false;
+    }
+
+    switch (view.component_type) {
+    case GLTF_COMPONENT_UNSIGNED_BYTE:
+        GltfAccessorDetail::decodeIndices<uint8_t>(view, out, count);
+        return true;
+    case GLTF_COMPONENT_UNSIGNED_SHORT:
+        GltfAccessorDetail::decodeIndices<uint16_t>(view, out, count);
+        return true;
+    case GLTF_COMPONENT_UNSIGNED_INT:
+        if (view.stride == sizeof(uint32_t)) {
+            memcpy(out, view.data, count * sizeof(uint32_t));
+        }
+        else {
+            GltfAccessorDetail::decodeIndices<uint32_t>(view, out, count);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,827 @@
+#include "GltfDocument.hpp"
+#include "MeshoptDecoder.hpp"
+#include "ThreadPool.hpp"
+#include <iostream>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#include <tiny_gltf.h>
+
+namespace
+{
+    struct CacheEntry
+    {
+        std::string key;
+        uint64_t file_size = 0;
+        int64_t write_time = 0;
+        std::shared_ptr<const GltfDocument> document;
+    };
+
+    struct DocumentCache
+    {
+        std::mutex mutex;
+        std::list<CacheEntry> entries;  // Most recently used first
+        size_t capacity = 4;
+    };
+
+    DocumentCache& documentCache()
+    {
+        static DocumentCache cache;
+        return cache;
+    }
+
+    std::string makeCacheKey(const std::string& filename)
+    {
+        std::error_code ec;
+        std::filesystem::path path = std::filesystem::weakly_canonical(filename, ec);
+        return ec ? filename : path.generic_string();
+    }
+
+    std::atomic<bool> map_buffers{ true };
+
+    constexpr uint32_t GLB_MAGIC = 0x46546C67;       // "glTF"
+    constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;  // "JSON"
+    constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;   // "BIN\0"
+
+    const char* const MESHOPT_EXTENSION = "EXT_meshopt_compression";
+
+    // Made-up file names given to buffers without a uri, so tinygltf loads
+    // them through the file callbacks. The name ends in the byte length.
+    const char* const GLB_BIN_NAME = "__glb_bin_";
+    const char* const MESHOPT_FALLBACK_NAME = "__meshopt_fallback_";
+
+    struct ByteSpan
+    {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+    };
+
+    uint32_t readU32(const unsigned char* p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // JSON and (optional) BIN chunk of a .glb
+    bool splitGlb(const AssetFile& file, ByteSpan& json, ByteSpan& bin, std::string& error)
+    {
+        const unsigned char* data = file.data();
+        const size_t size = file.size();
+
+        if (size < 20 || readU32(data) != GLB_MAGIC || readU32(data + 4) != 2) {
+            error = "Not a glTF 2.0 binary file";
+            return false;
+        }
+
+        const size_t total = std::min<size_t>(readU32(data + 8), size);
+        const size_t json_size = readU32(data + 12);
+        if (readU32(data + 16) != GLB_CHUNK_JSON || json_size > total - 20) {
+            error = "Invalid GLB JSON chunk";
+            return false;
+        }
+        json = { data + 20, json_size };
+
+        // Chunks are 4-byte aligned
+        const size_t bin_header = 20 + ((json_size + 3) & ~size_t(3));
+        if (bin_header + 8 <= total && readU32(data + bin_header + 4) == GLB_CHUNK_BIN) {
+            const size_t bin_size = readU32(data + bin_header);
+            if (bin_size > total - bin_header - 8) {
+                error = "Invalid GLB BIN chunk";
+                return false;
+            }
+            bin = { data + bin_header + 8, bin_size };
+        }
+        return true;
+    }
+
+    // Just enough of a JSON reader to walk the buffers array without
+    // building anything; tinygltf does the one real parse
+    class JsonScanner
+    {
+    public:
+        JsonScanner(const char* text, size_t size) : begin(text), p(text), end(text + size) {}
+
+        size_t offset() const { return static_cast<size_t>(p - begin); }
+
+        bool consume(char c)
+        {
+            skipSpace();
+            if (p == end || *p != c) {
+                return false;
+            }
+            ++p;
+            return true;
+        }
+
+        bool peek(char c)
+        {
+            skipSpace();
+            return p != end && *p == c;
+        }
+
+        // Raw contents of a string, escapes left as they are
+        bool readString(std::string_view& value)
+        {
+            if (!consume('"')) {
+                return false;
+            }
+            const char* start = p;
+            for (; p != end && *p != '"'; ++p) {
+                if (*p == '\\' && ++p == end) {
+                    return false;
+                }
+            }
+            if (p == end) {
+                return false;
+            }
+            value = std::string_view(start, static_cast<size_t>(p++ - start));
+            return true;
+        }
+
+        bool readUnsigned(size_t& value)
+        {
+            skipSpace();
+            const char* start = p;
+            value = 0;
+            for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+                value = value * 10 + static_cast<size_t>(*p - '0');
+            }
+            return p != start && (p == end || (*p != '.' && *p != 'e' && *p != 'E'));
+        }
+
+        // value is true only for a literal true
+        bool readBool(bool& value)
+        {
+            skipSpace();
+            value = end - p >= 4 && memcmp(p, "true", 4) == 0;
+            return skipValue();
+        }
+
+        bool skipValue()
+        {
+            std::string_view string;
+            if (peek('"')) {
+                return readString(string);
+            }
+
+            int depth = 0;
+            while (p != end) {
+                const char c = *p;
+                if (c == '"') {
+                    if (!readString(string)) {
+                        return false;
+                    }
+                    continue;
+                }
+                if (c == '{' || c == '[') {
+                    ++depth;
+                }
+                else if (c == '}' || c == ']') {
+                    if (depth == 0) {
+                        return true;
+                    }
+                    --depth;
+                }
+                else if (c == ',' && depth == 0) {
+                    return true;
+                }
+                ++p;
+                if (depth == 0 && (c == '}' || c == ']')) {
+                    return true;
+                }
+            }
+            return depth == 0;
+        }
+
+        // Calls member(key) with the scanner on each value, which it must consume
+        template <typename Member>
+        bool forEachMember(Member&& member)
+        {
+            if (!consume('{')) {
+                return false;
+            }
+            if (consume('}')) {
+                return true;
+            }
+            do {
+                std::string_view key;
+                if (!readString(key) || !consume(':') || !member(key)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+        }
+
+        template <typename Element>
+        bool forEachElement(Element&& element)
+        {
+            if (!consume('[')) {
+                return false;
+            }
+            if (consume(']')) {
+                return true;
+            }
+            do {
+                if (!element()) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']');
+        }
+
+    private:
+        const char* begin;
+        const char* p;
+        const char* end;
+
+        void skipSpace()
+        {
+            while (p != end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+                ++p;
+            }
+        }
+    };
+
+    struct BufferEntry
+    {
+        size_t object_begin = 0;    // Offset just past the buffer's '{'
+        size_t byte_length = 0;
+        bool has_uri = false;
+        bool meshopt_fallback = false;  // Only reserves space for EXT_meshopt_compression output
+    };
+
+    // Buffers of a glTF JSON text; false if it is too broken to tell
+    bool scanBuffers(const char* text, size_t size, std::vector<BufferEntry>& buffers)
+    {
+        JsonScanner json(text, size);
+        return json.forEachMember([&](std::string_view key) {
+            if (key != "buffers" || !json.peek('[')) {
+                return json.skipValue();
+            }
+
+            return json.forEachElement([&]() {
+                if (!json.peek('{')) {
+                    return json.skipValue();
+                }
+
+                BufferEntry buffer;
+                buffer.object_begin = json.offset() + 1;
+                bool scanned = json.forEachMember([&](std::string_view key) {
+                    if (key == "uri") {
+                        buffer.has_uri = true;
+                    }
+                    else if (key == "byteLength" && json.readUnsigned(buffer.byte_length)) {
+                        return true;
+                    }
+                    else if (key == "extensions" && json.peek('{')) {
+                        return json.forEachMember([&](std::string_view extension) {
+                            if (extension != MESHOPT_EXTENSION || !json.peek('{')) {
+                                return json.skipValue();
+                            }
+                            return json.forEachMember([&](std::string_view property) {
+                                return property == "fallback" ? json.readBool(buffer.meshopt_fallback) : json.skipValue();
+                            });
+                        });
+                    }
+                    return json.skipValue();
+                });
+                buffers.push_back(buffer);
+                return scanned;
+            });
+        });
+    }
+
+    bool parseNameSize(const std::string& name, const char* prefix, size_t& size)
+    {
+        const size_t prefix_length = strlen(prefix);
+        if (name.compare(0, prefix_length, prefix) != 0 || name.size() == prefix_length) {
+            return false;
+        }
+        size = 0;
+        for (size_t i = prefix_length; i < name.size(); ++i) {
+            if (name[i] < '0' || name[i] > '9') {
+                return false;
+            }
+            size = size * 10 + static_cast<size_t>(name[i] - '0');
+        }
+        return true;
+    }
+
+    bool getNumber(const tinygltf::Value& object, const char* key, size_t& value)
+    {
+        const tinygltf::Value& number = object.Get(key);
+        if (!number.IsNumber() || number.GetNumberAsDouble() < 0.0) {
+            return false;
+        }
+        value = static_cast<size_t>(number.GetNumberAsDouble());
+        return true;
+    }
+
+    // tinygltf file access through AssetFileSystem, so external images and
+    // buffers are found in mounted archives too
+    bool assetFileExists(const std::string& path, void*)
+    {
+        return AssetFileSystem::get().exists(path);
+    }
+
+    bool readAssetFile(std::vector<unsigned char>* out, std::string* err, const std::string& path, void*)
+    {
+        AssetFile file;
+        if (!file.open(path)) {
+            if (err) {
+                *err += "File open error : " + path + "\n";
+            }
+            return false;
+        }
+        out->assign(file.data(), file.data() + file.size());
+        return true;
+    }
+
+    bool getAssetFileSize(size_t* size, std::string* err, const std::string& path, void*)
+    {
+        uint64_t file_size = 0;
+        int64_t write_time = 0;
+        if (!AssetFileSystem::get().stat(path, file_size, write_time)) {
+            if (err) {
+                *err += "File open error : " + path + "\n";
+            }
+            return false;
+        }
+        *size = static_cast<size_t>(file_size);
+        return true;
+    }
+
+    tinygltf::FsCallbacks makeAssetCallbacks()
+    {
+        tinygltf::FsCallbacks fs;
+        fs.FileExists = &assetFileExists;
+        fs.ExpandFilePath = [](const std::string& path, void*) {
+            return tinygltf::ExpandFilePath(path, nullptr);
+        };
+        fs.ReadWholeFile = &readAssetFile;
+        fs.WriteWholeFile = &tinygltf::WriteWholeFile;
+        fs.GetFileSizeInBytes = &getAssetFileSize;
+        fs.user_data = nullptr;
+        return fs;
+    }
+
+    // What the file callbacks serve while a mapped document is parsed: the
+    // BIN chunk and meshopt fallback buffers under their made-up names, and
+    // every other file through AssetFileSystem, kept open so the buffers can
+    // be served from it afterwards
+    struct MappedSources
+    {
+        ByteSpan bin;
+        std::vector<AssetFile> files;   // In the order tinygltf read them
+    };
+
+    std::string getFileName(const std::string& path)
+    {
+        const size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    // Size of the made-up file at path, false for a real file
+    bool getMadeUpSize(const std::string& path, const MappedSources& sources, size_t& size)
+    {
+        const std::string name = getFileName(path);
+        if (parseNameSize(name, MESHOPT_FALLBACK_NAME, size)) {
+            return true;
+        }
+        return parseNameSize(name, GLB_BIN_NAME, size) && size <= sources.bin.size;
+    }
+
+    tinygltf::FsCallbacks makeMappedCallbacks(MappedSources& sources)
+    {
+        tinygltf::FsCallbacks fs = makeAssetCallbacks();
+        fs.user_data = &sources;
+        fs.FileExists = [](const std::string& path, void* user_data) {
+            size_t size = 0;
+            return getMadeUpSize(path, *static_cast<MappedSources*>(user_data), size) || assetFileExists(path, nullptr);
+        };
+        fs.GetFileSizeInBytes = [](size_t* size, std::string* err, const std::string& path, void* user_data) {
+            return getMadeUpSize(path, *static_cast<MappedSources*>(user_data), *size) || getAssetFileSize(size, err, path, nullptr);
+        };
+        fs.ReadWholeFile = [](std::vector<unsigned char>* out, std::string* err, const std::string& path, void* user_data) {
+            MappedSources& sources = *static_cast<MappedSources*>(user_data);
+            size_t size = 0;
+            if (parseNameSize(getFileName(path), MESHOPT_FALLBACK_NAME, size)) {
+                out->assign(size, 0); // Decoded into by decodeCompressedViews()
+                return true;
+            }
+            if (getMadeUpSize(path, sources, size)) {
+                out->assign(sources.bin.data, sources.bin.data + size);
+                return true;
+            }
+
+            AssetFile file;
+            if (!file.open(path)) {
+                if (err) {
+                    *err += "File open error : " + path + "\n";
+                }
+                return false;
+            }
+            out->assign(file.data(), file.data() + file.size());
+            sources.files.push_back(std::move(file));
+            return true;
+        };
+        return fs;
+    }
+}
+
+GltfDocument::GltfDocument()
+    : model(std::make_unique<tinygltf::Model>())
+{
+}
+
+GltfDocument::~GltfDocument() = default;
+
+std::shared_ptr<const GltfDocument> GltfDocument::load(const std::string& filename, std::string& error)
+{
+    DocumentCache& cache = documentCache();
+
+    uint64_t file_size = 0;
+    int64_t write_time = 0;
+    if (!AssetFileSystem::get().stat(filename, file_size, write_time))
+    {
+        // Let tinygltf produce the error message
+        return parse(filename, error);
+    }
+
+    std::string key = makeCacheKey(filename);
+
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        for (auto it = cache.entries.begin(); it != cache.entries.end(); ++it)
+        {
+            if (it->key != key)
+            {
+                continue;
+            }
+
+            if (it->file_size == file_size && it->write_time == write_time)
+            {
+                cache.entries.splice(cache.entries.begin(), cache.entries, it);
+                return it->document;
+            }
+
+            cache.entries.erase(it); // File changed on disk
+            break;
+        }
+    }
+
+    // Parse outside the lock so unrelated files can load concurrently
+    std::shared_ptr<const GltfDocument> document = parse(filename, error);
+    if (!document)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.capacity > 0)
+    {
+        CacheEntry entry;
+        entry.key = key;
+        entry.file_size = file_size;
+        entry.write_time = write_time;
+        entry.document = document;
+        cache.entries.push_front(std::move(entry));
+
+        while (cache.entries.size() > cache.capacity)
+        {
+            cache.entries.pop_back();
+        }
+    }
+
+    return document;
+}
+
+std::shared_ptr<const GltfDocument> GltfDocument::parse(const std::string& filename, std::string& error)
+{
+    std::shared_ptr<GltfDocument> document(new GltfDocument());
+    document->filename = filename;
+
+    bool fall_back = true;
+    if (map_buffers && document->parseMapped(error, fall_back)) {
+        return document;
+    }
+    if (!fall_back) {
+        return nullptr;
+    }
+
+    // Mapping is off or the file could not be mapped
+    *document->model = tinygltf::Model();
+    document->mappings.clear();
+    error.clear();
+
+    tinygltf::TinyGLTF loader;
+    loader.SetFsCallbacks(makeAssetCallbacks());
+    std::string warn;
+
+    // Determine if file is binary (.glb) or text (.gltf)
+    bool is_binary = filename.substr(filename.find_last_of(".") + 1) == "glb";
+
+    bool success;
+    if (is_binary) {
+        success = loader.LoadBinaryFromFile(document->model.get(), &error, &warn, filename);
+    }
+    else {
+        success = loader.LoadASCIIFromFile(document->model.get(), &error, &warn, filename);
+    }
+
+    if (!warn.empty()) {
+        std::cout << "glTF warning: " << warn << std::endl;
+    }
+
+    if (!success) {
+        return nullptr;
+    }
+
+    document->useModelBuffers();
+    if (!document->decodeCompressedViews(error)) {
+        return nullptr;
+    }
+    return document;
+}
+
+bool GltfDocument::parseMapped(std::string& error, bool& fall_back)
+{
+    fall_back = true;
+
+    AssetFile source;
+    if (!source.open(filename)) {
+        return false;
+    }
+
+    const bool is_binary = filename.substr(filename.find_last_of(".") + 1) == "glb";
+
+    MappedSources sources;
+    ByteSpan json_chunk = { source.data(), source.size() };
+    if (is_binary && !splitGlb(source, json_chunk, sources.bin, error)) {
+        return false; // tinygltf reports the broken container
+    }
+
+    const char* json_begin = reinterpret_cast<const char*>(json_chunk.data);
+    std::vector<BufferEntry> buffer_entries;
+    if (!scanBuffers(json_begin, json_chunk.size, buffer_entries)) {
+        return false; // Let tinygltf report the syntax error
+    }
+    fall_back = false;
+
+    // Buffers without a uri get a made-up file name: tinygltf only takes
+    // them from the BIN chunk of a GLB it parses itself, and never accepts a
+    // fallback buffer that has no data at all
+    std::string patched_json;
+    size_t copied = 0;
+    for (size_t i = 0; i < buffer_entries.size(); ++i) {
+        const BufferEntry& buffer = buffer_entries[i];
+        if (buffer.has_uri || (!is_binary && !buffer.meshopt_fallback)) {
+            continue; // tinygltf reports a missing uri
+        }
+        if (!buffer.meshopt_fallback && (!sources.bin.data || buffer.byte_length > sources.bin.size)) {
+            error = "Buffer " + std::to_string(i) + (sources.bin.data ? " is larger than the BIN chunk" : " has no uri and there is no BIN chunk");
+            return false;
+        }
+
+        patched_json.append(json_begin + copied, buffer.object_begin - copied);
+        patched_json += std::string("\"uri\":\"") + (buffer.meshopt_fallback ? MESHOPT_FALLBACK_NAME : GLB_BIN_NAME) +
+            std::to_string(buffer.byte_length) + "\",";
+        copied = buffer.object_begin;
+    }
+    if (copied > 0) {
+        patched_json.append(json_begin + copied, json_chunk.size - copied);
+        json_begin = patched_json.c_str();
+    }
+    const size_t json_size = copied > 0 ? patched_json.size() : json_chunk.size;
+
+    // tinygltf reads every buffer once, and decodes the images stored in
+    // them from that copy
+    tinygltf::TinyGLTF loader;
+    loader.SetFsCallbacks(makeMappedCallbacks(sources));
+
+    std::string warn;
+    const std::string base_dir = std::filesystem::path(filename).parent_path().string();
+    bool success = loader.LoadASCIIFromString(model.get(), &error, &warn, json_begin, static_cast<unsigned int>(json_size), base_dir);
+
+    if (!warn.empty()) {
+        std::cout << "glTF warning: " << warn << std::endl;
+    }
+
+    if (!success) {
+        return false;
+    }
+
+    // Then the copies of file buffers are dropped for the mapped files
+    useModelBuffers();
+    bool keep_source = false;
+    size_t next_file = 0;
+    for (size_t i = 0; i < model->buffers.size(); ++i) {
+        tinygltf::Buffer& buffer = model->buffers[i];
+        const size_t size = buffer.data.size();
+        size_t made_up_size = 0;
+        if (parseNameSize(buffer.uri, MESHOPT_FALLBACK_NAME, made_up_size)) {
+            buffer.uri.clear(); // Keeps its zeroed data to be decoded into
+            continue;
+        }
+        else if (parseNameSize(buffer.uri, GLB_BIN_NAME, made_up_size)) {
+            buffers[i] = { sources.bin.data, size, true };
+            buffer.uri.clear();
+            keep_source = true;
+        }
+        else if (buffer.uri.compare(0, 5, "data:") != 0 && next_file < sources.files.size()) {
+            AssetFile& file = sources.files[next_file++];
+            buffers[i] = { file.data(), size, true };
+            mappings.push_back(std::move(file));
+        }
+        else {
+            continue;
+        }
+        std::vector<unsigned char>().swap(buffer.data);
+    }
+
+    if (keep_source) {
+        mappings.push_back(std::move(source));
+    }
+    return decodeCompressedViews(error);
+}
+
+void GltfDocument::useModelBuffers()
+{
+    buffers.clear();
+    for (const auto& buffer : model->buffers) {
+        buffers.push_back({ buffer.data.data(), buffer.data.size(), false });
+    }
+}
+
+bool GltfDocument::decodeCompressedViews(std::string& error)
+{
+    struct CompressedView
+    {
+        size_t view_index = 0;
+        const unsigned char* source = nullptr;
+        size_t source_size = 0;
+        size_t target_buffer = 0;
+        size_t target_offset = 0;
+        size_t count = 0;
+        size_t stride = 0;
+        MeshoptMode mode = MeshoptMode::Attributes;
+        MeshoptFilter filter = MeshoptFilter::None;
+    };
+
+    std::vector<CompressedView> views;
+    std::vector<size_t> target_sizes(buffers.size(), 0);
+    std::vector<bool> source_buffers(buffers.size(), false);
+
+    for (size_t i = 0; i < model->bufferViews.size(); ++i) {
+        const tinygltf::BufferView& buffer_view = model->bufferViews[i];
+        auto extension = buffer_view.extensions.find(MESHOPT_EXTENSION);
+        if (extension == buffer_view.extensions.end()) {
+            continue;
+        }
+
+        const tinygltf::Value& meshopt = extension->second;
+        const std::string view_name = "Buffer view " + std::to_string(i);
+
+        CompressedView view;
+        view.view_index = i;
+        size_t source_buffer = 0, source_offset = 0;
+        if (!getNumber(meshopt, "buffer", source_buffer) || !getNumber(meshopt, "byteLength", view.source_size) ||
+            !getNumber(meshopt, "byteStride", view.stride) || !getNumber(meshopt, "count", view.count) ||
+            !meshopt.Get("mode").IsString()) {
+            error = view_name + " has an incomplete " + MESHOPT_EXTENSION + " extension";
+            return false;
+        }
+        getNumber(meshopt, "byteOffset", source_offset);
+
+        const tinygltf::Value& filter = meshopt.Get("filter");
+        if (!MeshoptDecoder::parseMode(meshopt.Get("mode").Get<std::string>(), view.mode) ||
+            !MeshoptDecoder::parseFilter(filter.IsString() ? filter.Get<std::string>() : std::string(), view.filter)) {
+            error = view_name + " uses an unknown meshopt mode or filter";
+            return false;
+        }
+
+        if (source_buffer >= buffers.size() || source_offset > buffers[source_buffer].size ||
+            view.source_size > buffers[source_buffer].size - source_offset) {
+            error = view_name + ": compressed data lies outside its buffer";
+            return false;
+        }
+        view.source = buffers[source_buffer].data + source_offset;
+        source_buffers[source_buffer] = true;
+
+        // Decoded elements fill the view in its fallback buffer
+        if (buffer_view.buffer < 0 || static_cast<size_t>(buffer_view.buffer) >= buffers.size() ||
+            view.stride == 0 || view.count > buffer_view.byteLength / view.stride) {
+            error = view_name + ": decoded data does not fit the buffer view";
+            return false;
+        }
+        view.target_buffer = static_cast<size_t>(buffer_view.buffer);
+        view.target_offset = buffer_view.byteOffset;
+
+        size_t& target_size = target_sizes[view.target_buffer];
+        target_size = std::max(target_size, buffer_view.byteOffset + buffer_view.byteLength);
+        views.push_back(view);
+    }
+
+    if (views.empty()) {
+        return true;
+    }
+
+    // Decode into copies of the fallback buffers, keeping whatever they already
+    // hold, or straight into the ones the model owns and that are big enough
+    std::vector<unsigned char*> targets(buffers.size(), nullptr);
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        if (target_sizes[i] == 0) {
+            continue;
+        }
+
+        std::vector<unsigned char>& owned = model->buffers[i].data;
+        if (!buffers[i].mapped && !source_buffers[i] && buffers[i].data == owned.data() && owned.size() >= target_sizes[i]) {
+            targets[i] = owned.data();
+            continue;
+        }
+
+        const size_t size = std::max(target_sizes[i], buffers[i].size);
+        std::unique_ptr<unsigned char[]> copy(new unsigned char[size]());
+        if (buffers[i].data) {
+            memcpy(copy.get(), buffers[i].data, buffers[i].size);
+        }
+        targets[i] = copy.get();
+        buffers[i] = { copy.get(), size, false };
+        decoded_buffers.push_back(std::move(copy));
+    }
+
+    std::vector<unsigned char> decoded(views.size(), 0);
+    ThreadPool::get().parallelFor(views.size(), [&](size_t i) {
+        const CompressedView& view = views[i];
+        decoded[i] = MeshoptDecoder::decode(targets[view.target_buffer] + view.target_offset, view.count, view.stride, view.source, view.source_size,
+                                            view.mode, view.filter);
+    });
+
+    decompressed_size = 0;
+    for (size_t i = 0; i < views.size(); ++i) {
+        if (!decoded[i]) {
+            error = "Buffer view " + std::to_string(views[i].view_index) + " holds corrupt " + MESHOPT_EXTENSION + " data";
+            return false;
+        }
+        decompressed_size += views[i].count * views[i].stride;
+    }
+    return true;
+}
+
+const unsigned char* GltfDocument::getBufferData(int buffer_index, size_t& size) const
+{
+    if (buffer_index < 0 || static_cast<size_t>(buffer_index) >= buffers.size()) {
+        size = 0;
+        return nullptr;
+    }
+
+    size = buffers[buffer_index].size;
+    return buffers[buffer_index].data;
+}
+
+size_t GltfDocument::getMappedBufferSize() const
+{
+    size_t size = 0;
+    for (const BufferData& buffer : buffers) {
+        size += buffer.mapped ? buffer.size : 0;
+    }
+    return size;
+}
+
+void GltfDocument::setMapBuffers(bool enabled)
+{
+    map_buffers = enabled;
+}
+
+void GltfDocument::setCacheCapacity(size_t capacity)
+{
+    DocumentCache& cache = documentCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+
+    cache.capacity = capacity;
+    while (cache.entries.size() > cache.capacity)
+    {
+        cache.entries.pop_back();
+    }
+}
+
+size_t GltfDocument::getCacheCapacity()
+{
+    DocumentCache& cache = documentCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.capacity;
+}
+
+void GltfDocument::clearCache()
+{
+    DocumentCache& cache = documentCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.entries.clear();
+}
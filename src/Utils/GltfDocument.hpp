@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include "AssetFile.hpp"
+
+// Forward declare tinygltf types to avoid including the entire header
+namespace tinygltf {
+    class Model;
+}
+
+// One parsed glTF/GLB file. Geometry, materials and the metadata queries all
+// read from the same tinygltf::Model instead of parsing the file again.
+//
+// load() keeps the most recently parsed documents in a small LRU keyed by
+// path and file stamp, so the geometry pass, the material pass and any name
+// or count queries made while importing a file all share a single parse.
+// Call clearCache() once importing is done to give the memory back.
+//
+// The JSON is parsed once, by tinygltf. The GLB BIN chunk and external .bin
+// buffers are read through the file callbacks for that parse (images stored
+// in them are decoded from the copy), then the copies are dropped and
+// getBufferData() points into the memory-mapped files instead, so a cached
+// document keeps only the pages its accessors touch resident. Data URI
+// buffers stay in tinygltf::Buffer::data. Every file, the document itself,
+// its buffers and images, is opened through AssetFileSystem, so glTF files
+// load from mounted archives like loose ones.
+//
+// Buffer views compressed with EXT_meshopt_compression are decoded right
+// after parsing, in parallel on the ThreadPool, into their fallback buffer;
+// getBufferData() then serves that buffer, so accessors never see the
+// compressed data. A fallback buffer without a uri is only accepted on the
+// mapped path, tinygltf's own loader rejects it.
+class GltfDocument
+{
+public:
+    ~GltfDocument();
+
+    // Parsed document for filename, from the cache when the file is unchanged
+    static std::shared_ptr<const GltfDocument> load(const std::string& filename, std::string& error);
+
+    // Always parse, bypassing the cache
+    static std::shared_ptr<const GltfDocument> parse(const std::string& filename, std::string& error);
+
+    const tinygltf::Model& getModel() const { return *model; }
+    const std::string& getFilename() const { return filename; }
+
+    // Bytes of a buffer, mapped or not (nullptr if the index is out of range)
+    const unsigned char* getBufferData(int buffer_index, size_t& size) const;
+    size_t getBufferCount() const { return buffers.size(); }
+
+    // Total size of the buffers served from mapped files
+    size_t getMappedBufferSize() const;
+
+    // Total size of the buffer views decoded from EXT_meshopt_compression
+    size_t getDecompressedSize() const { return decompressed_size; }
+
+    // Map buffers (default) or let tinygltf read and copy them
+    static void setMapBuffers(bool enabled);
+
+    // Cache control (capacity 0 disables caching)
+    static void setCacheCapacity(size_t capacity);
+    static size_t getCacheCapacity();
+    static void clearCache();
+
+private:
+    struct BufferData
+    {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        bool mapped = false;
+    };
+
+    std::string filename;
+    std::unique_ptr<tinygltf::Model> model;
+    std::vector<BufferData> buffers;
+    std::vector<AssetFile> mappings;    // Keep the mapped buffers alive
+    std::vector<std::unique_ptr<unsigned char[]>> decoded_buffers;
+    size_t decompressed_size = 0;
+
+    GltfDocument();
+
+    // Parse with the buffers mapped. On failure, fall_back tells whether the
+    // file should go through tinygltf's own loader instead.
+    bool parseMapped(std::string& error, bool& fall_back);
+    void useModelBuffers();
+
+    // Decode every EXT_meshopt_compression buffer view into its fallback buffer
+    bool decodeCompressedViews(std::string& error);
+};
@@ -1,9 +1,14 @@
 #include "GltfLoader.hpp"
+#include "GltfAccessor.hpp"
+#include "ThreadPool.hpp"
+#include "AssetCatalog.hpp"
+#include "Graphics/Frustum.hpp"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 #include <map>
 #include <set>
+#include <memory>
 
 // Don't define any STB_IMAGE implementations - use existing ones
 // Configure tinygltf to use external STB_IMAGE
@@ -23,15 +28,25 @@ GltfLoadResult GltfLoader::loadGltfWithMaterials(const std::string& filename,
 {
     logMessage(config, "Loading glTF file with materials: " + filename);
 
+    // Parse once; geometry and materials both read from the same document
+    GltfLoadResult result;
+    std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    if (!document) {
+        result.error_message = "Failed to load glTF file: " + error;
+        logError(config, result.error_message);
+        return result;
+    }
+
     // First load geometry
-    GltfLoadResult result = loadGltfGeometry(filename, config);
+    result = loadGltfGeometry(*document, config);
     
     if (!result.success) {
         return result;
     }
 
     // Then load materials
-    if (!loadMaterialsIntoResult(result, filename, render_api, material_config)) {
+    if (!loadMaterialsIntoResult(result, *document, render_api, material_config)) {
         logMessage(config, "Warning: Failed to load materials, continuing with geometry only");
     }
 
@@ -44,53 +59,40 @@ GltfLoadResult GltfLoader::loadGltfGeometry(const std::string& filename, const G
 
     logMessage(config, "Loading glTF geometry: " + filename);
 
-    tinygltf::Model model;
     std::string error;
-
-    if (!loadModel(filename, model, error)) {
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    if (!document) {
         result.error_message = "Failed to load glTF file: " + error;
         logError(config, result.error_message);
         return result;
     }
 
-    std::vector<vertex> vertices;
-    std::vector<int> material_indices;
+    return loadGltfGeometry(*document, config);
+}
 
-    // Process all scenes and nodes
-    for (const auto& scene : model.scenes) {
-        for (int node_index : scene.nodes) {
-            if (node_index >= 0 && node_index < model.nodes.size()) {
-                if (!processNodeWithMaterials(model, model.nodes[node_index], vertices, material_indices, config)) {
-                    result.error_message = "Failed to process node " + std::to_string(node_index);
-                    logError(config, result.error_message);
-                    return result;
-                }
-            }
-        }
-    }
+GltfLoadResult GltfLoader::loadGltfGeometry(const GltfDocument& document, const GltfLoaderConfig& config)
+{
+    GltfLoadResult result;
+    const tinygltf::Model& model = document.getModel();
 
-    if (vertices.empty()) {
-        result.error_message = "No geometry found in glTF file";
-        logError(config, result.error_message);
-        return result;
+    if (config.preserve_hierarchy) {
+        if (!loadHierarchy(document, result, config)) {
+            return result;
+        }
     }
-
-    // Convert to array format
-    result.vertex_count = vertices.size();
-    result.vertices = new vertex[result.vertex_count];
-
-    for (size_t i = 0; i < result.vertex_count; ++i) {
-        result.vertices[i] = vertices[i];
-
-        if (config.validate_normals || config.validate_texcoords) {
-            if (!validateVertex(result.vertices[i], config)) {
-                logError(config, "Invalid vertex data at index " + std::to_string(i));
+    else {
+        // Gather the primitives of all scenes and nodes
+        std::vector<const tinygltf::Primitive*> primitives;
+        for (const auto& scene : model.scenes) {
+            for (int node_index : scene.nodes) {
+                collectPrimitives(model, node_index, primitives);
             }
         }
-    }
 
-    // Store material indices
-    result.material_indices = std::move(material_indices);
+        if (!decodePrimitives(document, primitives, result, config)) {
+            return result;
+        }
+    }
 
     // Extract basic material names for compatibility
     result.material_names.clear();
@@ -108,6 +110,21 @@ bool GltfLoader::loadMaterialsIntoResult(GltfLoadResult& result,
                                        const std::string& filename,
                                        IRenderAPI* render_api,
                                        const MaterialLoaderConfig& material_config)
+{
+    std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    if (!document) {
+        logError(GltfLoaderConfig(), "Failed to load glTF file: " + error);
+        return false;
+    }
+
+    return loadMaterialsIntoResult(result, *document, render_api, material_config);
+}
+
+bool GltfLoader::loadMaterialsIntoResult(GltfLoadResult& result,
+                                       const GltfDocument& document,
+                                       IRenderAPI* render_api,
+                                       const MaterialLoaderConfig& material_config)
 {
     if (!render_api) {
         logError(GltfLoaderConfig(), "Render API is null");
@@ -115,7 +132,7 @@ bool GltfLoader::loadMaterialsIntoResult(GltfLoadResult& result,
     }
 
     // Load materials using the dedicated material loader
-    result.material_data = GltfMaterialLoader::loadMaterials(filename, render_api, material_config);
+    result.material_data = GltfMaterialLoader::loadMaterials(document, render_api, material_config);
     
     if (result.material_data.success) {
         result.materials_loaded = true;
@@ -139,14 +156,15 @@ GltfLoadResult GltfLoader::loadGltfMesh(const std::string& filename, const std::
 {
     GltfLoadResult result;
 
-    tinygltf::Model model;
     std::string error;
-
-    if (!loadModel(filename, model, error)) {
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    if (!document) {
         result.error_message = "Failed to load glTF file: " + error;
         return result;
     }
 
+    const tinygltf::Model& model = document->getModel();
+
     // Find mesh by name
     int mesh_index = -1;
     for (size_t i = 0; i < model.meshes.size(); ++i) {
@@ -161,43 +179,42 @@ GltfLoadResult GltfLoader::loadGltfMesh(const std::string& filename, const std::
         return result;
     }
 
-    return loadGltfMesh(filename, mesh_index, config);
+    return loadGltfMesh(*document, mesh_index, config);
 }
 
 GltfLoadResult GltfLoader::loadGltfMesh(const std::string& filename, size_t mesh_index, const GltfLoaderConfig& config)
 {
     GltfLoadResult result;
 
-    tinygltf::Model model;
     std::string error;
-
-    if (!loadModel(filename, model, error)) {
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    if (!document) {
         result.error_message = "Failed to load glTF file: " + error;
         return result;
     }
 
+    return loadGltfMesh(*document, mesh_index, config);
+}
+
+GltfLoadResult GltfLoader::loadGltfMesh(const GltfDocument& document, size_t mesh_index, const GltfLoaderConfig& config)
+{
+    GltfLoadResult result;
+    const tinygltf::Model& model = document.getModel();
+
     if (mesh_index >= model.meshes.size()) {
         result.error_message = "Mesh index out of range: " + std::to_string(mesh_index);
         return result;
     }
 
-    std::vector<vertex> vertices;
-
-    if (!processMesh(model, model.meshes[mesh_index], vertices, config)) {
-        result.error_message = "Failed to process mesh at index " + std::to_string(mesh_index);
-        return result;
+    std::vector<const tinygltf::Primitive*> primitives;
+    for (const auto& primitive : model.meshes[mesh_index].primitives) {
+        primitives.push_back(&primitive);
     }
 
-    if (vertices.empty()) {
-        result.error_message = "No geometry found in specified mesh";
+    if (!decodePrimitives(document, primitives, result, config)) {
         return result;
     }
 
-    // Convert to array format
-    result.vertex_count = vertices.size();
-    result.vertices = new vertex[result.vertex_count];
-    std::copy(vertices.begin(), vertices.end(), result.vertices);
-
     result.success = true;
     return result;
 }
@@ -234,414 +251,522 @@ GltfLoadResult GltfLoader::loadGltfMeshWithMaterials(const std::string& filename
 
 bool GltfLoader::validateGltfFile(const std::string& filename)
 {
-    tinygltf::Model model;
     std::string error;
-    return loadModel(filename, model, error);
+    return GltfDocument::load(filename, error) != nullptr;
 }
 
 size_t GltfLoader::getGltfVertexCount(const std::string& filename)
 {
-    GltfLoaderConfig config;
-    config.verbose_logging = false;
-
-    auto result = loadGltfGeometry(filename, config);
-    return result.success ? result.vertex_count : 0;
+    std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    return document ? getGltfVertexCount(*document) : 0;
 }
 
-std::vector<std::string> GltfLoader::getGltfMeshNames(const std::string& filename)
+size_t GltfLoader::getGltfVertexCount(const GltfDocument& document)
 {
-    std::vector<std::string> names;
+    const tinygltf::Model& model = document.getModel();
 
-    tinygltf::Model model;
-    std::string error;
+    // Same traversal and per-primitive counts as loadGltfGeometry, without decoding anything
+    std::vector<const tinygltf::Primitive*> primitives;
+    for (const auto& scene : model.scenes) {
+        for (int node_index : scene.nodes) {
+            collectPrimitives(model, node_index, primitives);
+        }
+    }
 
-    if (loadModel(filename, model, error)) {
-        for (const auto& mesh : model.meshes) {
-            names.push_back(mesh.name.empty() ? "unnamed_mesh" : mesh.name);
+    size_t count = 0;
+    for (const tinygltf::Primitive* primitive : primitives) {
+        size_t primitive_count = 0;
+        if (!countPrimitiveVertices(model, *primitive, primitive_count)) {
+            return 0; // Geometry loading fails on this primitive
         }
+        count += primitive_count;
     }
 
-    return names;
+    return count;
 }
 
-std::vector<std::string> GltfLoader::getGltfTextureNames(const std::string& filename)
+std::vector<std::string> GltfLoader::getGltfMeshNames(const std::string& filename)
 {
-    std::vector<std::string> names;
-
-    tinygltf::Model model;
-    std::string error;
-
-    if (loadModel(filename, model, error)) {
-        for (const auto& image : model.images) {
-            if (!image.uri.empty()) {
-                names.push_back(image.uri);
-            }
-            else {
-                names.push_back("embedded_image");
-            }
+    const AssetRecord* record = AssetCatalog::get().findCurrent(filename);
+    if (record && record->isGltf()) {
+        std::vector<std::string> names;
+        for (const auto& name : record->mesh_names) {
+            names.push_back(name.empty() ? "unnamed_mesh" : name);
         }
+        return names;
     }
 
-    return names;
+    std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    return document ? getGltfMeshNames(*document) : std::vector<std::string>();
 }
 
-bool GltfLoader::loadModel(const std::string& filename, tinygltf::Model& model, std::string& error)
+std::vector<std::string> GltfLoader::getGltfMeshNames(const GltfDocument& document)
 {
-    tinygltf::TinyGLTF loader;
-    std::string warn;
-
-    // Determine if file is binary (.glb) or text (.gltf)
-    bool is_binary = filename.substr(filename.find_last_of(".") + 1) == "glb";
-
-    bool success;
-    if (is_binary) {
-        success = loader.LoadBinaryFromFile(&model, &error, &warn, filename);
-    }
-    else {
-        success = loader.LoadASCIIFromFile(&model, &error, &warn, filename);
-    }
+    std::vector<std::string> names;
 
-    if (!warn.empty()) {
-        std::cout << "glTF warning: " << warn << std::endl;
+    for (const auto& mesh : document.getModel().meshes) {
+        names.push_back(mesh.name.empty() ? "unnamed_mesh" : mesh.name);
     }
 
-    return success;
+    return names;
 }
 
-bool GltfLoader::processNodeWithMaterials(const tinygltf::Model& model, const tinygltf::Node& node,
-    std::vector<vertex>& vertices, std::vector<int>& material_indices, const GltfLoaderConfig& config)
+std::vector<std::string> GltfLoader::getGltfTextureNames(const std::string& filename)
 {
-    // Process mesh if present
-    if (node.mesh >= 0 && node.mesh < model.meshes.size()) {
-        if (!processMeshWithMaterials(model, model.meshes[node.mesh], vertices, material_indices, config)) {
-            return false;
+    const AssetRecord* record = AssetCatalog::get().findCurrent(filename);
+    if (record && record->isGltf()) {
+        std::vector<std::string> names;
+        for (const auto& uri : record->texture_uris) {
+            names.push_back(uri.empty() ? "embedded_image" : uri);
         }
+        return names;
     }
 
-    // Recursively process children
-    for (int child_index : node.children) {
-        if (child_index >= 0 && child_index < model.nodes.size()) {
-            if (!processNodeWithMaterials(model, model.nodes[child_index], vertices, material_indices, config)) {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
+    return document ? getGltfTextureNames(*document) : std::vector<std::string>();
 }
 
-bool GltfLoader::processMeshWithMaterials(const tinygltf::Model& model, const tinygltf::Mesh& mesh,
-    std::vector<vertex>& vertices, std::vector<int>& material_indices, const GltfLoaderConfig& config)
+std::vector<std::string> GltfLoader::getGltfTextureNames(const GltfDocument& document)
 {
-    for (const auto& primitive : mesh.primitives) {
-        int material_index = -1;
-        if (!processPrimitiveWithMaterial(model, primitive, vertices, config, material_index)) {
-            return false;
+    std::vector<std::string> names;
+
+    for (const auto& image : document.getModel().images) {
+        if (!image.uri.empty()) {
+            names.push_back(image.uri);
+        }
+        else {
+            names.push_back("embedded_image");
         }
-        material_indices.push_back(material_index);
     }
-    return true;
+
+    return names;
 }
 
-bool GltfLoader::processNode(const tinygltf::Model& model, const tinygltf::Node& node,
-    std::vector<vertex>& vertices, const GltfLoaderConfig& config)
+void GltfLoader::collectPrimitives(const tinygltf::Model& model, int node_index,
+    std::vector<const tinygltf::Primitive*>& primitives)
 {
-    // Process mesh if present
-    if (node.mesh >= 0 && node.mesh < model.meshes.size()) {
-        if (!processMesh(model, model.meshes[node.mesh], vertices, config)) {
-            return false;
+    if (node_index < 0 || static_cast<size_t>(node_index) >= model.nodes.size()) {
+        return;
+    }
+
+    const tinygltf::Node& node = model.nodes[node_index];
+    if (node.mesh >= 0 && static_cast<size_t>(node.mesh) < model.meshes.size()) {
+        for (const auto& primitive : model.meshes[node.mesh].primitives) {
+            primitives.push_back(&primitive);
         }
     }
 
     // Recursively process children
     for (int child_index : node.children) {
-        if (child_index >= 0 && child_index < model.nodes.size()) {
-            if (!processNode(model, model.nodes[child_index], vertices, config)) {
-                return false;
-            }
-        }
+        collectPrimitives(model, child_index, primitives);
     }
-
-    return true;
 }
 
-bool GltfLoader::processMesh(const tinygltf::Model& model, const tinygltf::Mesh& mesh,
-    std::vector<vertex>& vertices, const GltfLoaderConfig& config)
+bool GltfLoader::loadHierarchy(const GltfDocument& document, GltfLoadResult& result, const GltfLoaderConfig& config)
 {
-    for (const auto& primitive : mesh.primitives) {
-        if (!processPrimitive(model, primitive, vertices, config)) {
-            return false;
-        }
-    }
-    return true;
-}
+    const tinygltf::Model& model = document.getModel();
 
-bool GltfLoader::processPrimitive(const tinygltf::Model& model, const tinygltf::Primitive& primitive,
-    std::vector<vertex>& vertices, const GltfLoaderConfig& config)
-{
-    std::vector<float> positions, normals, texcoords;
-    std::vector<unsigned int> indices;
+    // Walk the scenes depth first so parents come before their children. A
+    // node can only have one parent, so a node seen twice means a broken file.
+    std::vector<int> result_index(model.nodes.size(), -1);
+    std::vector<std::pair<int, int>> stack; // (glTF node, parent in result.nodes)
 
-    // Extract positions (required)
-    auto pos_it = primitive.attributes.find("POSITION");
-    if (pos_it == primitive.attributes.end()) {
-        logError(config, "Primitive missing POSITION attribute");
-        return false;
+    for (const auto& scene : model.scenes) {
+        for (auto it = scene.nodes.rbegin(); it != scene.nodes.rend(); ++it) {
+            stack.emplace_back(*it, -1);
+        }
     }
 
-    if (!extractPositions(model, pos_it->second, positions)) {
-        logError(config, "Failed to extract positions");
-        return false;
-    }
+    while (!stack.empty()) {
+        auto [node_index, parent] = stack.back();
+        stack.pop_back();
 
-    // Extract normals (optional)
-    auto norm_it = primitive.attributes.find("NORMAL");
-    bool has_normals = false;
-    if (norm_it != primitive.attributes.end()) {
-        has_normals = extractNormals(model, norm_it->second, normals);
-        if (!has_normals && config.verbose_logging) {
-            logMessage(config, "Failed to extract normals, will generate if enabled");
+        if (node_index < 0 || static_cast<size_t>(node_index) >= model.nodes.size() || result_index[node_index] >= 0) {
+            logError(config, "Skipping invalid or repeated node " + std::to_string(node_index));
+            continue;
         }
-    }
 
-    // Extract texture coordinates (optional)
-    auto tex_it = primitive.attributes.find("TEXCOORD_0");
-    bool has_texcoords = false;
-    if (tex_it != primitive.attributes.end()) {
-        has_texcoords = extractTexCoords(model, tex_it->second, texcoords, config.flip_uvs);
-        if (!has_texcoords && config.verbose_logging) {
-            logMessage(config, "Failed to extract texture coordinates");
+        const tinygltf::Node& node = model.nodes[node_index];
+        const int index = static_cast<int>(result.nodes.size());
+        result_index[node_index] = index;
+
+        GltfNodeData data;
+        data.name = node.name;
+        data.parent = parent;
+        data.local_transform = getNodeTransform(node, config.scale);
+        data.world_transform = parent >= 0 ? result.nodes[parent].world_transform * data.local_transform
+                                           : data.local_transform;
+        data.mesh_index = (node.mesh >= 0 && static_cast<size_t>(node.mesh) < model.meshes.size()) ? node.mesh : -1;
+        result.nodes.push_back(std::move(data));
+
+        if (parent >= 0) {
+            result.nodes[parent].children.push_back(index);
         }
-    }
 
-    // Extract indices (optional)
-    bool has_indices = false;
-    if (primitive.indices >= 0) {
-        has_indices = extractIndices(model, primitive.indices, indices);
+        for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+            stack.emplace_back(*it, index);
+        }
     }
 
-    // Validate data consistency
-    size_t vertex_count = positions.size() / 3;
-    if (has_normals && normals.size() / 3 != vertex_count) {
-        logError(config, "Normal count doesn't match position count");
-        has_normals = false;
-        normals.clear();
+    // Every referenced mesh is decoded once, however many nodes draw it
+    std::vector<int> mesh_first_primitive(model.meshes.size(), -1);
+    std::vector<const tinygltf::Primitive*> primitives;
+    for (const GltfNodeData& node : result.nodes) {
+        if (node.mesh_index < 0 || mesh_first_primitive[node.mesh_index] >= 0) {
+            continue;
+        }
+        mesh_first_primitive[node.mesh_index] = static_cast<int>(primitives.size());
+        for (const auto& primitive : model.meshes[node.mesh_index].primitives) {
+            primitives.push_back(&primitive);
+        }
     }
 
-    if (has_texcoords && texcoords.size() / 2 != vertex_count) {
-        logError(config, "Texture coordinate count doesn't match position count");
-        has_texcoords = false;
-        texcoords.clear();
+    if (!decodePrimitives(document, primitives, result, config)) {
+        return false;
     }
 
-    // Create vertices
-    std::vector<vertex> primitive_vertices;
-
-    if (has_indices) {
-        // Use indices to build triangulated mesh
-        for (size_t i = 0; i < indices.size(); i += 3) {
-            for (int j = 0; j < 3; ++j) {
-                unsigned int idx = indices[i + j];
-                if (idx >= vertex_count) {
-                    logError(config, "Index out of range");
-                    continue;
-                }
-
-                vertex v;
-                v.vx = positions[idx * 3] * config.scale;
-                v.vy = positions[idx * 3 + 1] * config.scale;
-                v.vz = positions[idx * 3 + 2] * config.scale;
-
-                if (has_normals) {
-                    v.nx = normals[idx * 3];
-                    v.ny = normals[idx * 3 + 1];
-                    v.nz = normals[idx * 3 + 2];
-                }
-                else {
-                    v.nx = v.ny = v.nz = 0.0f;
-                }
-
-                if (has_texcoords) {
-                    v.u = texcoords[idx * 2];
-                    v.v = texcoords[idx * 2 + 1];
-                }
-                else {
-                    v.u = v.v = 0.0f;
-                }
-
-                primitive_vertices.push_back(v);
-            }
+    for (GltfPrimitiveRange& range : result.primitive_ranges) {
+        const vertex* v = result.vertices + range.first_vertex;
+        if (range.vertex_count == 0) {
+            continue;
+        }
+        range.bounds_min = range.bounds_max = vector3f(v[0].vx, v[0].vy, v[0].vz);
+        for (size_t i = 1; i < range.vertex_count; ++i) {
+            vector3f position(v[i].vx, v[i].vy, v[i].vz);
+            range.bounds_min.X = std::min(range.bounds_min.X, position.X);
+            range.bounds_min.Y = std::min(range.bounds_min.Y, position.Y);
+            range.bounds_min.Z = std::min(range.bounds_min.Z, position.Z);
+            range.bounds_max.X = std::max(range.bounds_max.X, position.X);
+            range.bounds_max.Y = std::max(range.bounds_max.Y, position.Y);
+            range.bounds_max.Z = std::max(range.bounds_max.Z, position.Z);
         }
     }
-    else {
-        // No indices, use vertices directly (assuming triangulated)
-        for (size_t i = 0; i < vertex_count; ++i) {
-            vertex v;
-            v.vx = positions[i * 3] * config.scale;
-            v.vy = positions[i * 3 + 1] * config.scale;
-            v.vz = positions[i * 3 + 2] * config.scale;
-
-            if (has_normals) {
-                v.nx = normals[i * 3];
-                v.ny = normals[i * 3 + 1];
-                v.nz = normals[i * 3 + 2];
-            }
-            else {
-                v.nx = v.ny = v.nz = 0.0f;
+
+    for (GltfNodeData& node : result.nodes) {
+        if (node.mesh_index < 0) {
+            continue;
+        }
+        node.first_primitive = mesh_first_primitive[node.mesh_index];
+        node.primitive_count = model.meshes[node.mesh_index].primitives.size();
+
+        for (size_t i = node.first_primitive; i < node.first_primitive + node.primitive_count; ++i) {
+            const GltfPrimitiveRange& range = result.primitive_ranges[i];
+            if (range.vertex_count == 0) {
+                continue;
             }
 
-            if (has_texcoords) {
-                v.u = texcoords[i * 2];
-                v.v = texcoords[i * 2 + 1];
+            vector3f box_min, box_max;
+            transformBox(node.world_transform, range.bounds_min, range.bounds_max, box_min, box_max);
+            if (!node.has_bounds) {
+                node.bounds_min = box_min;
+                node.bounds_max = box_max;
+                node.has_bounds = true;
             }
             else {
-                v.u = v.v = 0.0f;
+                node.bounds_min.X = std::min(node.bounds_min.X, box_min.X);
+                node.bounds_min.Y = std::min(node.bounds_min.Y, box_min.Y);
+                node.bounds_min.Z = std::min(node.bounds_min.Z, box_min.Z);
+                node.bounds_max.X = std::max(node.bounds_max.X, box_max.X);
+                node.bounds_max.Y = std::max(node.bounds_max.Y, box_max.Y);
+                node.bounds_max.Z = std::max(node.bounds_max.Z, box_max.Z);
             }
-
-            primitive_vertices.push_back(v);
         }
     }
 
-    // Generate missing data if requested
-    if (!has_normals && config.generate_normals_if_missing) {
-        generateNormals(primitive_vertices);
-    }
-
-    if (!has_texcoords && config.generate_texcoords_if_missing) {
-        generateTexCoords(primitive_vertices);
-    }
-
-    // Add to main vertex list
-    vertices.insert(vertices.end(), primitive_vertices.begin(), primitive_vertices.end());
-
     return true;
 }
 
-bool GltfLoader::processPrimitiveWithMaterial(const tinygltf::Model& model, const tinygltf::Primitive& primitive,
-    std::vector<vertex>& vertices, const GltfLoaderConfig& config, int& material_index)
+matrix4f GltfLoader::getNodeTransform(const tinygltf::Node& node, float scale)
 {
-    // Store material index for this primitive
-    material_index = primitive.material;
-    
-    // Use the regular primitive processing for geometry
-    return processPrimitive(model, primitive, vertices, config);
-}
+    matrix4f transform;
 
-bool GltfLoader::extractPositions(const tinygltf::Model& model, int accessor_index, std::vector<float>& positions)
-{
-    return extractBufferData(model, accessor_index, positions);
-}
+    if (node.matrix.size() == 16) {
+        // glTF matrices are column-major, the same memory layout as matrix4f
+        for (int i = 0; i < 16; ++i) {
+            transform[i] = static_cast<float>(node.matrix[i]);
+        }
+    }
+    else {
+        // T * R * S
+        double x = 0.0, y = 0.0, z = 0.0, w = 1.0;
+        if (node.rotation.size() == 4) {
+            x = node.rotation[0]; y = node.rotation[1]; z = node.rotation[2]; w = node.rotation[3];
+        }
 
-bool GltfLoader::extractNormals(const tinygltf::Model& model, int accessor_index, std::vector<float>& normals)
-{
-    return extractBufferData(model, accessor_index, normals);
+        double sx = 1.0, sy = 1.0, sz = 1.0;
+        if (node.scale.size() == 3) {
+            sx = node.scale[0]; sy = node.scale[1]; sz = node.scale[2];
+        }
+
+        transform[0] = static_cast<float>((1.0 - 2.0 * (y * y + z * z)) * sx);
+        transform[1] = static_cast<float>((2.0 * (x * y + z * w)) * sx);
+        transform[2] = static_cast<float>((2.0 * (x * z - y * w)) * sx);
+        transform[4] = static_cast<float>((2.0 * (x * y - z * w)) * sy);
+        transform[5] = static_cast<float>((1.0 - 2.0 * (x * x + z * z)) * sy);
+        transform[6] = static_cast<float>((2.0 * (y * z + x * w)) * sy);
+        transform[8] = static_cast<float>((2.0 * (x * z + y * w)) * sz);
+        transform[9] = static_cast<float>((2.0 * (y * z - x * w)) * sz);
+        transform[10] = static_cast<float>((1.0 - 2.0 * (x * x + y * y)) * sz);
+
+        if (node.translation.size() == 3) {
+            transform[12] = static_cast<float>(node.translation[0]);
+            transform[13] = static_cast<float>(node.translation[1]);
+            transform[14] = static_cast<float>(node.translation[2]);
+        }
+    }
+
+    // Vertices are decoded pre-scaled, so only translations need the global
+    // scale for the whole model to come out scaled uniformly
+    transform[12] *= scale;
+    transform[13] *= scale;
+    transform[14] *= scale;
+    return transform;
 }
 
-bool GltfLoader::extractTexCoords(const tinygltf::Model& model, int accessor_index, std::vector<float>& texcoords, bool flip_v)
+bool GltfLoader::countPrimitiveVertices(const tinygltf::Model& model, const tinygltf::Primitive& primitive, size_t& count)
 {
-    if (!extractBufferData(model, accessor_index, texcoords)) {
+    auto pos_it = primitive.attributes.find("POSITION");
+    if (pos_it == primitive.attributes.end() || pos_it->second < 0 || pos_it->second >= model.accessors.size()) {
         return false;
     }
 
-    if (flip_v) {
-        for (size_t i = 1; i < texcoords.size(); i += 2) {
-            texcoords[i] = 1.0f - texcoords[i];
-        }
+    if (primitive.indices >= 0 && primitive.indices < model.accessors.size()) {
+        // Indexed primitives are expanded to a triangle list; a trailing partial triangle is dropped
+        size_t index_count = model.accessors[primitive.indices].count;
+        count = index_count - index_count % 3;
+    }
+    else {
+        count = model.accessors[pos_it->second].count;
     }
 
     return true;
 }
 
-bool GltfLoader::extractIndices(const tinygltf::Model& model, int accessor_index, std::vector<unsigned int>& indices)
+bool GltfLoader::decodePrimitives(const GltfDocument& document, const std::vector<const tinygltf::Primitive*>& primitives,
+    GltfLoadResult& result, const GltfLoaderConfig& config)
 {
-    if (accessor_index < 0 || accessor_index >= model.accessors.size()) {
+    const tinygltf::Model& model = document.getModel();
+
+    // Size every primitive up front, so the final vertex array is allocated
+    // once and each primitive decodes straight into its own slice of it
+    std::vector<GltfPrimitiveRange> ranges(primitives.size());
+    size_t total = 0;
+
+    for (size_t i = 0; i < primitives.size(); ++i) {
+        if (!countPrimitiveVertices(model, *primitives[i], ranges[i].vertex_count)) {
+            result.error_message = "Primitive " + std::to_string(i) + " is missing its POSITION attribute";
+            logError(config, result.error_message);
+            return false;
+        }
+        ranges[i].first_vertex = total;
+        ranges[i].material_index = primitives[i]->material;
+        total += ranges[i].vertex_count;
+    }
+
+    if (total == 0) {
+        result.error_message = "No geometry found in glTF file";
+        logError(config, result.error_message);
         return false;
     }
 
-    const auto& accessor = model.accessors[accessor_index];
-    const auto& buffer_view = model.bufferViews[accessor.bufferView];
-    const auto& buffer = model.buffers[buffer_view.buffer];
+    std::unique_ptr<vertex[]> vertices(new vertex[total]);
+
+    // Slices don't overlap and the model is only read, so primitives decode
+    // independently. Hand out the biggest ones first to keep the tail short.
+    std::vector<size_t> order(primitives.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return ranges[a].vertex_count > ranges[b].vertex_count;
+    });
 
-    const unsigned char* data = buffer.data.data() + buffer_view.byteOffset + accessor.byteOffset;
+    std::vector<char> decoded(primitives.size(), 0);
+    auto decode = [&](size_t job) {
+        const size_t i = order[job];
+        vertex* slice = vertices.get() + ranges[i].first_vertex;
+        if (!decodePrimitive(document, *primitives[i], slice, ranges[i].vertex_count, config)) {
+            return;
+        }
+        decoded[i] = 1;
 
-    indices.resize(accessor.count);
+        if (config.validate_normals || config.validate_texcoords) {
+            for (size_t v = 0; v < ranges[i].vertex_count; ++v) {
+                if (!validateVertex(slice[v], config)) {
+                    logError(config, "Invalid vertex data at index " + std::to_string(ranges[i].first_vertex + v));
+                }
+            }
+        }
+    };
 
-    switch (accessor.componentType) {
-    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-        for (size_t i = 0; i < accessor.count; ++i) {
-            indices[i] = static_cast<unsigned int>(reinterpret_cast<const unsigned char*>(data)[i]);
+    if (config.multithreaded && primitives.size() > 1) {
+        ThreadPool::get().parallelFor(order.size(), decode);
+    }
+    else {
+        for (size_t job = 0; job < order.size(); ++job) {
+            decode(job);
         }
-        break;
-    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-        for (size_t i = 0; i < accessor.count; ++i) {
-            indices[i] = static_cast<unsigned int>(reinterpret_cast<const unsigned short*>(data)[i]);
+    }
+
+    for (size_t i = 0; i < primitives.size(); ++i) {
+        if (!decoded[i]) {
+            result.error_message = "Failed to process primitive " + std::to_string(i);
+            logError(config, result.error_message);
+            return false;
         }
-        break;
-    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-        std::memcpy(indices.data(), data, accessor.count * sizeof(unsigned int));
-        break;
-    default:
-        return false;
     }
 
+    result.vertices = vertices.release();
+    result.vertex_count = total;
+
+    // Store material indices
+    result.material_indices.clear();
+    for (const auto& range : ranges) {
+        result.material_indices.push_back(range.material_index);
+    }
+    result.primitive_ranges = std::move(ranges);
+
     return true;
 }
 
-template<typename T>
-bool GltfLoader::extractBufferData(const tinygltf::Model& model, int accessor_index, std::vector<T>& data)
+bool GltfLoader::decodePrimitive(const GltfDocument& document, const tinygltf::Primitive& primitive,
+    vertex* vertices, size_t vertex_count, const GltfLoaderConfig& config)
 {
-    if (accessor_index < 0 || accessor_index >= model.accessors.size()) {
-        return false;
-    }
+    std::string error;
 
-    const auto& accessor = model.accessors[accessor_index];
-    if (accessor.bufferView < 0 || accessor.bufferView >= model.bufferViews.size()) {
+    // Extract positions (required)
+    GltfAccessorView positions;
+    if (!GltfAccessorView::create(document, primitive.attributes.at("POSITION"), positions, &error) ||
+        positions.components != 3) {
+        logError(config, "Failed to extract positions" + (error.empty() ? std::string() : ": " + error));
         return false;
     }
 
-    const auto& buffer_view = model.bufferViews[accessor.bufferView];
-    if (buffer_view.buffer < 0 || buffer_view.buffer >= model.buffers.size()) {
-        return false;
+    if (vertex_count == 0) {
+        return true;
     }
 
-    const auto& buffer = model.buffers[buffer_view.buffer];
+    // Extract indices (optional). Attributes are then gathered through them,
+    // so every output vertex is decoded exactly once.
+    std::vector<uint32_t> indices;
+    const uint32_t* index_data = nullptr;
+    if (primitive.indices >= 0 && primitive.indices < document.getModel().accessors.size()) {
+        GltfAccessorView index_view;
+        indices.resize(vertex_count);
+        if (!GltfAccessorView::create(document, primitive.indices, index_view, &error) ||
+            !decodeAccessorIndices(index_view, indices.data(), vertex_count)) {
+            logError(config, "Failed to extract indices" + (error.empty() ? std::string() : ": " + error));
+            return false;
+        }
+
+        // An out-of-range index collapses its triangle, so the vertex count stays as sized
+        bool out_of_range = false;
+        for (size_t i = 0; i < vertex_count; i += 3) {
+            if (indices[i] >= positions.count || indices[i + 1] >= positions.count || indices[i + 2] >= positions.count) {
+                indices[i] = indices[i + 1] = indices[i + 2] = 0;
+                out_of_range = true;
+            }
+        }
 
-    // Calculate component size and count
-    size_t component_size = tinygltf::GetComponentSizeInBytes(accessor.componentType);
-    size_t num_components = tinygltf::GetNumComponentsInType(accessor.type);
-    size_t total_size = accessor.count * num_components;
+        if (out_of_range) {
+            if (positions.count == 0) {
+                logError(config, "Indices reference an empty POSITION accessor");
+                return false;
+            }
+            logError(config, "Index out of range");
+        }
 
-    if (sizeof(T) != component_size) {
-        return false; // Type mismatch
+        index_data = indices.data();
     }
 
-    const unsigned char* src_data = buffer.data.data() + buffer_view.byteOffset + accessor.byteOffset;
+    decodeAccessorFloats(positions, index_data, vertex_count, &vertices[0].vx, sizeof(vertex), config.scale);
 
-    data.resize(total_size);
+    // Extract normals (optional)
+    GltfAccessorView normals;
+    bool has_normals = false;
+    auto norm_it = primitive.attributes.find("NORMAL");
+    if (norm_it != primitive.attributes.end()) {
+        has_normals = GltfAccessorView::create(document, norm_it->second, normals, &error) && normals.components == 3;
+        if (!has_normals && config.verbose_logging) {
+            logMessage(config, "Failed to extract normals, will generate if enabled");
+        }
+        else if (has_normals && normals.count != positions.count) {
+            logError(config, "Normal count doesn't match position count");
+            has_normals = false;
+        }
+    }
+
+    if (has_normals) {
+        decodeAccessorFloats(normals, index_data, vertex_count, &vertices[0].nx, sizeof(vertex));
 
-    if (buffer_view.byteStride == 0 || buffer_view.byteStride == component_size * num_components) {
-        // Tightly packed data
-        std::memcpy(data.data(), src_data, total_size * sizeof(T));
+        // Quantized normals are only approximately unit length
+        if (!normals.isFloat()) {
+            for (size_t i = 0; i < vertex_count; ++i) {
+                vertex& v = vertices[i];
+                float length = std::sqrt(v.nx * v.nx + v.ny * v.ny + v.nz * v.nz);
+                if (length > 0.0f) {
+                    v.nx /= length;
+                    v.ny /= length;
+                    v.nz /= length;
+                }
+            }
+        }
     }
     else {
-        // Interleaved data
-        for (size_t i = 0; i < accessor.count; ++i) {
-            const T* element_data = reinterpret_cast<const T*>(src_data + i * buffer_view.byteStride);
-            for (size_t j = 0; j < num_components; ++j) {
-                data[i * num_components + j] = element_data[j];
+        for (size_t i = 0; i < vertex_count; ++i) {
+            vertices[i].nx = vertices[i].ny = vertices[i].nz = 0.0f;
+        }
+    }
+
+    // Extract texture coordinates (optional)
+    GltfAccessorView texcoords;
+    bool has_texcoords = false;
+    auto tex_it = primitive.attributes.find("TEXCOORD_0");
+    if (tex_it != primitive.attributes.end()) {
+        has_texcoords = GltfAccessorView::create(document, tex_it->second, texcoords, &error) && texcoords.components == 2;
+        if (!has_texcoords && config.verbose_logging) {
+            logMessage(config, "Failed to extract texture coordinates");
+        }
+        else if (has_texcoords && texcoords.count != positions.count) {
+            logError(config, "Texture coordinate count doesn't match position count");
+            has_texcoords = false;
+        }
+    }
+
+    if (has_texcoords) {
+        decodeAccessorFloats(texcoords, index_data, vertex_count, &vertices[0].u, sizeof(vertex));
+
+        if (config.flip_uvs) {
+            for (size_t i = 0; i < vertex_count; ++i) {
+                vertices[i].v = 1.0f - vertices[i].v;
             }
         }
     }
+    else {
+        for (size_t i = 0; i < vertex_count; ++i) {
+            vertices[i].u = vertices[i].v = 0.0f;
+        }
+    }
+
+    // Generate missing data if requested
+    if (!has_normals && config.generate_normals_if_missing) {
+        generateNormals(vertices, vertex_count);
+    }
+
+    if (!has_texcoords && config.generate_texcoords_if_missing) {
+        generateTexCoords(vertices, vertex_count);
+    }
 
     return true;
 }
 
-void GltfLoader::generateNormals(std::vector<vertex>& vertices)
+void GltfLoader::generateNormals(vertex* vertices, size_t vertex_count)
 {
     // Generate face normals for triangulated mesh
-    for (size_t i = 0; i < vertices.size(); i += 3) {
-        if (i + 2 >= vertices.size()) break;
-
+    for (size_t i = 0; i + 2 < vertex_count; i += 3) {
         // Calculate face normal
         float v1x = vertices[i + 1].vx - vertices[i].vx;
         float v1y = vertices[i + 1].vy - vertices[i].vy;
@@ -673,12 +798,12 @@ void GltfLoader::generateNormals(std::vector<vertex>& vertices)
     }
 }
 
-void GltfLoader::generateTexCoords(std::vector<vertex>& vertices)
+void GltfLoader::generateTexCoords(vertex* vertices, size_t vertex_count)
 {
     // Simple planar UV mapping
-    for (auto& v : vertices) {
-        v.u = (v.vx + 1.0f) * 0.5f;
-        v.v = (v.vy + 1.0f) * 0.5f;
+    for (size_t i = 0; i < vertex_count; ++i) {
+        vertices[i].u = (vertices[i].vx + 1.0f) * 0.5f;
+        vertices[i].v = (vertices[i].vy + 1.0f) * 0.5f;
     }
 }
 
@@ -7,13 +7,13 @@
 #include "Graphics/RenderAPI.hpp"
 #include "Vertex.hpp"
 #include "GltfMaterialLoader.hpp"
+#include "GltfDocument.hpp"
 
 // Forward declare tinygltf types to avoid including the entire header
 namespace tinygltf {
     class Model;
-    class Node;
-    class Mesh;
     class Primitive;
+    class Node;
 }
 
 struct GltfLoaderConfig
@@ -26,6 +26,39 @@ struct GltfLoaderConfig
     bool flip_uvs = true;  // glTF uses bottom-left origin, engine may use top-left
     bool triangulate = true;  // Convert quads/polygons to triangles
     float scale = 1.0f;  // Global scale factor
+    bool multithreaded = true;  // Decode primitives on the shared ThreadPool
+
+    // Keep the scene graph: every mesh is decoded once in its own space and
+    // GltfLoadResult::nodes says where each node draws it. Without this all
+    // primitives are concatenated into one array and node transforms are ignored.
+    bool preserve_hierarchy = false;
+};
+
+// Run of vertices produced by one glTF primitive
+struct GltfPrimitiveRange
+{
+    size_t first_vertex = 0;
+    size_t vertex_count = 0;
+    int material_index = -1;
+    vector3f bounds_min;        // Of the decoded vertices, in mesh space
+    vector3f bounds_max;
+};
+
+// Node of the imported scene graph (preserve_hierarchy only). Parents always
+// come before their children.
+struct GltfNodeData
+{
+    std::string name;
+    int parent = -1;                // Index into GltfLoadResult::nodes
+    std::vector<int> children;
+    matrix4f local_transform;
+    matrix4f world_transform;       // Relative to the model root
+    int mesh_index = -1;            // glTF mesh, -1 for pure transform nodes
+    size_t first_primitive = 0;     // primitive_ranges of that mesh; nodes sharing
+    size_t primitive_count = 0;     // a mesh share the same ranges
+    bool has_bounds = false;
+    vector3f bounds_min;            // Of the node's own primitives, in model space
+    vector3f bounds_max;
 };
 
 // Enhanced result structure that works with the new material loader
@@ -40,6 +73,8 @@ struct GltfLoadResult
     std::vector<std::string> texture_paths;
     std::vector<std::string> material_names;
     std::vector<int> material_indices; // Which material each vertex group uses
+    std::vector<GltfPrimitiveRange> primitive_ranges; // Vertex range of each vertex group
+    std::vector<GltfNodeData> nodes;                  // Scene graph (preserve_hierarchy)
     
     MaterialLoadResult material_data;  // Complete material information
     bool materials_loaded = false;     // Whether materials were loaded separately
@@ -62,6 +97,8 @@ struct GltfLoadResult
         texture_paths(std::move(other.texture_paths)),
         material_names(std::move(other.material_names)),
         material_indices(std::move(other.material_indices)),
+        primitive_ranges(std::move(other.primitive_ranges)),
+        nodes(std::move(other.nodes)),
         material_data(std::move(other.material_data)),
         materials_loaded(other.materials_loaded)
     {
@@ -82,6 +119,8 @@ struct GltfLoadResult
             texture_paths = std::move(other.texture_paths);
             material_names = std::move(other.material_names);
             material_indices = std::move(other.material_indices);
+            primitive_ranges = std::move(other.primitive_ranges);
+            nodes = std::move(other.nodes);
             material_data = std::move(other.material_data);
             materials_loaded = other.materials_loaded;
 
@@ -134,12 +173,26 @@ public:
         IRenderAPI* render_api,
         const MaterialLoaderConfig& material_config = MaterialLoaderConfig());
 
+    // Same as above, reading from an already parsed document
+    static GltfLoadResult loadGltfGeometry(const GltfDocument& document,
+        const GltfLoaderConfig& config = GltfLoaderConfig());
+
+    static bool loadMaterialsIntoResult(GltfLoadResult& result,
+        const GltfDocument& document,
+        IRenderAPI* render_api,
+        const MaterialLoaderConfig& material_config = MaterialLoaderConfig());
+
     // Utility methods
     static bool validateGltfFile(const std::string& filename);
     static size_t getGltfVertexCount(const std::string& filename);
     static std::vector<std::string> getGltfMeshNames(const std::string& filename);
     static std::vector<std::string> getGltfTextureNames(const std::string& filename);
 
+    // Vertex count from accessor counts, without decoding any geometry
+    static size_t getGltfVertexCount(const GltfDocument& document);
+    static std::vector<std::string> getGltfMeshNames(const GltfDocument& document);
+    static std::vector<std::string> getGltfTextureNames(const GltfDocument& document);
+
     // Load specific mesh by name or index
     static GltfLoadResult loadGltfMesh(const std::string& filename,
         const std::string& mesh_name,
@@ -149,6 +202,10 @@ public:
         size_t mesh_index,
         const GltfLoaderConfig& config = GltfLoaderConfig());
 
+    static GltfLoadResult loadGltfMesh(const GltfDocument& document,
+        size_t mesh_index,
+        const GltfLoaderConfig& config = GltfLoaderConfig());
+
     // Mesh loading with materials
     static GltfLoadResult loadGltfMeshWithMaterials(const std::string& filename,
         const std::string& mesh_name,
@@ -163,44 +220,28 @@ public:
         const MaterialLoaderConfig& material_config = MaterialLoaderConfig());
 
 private:
-    // Internal helper methods
-    static bool loadModel(const std::string& filename, tinygltf::Model& model, std::string& error);
-    
-    // Processing methods (simplified - no longer handle materials internally)
-    static bool processNode(const tinygltf::Model& model, const tinygltf::Node& node,
-        std::vector<vertex>& vertices, const GltfLoaderConfig& config);
-    static bool processMesh(const tinygltf::Model& model, const tinygltf::Mesh& mesh,
-        std::vector<vertex>& vertices, const GltfLoaderConfig& config);
-    static bool processPrimitive(const tinygltf::Model& model, const tinygltf::Primitive& primitive,
-        std::vector<vertex>& vertices, const GltfLoaderConfig& config);
-
-    // Enhanced processing methods that track material indices
-    static bool processNodeWithMaterials(const tinygltf::Model& model, const tinygltf::Node& node,
-        std::vector<vertex>& vertices, std::vector<int>& material_indices, const GltfLoaderConfig& config);
-    static bool processMeshWithMaterials(const tinygltf::Model& model, const tinygltf::Mesh& mesh,
-        std::vector<vertex>& vertices, std::vector<int>& material_indices, const GltfLoaderConfig& config);
-    static bool processPrimitiveWithMaterial(const tinygltf::Model& model, const tinygltf::Primitive& primitive,
-        std::vector<vertex>& vertices, const GltfLoaderConfig& config, int& material_index);
-
-    // Data extraction helpers
-    static bool extractPositions(const tinygltf::Model& model, int accessor_index,
-        std::vector<float>& positions);
-    static bool extractNormals(const tinygltf::Model& model, int accessor_index,
-        std::vector<float>& normals);
-    static bool extractTexCoords(const tinygltf::Model& model, int accessor_index,
-        std::vector<float>& texcoords, bool flip_v = true);
-    static bool extractIndices(const tinygltf::Model& model, int accessor_index,
-        std::vector<unsigned int>& indices);
+    // Primitives reachable from node_index, in traversal order
+    static void collectPrimitives(const tinygltf::Model& model, int node_index,
+        std::vector<const tinygltf::Primitive*>& primitives);
+
+    // preserve_hierarchy: decode every referenced mesh once and build result.nodes
+    static bool loadHierarchy(const GltfDocument& document, GltfLoadResult& result, const GltfLoaderConfig& config);
+    static matrix4f getNodeTransform(const tinygltf::Node& node, float scale);
+
+    // Number of vertices decodePrimitive produces (indexed primitives are expanded)
+    static bool countPrimitiveVertices(const tinygltf::Model& model, const tinygltf::Primitive& primitive,
+        size_t& count);
+
+    // Allocate result.vertices once and decode every primitive into its own range of it
+    static bool decodePrimitives(const GltfDocument& document, const std::vector<const tinygltf::Primitive*>& primitives,
+        GltfLoadResult& result, const GltfLoaderConfig& config);
+    static bool decodePrimitive(const GltfDocument& document, const tinygltf::Primitive& primitive,
+        vertex* vertices, size_t vertex_count, const GltfLoaderConfig& config);
 
     // Utility helpers
-    static void generateNormals(std::vector<vertex>& vertices);
-    static void generateTexCoords(std::vector<vertex>& vertices);
+    static void generateNormals(vertex* vertices, size_t vertex_count);
+    static void generateTexCoords(vertex* vertices, size_t vertex_count);
     static bool validateVertex(const vertex& v, const GltfLoaderConfig& config);
     static void logMessage(const GltfLoaderConfig& config, const std::string& message);
     static void logError(const GltfLoaderConfig& config, const std::string& error);
-
-    // Template helper for buffer data extraction
-    template<typename T>
-    static bool extractBufferData(const tinygltf::Model& model, int accessor_index,
-        std::vector<T>& data);
 };
\ No newline at end of file
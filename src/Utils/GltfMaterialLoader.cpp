@@ -1,4 +1,6 @@
 #include "GltfMaterialLoader.hpp"
+#include "Graphics/TextureManager.hpp"
+#include "AssetCatalog.hpp"
 #include <iostream>
 #include <algorithm>
 #include <fstream>
@@ -31,17 +33,41 @@ MaterialLoadResult GltfMaterialLoader::loadMaterials(const std::string& filename
     
     logMessage(config, "Loading materials from: " + filename);
     
-    tinygltf::Model model;
     std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
     
-    if (!loadModel(filename, model, error))
+    if (!document)
     {
         result.error_message = "Failed to load glTF file: " + error;
         logError(config, result.error_message);
         return result;
     }
     
-    result = processMaterials(model, render_api, config, material_indices);
+    return loadMaterials(*document, render_api, material_indices, config);
+}
+
+MaterialLoadResult GltfMaterialLoader::loadMaterials(const GltfDocument& document,
+                                                    IRenderAPI* render_api,
+                                                    const MaterialLoaderConfig& config)
+{
+    return loadMaterials(document, render_api, {}, config);
+}
+
+MaterialLoadResult GltfMaterialLoader::loadMaterials(const GltfDocument& document,
+                                                    IRenderAPI* render_api,
+                                                    const std::vector<int>& material_indices,
+                                                    const MaterialLoaderConfig& config)
+{
+    MaterialLoadResult result;
+    
+    if (!render_api)
+    {
+        result.error_message = "Render API is null";
+        logError(config, result.error_message);
+        return result;
+    }
+    
+    result = processMaterials(document.getModel(), render_api, config, material_indices);
     
     if (result.success)
     {
@@ -56,12 +82,22 @@ std::vector<std::string> GltfMaterialLoader::getMaterialNames(const std::string&
 {
     std::vector<std::string> names;
     
-    tinygltf::Model model;
+    const AssetRecord* record = AssetCatalog::get().findCurrent(filename);
+    if (record && record->isGltf())
+    {
+        for (const auto& name : record->material_names)
+        {
+            names.push_back(name.empty() ? "unnamed_material" : name);
+        }
+        return names;
+    }
+    
     std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
     
-    if (loadModel(filename, model, error))
+    if (document)
     {
-        for (const auto& material : model.materials)
+        for (const auto& material : document->getModel().materials)
         {
             names.push_back(material.name.empty() ? "unnamed_material" : material.name);
         }
@@ -74,12 +110,22 @@ std::vector<std::string> GltfMaterialLoader::getTextureUris(const std::string& f
 {
     std::vector<std::string> uris;
     
-    tinygltf::Model model;
+    const AssetRecord* record = AssetCatalog::get().findCurrent(filename);
+    if (record && record->isGltf())
+    {
+        for (const auto& uri : record->texture_uris)
+        {
+            uris.push_back(uri.empty() ? "embedded_image_" + std::to_string(uris.size()) : uri);
+        }
+        return uris;
+    }
+    
     std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
     
-    if (loadModel(filename, model, error))
+    if (document)
     {
-        for (const auto& image : model.images)
+        for (const auto& image : document->getModel().images)
         {
             if (!image.uri.empty())
             {
@@ -97,67 +143,104 @@ std::vector<std::string> GltfMaterialLoader::getTextureUris(const std::string& f
 
 int GltfMaterialLoader::getMaterialCount(const std::string& filename)
 {
-    tinygltf::Model model;
+    const AssetRecord* record = AssetCatalog::get().findCurrent(filename);
+    if (record && record->isGltf())
+    {
+        return static_cast<int>(record->material_names.size());
+    }
+    
     std::string error;
+    std::shared_ptr<const GltfDocument> document = GltfDocument::load(filename, error);
     
-    if (loadModel(filename, model, error))
+    if (document)
     {
-        return static_cast<int>(model.materials.size());
+        return static_cast<int>(document->getModel().materials.size());
     }
     
     return 0;
 }
 
-void GltfMaterialLoader::cleanupMaterialTextures(MaterialLoadResult& result, IRenderAPI* render_api)
+std::vector<std::string> GltfMaterialLoader::getTextureFiles(const GltfDocument& document,
+                                                            const MaterialLoaderConfig& config)
 {
-    if (!render_api) return;
+    const tinygltf::Model& model = document.getModel();
+    std::vector<std::string> files;
     
-    // Clean up all loaded textures
-    for (const auto& cache_entry : result.texture_cache)
+    auto addTexture = [&](int texture_index, TextureType type) {
+        if (texture_index < 0 || !isTextureTypeWanted(type, config))
+        {
+            return;
+        }
+        
+        TextureInfo tex_info;
+        const tinygltf::Image* image = resolveTextureImage(texture_index, model, tex_info);
+        if (!image || image->uri.empty())
+        {
+            return;
+        }
+        
+        std::string full_path = getFullTexturePath(image->uri, config.texture_base_path);
+        if (std::find(files.begin(), files.end(), full_path) == files.end())
+        {
+            files.push_back(full_path);
+        }
+    };
+    
+    // Same slots as extractMaterialTextures; packed ORM reads the same two images
+    for (const auto& gltf_material : model.materials)
     {
-        if (cache_entry.second != INVALID_TEXTURE)
+        addTexture(gltf_material.pbrMetallicRoughness.baseColorTexture.index, TextureType::BASE_COLOR);
+        addTexture(gltf_material.pbrMetallicRoughness.metallicRoughnessTexture.index, TextureType::METALLIC_ROUGHNESS);
+        addTexture(gltf_material.occlusionTexture.index, TextureType::OCCLUSION);
+        addTexture(gltf_material.normalTexture.index, TextureType::NORMAL);
+        addTexture(gltf_material.emissiveTexture.index, TextureType::EMISSIVE);
+        
+        auto specular_ext_it = gltf_material.extensions.find("KHR_materials_specular");
+        if (specular_ext_it != gltf_material.extensions.end() && specular_ext_it->second.Has("specularTexture"))
         {
-            render_api->deleteTexture(cache_entry.second);
+            const tinygltf::Value& specular_texture = specular_ext_it->second.Get("specularTexture");
+            if (specular_texture.Has("index"))
+            {
+                addTexture(specular_texture.Get("index").GetNumberAsInt(), TextureType::SPECULAR);
+            }
+        }
+        
+        auto diffuse_it = gltf_material.values.find("diffuse");
+        if (diffuse_it != gltf_material.values.end())
+        {
+            addTexture(diffuse_it->second.TextureIndex(), TextureType::DIFFUSE);
+        }
+        
+        auto specular_it = gltf_material.values.find("specular");
+        if (specular_it != gltf_material.values.end())
+        {
+            addTexture(specular_it->second.TextureIndex(), TextureType::SPECULAR);
         }
     }
     
-    result.texture_cache.clear();
+    return files;
+}
+
+void GltfMaterialLoader::cleanupMaterialTextures(MaterialLoadResult& result, IRenderAPI* render_api)
+{
+    if (!render_api) return;
     
-    // Mark all material textures as invalid
+    // Every loaded texture slot holds one reference in the texture manager;
+    // the GPU texture goes away once nothing else in the process uses it
     for (auto& material : result.materials)
     {
         for (auto& texture : material.textures.textures)
         {
+            if (texture.handle != INVALID_TEXTURE)
+            {
+                TextureManager::get().release(texture.handle);
+            }
             texture.handle = INVALID_TEXTURE;
             texture.is_loaded = false;
         }
     }
-}
-
-bool GltfMaterialLoader::loadModel(const std::string& filename, tinygltf::Model& model, std::string& error)
-{
-    tinygltf::TinyGLTF loader;
-    std::string warn;
-    
-    // Determine if file is binary (.glb) or text (.gltf)
-    bool is_binary = filename.substr(filename.find_last_of(".") + 1) == "glb";
     
-    bool success;
-    if (is_binary)
-    {
-        success = loader.LoadBinaryFromFile(&model, &error, &warn, filename);
-    }
-    else
-    {
-        success = loader.LoadASCIIFromFile(&model, &error, &warn, filename);
-    }
-    
-    if (!warn.empty())
-    {
-        std::cout << "glTF warning: " << warn << std::endl;
-    }
-    
-    return success;
+    result.texture_cache.clear();
 }
 
 MaterialLoadResult GltfMaterialLoader::processMaterials(const tinygltf::Model& model,
@@ -355,11 +438,29 @@ MaterialTextureSet GltfMaterialLoader::extractMaterialTextures(const tinygltf::M
     
     // Process PBR textures
     processTextureIfExists(gltf_material.pbrMetallicRoughness.baseColorTexture.index, TextureType::BASE_COLOR);
-    processTextureIfExists(gltf_material.pbrMetallicRoughness.metallicRoughnessTexture.index, TextureType::METALLIC_ROUGHNESS);
+    
+    bool packed_orm = config.pack_occlusion_roughness_metallic &&
+                      processPackedOrmTextures(gltf_material, model, config, texture_set);
+    if (!packed_orm)
+    {
+        processTextureIfExists(gltf_material.pbrMetallicRoughness.metallicRoughnessTexture.index, TextureType::METALLIC_ROUGHNESS);
+        processTextureIfExists(gltf_material.occlusionTexture.index, TextureType::OCCLUSION);
+    }
+    
     processTextureIfExists(gltf_material.normalTexture.index, TextureType::NORMAL);
-    processTextureIfExists(gltf_material.occlusionTexture.index, TextureType::OCCLUSION);
     processTextureIfExists(gltf_material.emissiveTexture.index, TextureType::EMISSIVE);
     
+    // KHR_materials_specular stores its map outside the core material
+    auto specular_ext_it = gltf_material.extensions.find("KHR_materials_specular");
+    if (specular_ext_it != gltf_material.extensions.end() && specular_ext_it->second.Has("specularTexture"))
+    {
+        const tinygltf::Value& specular_texture = specular_ext_it->second.Get("specularTexture");
+        if (specular_texture.Has("index"))
+        {
+            processSpecularStrengthTexture(specular_texture.Get("index").GetNumberAsInt(), model, config, texture_set);
+        }
+    }
+    
     // Process legacy textures
     auto diffuse_it = gltf_material.values.find("diffuse");
     if (diffuse_it != gltf_material.values.end())
@@ -386,11 +487,51 @@ TextureInfo GltfMaterialLoader::processTexture(int texture_index,
     TextureInfo tex_info;
     tex_info.type = type;
     
-    if (texture_index < 0 || texture_index >= model.textures.size())
+    const tinygltf::Image* image_ptr = resolveTextureImage(texture_index, model, tex_info);
+    if (!image_ptr)
     {
         return tex_info;
     }
     
+    const auto& image = *image_ptr;
+    const int source_index = model.textures[texture_index].source;
+    
+    if (!image.uri.empty())
+    {
+        // External texture file
+        tex_info.uri = image.uri;
+        tex_info.is_embedded = false;
+        tex_info.handle = loadTextureFromUri(image.uri, config, texture_cache,
+                                             getTextureFormatForType(type, config));
+    }
+    else if (config.load_embedded_textures && !image.image.empty())
+    {
+        // Embedded texture
+        tex_info.uri = "embedded_texture_" + std::to_string(source_index);
+        tex_info.is_embedded = true;
+        tex_info.handle = loadEmbeddedTexture(image, render_api, config);
+        
+        // Cache embedded textures too
+        if (tex_info.handle != INVALID_TEXTURE)
+        {
+            texture_cache[tex_info.uri] = tex_info.handle;
+        }
+    }
+    
+    tex_info.is_loaded = (tex_info.handle != INVALID_TEXTURE);
+    
+    return tex_info;
+}
+
+const tinygltf::Image* GltfMaterialLoader::resolveTextureImage(int texture_index,
+                                                              const tinygltf::Model& model,
+                                                              TextureInfo& tex_info)
+{
+    if (texture_index < 0 || texture_index >= model.textures.size())
+    {
+        return nullptr;
+    }
+    
     const auto& gltf_texture = model.textures[texture_index];
     
     // Get sampler properties
@@ -406,68 +547,158 @@ TextureInfo GltfMaterialLoader::processTexture(int texture_index,
     // Get image source
     if (gltf_texture.source < 0 || gltf_texture.source >= model.images.size())
     {
-        return tex_info;
+        return nullptr;
     }
     
-    const auto& image = model.images[gltf_texture.source];
+    return &model.images[gltf_texture.source];
+}
+
+bool GltfMaterialLoader::processPackedOrmTextures(const tinygltf::Material& gltf_material,
+                                                 const tinygltf::Model& model,
+                                                 const MaterialLoaderConfig& config,
+                                                 MaterialTextureSet& texture_set)
+{
+    const int occlusion_index = gltf_material.occlusionTexture.index;
+    const int metallic_roughness_index = gltf_material.pbrMetallicRoughness.metallicRoughnessTexture.index;
     
-    if (!image.uri.empty())
+    if (occlusion_index < 0 || metallic_roughness_index < 0 ||
+        !isTextureTypeWanted(TextureType::OCCLUSION, config) ||
+        !isTextureTypeWanted(TextureType::METALLIC_ROUGHNESS, config))
     {
-        // External texture file
-        tex_info.uri = image.uri;
-        tex_info.is_embedded = false;
-        tex_info.handle = loadTextureFromUri(image.uri, config, render_api, texture_cache);
+        return false;
     }
-    else if (config.load_embedded_textures && !image.image.empty())
+    
+    TextureInfo occlusion;
+    occlusion.type = TextureType::OCCLUSION;
+    TextureInfo metallic_roughness;
+    metallic_roughness.type = TextureType::METALLIC_ROUGHNESS;
+    
+    const tinygltf::Image* occlusion_image = resolveTextureImage(occlusion_index, model, occlusion);
+    const tinygltf::Image* metallic_roughness_image = resolveTextureImage(metallic_roughness_index, model, metallic_roughness);
+    
+    // Already-packed ORM images (same file) and embedded images load the normal way
+    if (!occlusion_image || !metallic_roughness_image ||
+        occlusion_image->uri.empty() || metallic_roughness_image->uri.empty() ||
+        occlusion_image->uri == metallic_roughness_image->uri)
     {
-        // Embedded texture
-        tex_info.uri = "embedded_texture_" + std::to_string(gltf_texture.source);
-        tex_info.is_embedded = true;
-        tex_info.handle = loadEmbeddedTexture(image, render_api, config);
-        
-        // Cache embedded textures too
-        if (tex_info.handle != INVALID_TEXTURE)
-        {
-            texture_cache[tex_info.uri] = tex_info.handle;
-        }
+        return false;
     }
     
-    tex_info.is_loaded = (tex_info.handle != INVALID_TEXTURE);
+    const std::string occlusion_path = getFullTexturePath(occlusion_image->uri, config.texture_base_path);
+    const std::string metallic_roughness_path = getFullTexturePath(metallic_roughness_image->uri, config.texture_base_path);
     
-    return tex_info;
+    // glTF keeps roughness in G and metallic in B, which is where the packed texture wants them
+    TextureHandle handle = TextureManager::get().acquirePacked(
+        { { occlusion_path, 0 }, { metallic_roughness_path, 1 }, { metallic_roughness_path, 2 } },
+        config.flip_textures_vertically, config.generate_mipmaps, TextureFormat::RGB8);
+    
+    if (handle == INVALID_TEXTURE)
+    {
+        logMessage(config, "Could not pack " + occlusion_image->uri + " with " + metallic_roughness_image->uri +
+                  ", loading them separately");
+        return false;
+    }
+    
+    logMessage(config, "Packed occlusion/roughness/metallic: " + occlusion_image->uri + " + " + metallic_roughness_image->uri);
+    
+    // Both slots hold their own reference to the shared texture
+    TextureManager::get().addRef(handle);
+    
+    occlusion.uri = occlusion_image->uri;
+    occlusion.handle = handle;
+    occlusion.is_loaded = true;
+    occlusion.scale = static_cast<float>(gltf_material.occlusionTexture.strength);
+    
+    metallic_roughness.uri = metallic_roughness_image->uri;
+    metallic_roughness.handle = handle;
+    metallic_roughness.is_loaded = true;
+    
+    texture_set.type_to_index[TextureType::OCCLUSION] = static_cast<int>(texture_set.textures.size());
+    texture_set.textures.push_back(occlusion);
+    texture_set.type_to_index[TextureType::METALLIC_ROUGHNESS] = static_cast<int>(texture_set.textures.size());
+    texture_set.textures.push_back(metallic_roughness);
+    
+    return true;
+}
+
+bool GltfMaterialLoader::processSpecularStrengthTexture(int texture_index,
+                                                       const tinygltf::Model& model,
+                                                       const MaterialLoaderConfig& config,
+                                                       MaterialTextureSet& texture_set)
+{
+    if (texture_index < 0 || !isTextureTypeWanted(TextureType::SPECULAR, config))
+    {
+        return false;
+    }
+    
+    TextureInfo specular;
+    specular.type = TextureType::SPECULAR;
+    
+    const tinygltf::Image* image = resolveTextureImage(texture_index, model, specular);
+    if (!image || image->uri.empty())
+    {
+        return false;
+    }
+    
+    // The extension keeps the strength in alpha; the single-channel SPECULAR
+    // format would keep red, so the alpha channel is packed on its own
+    const std::string path = getFullTexturePath(image->uri, config.texture_base_path);
+    TextureHandle handle = TextureManager::get().acquirePacked(
+        { { path, 3 } }, config.flip_textures_vertically, config.generate_mipmaps, TextureFormat::R8);
+    
+    if (handle == INVALID_TEXTURE)
+    {
+        logMessage(config, "Failed to load specular texture: " + image->uri);
+        return false;
+    }
+    
+    specular.uri = image->uri;
+    specular.handle = handle;
+    specular.is_loaded = true;
+    
+    texture_set.type_to_index[TextureType::SPECULAR] = static_cast<int>(texture_set.textures.size());
+    texture_set.textures.push_back(specular);
+    
+    return true;
 }
 
 TextureHandle GltfMaterialLoader::loadTextureFromUri(const std::string& uri,
                                                     const MaterialLoaderConfig& config,
-                                                    IRenderAPI* render_api,
-                                                    std::map<std::string, TextureHandle>& texture_cache)
+                                                    std::map<std::string, TextureHandle>& texture_cache,
+                                                    TextureFormat format)
 {
+    // The same image used with two storage formats is two different textures
+    const std::string cache_key = (format == TextureFormat::Auto) ?
+        uri : uri + "#" + std::to_string(static_cast<int>(format));
+    
     // Check cache first
     if (config.cache_textures)
     {
-        auto cache_it = texture_cache.find(uri);
+        auto cache_it = texture_cache.find(cache_key);
         if (cache_it != texture_cache.end())
         {
             logMessage(config, "Using cached texture: " + uri);
+            TextureManager::get().addRef(cache_it->second);
             return cache_it->second;
         }
     }
     
-    // Load new texture
+    // Load new texture (the texture manager dedupes across files and loaders)
     std::string full_path = getFullTexturePath(uri, config.texture_base_path);
     
     logMessage(config, "Loading texture: " + full_path);
     
-    TextureHandle handle = render_api->loadTexture(full_path, 
-                                                 config.flip_textures_vertically, 
-                                                 config.generate_mipmaps);
+    TextureHandle handle = TextureManager::get().acquire(full_path, 
+                                                       config.flip_textures_vertically, 
+                                                       config.generate_mipmaps,
+                                                       format);
     
     if (handle != INVALID_TEXTURE)
     {
         logMessage(config, "Successfully loaded texture: " + uri);
         if (config.cache_textures)
         {
-            texture_cache[uri] = handle;
+            texture_cache[cache_key] = handle;
         }
     }
     else
@@ -500,6 +731,22 @@ TextureType GltfMaterialLoader::getTextureTypeFromMaterialProperty(const std::st
     return TextureType::UNKNOWN;
 }
 
+TextureFormat GltfMaterialLoader::getTextureFormatForType(TextureType type, const MaterialLoaderConfig& config)
+{
+    switch (type)
+    {
+    case TextureType::OCCLUSION:
+    case TextureType::SPECULAR:
+        return TextureFormat::R8;   // Single channel data
+    case TextureType::NORMAL:
+        return TextureFormat::RG8;  // X/Y only, Z = sqrt(1 - x^2 - y^2)
+    case TextureType::METALLIC_ROUGHNESS:
+        return TextureFormat::Auto; // Gray gloss maps collapse to one channel, real MR maps keep G/B
+    default:
+        return config.use_16bit_color_formats ? TextureFormat::Auto16 : TextureFormat::Auto;
+    }
+}
+
 std::string GltfMaterialLoader::getFullTexturePath(const std::string& uri, const std::string& base_path)
 {
     if (base_path.empty())
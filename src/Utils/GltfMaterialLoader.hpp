@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <memory>
 #include "Graphics/RenderAPI.hpp"
+#include "GltfDocument.hpp"
 
 // Forward declare tinygltf types
 namespace tinygltf {
@@ -144,6 +145,10 @@ struct MaterialLoaderConfig
     bool load_embedded_textures = false;    // Whether to handle embedded textures
     std::string texture_base_path = "";     // Base path for texture files
     
+    // Texture storage options
+    bool pack_occlusion_roughness_metallic = true;  // Pack AO (R) + roughness (G) + metallic (B) into one texture
+    bool use_16bit_color_formats = false;           // Store color maps as RGB565 / RGBA4 instead of 8 bits per channel
+    
     // Texture filtering options
     std::vector<TextureType> priority_texture_types = {
         TextureType::BASE_COLOR,
@@ -159,7 +164,7 @@ struct MaterialLoadResult
     bool success = false;
     std::string error_message;
     std::vector<GltfMaterial> materials;
-    std::map<std::string, TextureHandle> texture_cache;  // URI -> Handle mapping
+    std::map<std::string, TextureHandle> texture_cache;  // URI -> Handle mapping (handles are owned by TextureManager)
     
     // Statistics
     int total_materials = 0;
@@ -202,17 +207,31 @@ public:
                                            const std::vector<int>& material_indices,
                                            const MaterialLoaderConfig& config = MaterialLoaderConfig());
     
+    // Load from an already parsed document (shared with geometry loading)
+    static MaterialLoadResult loadMaterials(const GltfDocument& document,
+                                           IRenderAPI* render_api,
+                                           const MaterialLoaderConfig& config = MaterialLoaderConfig());
+    
+    static MaterialLoadResult loadMaterials(const GltfDocument& document,
+                                           IRenderAPI* render_api,
+                                           const std::vector<int>& material_indices,
+                                           const MaterialLoaderConfig& config = MaterialLoaderConfig());
+    
     // Utility functions
     static std::vector<std::string> getMaterialNames(const std::string& filename);
     static std::vector<std::string> getTextureUris(const std::string& filename);
     static int getMaterialCount(const std::string& filename);
     
-    // Cleanup textures from a result
+    // Image files loadMaterials would read for this config (external images
+    // only, each once), so they can be decoded ahead of the upload
+    static std::vector<std::string> getTextureFiles(const GltfDocument& document,
+                                                    const MaterialLoaderConfig& config = MaterialLoaderConfig());
+    
+    // Release the texture references held by a result
     static void cleanupMaterialTextures(MaterialLoadResult& result, IRenderAPI* render_api);
 
 private:
     // Internal loading methods
-    static bool loadModel(const std::string& filename, tinygltf::Model& model, std::string& error);
     static MaterialLoadResult processMaterials(const tinygltf::Model& model,
                                              IRenderAPI* render_api,
                                              const MaterialLoaderConfig& config,
@@ -240,10 +259,24 @@ private:
                                     const MaterialLoaderConfig& config,
                                     std::map<std::string, TextureHandle>& texture_cache);
     
+    static bool processPackedOrmTextures(const tinygltf::Material& gltf_material,
+                                       const tinygltf::Model& model,
+                                       const MaterialLoaderConfig& config,
+                                       MaterialTextureSet& texture_set);
+    
+    static bool processSpecularStrengthTexture(int texture_index,
+                                               const tinygltf::Model& model,
+                                               const MaterialLoaderConfig& config,
+                                               MaterialTextureSet& texture_set);
+    
+    static const tinygltf::Image* resolveTextureImage(int texture_index,
+                                                     const tinygltf::Model& model,
+                                                     TextureInfo& tex_info);
+    
     static TextureHandle loadTextureFromUri(const std::string& uri,
                                           const MaterialLoaderConfig& config,
-                                          IRenderAPI* render_api,
-                                          std::map<std::string, TextureHandle>& texture_cache);
+                                          std::map<std::string, TextureHandle>& texture_cache,
+                                          TextureFormat format = TextureFormat::Auto);
     
     static TextureHandle loadEmbeddedTexture(const tinygltf::Image& image,
                                            IRenderAPI* render_api,
@@ -251,6 +284,7 @@ private:
     
     // Utility methods
     static TextureType getTextureTypeFromMaterialProperty(const std::string& property_name);
+    static TextureFormat getTextureFormatForType(TextureType type, const MaterialLoaderConfig& config);
     static std::string getFullTexturePath(const std::string& uri, const std::string& base_path);
     static bool isTextureTypeWanted(TextureType type, const MaterialLoaderConfig& config);
     
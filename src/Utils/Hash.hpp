@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+// Small non-cryptographic 64-bit hashing used for cache keys and content checks
+// of baked assets. Stable across runs and platforms (little-endian).
+
+constexpr uint64_t HASH_SEED = 0x9E3779B97F4A7C15ull;
+
+inline uint64_t hashMix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = HASH_SEED)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    // Two independent lanes so the multiplies of consecutive words overlap
+    uint64_t h0 = seed ^ (size * 0x87C37B91114253D5ull);
+    uint64_t h1 = hashMix(seed + 1);
+
+    while (size >= 16)
+    {
+        uint64_t k0, k1;
+        memcpy(&k0, bytes, 8);
+        memcpy(&k1, bytes + 8, 8);
+        h0 = (h0 ^ hashMix(k0)) * 0x9E3779B97F4A7C15ull;
+        h1 = (h1 ^ hashMix(k1)) * 0xC2B2AE3D27D4EB4Full;
+        bytes += 16;
+        size -= 16;
+    }
+
+    uint64_t tail[2] = { 0, 0 };
+    memcpy(tail, bytes, size);
+    h0 = (h0 ^ hashMix(tail[0])) * 0x9E3779B97F4A7C15ull;
+    h1 = (h1 ^ hashMix(tail[1] ^ size)) * 0xC2B2AE3D27D4EB4Full;
+
+    return hashMix(h0 ^ (h1 >> 29) ^ (h1 << 35));
+}
+
+inline uint64_t hashCombine(uint64_t seed, uint64_t value)
+{
+    return hashMix(seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2)));
+}
+
+inline uint64_t hashString(const std::string& text, uint64_t seed = HASH_SEED)
+{
+    return hashBytes(text.data(), text.size(), seed);
+}
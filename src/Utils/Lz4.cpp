@@ -0,0 +1,204 @@
+#include "Lz4.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    constexpr size_t MIN_MATCH = 4;
+    constexpr size_t LAST_LITERALS = 5;     // The block ends with at least this many literals
+    constexpr size_t MATCH_SAFE_END = 12;   // No match may start in the last 12 bytes
+    constexpr size_t MAX_OFFSET = 65535;
+    constexpr int HASH_BITS = 16;
+
+    inline uint32_t read32(const unsigned char* p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t hashSequence(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // Length beyond the 4-bit token field, as a run of 255s and a final byte
+    inline unsigned char* writeLength(unsigned char* out, size_t length)
+    {
+        while (length >= 255) {
+            *out++ = 255;
+            length -= 255;
+        }
+        *out++ = static_cast<unsigned char>(length);
+        return out;
+    }
+
+    inline unsigned char* writeSequence(unsigned char* out, const unsigned char* literals, size_t literal_length,
+                                        size_t offset, size_t match_length)
+    {
+        unsigned char* token = out++;
+        *token = static_cast<unsigned char>((literal_length >= 15 ? 15 : literal_length) << 4);
+        if (literal_length >= 15) {
+            out = writeLength(out, literal_length - 15);
+        }
+        memcpy(out, literals, literal_length);
+        out += literal_length;
+
+        if (match_length == 0) {
+            return out; // Last sequence: literals only
+        }
+
+        *out++ = static_cast<unsigned char>(offset & 0xFF);
+        *out++ = static_cast<unsigned char>(offset >> 8);
+
+        size_t code = match_length - MIN_MATCH;
+        *token |= static_cast<unsigned char>(code >= 15 ? 15 : code);
+        if (code >= 15) {
+            out = writeLength(out, code - 15);
+        }
+        return out;
+    }
+}
+
+size_t Lz4::compressBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+size_t Lz4::compress(const void* src, size_t size, void* dst, size_t dst_capacity)
+{
+    if (dst_capacity < compressBound(size)) {
+        return 0;
+    }
+
+    const unsigned char* input = static_cast<const unsigned char*>(src);
+    const unsigned char* input_end = input + size;
+    unsigned char* out = static_cast<unsigned char*>(dst);
+
+    const unsigned char* anchor = input;
+    if (size > MATCH_SAFE_END) {
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);    // Position + 1, 0 = empty
+        const unsigned char* match_limit = input_end - MATCH_SAFE_END;
+        const unsigned char* p = input;
+
+        while (p < match_limit) {
+            const uint32_t sequence = read32(p);
+            uint32_t& slot = table[hashSequence(sequence)];
+            const unsigned char* candidate = slot ? input + slot - 1 : nullptr;
+            slot = static_cast<uint32_t>(p - input) + 1;
+
+            if (!candidate || static_cast<size_t>(p - candidate) > MAX_OFFSET || read32(candidate) != sequence) {
+                ++p;
+                continue;
+            }
+
+            // Extend backwards over pending literals, then forwards up to the literal tail
+            while (p > anchor && candidate > input && p[-1] == candidate[-1]) {
+                --p;
+                --candidate;
+            }
+
+            const unsigned char* match_end = p + MIN_MATCH;
+            const unsigned char* extend_limit = input_end - LAST_LITERALS;
+            while (match_end < extend_limit && *match_end == candidate[match_end - p]) {
+                ++match_end;
+            }
+
+            out = writeSequence(out, anchor, static_cast<size_t>(p - anchor), static_cast<size_t>(p - candidate),
+                                static_cast<size_t>(match_end - p));
+
+            // Index one position inside the match so repeats keep matching
+            if (match_end - 2 > p) {
+                table[hashSequence(read32(match_end - 2))] = static_cast<uint32_t>(match_end - 2 - input) + 1;
+            }
+            p = anchor = match_end;
+        }
+    }
+
+    out = writeSequence(out, anchor, static_cast<size_t>(input_end - anchor), 0, 0);
+    return static_cast<size_t>(out - static_cast<unsigned char*>(dst));
+}
+
+size_t Lz4::decompress(const void* src, size_t size, void* dst, size_t dst_capacity)
+{
+    const unsigned char* in = static_cast<const unsigned char*>(src);
+    const unsigned char* in_end = in + size;
+    unsigned char* out = static_cast<unsigned char*>(dst);
+    unsigned char* out_begin = out;
+    unsigned char* out_end = out + dst_capacity;
+
+    while (in < in_end) {
+        const unsigned char token = *in++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15) {
+            unsigned char extra;
+            do {
+                if (in >= in_end) {
+                    return 0;
+                }
+                extra = *in++;
+                literal_length += extra;
+            } while (extra == 255);
+        }
+
+        if (literal_length > static_cast<size_t>(in_end - in) || literal_length > static_cast<size_t>(out_end - out)) {
+            return 0;
+        }
+        memcpy(out, in, literal_length);
+        in += literal_length;
+        out += literal_length;
+
+        if (in == in_end) {
+            break; // The last sequence has no match
+        }
+
+        if (in_end - in < 2) {
+            return 0;
+        }
+        const size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        if (offset == 0 || offset > static_cast<size_t>(out - out_begin)) {
+            return 0;
+        }
+
+        size_t match_length = (token & 15) + MIN_MATCH;
+        if ((token & 15) == 15) {
+            unsigned char extra;
+            do {
+                if (in >= in_end) {
+                    return 0;
+                }
+                extra = *in++;
+                match_length += extra;
+            } while (extra == 255);
+        }
+
+        if (match_length > static_cast<size_t>(out_end - out)) {
+            return 0;
+        }
+
+        // Overlapping copies repeat the pattern, so copy forwards
+        const unsigned char* match = out - offset;
+        if (offset >= 8) {
+            unsigned char* copy_end = out + match_length;
+            while (out + 8 <= copy_end) {
+                memcpy(out, match, 8);
+                out += 8;
+                match += 8;
+            }
+            while (out < copy_end) {
+                *out++ = *match++;
+            }
+        }
+        else {
+            for (size_t i = 0; i < match_length; ++i) {
+                out[i] = match[i];
+            }
+            out += match_length;
+        }
+    }
+
+    return static_cast<size_t>(out - out_begin);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+
+// LZ4 block format (no frame header), compatible with the reference
+// implementation: blocks written here decode with any LZ4 decoder and the
+// other way round. Used for the asset archive, where every block is
+// compressed on its own so blocks can be decompressed in parallel.
+//
+// The compressor is the simple greedy single-probe variant; it trades some
+// ratio for speed and only runs while cooking. The decompressor is
+// bounds checked against both buffers and never writes past dst_capacity.
+class Lz4
+{
+public:
+    // Worst-case compressed size of size input bytes
+    static size_t compressBound(size_t size);
+
+    // Returns the compressed size, or 0 if dst_capacity is too small
+    static size_t compress(const void* src, size_t size, void* dst, size_t dst_capacity);
+
+    // Returns the decompressed size, or 0 on corrupt input or insufficient capacity
+    static size_t decompress(const void* src, size_t size, void* dst, size_t dst_capacity);
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <stddef.h>
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first
+// touch, so data can be used in place without reading it up front.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const { return mapped != nullptr; }
+    const unsigned char* data() const { return mapped; }
+    size_t size() const { return mapped_size; }
+
+private:
+    const unsigned char* mapped = nullptr;
+    size_t mapped_size = 0;
+
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+};
@@ -0,0 +1,326 @@
+#include "MeshAsset.hpp"
+#include "BakedMesh.hpp"
+#include "Hash.hpp"
+#include "ObjLoader.hpp"
+#include "Graphics/Frustum.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+
+namespace
+{
+    uint64_t hashVertices(const vertex* vertices, size_t vertex_count)
+    {
+        return vertices ? hashBytes(vertices, vertex_count * sizeof(vertex)) : 0;
+    }
+}
+
+std::shared_ptr<MeshAsset> MeshAsset::fromOwned(vertex* vertices, size_t vertex_count)
+{
+    auto asset = std::make_shared<MeshAsset>();
+    asset->storage = std::shared_ptr<vertex>(vertices, std::default_delete<vertex[]>());
+    asset->vertices = vertices;
+    asset->vertex_count = vertex_count;
+    asset->content_hash = hashVertices(vertices, vertex_count);
+    return asset;
+}
+
+std::shared_ptr<MeshAsset> MeshAsset::fromBaked(std::shared_ptr<BakedMesh> baked)
+{
+    auto asset = std::make_shared<MeshAsset>();
+    asset->vertices = baked->getVertices();
+    asset->vertex_count = baked->getVertexCount();
+    asset->content_hash = baked->getHeader().vertex_hash;
+
+    // Indexed bakes describe index ranges, which meshes do not draw
+    if (baked->getIndexCount() == 0)
+    {
+        for (size_t i = 0; i < baked->getSubmeshCount(); ++i)
+        {
+            const BakedSubmesh& submesh = baked->getSubmeshes()[i];
+            asset->submeshes.push_back({ submesh.first, submesh.count, submesh.material_index });
+        }
+        asset->sortSubmeshes();
+    }
+
+    asset->storage = std::move(baked);
+    return asset;
+}
+
+std::shared_ptr<MeshAsset> MeshAsset::fromExternal(const vertex* vertices, size_t vertex_count)
+{
+    auto asset = std::make_shared<MeshAsset>();
+    asset->vertices = vertices;
+    asset->vertex_count = vertex_count;
+    asset->content_hash = hashVertices(vertices, vertex_count);
+    return asset;
+}
+
+void MeshAsset::setSubmeshes(const std::vector<GltfPrimitiveRange>& ranges)
+{
+    submeshes.clear();
+    for (const GltfPrimitiveRange& range : ranges)
+    {
+        submeshes.push_back({ range.first_vertex, range.vertex_count, range.material_index });
+    }
+    sortSubmeshes();
+}
+
+void MeshAsset::setNodes(const GltfLoadResult& result)
+{
+    nodes.clear();
+    for (const GltfNodeData& node : result.nodes)
+    {
+        for (size_t i = node.first_primitive; i < node.first_primitive + node.primitive_count; ++i)
+        {
+            const GltfPrimitiveRange& range = result.primitive_ranges[i];
+            if (range.vertex_count == 0)
+            {
+                continue;
+            }
+
+            mesh_node entry;
+            entry.first_vertex = range.first_vertex;
+            entry.vertex_count = range.vertex_count;
+            entry.material_index = range.material_index;
+            entry.transform = node.world_transform;
+            transformBox(node.world_transform, range.bounds_min, range.bounds_max,
+                         entry.bounds_min, entry.bounds_max);
+            nodes.push_back(entry);
+        }
+    }
+
+    std::stable_sort(nodes.begin(), nodes.end(), [](const mesh_node& a, const mesh_node& b)
+    {
+        return a.material_index < b.material_index;
+    });
+}
+
+void MeshAsset::sortSubmeshes()
+{
+    std::stable_sort(submeshes.begin(), submeshes.end(), [](const mesh_submesh& a, const mesh_submesh& b)
+    {
+        return a.material_index < b.material_index;
+    });
+
+    std::vector<mesh_submesh> merged;
+    for (const mesh_submesh& submesh : submeshes)
+    {
+        if (submesh.vertex_count == 0)
+        {
+            continue;
+        }
+
+        if (!merged.empty() && merged.back().material_index == submesh.material_index &&
+            merged.back().first_vertex + merged.back().vertex_count == submesh.first_vertex)
+        {
+            merged.back().vertex_count += submesh.vertex_count;
+        }
+        else
+        {
+            merged.push_back(submesh);
+        }
+    }
+    submeshes = std::move(merged);
+}
+
+MeshAssetManager& MeshAssetManager::get()
+{
+    static MeshAssetManager instance;
+    return instance;
+}
+
+MeshAssetHandle MeshAssetManager::find(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = assets_by_key.find(key);
+    return it != assets_by_key.end() ? it->second.lock() : nullptr;
+}
+
+MeshAssetHandle MeshAssetManager::add(std::shared_ptr<MeshAsset> asset)
+{
+    if (!asset)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    removeExpired();
+
+    // Two threads may have loaded the same key; the first one to register wins
+    if (!asset->key.empty())
+    {
+        auto it = assets_by_key.find(asset->key);
+        if (it != assets_by_key.end())
+        {
+            if (MeshAssetHandle existing = it->second.lock())
+            {
+                return existing;
+            }
+        }
+    }
+
+    // Share the vertices of an identical stream that is still alive
+    bool shared = false;
+    if (asset->storage && asset->vertex_count > 0)
+    {
+        auto range = streams_by_hash.equal_range(asset->content_hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            const StreamEntry& stream = it->second;
+            std::shared_ptr<const void> storage = stream.storage.lock();
+            if (!storage || stream.vertex_count != asset->vertex_count ||
+                memcmp(stream.vertices, asset->vertices, asset->vertex_count * sizeof(vertex)) != 0)
+            {
+                continue;
+            }
+
+            asset->storage = std::move(storage);
+            asset->vertices = stream.vertices;
+            shared = true;
+            break;
+        }
+
+        if (!shared)
+        {
+            StreamEntry stream;
+            stream.storage = asset->storage;
+            stream.vertices = asset->vertices;
+            stream.vertex_count = asset->vertex_count;
+            streams_by_hash.emplace(asset->content_hash, stream);
+        }
+    }
+
+    if (shared)
+    {
+        printf("[Mesh Assets] %s shares %zu vertices with an identical stream\n",
+               asset->key.empty() ? "Mesh" : asset->key.c_str(), asset->vertex_count);
+    }
+
+    MeshAssetHandle handle = std::move(asset);
+    if (!handle->key.empty())
+    {
+        assets_by_key[handle->key] = handle;
+    }
+    return handle;
+}
+
+MeshAssetHandle MeshAssetManager::addBaked(const std::string& key, const std::string& source_path, uint64_t config_hash)
+{
+    return addBaked(key, BakedMesh::openIfCurrent(source_path, config_hash));
+}
+
+MeshAssetHandle MeshAssetManager::addBaked(const std::string& key, std::shared_ptr<BakedMesh> baked)
+{
+    if (!baked)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<MeshAsset> asset = MeshAsset::fromBaked(std::move(baked));
+    asset->key = key;
+    return add(std::move(asset));
+}
+
+MeshAssetHandle MeshAssetManager::addLoaded(const std::string& key, ObjLoadResult& result,
+                                            const std::string& source_path, uint64_t config_hash, bool bake)
+{
+    std::shared_ptr<MeshAsset> asset = MeshAsset::fromOwned(result.vertices, result.vertex_count);
+    asset->key = key;
+    result.vertices = nullptr;
+    result.vertex_count = 0;
+
+    if (bake)
+    {
+        BakedSubmeshSource whole_mesh;
+        whole_mesh.count = static_cast<uint32_t>(asset->vertex_count);
+        BakedMesh::bake(source_path, config_hash, asset->vertices, asset->vertex_count, { whole_mesh });
+    }
+    return add(std::move(asset));
+}
+
+MeshAssetHandle MeshAssetManager::addLoaded(const std::string& key, GltfLoadResult& result,
+                                            const std::string& source_path, uint64_t config_hash, bool bake)
+{
+    std::shared_ptr<MeshAsset> asset = MeshAsset::fromOwned(result.vertices, result.vertex_count);
+    asset->key = key;
+    if (!result.nodes.empty())
+    {
+        asset->setNodes(result);
+    }
+    else
+    {
+        asset->setSubmeshes(result.primitive_ranges);
+    }
+    result.vertices = nullptr;
+    result.vertex_count = 0;
+
+    if (bake && result.nodes.empty())
+    {
+        std::vector<BakedSubmeshSource> submeshes;
+        for (const GltfPrimitiveRange& range : result.primitive_ranges)
+        {
+            BakedSubmeshSource submesh;
+            submesh.first = static_cast<uint32_t>(range.first_vertex);
+            submesh.count = static_cast<uint32_t>(range.vertex_count);
+            submesh.material_index = range.material_index;
+            if (range.material_index >= 0 && range.material_index < (int)result.material_names.size())
+            {
+                submesh.material_name = result.material_names[range.material_index];
+            }
+            submeshes.push_back(submesh);
+        }
+        BakedMesh::bake(source_path, config_hash, asset->vertices, asset->vertex_count, submeshes);
+    }
+    return add(std::move(asset));
+}
+
+std::string MeshAssetManager::makeKey(const std::string& filename, uint64_t config_hash)
+{
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::weakly_canonical(filename, ec);
+    char suffix[24];
+    snprintf(suffix, sizeof(suffix), "|%016llx", static_cast<unsigned long long>(config_hash));
+    return (ec ? filename : path.generic_string()) + suffix;
+}
+
+size_t MeshAssetManager::getAssetCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    removeExpired();
+    return assets_by_key.size();
+}
+
+size_t MeshAssetManager::getVertexMemory()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    removeExpired();
+
+    size_t bytes = 0;
+    for (const auto& entry : streams_by_hash)
+    {
+        bytes += entry.second.vertex_count * sizeof(vertex);
+    }
+    return bytes;
+}
+
+long MeshAssetManager::getRefCount(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = assets_by_key.find(key);
+    return it != assets_by_key.end() ? it->second.use_count() : 0;
+}
+
+void MeshAssetManager::removeExpired()
+{
+    for (auto it = assets_by_key.begin(); it != assets_by_key.end();)
+    {
+        it = it->second.expired() ? assets_by_key.erase(it) : std::next(it);
+    }
+
+    for (auto it = streams_by_hash.begin(); it != streams_by_hash.end();)
+    {
+        it = it->second.storage.expired() ? streams_by_hash.erase(it) : std::next(it);
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+#include "Vertex.hpp"
+#include "GltfLoader.hpp"
+
+class BakedMesh;
+struct ObjLoadResult;
+
+// Vertex range drawn with one material
+struct mesh_submesh
+{
+    size_t first_vertex = 0;
+    size_t vertex_count = 0;
+    int material_index = -1;
+};
+
+// Vertex range drawn with its own transform, relative to the game object.
+// Bounds are in object space so the renderer can cull without touching vertices.
+struct mesh_node
+{
+    size_t first_vertex = 0;
+    size_t vertex_count = 0;
+    int material_index = -1;
+    matrix4f transform;
+    vector3f bounds_min;
+    vector3f bounds_max;
+};
+
+// Geometry of one model: the vertex stream plus its material ranges and
+// scene-graph nodes. Everything per instance (visibility, culling, textures)
+// stays on the mesh component, so any number of components can draw the
+// same asset. Treated as immutable once handed to the MeshAssetManager.
+struct MeshAsset
+{
+    std::string key;                        // Cache key, empty for assets not loaded from a file
+    const vertex* vertices = nullptr;
+    size_t vertex_count = 0;
+    uint64_t content_hash = 0;              // Of the vertex stream
+
+    std::vector<mesh_submesh> submeshes;    // Sorted by material; empty draws the whole stream at once
+    std::vector<mesh_node> nodes;           // When not empty, drawn node by node instead
+
+    // Keeps vertices alive: an owned array or a baked mapping, shared with
+    // every other asset that has the same vertex stream
+    std::shared_ptr<const void> storage;
+
+    // Takes over an array allocated with new[]
+    static std::shared_ptr<MeshAsset> fromOwned(vertex* vertices, size_t vertex_count);
+    static std::shared_ptr<MeshAsset> fromBaked(std::shared_ptr<BakedMesh> baked);
+
+    // Arrays that outlive the asset (e.g. static data), not copied or freed
+    static std::shared_ptr<MeshAsset> fromExternal(const vertex* vertices, size_t vertex_count);
+
+    void setSubmeshes(const std::vector<GltfPrimitiveRange>& ranges);
+
+    // One node per primitive of every glTF node that draws a mesh
+    void setNodes(const GltfLoadResult& result);
+
+    bool isValid() const { return vertices != nullptr && vertex_count > 0; }
+
+private:
+    // Order by material and merge neighbours that continue each other
+    void sortSubmeshes();
+};
+
+using MeshAssetHandle = std::shared_ptr<const MeshAsset>;
+
+// Process-wide cache of mesh assets, keyed by canonical path plus a hash of
+// the loader settings. Handles are reference counted: an asset lives as long
+// as some mesh component holds it and is freed with the last one, after
+// which the next load of that key reads the file again. Assets whose vertex
+// streams are byte-identical share one copy of the vertices even when they
+// come from different files. Thread-safe.
+class MeshAssetManager
+{
+public:
+    static MeshAssetManager& get();
+
+    // Live asset cached under key, or nullptr
+    MeshAssetHandle find(const std::string& key);
+
+    // Register a freshly loaded asset under its key (none for an empty key).
+    // If a live asset already holds the same vertex stream, the new asset
+    // drops its own copy and shares that one.
+    MeshAssetHandle add(std::shared_ptr<MeshAsset> asset);
+
+    // Register an opened .gmesh under key (nullptr for none)
+    MeshAssetHandle addBaked(const std::string& key, std::shared_ptr<BakedMesh> baked);
+
+    // Register the .gmesh cache of source_path under key, or nullptr when it
+    // is missing or was baked from another file or other settings
+    MeshAssetHandle addBaked(const std::string& key, const std::string& source_path, uint64_t config_hash);
+
+    // Register freshly loaded geometry under key. The asset takes over the
+    // result's vertex array, and with bake set writes the .gmesh cache for
+    // source_path. Loads that kept a node hierarchy are not baked, as the
+    // cache has no room for node transforms.
+    MeshAssetHandle addLoaded(const std::string& key, ObjLoadResult& result,
+                              const std::string& source_path, uint64_t config_hash, bool bake);
+    MeshAssetHandle addLoaded(const std::string& key, GltfLoadResult& result,
+                              const std::string& source_path, uint64_t config_hash, bool bake);
+
+    static std::string makeKey(const std::string& filename, uint64_t config_hash);
+
+    // Statistics over live assets
+    size_t getAssetCount();
+    size_t getVertexMemory();   // Bytes of distinct vertex streams
+    long getRefCount(const std::string& key);
+
+private:
+    struct StreamEntry
+    {
+        std::weak_ptr<const void> storage;
+        const vertex* vertices = nullptr;
+        size_t vertex_count = 0;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<const MeshAsset>> assets_by_key;
+    std::unordered_multimap<uint64_t, StreamEntry> streams_by_hash;
+
+    MeshAssetManager() = default;
+    MeshAssetManager(const MeshAssetManager&) = delete;
+    MeshAssetManager& operator=(const MeshAssetManager&) = delete;
+
+    void removeExpired();
+};
@@ -0,0 +1,677 @@
+// The bitstream formats and filters are decoded the way meshoptimizer
+// (https://github.com/zeux/meshoptimizer) decodes them, and this code follows
+// its decoders. It is distributed under meshoptimizer's license:
+//
+// MIT License
+//
+// Copyright (c) 2016-2025 Arseny Kapoulkine
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MeshoptDecoder.hpp"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESHOPT_DECODER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // ------------------------------------------------------------------
+    // Vertex codec
+    // ------------------------------------------------------------------
+
+    constexpr unsigned char VERTEX_HEADER = 0xa0;
+    constexpr size_t VERTEX_BLOCK_BYTES = 8192;
+    constexpr size_t VERTEX_BLOCK_MAX = 256;
+    constexpr size_t TAIL_MIN_SIZE = 32;
+    constexpr size_t BYTE_GROUP_SIZE = 16;
+
+    // The most a single byte group can read: 8 bytes of 4-bit codes plus 16 escapes
+    constexpr size_t BYTE_GROUP_DECODE_LIMIT = 24;
+
+    size_t getVertexBlockSize(size_t stride)
+    {
+        return std::min(VERTEX_BLOCK_MAX, (VERTEX_BLOCK_BYTES / stride) & ~size_t(15));
+    }
+
+    // 16 values of 0, 2, 4 or 8 bits; 2 and 4 bit codes with all bits set are
+    // escapes whose value follows the packed codes
+    template<int Bits>
+    const unsigned char* decodeBitsGroup(const unsigned char* data, unsigned char* out)
+    {
+        constexpr int CODES_PER_BYTE = 8 / Bits;
+        constexpr unsigned char ESCAPE = (1 << Bits) - 1;
+
+#ifdef MESHOPT_DECODER_SSE2
+        // Unpack all 16 codes at once; most groups have no escapes
+        __m128i codes;
+        if (Bits == 2) {
+            uint32_t packed;
+            memcpy(&packed, data, sizeof(packed));
+            __m128i bytes = _mm_cvtsi32_si128(static_cast<int>(packed));
+            bytes = _mm_unpacklo_epi8(bytes, bytes);
+            bytes = _mm_unpacklo_epi16(bytes, bytes);   // Every byte 4 times
+
+            const __m128i mask = _mm_set1_epi8(3);
+            __m128i s6 = _mm_and_si128(_mm_srli_epi16(bytes, 6), mask);
+            __m128i s4 = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+            __m128i s2 = _mm_and_si128(_mm_srli_epi16(bytes, 2), mask);
+            __m128i s0 = _mm_and_si128(bytes, mask);
+            codes = _mm_or_si128(
+                _mm_or_si128(_mm_and_si128(s6, _mm_set1_epi32(0x000000FF)), _mm_and_si128(s4, _mm_set1_epi32(0x0000FF00))),
+                _mm_or_si128(_mm_and_si128(s2, _mm_set1_epi32(0x00FF0000)), _mm_and_si128(s0, _mm_set1_epi32(static_cast<int>(0xFF000000)))));
+        }
+        else {
+            __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+            bytes = _mm_unpacklo_epi8(bytes, bytes);    // Every byte twice
+
+            const __m128i mask = _mm_set1_epi8(15);
+            __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+            __m128i low = _mm_and_si128(bytes, mask);
+            codes = _mm_or_si128(_mm_and_si128(high, _mm_set1_epi16(0x00FF)), _mm_andnot_si128(_mm_set1_epi16(0x00FF), low));
+        }
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(codes, _mm_set1_epi8(static_cast<char>(ESCAPE)))) == 0) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), codes);
+            return data + BYTE_GROUP_SIZE / CODES_PER_BYTE;
+        }
+#endif
+
+        const unsigned char* escapes = data + BYTE_GROUP_SIZE / CODES_PER_BYTE;
+        for (size_t i = 0; i < BYTE_GROUP_SIZE / CODES_PER_BYTE; ++i) {
+            unsigned char codes = data[i];
+            for (int j = 0; j < CODES_PER_BYTE; ++j) {
+                unsigned char code = codes >> (8 - Bits);
+                codes = static_cast<unsigned char>(codes << Bits);
+                *out++ = code == ESCAPE ? *escapes : code;
+                escapes += code == ESCAPE;
+            }
+        }
+        return escapes;
+    }
+
+    // count is a multiple of 16
+    const unsigned char* decodeBytes(const unsigned char* data, const unsigned char* end, unsigned char* out, size_t count)
+    {
+        const size_t group_count = count / BYTE_GROUP_SIZE;
+        const size_t header_size = (group_count + 3) / 4;
+        if (static_cast<size_t>(end - data) < header_size) {
+            return nullptr;
+        }
+
+        const unsigned char* header = data;
+        data += header_size;
+
+        for (size_t group = 0; group < group_count; ++group) {
+            if (static_cast<size_t>(end - data) < BYTE_GROUP_DECODE_LIMIT) {
+                return nullptr;
+            }
+
+            unsigned char* group_out = out + group * BYTE_GROUP_SIZE;
+            switch ((header[group / 4] >> ((group % 4) * 2)) & 3) {
+            case 0:
+                memset(group_out, 0, BYTE_GROUP_SIZE);
+                break;
+            case 1:
+                data = decodeBitsGroup<2>(data, group_out);
+                break;
+            case 2:
+                data = decodeBitsGroup<4>(data, group_out);
+                break;
+            default:
+                memcpy(group_out, data, BYTE_GROUP_SIZE);
+                data += BYTE_GROUP_SIZE;
+                break;
+            }
+        }
+        return data;
+    }
+
+    inline unsigned char unzigzag8(unsigned char v)
+    {
+        return static_cast<unsigned char>((0 - (v & 1)) ^ (v >> 1));
+    }
+
+#ifdef MESHOPT_DECODER_SSE2
+    // Zigzag deltas of 16 vertices to values, continuing from running (the
+    // previous value in every byte); running becomes the last value
+    inline __m128i decodeDeltaGroup(const unsigned char* deltas, __m128i& running)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas));
+        __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi8(1)));
+        __m128i d = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(v, 1), _mm_set1_epi8(127)), sign);
+
+        // Inclusive prefix sum over the 16 bytes
+        d = _mm_add_epi8(d, _mm_slli_si128(d, 1));
+        d = _mm_add_epi8(d, _mm_slli_si128(d, 2));
+        d = _mm_add_epi8(d, _mm_slli_si128(d, 4));
+        d = _mm_add_epi8(d, _mm_slli_si128(d, 8));
+        d = _mm_add_epi8(d, running);
+
+        __m128i high = _mm_unpackhi_epi8(d, d);
+        running = _mm_shuffle_epi32(_mm_unpackhi_epi16(high, high), 0xFF);
+        return d;
+    }
+#endif
+
+    // Undo the zigzag deltas of four consecutive vertex bytes and write them
+    // into the interleaved output, continuing from last
+    void decodeDeltas(const unsigned char (*deltas)[VERTEX_BLOCK_MAX], size_t count,
+                      unsigned char* out, size_t stride, unsigned char* last)
+    {
+        size_t i = 0;
+
+#ifdef MESHOPT_DECODER_SSE2
+        if (count >= BYTE_GROUP_SIZE) {
+            __m128i running[4];
+            for (int c = 0; c < 4; ++c) {
+                running[c] = _mm_set1_epi8(static_cast<char>(last[c]));
+            }
+
+            alignas(16) unsigned char values[64];
+            for (; i + BYTE_GROUP_SIZE <= count; i += BYTE_GROUP_SIZE) {
+                __m128i r0 = decodeDeltaGroup(deltas[0] + i, running[0]);
+                __m128i r1 = decodeDeltaGroup(deltas[1] + i, running[1]);
+                __m128i r2 = decodeDeltaGroup(deltas[2] + i, running[2]);
+                __m128i r3 = decodeDeltaGroup(deltas[3] + i, running[3]);
+
+                // Transpose to four bytes per vertex
+                __m128i r01l = _mm_unpacklo_epi8(r0, r1);
+                __m128i r01h = _mm_unpackhi_epi8(r0, r1);
+                __m128i r23l = _mm_unpacklo_epi8(r2, r3);
+                __m128i r23h = _mm_unpackhi_epi8(r2, r3);
+                _mm_store_si128(reinterpret_cast<__m128i*>(values + 0), _mm_unpacklo_epi16(r01l, r23l));
+                _mm_store_si128(reinterpret_cast<__m128i*>(values + 16), _mm_unpackhi_epi16(r01l, r23l));
+                _mm_store_si128(reinterpret_cast<__m128i*>(values + 32), _mm_unpacklo_epi16(r01h, r23h));
+                _mm_store_si128(reinterpret_cast<__m128i*>(values + 48), _mm_unpackhi_epi16(r01h, r23h));
+
+                for (size_t j = 0; j < BYTE_GROUP_SIZE; ++j) {
+                    memcpy(out + (i + j) * stride, values + j * 4, 4);
+                }
+            }
+
+            for (int c = 0; c < 4; ++c) {
+                last[c] = static_cast<unsigned char>(_mm_cvtsi128_si32(running[c]));
+            }
+        }
+#endif
+
+        for (; i < count; ++i) {
+            for (int c = 0; c < 4; ++c) {
+                last[c] = static_cast<unsigned char>(last[c] + unzigzag8(deltas[c][i]));
+                out[i * stride + c] = last[c];
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Index codecs
+    // ------------------------------------------------------------------
+
+    constexpr unsigned char INDEX_HEADER = 0xe0;
+    constexpr unsigned char SEQUENCE_HEADER = 0xd0;
+
+    inline unsigned int decodeVByte(const unsigned char*& data)
+    {
+        unsigned char lead = *data++;
+        if (lead < 128) {
+            return lead;
+        }
+
+        unsigned int result = lead & 127;
+        unsigned int shift = 7;
+        for (int i = 0; i < 4; ++i) {
+            unsigned char group = *data++;
+            result |= static_cast<unsigned int>(group & 127) << shift;
+            shift += 7;
+            if (group < 128) {
+                break;
+            }
+        }
+        return result;
+    }
+
+    inline unsigned int decodeIndex(const unsigned char*& data, unsigned int last)
+    {
+        unsigned int v = decodeVByte(data);
+        unsigned int d = (v >> 1) ^ (0u - (v & 1));
+        return last + d;
+    }
+
+    inline void writeIndex(void* destination, size_t i, size_t index_size, unsigned int index)
+    {
+        unsigned char* out = static_cast<unsigned char*>(destination) + i * index_size;
+        if (index_size == 2) {
+            uint16_t value = static_cast<uint16_t>(index);
+            memcpy(out, &value, sizeof(value));
+        }
+        else {
+            uint32_t value = index;
+            memcpy(out, &value, sizeof(value));
+        }
+    }
+
+    // Both FIFOs hold 16 entries and are indexed backwards from the write position
+    struct IndexFifos
+    {
+        unsigned int edges[16][2];
+        unsigned int vertices[16];
+        size_t edge_offset = 0;
+        size_t vertex_offset = 0;
+
+        IndexFifos()
+        {
+            memset(edges, -1, sizeof(edges));
+            memset(vertices, -1, sizeof(vertices));
+        }
+
+        void pushEdge(unsigned int a, unsigned int b)
+        {
+            edges[edge_offset][0] = a;
+            edges[edge_offset][1] = b;
+            edge_offset = (edge_offset + 1) & 15;
+        }
+
+        void pushVertex(unsigned int v, bool advance = true)
+        {
+            vertices[vertex_offset] = v;
+            vertex_offset = (vertex_offset + advance) & 15;
+        }
+    };
+
+    // ------------------------------------------------------------------
+    // Filters
+    // ------------------------------------------------------------------
+
+    template<typename T>
+    inline T load(const unsigned char* p)
+    {
+        T value;
+        memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    inline void store(unsigned char* p, T value)
+    {
+        memcpy(p, &value, sizeof(T));
+    }
+
+    inline int roundToInt(float value)
+    {
+        return static_cast<int>(value + (value >= 0.0f ? 0.5f : -0.5f));
+    }
+
+    // x and y are octahedral coordinates; z holds the scale that stands for 1
+    template<typename T>
+    void decodeOctahedral(unsigned char* data, size_t count)
+    {
+        const float max = static_cast<float>((1 << (sizeof(T) * 8 - 1)) - 1);
+
+        for (size_t i = 0; i < count; ++i) {
+            unsigned char* element = data + i * 4 * sizeof(T);
+            float x = static_cast<float>(load<T>(element));
+            float y = static_cast<float>(load<T>(element + sizeof(T)));
+            float z = static_cast<float>(load<T>(element + 2 * sizeof(T))) - fabsf(x) - fabsf(y);
+
+            // Unfold the lower hemisphere
+            float t = z >= 0.0f ? 0.0f : z;
+            x += x >= 0.0f ? t : -t;
+            y += y >= 0.0f ? t : -t;
+
+            float s = max / sqrtf(x * x + y * y + z * z);
+            store<T>(element, static_cast<T>(roundToInt(x * s)));
+            store<T>(element + sizeof(T), static_cast<T>(roundToInt(y * s)));
+            store<T>(element + 2 * sizeof(T), static_cast<T>(roundToInt(z * s)));
+        }
+    }
+
+    // Three components plus the index of the dropped (largest) one and the scale
+    void decodeQuaternion(unsigned char* data, size_t count)
+    {
+        const float scale = 1.0f / sqrtf(2.0f);
+
+        for (size_t i = 0; i < count; ++i) {
+            unsigned char* element = data + i * 8;
+            int16_t packed = load<int16_t>(element + 6);
+            float ss = scale / static_cast<float>(packed | 3);
+
+            float x = load<int16_t>(element) * ss;
+            float y = load<int16_t>(element + 2) * ss;
+            float z = load<int16_t>(element + 4) * ss;
+            float ww = 1.0f - x * x - y * y - z * z;
+            float w = sqrtf(ww >= 0.0f ? ww : 0.0f);
+
+            int qc = packed & 3;
+            store<int16_t>(element + ((qc + 1) & 3) * 2, static_cast<int16_t>(roundToInt(x * 32767.0f)));
+            store<int16_t>(element + ((qc + 2) & 3) * 2, static_cast<int16_t>(roundToInt(y * 32767.0f)));
+            store<int16_t>(element + ((qc + 3) & 3) * 2, static_cast<int16_t>(roundToInt(z * 32767.0f)));
+            store<int16_t>(element + qc * 2, static_cast<int16_t>(static_cast<int>(w * 32767.0f + 0.5f)));
+        }
+    }
+
+    // ldexp(mantissa, exponent) for every 32-bit value
+    void decodeExponential(unsigned char* data, size_t count)
+    {
+        size_t i = 0;
+
+#ifdef MESHOPT_DECODER_SSE2
+        for (; i + 4 <= count; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+            __m128i mantissa = _mm_srai_epi32(_mm_slli_epi32(v, 8), 8);
+            __m128i exponent = _mm_srai_epi32(v, 24);
+            __m128 power = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23));
+            __m128 result = _mm_mul_ps(power, _mm_cvtepi32_ps(mantissa));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i * 4), _mm_castps_si128(result));
+        }
+#endif
+
+        for (; i < count; ++i) {
+            uint32_t v = load<uint32_t>(data + i * 4);
+            int32_t mantissa = static_cast<int32_t>(v << 8) >> 8;
+            int32_t exponent = static_cast<int32_t>(v) >> 24;
+
+            uint32_t power_bits = static_cast<uint32_t>(exponent + 127) << 23;
+            float power;
+            memcpy(&power, &power_bits, sizeof(power));
+            store<float>(data + i * 4, power * static_cast<float>(mantissa));
+        }
+    }
+}
+
+bool MeshoptDecoder::parseMode(const std::string& name, MeshoptMode& mode)
+{
+    if (name == "ATTRIBUTES") {
+        mode = MeshoptMode::Attributes;
+    }
+    else if (name == "TRIANGLES") {
+        mode = MeshoptMode::Triangles;
+    }
+    else if (name == "INDICES") {
+        mode = MeshoptMode::Indices;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+bool MeshoptDecoder::parseFilter(const std::string& name, MeshoptFilter& filter)
+{
+    if (name.empty() || name == "NONE") {
+        filter = MeshoptFilter::None;
+    }
+    else if (name == "OCTAHEDRAL") {
+        filter = MeshoptFilter::Octahedral;
+    }
+    else if (name == "QUATERNION") {
+        filter = MeshoptFilter::Quaternion;
+    }
+    else if (name == "EXPONENTIAL") {
+        filter = MeshoptFilter::Exponential;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+bool MeshoptDecoder::decode(void* destination, size_t count, size_t stride, const unsigned char* data, size_t size,
+                            MeshoptMode mode, MeshoptFilter filter)
+{
+    bool decoded = false;
+    switch (mode) {
+    case MeshoptMode::Attributes:
+        decoded = decodeVertexBuffer(destination, count, stride, data, size);
+        break;
+    case MeshoptMode::Triangles:
+        decoded = decodeIndexBuffer(destination, count, stride, data, size);
+        break;
+    case MeshoptMode::Indices:
+        decoded = decodeIndexSequence(destination, count, stride, data, size);
+        break;
+    }
+
+    // Filters only apply to attributes
+    if (!decoded || filter == MeshoptFilter::None) {
+        return decoded;
+    }
+    return mode == MeshoptMode::Attributes && applyFilter(destination, count, stride, filter);
+}
+
+bool MeshoptDecoder::decodeVertexBuffer(void* destination, size_t count, size_t stride, const unsigned char* data, size_t size)
+{
+    if (stride == 0 || stride > VERTEX_BLOCK_MAX || stride % 4 != 0) {
+        return false;
+    }
+
+    // Header, blocks, then the first vertex right-aligned in a tail of at least 32 bytes
+    const size_t tail_size = std::max(stride, TAIL_MIN_SIZE);
+    if (size < 1 + tail_size || (data[0] & 0xf0) != VERTEX_HEADER || (data[0] & 0x0f) != 0) {
+        return false;
+    }
+
+    const unsigned char* end = data + size;
+    unsigned char last_vertex[VERTEX_BLOCK_MAX];
+    memcpy(last_vertex, end - stride, stride);
+
+    unsigned char* out = static_cast<unsigned char*>(destination);
+    const size_t block_size = getVertexBlockSize(stride);
+    unsigned char deltas[4][VERTEX_BLOCK_MAX];
+
+    const unsigned char* p = data + 1;
+    for (size_t first = 0; first < count; first += block_size) {
+        const size_t block_count = std::min(block_size, count - first);
+        const size_t aligned_count = (block_count + BYTE_GROUP_SIZE - 1) & ~(BYTE_GROUP_SIZE - 1);
+
+        // The stride is a multiple of 4, so bytes are decoded four at a time
+        for (size_t k = 0; k < stride; k += 4) {
+            for (size_t c = 0; c < 4; ++c) {
+                p = decodeBytes(p, end, deltas[c], aligned_count);
+                if (!p) {
+                    return false;
+                }
+            }
+            decodeDeltas(deltas, block_count, out + first * stride + k, stride, last_vertex + k);
+        }
+    }
+
+    return static_cast<size_t>(end - p) == tail_size;
+}
+
+bool MeshoptDecoder::decodeIndexBuffer(void* destination, size_t count, size_t index_size, const unsigned char* data, size_t size)
+{
+    if (count % 3 != 0 || (index_size != 2 && index_size != 4)) {
+        return false;
+    }
+
+    // One code per triangle, then the triangle data, then a 16-byte codeaux table
+    if (size < 1 + count / 3 + 16 || (data[0] & 0xf0) != INDEX_HEADER) {
+        return false;
+    }
+
+    const int version = data[0] & 0x0f;
+    if (version > 1) {
+        return false;
+    }
+
+    IndexFifos fifos;
+    unsigned int next = 0;
+    unsigned int last = 0;
+    const int fec_max = version >= 1 ? 13 : 15;
+
+    const unsigned char* code = data + 1;
+    const unsigned char* p = code + count / 3;
+    const unsigned char* safe_end = data + size - 16;
+    const unsigned char* codeaux_table = safe_end;
+
+    for (size_t i = 0; i < count; i += 3) {
+        // A triangle reads at most 16 bytes, which the codeaux table leaves room for
+        if (p > safe_end) {
+            return false;
+        }
+
+        unsigned char codetri = *code++;
+        unsigned int a, b, c;
+
+        if (codetri < 0xf0) {
+            // Edge from the FIFO plus a vertex from the FIFO, a new one or a free index
+            const unsigned int* edge = fifos.edges[(fifos.edge_offset - 1 - (codetri >> 4)) & 15];
+            a = edge[0];
+            b = edge[1];
+
+            int fec = codetri & 15;
+            if (fec < fec_max) {
+                bool is_new = fec == 0;
+                c = is_new ? next : fifos.vertices[(fifos.vertex_offset - 1 - fec) & 15];
+                next += is_new;
+                fifos.pushVertex(c, is_new);
+            }
+            else {
+                // 13 and 14 step the last free index by -1 and +1
+                last = c = fec != 15 ? last + (fec - (fec ^ 3)) : decodeIndex(p, last);
+                fifos.pushVertex(c);
+            }
+
+            fifos.pushEdge(c, b);
+            fifos.pushEdge(a, c);
+        }
+        else {
+            int fea, feb, fec;
+            if (codetri < 0xfe) {
+                unsigned char codeaux = codeaux_table[codetri & 15];
+                fea = 0;
+                feb = codeaux >> 4;
+                fec = codeaux & 15;
+            }
+            else {
+                unsigned char codeaux = *p++;
+                fea = codetri == 0xfe ? 0 : 15;
+                feb = codeaux >> 4;
+                fec = codeaux & 15;
+
+                if (codeaux == 0) {
+                    next = 0; // Restart
+                }
+            }
+
+            // next advances for all three vertices before any free index is read
+            a = fea == 0 ? next++ : 0;
+            b = feb == 0 ? next++ : feb == 15 ? 0 : fifos.vertices[(fifos.vertex_offset - feb) & 15];
+            c = fec == 0 ? next++ : fec == 15 ? 0 : fifos.vertices[(fifos.vertex_offset - fec) & 15];
+
+            if (fea == 15) {
+                last = a = decodeIndex(p, last);
+            }
+            if (feb == 15) {
+                last = b = decodeIndex(p, last);
+            }
+            if (fec == 15) {
+                last = c = decodeIndex(p, last);
+            }
+
+            fifos.pushVertex(a);
+            fifos.pushVertex(b, feb == 0 || feb == 15);
+            fifos.pushVertex(c, fec == 0 || fec == 15);
+
+            fifos.pushEdge(b, a);
+            fifos.pushEdge(c, b);
+            fifos.pushEdge(a, c);
+        }
+
+        writeIndex(destination, i + 0, index_size, a);
+        writeIndex(destination, i + 1, index_size, b);
+        writeIndex(destination, i + 2, index_size, c);
+    }
+
+    // All triangle data consumed, right up to the codeaux table
+    return p == safe_end;
+}
+
+bool MeshoptDecoder::decodeIndexSequence(void* destination, size_t count, size_t index_size, const unsigned char* data, size_t size)
+{
+    if (index_size != 2 && index_size != 4) {
+        return false;
+    }
+
+    // At least one byte per index and a 4-byte tail
+    if (size < 1 + count + 4 || (data[0] & 0xf0) != SEQUENCE_HEADER || (data[0] & 0x0f) > 1) {
+        return false;
+    }
+
+    const unsigned char* p = data + 1;
+    const unsigned char* safe_end = data + size - 4;
+    unsigned int last[2] = {};
+
+    for (size_t i = 0; i < count; ++i) {
+        // An index reads at most 5 bytes, which the tail leaves room for
+        if (p >= safe_end) {
+            return false;
+        }
+
+        // Low bit picks one of two baselines, the rest is a zigzag delta
+        unsigned int v = decodeVByte(p);
+        unsigned int baseline = v & 1;
+        v >>= 1;
+
+        unsigned int index = last[baseline] + ((v >> 1) ^ (0u - (v & 1)));
+        last[baseline] = index;
+        writeIndex(destination, i, index_size, index);
+    }
+
+    return p == safe_end;
+}
+
+bool MeshoptDecoder::applyFilter(void* data, size_t count, size_t stride, MeshoptFilter filter)
+{
+    unsigned char* bytes = static_cast<unsigned char*>(data);
+
+    switch (filter) {
+    case MeshoptFilter::None:
+        return true;
+    case MeshoptFilter::Octahedral:
+        if (stride == 4) {
+            decodeOctahedral<int8_t>(bytes, count);
+            return true;
+        }
+        if (stride == 8) {
+            decodeOctahedral<int16_t>(bytes, count);
+            return true;
+        }
+        return false;
+    case MeshoptFilter::Quaternion:
+        if (stride != 8) {
+            return false;
+        }
+        decodeQuaternion(bytes, count);
+        return true;
+    case MeshoptFilter::Exponential:
+        if (stride % 4 != 0) {
+            return false;
+        }
+        decodeExponential(bytes, count * stride / 4);
+        return true;
+    }
+    return false;
+}
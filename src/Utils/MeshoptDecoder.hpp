@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <stddef.h>
+
+// Buffer view modes and filters of EXT_meshopt_compression
+enum class MeshoptMode
+{
+    Attributes,     // Vertex codec, byte stride multiple of 4
+    Triangles,      // Index codec for triangle lists, 2 or 4 byte indices
+    Indices         // Index sequence codec, 2 or 4 byte indices
+};
+
+enum class MeshoptFilter
+{
+    None,
+    Octahedral,     // Unit vectors as 4 x int8 or 4 x int16
+    Quaternion,     // Unit quaternions as 4 x int16
+    Exponential     // Floats as 24-bit mantissa + 8-bit exponent
+};
+
+// Decoder for the bitstreams of EXT_meshopt_compression (vertex codec
+// version 0, index codecs versions 0 and 1), as written by gltfpack. Based
+// on meshoptimizer's decoders, see the license in MeshoptDecoder.cpp.
+//
+// The vertex codec stores every byte of the vertex as its own delta stream in
+// blocks of up to 256 vertices. With SSE2, byte groups without escapes unpack
+// in a few instructions, and deltas are undone for four bytes of 16 vertices
+// at a time and transposed straight into the interleaved output. The
+// exponential filter runs with SSE2 as well; the other filters and the index
+// codecs are scalar. Streams are bounds checked throughout, so a
+// truncated or corrupt buffer makes decode() fail instead of reading past it.
+class MeshoptDecoder
+{
+public:
+    static bool parseMode(const std::string& name, MeshoptMode& mode);
+    static bool parseFilter(const std::string& name, MeshoptFilter& filter);
+
+    // Decode count elements of stride bytes from data into destination, which
+    // must hold count * stride bytes, then apply the filter in place
+    static bool decode(void* destination, size_t count, size_t stride, const unsigned char* data, size_t size,
+                       MeshoptMode mode, MeshoptFilter filter = MeshoptFilter::None);
+
+    static bool decodeVertexBuffer(void* destination, size_t count, size_t stride, const unsigned char* data, size_t size);
+    static bool decodeIndexBuffer(void* destination, size_t count, size_t index_size, const unsigned char* data, size_t size);
+    static bool decodeIndexSequence(void* destination, size_t count, size_t index_size, const unsigned char* data, size_t size);
+    static bool applyFilter(void* data, size_t count, size_t stride, MeshoptFilter filter);
+};
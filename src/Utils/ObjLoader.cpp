@@ -1,220 +1,643 @@
 #include "ObjLoader.hpp"
+#include "AssetFile.hpp"
+#include "ThreadPool.hpp"
 #include "tiny_obj_loader.h"
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
 #include <cmath>
+#include <charconv>
+#include <algorithm>
+#include <map>
+#include <sstream>
 
-void ObjLoader::logMessage(const std::string& message, bool verbose)
+namespace
 {
-    if (verbose)
+    // Face corner with zero-based attribute indices, -1 when absent
+    struct ObjCorner
     {
-        printf("[OBJ Loader] %s\n", message.c_str());
-    }
-}
+        int32_t position;
+        int32_t texcoord;
+        int32_t normal;
+    };
 
-void ObjLoader::logError(const std::string& message)
-{
-    printf("[OBJ Loader ERROR] %s\n", message.c_str());
-}
+    // One line-aligned slice of the file. Attribute lines are parsed straight
+    // into the shared arrays at this chunk's base offsets; faces are kept
+    // here until every chunk's share of the output is known.
+    struct ObjChunk
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
 
-void ObjLoader::logWarning(const std::string& message)
-{
-    printf("[OBJ Loader WARNING] %s\n", message.c_str());
-}
+        size_t position_count = 0;
+        size_t normal_count = 0;
+        size_t texcoord_count = 0;
+        size_t position_base = 0;
+        size_t normal_base = 0;
+        size_t texcoord_base = 0;
 
-ObjLoadResult ObjLoader::loadObj(const std::string& filename, const ObjLoaderConfig& config)
-{
-    ObjLoadResult result;
-    
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    
-    // Configure the OBJ reader for optimal performance
-    tinyobj::ObjReaderConfig reader_config;
-    reader_config.mtl_search_path = config.mtl_search_path;
-    reader_config.triangulate = config.triangulate;
-    reader_config.vertex_color = false;  // Skip vertex colors for performance
-    
-    tinyobj::ObjReader reader;
-    
-    logMessage("Loading OBJ file: " + filename, config.verbose_logging);
-    
-    if (!reader.ParseFromFile(filename, reader_config))
+        std::vector<ObjCorner> corners;
+        std::vector<uint32_t> face_sizes;   // Corners per kept face
+        size_t skipped_faces = 0;
+        size_t output_count = 0;            // Vertices this chunk produces
+        size_t output_base = 0;
+
+        std::string error;
+    };
+
+    struct ObjData
     {
-        if (!reader.Error().empty())
-        {
-            result.error_message = "Failed to parse OBJ file: " + reader.Error();
-            logError(result.error_message);
-        }
-        else
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> texcoords;
+        std::vector<ObjChunk> chunks;
+        size_t output_count = 0;
+        size_t skipped_faces = 0;
+    };
+
+    enum class ObjLineType
+    {
+        Other,
+        Position,
+        Normal,
+        TexCoord,
+        Face
+    };
+
+    constexpr size_t OBJ_MIN_CHUNK_SIZE = 256 * 1024;
+
+    inline bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline const char* skipBlanks(const char* p, const char* end)
+    {
+        while (p < end && isBlank(*p))
         {
-            result.error_message = "Failed to parse OBJ file: Unknown error";
-            logError(result.error_message);
+            ++p;
         }
-        return result;
+        return p;
     }
-    
-    if (!reader.Warning().empty())
+
+    inline const char* findLineEnd(const char* p, const char* end)
     {
-        logWarning("OBJ loading warning: " + reader.Warning());
+        const void* newline = memchr(p, '\n', static_cast<size_t>(end - p));
+        return newline ? static_cast<const char*>(newline) : end;
     }
-    
-    // Get parsed data
-    attrib = reader.GetAttrib();
-    shapes = reader.GetShapes();
-    if (config.load_materials)
+
+    // Identify the line and move p past its keyword
+    ObjLineType classifyLine(const char*& p, const char* line_end)
     {
-        materials = reader.GetMaterials();
+        p = skipBlanks(p, line_end);
+        if (line_end - p < 2)
+        {
+            return ObjLineType::Other;
+        }
+
+        if (p[0] == 'v')
+        {
+            if (isBlank(p[1]))
+            {
+                p += 2;
+                return ObjLineType::Position;
+            }
+            if (line_end - p >= 3 && isBlank(p[2]))
+            {
+                if (p[1] == 'n')
+                {
+                    p += 3;
+                    return ObjLineType::Normal;
+                }
+                if (p[1] == 't')
+                {
+                    p += 3;
+                    return ObjLineType::TexCoord;
+                }
+            }
+        }
+        else if (p[0] == 'f' && isBlank(p[1]))
+        {
+            p += 2;
+            return ObjLineType::Face;
+        }
+
+        return ObjLineType::Other;
     }
-    
-    // Validate input data
-    if (attrib.vertices.empty())
+
+    // Parse up to count floats; missing or malformed values read as zero
+    void parseFloats(const char* p, const char* line_end, float* out, int count)
     {
-        result.error_message = "No vertex data found in OBJ file";
-        logError(result.error_message);
-        return result;
+        for (int i = 0; i < count; ++i)
+        {
+            out[i] = 0.0f;
+            p = skipBlanks(p, line_end);
+            if (p >= line_end)
+            {
+                continue;
+            }
+
+            if (*p == '+')
+            {
+                ++p;
+            }
+
+            auto parsed = std::from_chars(p, line_end, out[i]);
+            if (parsed.ec != std::errc())
+            {
+                out[i] = 0.0f;
+                while (p < line_end && !isBlank(*p))
+                {
+                    ++p;
+                }
+            }
+            else
+            {
+                p = parsed.ptr;
+            }
+        }
     }
-    
-    if (shapes.empty())
+
+    // One face index. OBJ indices are 1-based, negative ones count back from
+    // the attributes read so far and 0 means absent.
+    const char* parseIndex(const char* p, const char* end, size_t parsed_so_far, int32_t& index, bool& valid)
     {
-        result.error_message = "No shapes found in OBJ file";
-        logError(result.error_message);
-        return result;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative = (*p == '-');
+            ++p;
+        }
+
+        int64_t value = 0;
+        const char* digits = p;
+        while (p < end && *p >= '0' && *p <= '9' && value <= INT32_MAX)
+        {
+            value = value * 10 + (*p - '0');
+            ++p;
+        }
+
+        if (p == digits || value > INT32_MAX)
+        {
+            valid = false;
+            index = -1;
+            return p;
+        }
+
+        if (value == 0)
+        {
+            index = -1;
+        }
+        else if (negative)
+        {
+            int64_t resolved = static_cast<int64_t>(parsed_so_far) - value;
+            valid = valid && resolved >= 0;
+            index = resolved >= 0 ? static_cast<int32_t>(resolved) : -1;
+        }
+        else
+        {
+            index = static_cast<int32_t>(value - 1);
+        }
+        return p;
     }
-    
-    // Pre-calculate total vertex count for single allocation
-    size_t total_vertices = 0;
-    for (const auto& shape : shapes)
+
+    size_t outputVerticesForFace(size_t corner_count, bool triangulate)
     {
-        total_vertices += shape.mesh.indices.size();
+        return triangulate ? (corner_count - 2) * 3 : corner_count;
     }
-    
-    if (total_vertices == 0)
+
+    // Pass 1: count attribute lines so every chunk knows where its data goes
+    void countChunk(ObjChunk& chunk)
     {
-        result.error_message = "No vertices found in shapes";
-        logError(result.error_message);
-        return result;
+        for (const char* line = chunk.begin; line < chunk.end;)
+        {
+            const char* line_end = findLineEnd(line, chunk.end);
+            const char* p = line;
+
+            switch (classifyLine(p, line_end))
+            {
+            case ObjLineType::Position: ++chunk.position_count; break;
+            case ObjLineType::Normal:   ++chunk.normal_count;   break;
+            case ObjLineType::TexCoord: ++chunk.texcoord_count; break;
+            default: break;
+            }
+
+            line = line_end + 1;
+        }
     }
-    
-    logMessage("Total vertices to process: " + std::to_string(total_vertices), config.verbose_logging);
-    
-    // Single memory allocation - much faster than multiple allocations
-    try
+
+    // Pass 2: parse attributes into the shared arrays and collect faces
+    void parseChunk(ObjChunk& chunk, ObjData& data, bool triangulate)
     {
-        result.vertices = new vertex[total_vertices];
-        result.vertex_count = total_vertices;
+        const size_t total_positions = data.positions.size() / 3;
+        size_t positions_read = chunk.position_base;
+        size_t normals_read = chunk.normal_base;
+        size_t texcoords_read = chunk.texcoord_base;
+
+        std::vector<ObjCorner> face;
+
+        for (const char* line = chunk.begin; line < chunk.end;)
+        {
+            const char* line_end = findLineEnd(line, chunk.end);
+            const char* p = line;
+
+            switch (classifyLine(p, line_end))
+            {
+            case ObjLineType::Position:
+                parseFloats(p, line_end, &data.positions[positions_read * 3], 3);
+                ++positions_read;
+                break;
+
+            case ObjLineType::Normal:
+                parseFloats(p, line_end, &data.normals[normals_read * 3], 3);
+                ++normals_read;
+                break;
+
+            case ObjLineType::TexCoord:
+                parseFloats(p, line_end, &data.texcoords[texcoords_read * 2], 2);
+                ++texcoords_read;
+                break;
+
+            case ObjLineType::Face:
+            {
+                face.clear();
+                bool valid = true;
+                bool in_range = true;
+
+                for (p = skipBlanks(p, line_end); p < line_end && valid; p = skipBlanks(p, line_end))
+                {
+                    // v, v/vt, v//vn or v/vt/vn
+                    ObjCorner corner = { -1, -1, -1 };
+                    p = parseIndex(p, line_end, positions_read, corner.position, valid);
+                    if (p < line_end && *p == '/')
+                    {
+                        ++p;
+                        if (p < line_end && *p != '/')
+                        {
+                            p = parseIndex(p, line_end, texcoords_read, corner.texcoord, valid);
+                        }
+                        if (p < line_end && *p == '/')
+                        {
+                            p = parseIndex(p + 1, line_end, normals_read, corner.normal, valid);
+                        }
+                    }
+
+                    if (p < line_end && !isBlank(*p))
+                    {
+                        valid = false;
+                    }
+                    if (corner.position < 0 || static_cast<size_t>(corner.position) >= total_positions)
+                    {
+                        in_range = false;
+                    }
+                    face.push_back(corner);
+                }
+
+                if (!valid)
+                {
+                    chunk.error = "Invalid face: " + std::string(line, std::find(line, line_end, '\r'));
+                    return;
+                }
+
+                if (face.size() < 3 || !in_range)
+                {
+                    ++chunk.skipped_faces;
+                    break;
+                }
+
+                chunk.corners.insert(chunk.corners.end(), face.begin(), face.end());
+                chunk.face_sizes.push_back(static_cast<uint32_t>(face.size()));
+                chunk.output_count += outputVerticesForFace(face.size(), triangulate);
+                break;
+            }
+
+            default:
+                break;
+            }
+
+            line = line_end + 1;
+        }
     }
-    catch (const std::bad_alloc&)
+
+    void runChunks(ObjData& data, bool multithreaded, const std::function<void(size_t)>& body)
     {
-        result.error_message = "Failed to allocate memory for " + std::to_string(total_vertices) + " vertices";
-        logError(result.error_message);
-        return result;
+        if (multithreaded)
+        {
+            ThreadPool::get().parallelFor(data.chunks.size(), body);
+        }
+        else
+        {
+            for (size_t i = 0; i < data.chunks.size(); ++i)
+            {
+                body(i);
+            }
+        }
     }
-    
-    // Pre-calculate array sizes for optimized bounds checking
-    const size_t vertex_count = attrib.vertices.size() / 3;
-    const size_t normal_count = attrib.normals.size() / 3;
-    const size_t texcoord_count = attrib.texcoords.size() / 2;
-    
-    logMessage("Attribute counts - Vertices: " + std::to_string(vertex_count) + 
-               ", Normals: " + std::to_string(normal_count) + 
-               ", TexCoords: " + std::to_string(texcoord_count), config.verbose_logging);
-    
-    // Fast vertex processing with minimal bounds checking
-    size_t vertex_index = 0;
-    
-    for (const auto& shape : shapes)
+
+    bool parseObj(const AssetFile& file, const ObjLoaderConfig& config, ObjData& data, std::string& error)
     {
-        const auto& mesh_indices = shape.mesh.indices;
-        const size_t num_face_vertices = mesh_indices.size();
-        
-        // Process vertices in chunks for better cache performance
-        for (size_t f = 0; f < num_face_vertices; ++f)
+        const char* begin = reinterpret_cast<const char*>(file.data());
+        const char* end = begin + file.size();
+
+        // Split into line-aligned chunks, a few per worker for load balancing
+        size_t chunk_count = 1;
+        if (config.multithreaded)
         {
-            const tinyobj::index_t& idx = mesh_indices[f];
-            vertex& v = result.vertices[vertex_index];
-            
-            // Vertex position (with single bounds check)
-            if (idx.vertex_index >= 0 && static_cast<size_t>(idx.vertex_index) < vertex_count)
+            size_t max_chunks = (ThreadPool::get().getThreadCount() + 1) * 4;
+            chunk_count = std::max<size_t>(1, std::min(file.size() / OBJ_MIN_CHUNK_SIZE, max_chunks));
+        }
+
+        data.chunks.resize(chunk_count);
+        const char* chunk_begin = begin;
+        for (size_t i = 0; i < chunk_count; ++i)
+        {
+            const char* chunk_end = end;
+            if (i + 1 < chunk_count)
             {
-                const size_t base_idx = static_cast<size_t>(idx.vertex_index) * 3;
-                v.vx = attrib.vertices[base_idx];
-                v.vy = attrib.vertices[base_idx + 1];
-                v.vz = attrib.vertices[base_idx + 2];
+                const char* target = std::max(chunk_begin, begin + file.size() * (i + 1) / chunk_count);
+                chunk_end = findLineEnd(target, end);
+                if (chunk_end < end)
+                {
+                    ++chunk_end;
+                }
             }
-            else
+
+            data.chunks[i].begin = chunk_begin;
+            data.chunks[i].end = chunk_end;
+            chunk_begin = chunk_end;
+        }
+
+        runChunks(data, config.multithreaded, [&](size_t i) { countChunk(data.chunks[i]); });
+
+        size_t position_count = 0;
+        size_t normal_count = 0;
+        size_t texcoord_count = 0;
+        for (auto& chunk : data.chunks)
+        {
+            chunk.position_base = position_count;
+            chunk.normal_base = normal_count;
+            chunk.texcoord_base = texcoord_count;
+            position_count += chunk.position_count;
+            normal_count += chunk.normal_count;
+            texcoord_count += chunk.texcoord_count;
+        }
+
+        if (position_count > INT32_MAX || normal_count > INT32_MAX || texcoord_count > INT32_MAX)
+        {
+            error = "OBJ file has too many attributes";
+            return false;
+        }
+
+        data.positions.resize(position_count * 3);
+        data.normals.resize(normal_count * 3);
+        data.texcoords.resize(texcoord_count * 2);
+
+        runChunks(data, config.multithreaded, [&](size_t i) { parseChunk(data.chunks[i], data, config.triangulate); });
+
+        // Merge: give each chunk its range of the output, in file order
+        for (auto& chunk : data.chunks)
+        {
+            if (!chunk.error.empty())
+            {
+                error = chunk.error;
+                return false;
+            }
+
+            chunk.output_base = data.output_count;
+            data.output_count += chunk.output_count;
+            data.skipped_faces += chunk.skipped_faces;
+        }
+
+        return true;
+    }
+
+    void emitVertex(const ObjData& data, const ObjCorner& corner, vertex& v, const ObjLoaderConfig& config)
+    {
+        const float* position = &data.positions[static_cast<size_t>(corner.position) * 3];
+        v.vx = position[0];
+        v.vy = position[1];
+        v.vz = position[2];
+
+        if (corner.normal >= 0 && static_cast<size_t>(corner.normal) * 3 < data.normals.size())
+        {
+            const float* normal = &data.normals[static_cast<size_t>(corner.normal) * 3];
+            v.nx = normal[0];
+            v.ny = normal[1];
+            v.nz = normal[2];
+
+            // Optional normal validation (slower but safer)
+            if (config.validate_normals)
             {
-                v.vx = v.vy = v.vz = 0.0f;
-                if (idx.vertex_index >= 0 && config.verbose_logging)
+                float normal_length = std::sqrt(v.nx * v.nx + v.ny * v.ny + v.nz * v.nz);
+                if (normal_length < 0.0001f)
                 {
-                    logWarning("Invalid vertex index: " + std::to_string(idx.vertex_index));
+                    v.nx = 0.0f;
+                    v.ny = 1.0f;
+                    v.nz = 0.0f;
+                    printf("[OBJ Loader WARNING] Invalid normal vector, using default\n");
                 }
             }
-            
-            // Normal (with single bounds check)
-            if (idx.normal_index >= 0 && static_cast<size_t>(idx.normal_index) < normal_count)
+        }
+        else
+        {
+            // Default normal pointing up
+            v.nx = 0.0f;
+            v.ny = 1.0f;
+            v.nz = 0.0f;
+        }
+
+        if (corner.texcoord >= 0 && static_cast<size_t>(corner.texcoord) * 2 < data.texcoords.size())
+        {
+            const float* texcoord = &data.texcoords[static_cast<size_t>(corner.texcoord) * 2];
+            v.u = texcoord[0];
+            v.v = texcoord[1];
+
+            // Optional texture coordinate validation (slower but safer)
+            if (config.validate_texcoords)
             {
-                const size_t base_idx = static_cast<size_t>(idx.normal_index) * 3;
-                v.nx = attrib.normals[base_idx];
-                v.ny = attrib.normals[base_idx + 1];
-                v.nz = attrib.normals[base_idx + 2];
-                
-                // Optional normal validation (slower but safer)
-                if (config.validate_normals)
+                if (v.u < -10.0f || v.u > 10.0f)
                 {
-                    float normal_length = std::sqrt(v.nx * v.nx + v.ny * v.ny + v.nz * v.nz);
-                    if (normal_length < 0.0001f)
-                    {
-                        v.nx = 0.0f;
-                        v.ny = 1.0f;
-                        v.nz = 0.0f;
-                        logWarning("Invalid normal vector, using default");
-                    }
+                    v.u = 0.0f;
+                    printf("[OBJ Loader WARNING] Clamped invalid U coordinate\n");
+                }
+                if (v.v < -10.0f || v.v > 10.0f)
+                {
+                    v.v = 0.0f;
+                    printf("[OBJ Loader WARNING] Clamped invalid V coordinate\n");
                 }
             }
-            else
+        }
+        else
+        {
+            v.u = v.v = 0.0f;
+        }
+    }
+
+    float squaredDistance(const ObjData& data, const ObjCorner& a, const ObjCorner& b)
+    {
+        const float* pa = &data.positions[static_cast<size_t>(a.position) * 3];
+        const float* pb = &data.positions[static_cast<size_t>(b.position) * 3];
+        float dx = pb[0] - pa[0];
+        float dy = pb[1] - pa[1];
+        float dz = pb[2] - pa[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // Pass 3: triangulate this chunk's faces straight into its output range
+    void buildChunk(const ObjData& data, const ObjChunk& chunk, vertex* vertices, const ObjLoaderConfig& config)
+    {
+        vertex* out = vertices + chunk.output_base;
+        const ObjCorner* face = chunk.corners.data();
+
+        for (uint32_t corner_count : chunk.face_sizes)
+        {
+            if (!config.triangulate || corner_count == 3)
             {
-                // Default normal pointing up
-                v.nx = 0.0f;
-                v.ny = 1.0f;
-                v.nz = 0.0f;
+                for (uint32_t k = 0; k < corner_count; ++k)
+                {
+                    emitVertex(data, face[k], *out++, config);
+                }
             }
-            
-            // Texture coordinates (with single bounds check)
-            if (idx.texcoord_index >= 0 && static_cast<size_t>(idx.texcoord_index) < texcoord_count)
+            else if (corner_count == 4)
             {
-                const size_t base_idx = static_cast<size_t>(idx.texcoord_index) * 2;
-                v.u = attrib.texcoords[base_idx];
-                v.v = attrib.texcoords[base_idx + 1];
-                
-                // Optional texture coordinate validation (slower but safer)
-                if (config.validate_texcoords)
+                // Split quads along the shorter diagonal
+                static const int split_02[6] = { 0, 1, 2, 0, 2, 3 };
+                static const int split_13[6] = { 0, 1, 3, 1, 2, 3 };
+                const int* split = squaredDistance(data, face[0], face[2]) < squaredDistance(data, face[1], face[3])
+                    ? split_02 : split_13;
+                for (int k = 0; k < 6; ++k)
                 {
-                    if (v.u < -10.0f || v.u > 10.0f)
-                    {
-                        v.u = 0.0f;
-                        logWarning("Clamped invalid U coordinate");
-                    }
-                    if (v.v < -10.0f || v.v > 10.0f)
-                    {
-                        v.v = 0.0f;
-                        logWarning("Clamped invalid V coordinate");
-                    }
+                    emitVertex(data, face[split[k]], *out++, config);
                 }
             }
             else
             {
-                v.u = v.v = 0.0f;
+                // Larger polygons are fanned from their first corner
+                for (uint32_t k = 1; k + 1 < corner_count; ++k)
+                {
+                    emitVertex(data, face[0], *out++, config);
+                    emitVertex(data, face[k], *out++, config);
+                    emitVertex(data, face[k + 1], *out++, config);
+                }
             }
-            
-            ++vertex_index;
+
+            face += corner_count;
         }
     }
-    
+
+    // Hands tinyobjloader its .mtl files through the asset file system, so
+    // the fallback loader finds them in archives too
+    class AssetMaterialReader : public tinyobj::MaterialReader
+    {
+    public:
+        bool operator()(const std::string& material_id, std::vector<tinyobj::material_t>* materials,
+                        std::map<std::string, int>* material_map, std::string* warn, std::string* err) override
+        {
+            AssetFile file;
+            if (!file.open(material_id))
+            {
+                if (warn)
+                {
+                    *warn += "Material file [ " + material_id + " ] not found\n";
+                }
+                return false;
+            }
+
+            std::istringstream stream(std::string(reinterpret_cast<const char*>(file.data()), file.size()));
+            tinyobj::LoadMtl(material_map, materials, &stream, warn, err);
+            return true;
+        }
+    };
+}
+
+void ObjLoader::logMessage(const std::string& message, bool verbose)
+{
+    if (verbose)
+    {
+        printf("[OBJ Loader] %s\n", message.c_str());
+    }
+}
+
+void ObjLoader::logError(const std::string& message)
+{
+    printf("[OBJ Loader ERROR] %s\n", message.c_str());
+}
+
+void ObjLoader::logWarning(const std::string& message)
+{
+    printf("[OBJ Loader WARNING] %s\n", message.c_str());
+}
+
+ObjLoadResult ObjLoader::loadObj(const std::string& filename, const ObjLoaderConfig& config)
+{
+    ObjLoadResult result;
+
+    logMessage("Loading OBJ file: " + filename, config.verbose_logging);
+
+    // Parse in place from the mapping; nothing is read into an intermediate string
+    AssetFile file;
+    if (!file.open(filename))
+    {
+        result.error_message = "Failed to open OBJ file: " + filename;
+        logError(result.error_message);
+        return result;
+    }
+
+    ObjData data;
+    std::string error;
+    if (!parseObj(file, config, data, error))
+    {
+        result.error_message = "Failed to parse OBJ file: " + error;
+        logError(result.error_message);
+        return result;
+    }
+
+    if (data.skipped_faces > 0)
+    {
+        logWarning("Skipped " + std::to_string(data.skipped_faces) + " degenerate or out-of-range faces");
+    }
+
+    // Validate input data
+    if (data.positions.empty())
+    {
+        result.error_message = "No vertex data found in OBJ file";
+        logError(result.error_message);
+        return result;
+    }
+
+    if (data.output_count == 0)
+    {
+        result.error_message = "No faces found in OBJ file";
+        logError(result.error_message);
+        return result;
+    }
+
+    logMessage("Total vertices to process: " + std::to_string(data.output_count), config.verbose_logging);
+
+    // Single memory allocation - much faster than multiple allocations
+    try
+    {
+        result.vertices = new vertex[data.output_count];
+        result.vertex_count = data.output_count;
+    }
+    catch (const std::bad_alloc&)
+    {
+        result.error_message = "Failed to allocate memory for " + std::to_string(data.output_count) + " vertices";
+        logError(result.error_message);
+        return result;
+    }
+
+    logMessage("Attribute counts - Vertices: " + std::to_string(data.positions.size() / 3) +
+               ", Normals: " + std::to_string(data.normals.size() / 3) +
+               ", TexCoords: " + std::to_string(data.texcoords.size() / 2), config.verbose_logging);
+
+    // Every chunk fills its own range of the final array
+    runChunks(data, config.multithreaded, [&](size_t i) { buildChunk(data, data.chunks[i], result.vertices, config); });
+
     result.success = true;
-    logMessage("Successfully loaded OBJ: " + filename + " (" + std::to_string(result.vertex_count) + " vertices)", 
+    logMessage("Successfully loaded OBJ: " + filename + " (" + std::to_string(result.vertex_count) + " vertices)",
                config.verbose_logging);
-    
+
     return result;
 }
 
@@ -229,7 +652,17 @@ ObjLoadResult ObjLoader::loadObjSafe(const std::string& filename, const ObjLoade
     
     logMessage("Loading OBJ file (safe mode): " + filename, config.verbose_logging);
     
-    bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename.c_str());
+    AssetFile file;
+    if (!file.open(filename))
+    {
+        result.error_message = "Failed to open OBJ file: " + filename;
+        logError(result.error_message);
+        return result;
+    }
+
+    std::istringstream stream(std::string(reinterpret_cast<const char*>(file.data()), file.size()));
+    AssetMaterialReader material_reader;
+    bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &stream, &material_reader);
     
     if (!warn.empty())
     {
@@ -411,43 +844,32 @@ ObjLoadResult ObjLoader::loadObjSafe(const std::string& filename, const ObjLoade
 
 bool ObjLoader::validateObjFile(const std::string& filename)
 {
-    tinyobj::ObjReaderConfig config;
+    ObjLoaderConfig config;
     config.triangulate = true;
-    config.vertex_color = false;
-    
-    tinyobj::ObjReader reader;
-    
-    if (!reader.ParseFromFile(filename, config))
+
+    AssetFile file;
+    ObjData data;
+    std::string error;
+    if (!file.open(filename) || !parseObj(file, config, data, error))
     {
         return false;
     }
-    
-    const auto& attrib = reader.GetAttrib();
-    const auto& shapes = reader.GetShapes();
-    
-    return !attrib.vertices.empty() && !shapes.empty();
+
+    return !data.positions.empty() && data.output_count > 0;
 }
 
 size_t ObjLoader::getObjVertexCount(const std::string& filename)
 {
-    tinyobj::ObjReaderConfig config;
+    ObjLoaderConfig config;
     config.triangulate = true;
-    config.vertex_color = false;
-    
-    tinyobj::ObjReader reader;
-    
-    if (!reader.ParseFromFile(filename, config))
+
+    AssetFile file;
+    ObjData data;
+    std::string error;
+    if (!file.open(filename) || !parseObj(file, config, data, error))
     {
         return 0;
     }
-    
-    const auto& shapes = reader.GetShapes();
-    
-    size_t total_vertices = 0;
-    for (const auto& shape : shapes)
-    {
-        total_vertices += shape.mesh.indices.size();
-    }
-    
-    return total_vertices;
-}
\ No newline at end of file
+
+    return data.output_count;
+}
@@ -68,16 +68,17 @@ struct ObjLoaderConfig
     bool validate_texcoords = false;       // Validate texture coordinate ranges (slower)
     bool triangulate = true;               // Ensure triangulation
     bool load_materials = false;           // Load material information (not used currently)
+    bool multithreaded = true;             // Parse chunks of the file on the shared ThreadPool
     std::string mtl_search_path = "./";    // Path to search for material files
 };
 
 class ObjLoader
 {
 public:
-    // Load OBJ file with optimized performance
+    // Load OBJ file with the native parallel parser
     static ObjLoadResult loadObj(const std::string& filename, const ObjLoaderConfig& config = ObjLoaderConfig());
     
-    // Load OBJ file with original implementation (for comparison/fallback)
+    // Load OBJ file through tinyobjloader (for comparison/fallback)
     static ObjLoadResult loadObjSafe(const std::string& filename, const ObjLoaderConfig& config = ObjLoaderConfig());
     
     // Utility functions
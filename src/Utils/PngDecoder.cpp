@@ -0,0 +1,817 @@
+#include "PngDecoder.hpp"
+#include "AssetFile.hpp"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PNG_DECODER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // ------------------------------------------------------------------
+    // Inflate (RFC 1951)
+    // ------------------------------------------------------------------
+
+    constexpr int FAST_BITS = 10;
+    constexpr int FAST_SIZE = 1 << FAST_BITS;
+
+    // Matches may overshoot their length by up to 7 bytes, so the inflate
+    // target carries a little slack past the real data
+    constexpr size_t INFLATE_SLACK = 8;
+
+    const uint16_t LENGTH_BASE[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint8_t LENGTH_EXTRA[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const uint16_t DIST_BASE[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const uint8_t DIST_EXTRA[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    struct Huffman
+    {
+        uint16_t fast[FAST_SIZE];   // (length << 9) | symbol, 0 = code longer than FAST_BITS
+        uint16_t first_code[16];
+        uint16_t first_symbol[16];
+        uint32_t max_code[17];
+        uint8_t sizes[288];
+        uint16_t values[288];
+    };
+
+    inline uint32_t reverse16(uint32_t n)
+    {
+        n = ((n & 0xAAAA) >> 1) | ((n & 0x5555) << 1);
+        n = ((n & 0xCCCC) >> 2) | ((n & 0x3333) << 2);
+        n = ((n & 0xF0F0) >> 4) | ((n & 0x0F0F) << 4);
+        n = ((n & 0xFF00) >> 8) | ((n & 0x00FF) << 8);
+        return n;
+    }
+
+    bool buildHuffman(Huffman& h, const uint8_t* lengths, int count)
+    {
+        int size_counts[16] = {};
+        for (int i = 0; i < count; ++i)
+        {
+            if (lengths[i] > 15)
+            {
+                return false;
+            }
+            size_counts[lengths[i]]++;
+        }
+        size_counts[0] = 0;
+
+        memset(h.fast, 0, sizeof(h.fast));
+
+        uint32_t next_code[16] = {};
+        uint32_t code = 0;
+        int symbol = 0;
+        for (int i = 1; i < 16; ++i)
+        {
+            next_code[i] = code;
+            h.first_code[i] = static_cast<uint16_t>(code);
+            h.first_symbol[i] = static_cast<uint16_t>(symbol);
+            code += size_counts[i];
+            if (size_counts[i] && code - 1 >= (1u << i))
+            {
+                return false; // Over-subscribed
+            }
+            h.max_code[i] = code << (16 - i);
+            code <<= 1;
+            symbol += size_counts[i];
+        }
+        h.max_code[16] = 0x10000;
+
+        for (int i = 0; i < count; ++i)
+        {
+            int s = lengths[i];
+            if (!s)
+            {
+                continue;
+            }
+
+            int c = next_code[s] - h.first_code[s] + h.first_symbol[s];
+            h.sizes[c] = static_cast<uint8_t>(s);
+            h.values[c] = static_cast<uint16_t>(i);
+
+            if (s <= FAST_BITS)
+            {
+                uint16_t entry = static_cast<uint16_t>((s << 9) | i);
+                for (uint32_t j = reverse16(next_code[s]) >> (16 - s); j < FAST_SIZE; j += 1u << s)
+                {
+                    h.fast[j] = entry;
+                }
+            }
+            ++next_code[s];
+        }
+
+        return true;
+    }
+
+    struct FixedTables
+    {
+        Huffman lit;
+        Huffman dist;
+
+        FixedTables()
+        {
+            uint8_t lengths[288];
+            memset(lengths, 8, 144);
+            memset(lengths + 144, 9, 112);
+            memset(lengths + 256, 7, 24);
+            memset(lengths + 280, 8, 8);
+            buildHuffman(lit, lengths, 288);
+
+            memset(lengths, 5, 30);
+            buildHuffman(dist, lengths, 30);
+        }
+    };
+
+    const FixedTables& fixedTables()
+    {
+        static const FixedTables tables;
+        return tables;
+    }
+
+    inline void copyMatch(uint8_t* dst, size_t distance, size_t length)
+    {
+        const uint8_t* src = dst - distance;
+
+        if (distance >= 8)
+        {
+            // An 8 byte chunk never reads bytes it is itself writing
+            uint8_t* end = dst + length;
+            do
+            {
+                memcpy(dst, src, 8);
+                dst += 8;
+                src += 8;
+            } while (dst < end);
+        }
+        else if (distance == 1)
+        {
+            memset(dst, *src, length);
+        }
+        else
+        {
+            while (length--)
+            {
+                *dst++ = *src++;
+            }
+        }
+    }
+
+    class Inflater
+    {
+    public:
+        Inflater(const uint8_t* data, size_t size, uint8_t* output, size_t output_size)
+            : in(data), in_end(data + size), out(output), out_size(output_size)
+        {
+        }
+
+        // Inflate a zlib stream, succeeding only if it fills the output exactly
+        bool run()
+        {
+            if (in_end - in < 2)
+            {
+                return false;
+            }
+
+            int cmf = in[0];
+            int flg = in[1];
+            if ((cmf & 15) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 32))
+            {
+                return false; // Not deflate, bad check bits or preset dictionary
+            }
+            in += 2;
+
+            bool final_block = false;
+            while (!final_block)
+            {
+                refill();
+                final_block = getBits(1) != 0;
+                int type = static_cast<int>(getBits(2));
+
+                bool ok = false;
+                if (type == 0)
+                {
+                    ok = copyStored();
+                }
+                else if (type == 1)
+                {
+                    ok = inflateBlock(fixedTables().lit, fixedTables().dist);
+                }
+                else if (type == 2)
+                {
+                    ok = readDynamicTables() && inflateBlock(lit, dist);
+                }
+
+                // A few zero bytes past the end are fine (lookahead), more means truncation
+                if (!ok || overrun > 8)
+                {
+                    return false;
+                }
+            }
+
+            return out_pos == out_size;
+        }
+
+    private:
+        const uint8_t* in;
+        const uint8_t* in_end;
+        uint8_t* out;
+        size_t out_size;
+        size_t out_pos = 0;
+
+        // Bits above bit_count are always the next bits of the stream (or zero),
+        // which lets the word refill overlap what is already buffered
+        uint64_t bits = 0;
+        int bit_count = 0;
+        size_t overrun = 0;
+
+        Huffman lit;
+        Huffman dist;
+
+        // Top up to at least 56 buffered bits: enough for a literal/length code,
+        // its extra bits, a distance code and its extra bits (15 + 5 + 15 + 13)
+        void refill()
+        {
+            if (in_end - in >= 8)
+            {
+                uint64_t word;
+                memcpy(&word, in, 8); // Little-endian targets only
+                bits |= word << bit_count;
+                in += (63 - bit_count) >> 3;
+                bit_count |= 56;
+                return;
+            }
+
+            while (bit_count <= 56)
+            {
+                uint64_t byte = 0;
+                if (in < in_end)
+                {
+                    byte = *in++;
+                }
+                else
+                {
+                    ++overrun;
+                }
+                bits |= byte << bit_count;
+                bit_count += 8;
+            }
+        }
+
+        uint32_t getBits(int n)
+        {
+            uint32_t value = static_cast<uint32_t>(bits & ((1ull << n) - 1));
+            bits >>= n;
+            bit_count -= n;
+            return value;
+        }
+
+        int decodeSymbol(const Huffman& h)
+        {
+            uint16_t entry = h.fast[bits & (FAST_SIZE - 1)];
+            if (entry)
+            {
+                int s = entry >> 9;
+                bits >>= s;
+                bit_count -= s;
+                return entry & 511;
+            }
+
+            // Codes longer than the fast table: canonical decode on the bit-reversed peek
+            uint32_t k = reverse16(static_cast<uint32_t>(bits & 0xFFFF));
+            int s = FAST_BITS + 1;
+            while (k >= h.max_code[s])
+            {
+                ++s;
+            }
+            if (s >= 16)
+            {
+                return -1;
+            }
+
+            int c = static_cast<int>(k >> (16 - s)) - h.first_code[s] + h.first_symbol[s];
+            if (c < 0 || c >= 288 || h.sizes[c] != s)
+            {
+                return -1;
+            }
+
+            bits >>= s;
+            bit_count -= s;
+            return h.values[c];
+        }
+
+        bool readDynamicTables()
+        {
+            static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+            int hlit = static_cast<int>(getBits(5)) + 257;
+            int hdist = static_cast<int>(getBits(5)) + 1;
+            int hclen = static_cast<int>(getBits(4)) + 4;
+
+            uint8_t code_length_sizes[19] = {};
+            for (int i = 0; i < hclen; ++i)
+            {
+                refill();
+                code_length_sizes[order[i]] = static_cast<uint8_t>(getBits(3));
+            }
+
+            Huffman code_lengths;
+            if (!buildHuffman(code_lengths, code_length_sizes, 19))
+            {
+                return false;
+            }
+
+            uint8_t lengths[288 + 32];
+            int total = hlit + hdist;
+            int n = 0;
+            while (n < total)
+            {
+                refill();
+                int c = decodeSymbol(code_lengths);
+                if (c < 0 || c >= 19)
+                {
+                    return false;
+                }
+
+                if (c < 16)
+                {
+                    lengths[n++] = static_cast<uint8_t>(c);
+                    continue;
+                }
+
+                uint8_t fill = 0;
+                int repeat;
+                if (c == 16)
+                {
+                    if (n == 0)
+                    {
+                        return false;
+                    }
+                    fill = lengths[n - 1];
+                    repeat = static_cast<int>(getBits(2)) + 3;
+                }
+                else if (c == 17)
+                {
+                    repeat = static_cast<int>(getBits(3)) + 3;
+                }
+                else
+                {
+                    repeat = static_cast<int>(getBits(7)) + 11;
+                }
+
+                if (n + repeat > total)
+                {
+                    return false;
+                }
+                memset(lengths + n, fill, repeat);
+                n += repeat;
+            }
+
+            return buildHuffman(lit, lengths, hlit) && buildHuffman(dist, lengths + hlit, hdist);
+        }
+
+        bool inflateBlock(const Huffman& lit_table, const Huffman& dist_table)
+        {
+            for (;;)
+            {
+                refill();
+
+                int sym = decodeSymbol(lit_table);
+                if (sym < 256)
+                {
+                    if (sym < 0 || out_pos >= out_size)
+                    {
+                        return false;
+                    }
+                    out[out_pos++] = static_cast<uint8_t>(sym);
+                    continue;
+                }
+
+                if (sym == 256)
+                {
+                    return true;
+                }
+
+                sym -= 257;
+                if (sym >= 29)
+                {
+                    return false;
+                }
+                size_t length = LENGTH_BASE[sym] + getBits(LENGTH_EXTRA[sym]);
+
+                int dsym = decodeSymbol(dist_table);
+                if (dsym < 0 || dsym >= 30)
+                {
+                    return false;
+                }
+                size_t distance = DIST_BASE[dsym] + getBits(DIST_EXTRA[dsym]);
+
+                if (distance > out_pos || length > out_size - out_pos)
+                {
+                    return false;
+                }
+
+                copyMatch(out + out_pos, distance, length);
+                out_pos += length;
+            }
+        }
+
+        bool copyStored()
+        {
+            // Skip to the byte boundary, then LEN / NLEN
+            getBits(bit_count & 7);
+            refill();
+            uint32_t len = getBits(16);
+            uint32_t nlen = getBits(16);
+            if ((len ^ 0xFFFF) != nlen || len > out_size - out_pos)
+            {
+                return false;
+            }
+
+            // Whole bytes still sitting in the bit buffer come first
+            while (len && bit_count >= 8)
+            {
+                out[out_pos++] = static_cast<uint8_t>(getBits(8));
+                --len;
+            }
+
+            if (len)
+            {
+                if (static_cast<size_t>(in_end - in) < len)
+                {
+                    return false;
+                }
+                memcpy(out + out_pos, in, len);
+                in += len;
+                out_pos += len;
+                bits = 0; // Lookahead bits are stale now
+            }
+
+            return true;
+        }
+    };
+
+    // ------------------------------------------------------------------
+    // Row unfiltering
+    // ------------------------------------------------------------------
+
+    // Branch-free form of the spec's predictor: same result, but no
+    // data-dependent branches in the per-byte chain
+    inline uint8_t paethPredictor(int a, int b, int c)
+    {
+        int threshold = c * 3 - (a + b);
+        int lo = a < b ? a : b;
+        int hi = a < b ? b : a;
+        int t0 = (hi <= threshold) ? lo : c;
+        return static_cast<uint8_t>((threshold <= lo) ? hi : t0);
+    }
+
+    void unfilterUp(const uint8_t* src, const uint8_t* prior, uint8_t* dst, size_t stride)
+    {
+        size_t i = 0;
+#ifdef PNG_DECODER_SSE2
+        for (; i + 16 <= stride; i += 16)
+        {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi8(s, p));
+        }
+#endif
+        for (; i < stride; ++i)
+        {
+            dst[i] = static_cast<uint8_t>(src[i] + prior[i]);
+        }
+    }
+
+    void unfilterScalar(int filter, const uint8_t* src, const uint8_t* prior, uint8_t* dst, size_t stride, int bpp)
+    {
+        size_t i = 0;
+        switch (filter)
+        {
+        case 1: // Sub
+            for (; i < (size_t)bpp; ++i) dst[i] = src[i];
+            for (; i < stride; ++i) dst[i] = static_cast<uint8_t>(src[i] + dst[i - bpp]);
+            break;
+        case 3: // Average
+            for (; i < (size_t)bpp; ++i) dst[i] = static_cast<uint8_t>(src[i] + (prior[i] >> 1));
+            for (; i < stride; ++i) dst[i] = static_cast<uint8_t>(src[i] + ((dst[i - bpp] + prior[i]) >> 1));
+            break;
+        case 4: // Paeth
+            for (; i < (size_t)bpp; ++i) dst[i] = static_cast<uint8_t>(src[i] + prior[i]);
+            for (; i < stride; ++i) dst[i] = static_cast<uint8_t>(src[i] + paethPredictor(dst[i - bpp], prior[i], prior[i - bpp]));
+            break;
+        }
+    }
+
+#ifdef PNG_DECODER_SSE2
+    // Sub and Average depend on the previous pixel, so SIMD works one 3 or 4
+    // byte pixel per step rather than 16 bytes at a time. Paeth is left to the
+    // scalar path: one pixel per step makes it a single long dependency chain,
+    // while the scalar loop keeps one short chain per channel in flight.
+
+    template <int BPP>
+    inline __m128i loadPixel(const uint8_t* p)
+    {
+        uint32_t v = 0;
+        memcpy(&v, p, BPP);
+        return _mm_cvtsi32_si128(static_cast<int>(v));
+    }
+
+    template <int BPP>
+    inline void storePixel(uint8_t* p, __m128i v)
+    {
+        uint32_t value = static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+        memcpy(p, &value, BPP);
+    }
+
+    template <int BPP>
+    void unfilterSimd(int filter, const uint8_t* src, const uint8_t* prior, uint8_t* dst, size_t stride)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        switch (filter)
+        {
+        case 1: // Sub
+        {
+            __m128i a = zero;
+            for (size_t i = 0; i < stride; i += BPP)
+            {
+                a = _mm_add_epi8(a, loadPixel<BPP>(src + i));
+                storePixel<BPP>(dst + i, a);
+            }
+            break;
+        }
+        case 3: // Average: _mm_avg_epu8 rounds up, PNG rounds down
+        {
+            const __m128i one = _mm_set1_epi8(1);
+            __m128i a = zero;
+            for (size_t i = 0; i < stride; i += BPP)
+            {
+                __m128i b = loadPixel<BPP>(prior + i);
+                __m128i avg = _mm_avg_epu8(a, b);
+                avg = _mm_sub_epi8(avg, _mm_and_si128(_mm_xor_si128(a, b), one));
+                a = _mm_add_epi8(loadPixel<BPP>(src + i), avg);
+                storePixel<BPP>(dst + i, a);
+            }
+            break;
+        }
+        }
+    }
+#endif
+
+    bool unfilterRow(int filter, const uint8_t* src, const uint8_t* prior, uint8_t* dst, size_t stride, int bpp)
+    {
+        switch (filter)
+        {
+        case 0:
+            memcpy(dst, src, stride);
+            return true;
+        case 2:
+            unfilterUp(src, prior, dst, stride);
+            return true;
+        case 4:
+            unfilterScalar(filter, src, prior, dst, stride, bpp);
+            return true;
+        case 1:
+        case 3:
+#ifdef PNG_DECODER_SSE2
+            if (bpp == 3)
+            {
+                unfilterSimd<3>(filter, src, prior, dst, stride);
+                return true;
+            }
+            if (bpp == 4)
+            {
+                unfilterSimd<4>(filter, src, prior, dst, stride);
+                return true;
+            }
+#endif
+            unfilterScalar(filter, src, prior, dst, stride, bpp);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Chunk parsing
+    // ------------------------------------------------------------------
+
+    inline uint32_t readBE32(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+
+    constexpr uint32_t chunkType(char a, char b, char c, char d)
+    {
+        return (uint32_t(uint8_t(a)) << 24) | (uint32_t(uint8_t(b)) << 16) | (uint32_t(uint8_t(c)) << 8) | uint32_t(uint8_t(d));
+    }
+}
+
+bool PngDecoder::isPng(const unsigned char* data, size_t size)
+{
+    static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    return data && size >= 8 && memcmp(data, signature, 8) == 0;
+}
+
+bool PngDecoder::decode(const unsigned char* data, size_t size, PngImage& out, bool flip_vertically)
+{
+    if (!isPng(data, size))
+    {
+        return false;
+    }
+
+    const uint8_t* p = data + 8;
+    const uint8_t* end = data + size;
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int color_type = -1;
+    bool has_palette = false;
+    bool has_transparency = false;
+    uint8_t palette[256 * 4];
+    for (int i = 0; i < 256; ++i)
+    {
+        palette[i * 4 + 0] = palette[i * 4 + 1] = palette[i * 4 + 2] = 0;
+        palette[i * 4 + 3] = 255;
+    }
+
+    struct DataChunk
+    {
+        const uint8_t* data;
+        size_t size;
+    };
+    std::vector<DataChunk> idat;
+    size_t idat_size = 0;
+
+    while (end - p >= 12)
+    {
+        uint32_t length = readBE32(p);
+        uint32_t type = readBE32(p + 4);
+        const uint8_t* body = p + 8;
+        if (length > static_cast<size_t>(end - body) - 4)
+        {
+            return false; // Truncated chunk
+        }
+
+        if (type == chunkType('I', 'H', 'D', 'R'))
+        {
+            if (length != 13)
+            {
+                return false;
+            }
+            width = readBE32(body);
+            height = readBE32(body + 4);
+            int bit_depth = body[8];
+            color_type = body[9];
+
+            // 16-bit, sub-byte and interlaced images are left to stb_image
+            if (bit_depth != 8 || body[10] != 0 || body[11] != 0 || body[12] != 0)
+            {
+                return false;
+            }
+            if (color_type != 0 && color_type != 2 && color_type != 3 && color_type != 4 && color_type != 6)
+            {
+                return false;
+            }
+            if (width == 0 || height == 0 || width > (1u << 24) || height > (1u << 24))
+            {
+                return false;
+            }
+        }
+        else if (type == chunkType('P', 'L', 'T', 'E'))
+        {
+            if (length % 3 != 0 || length / 3 > 256)
+            {
+                return false;
+            }
+            for (uint32_t i = 0; i < length / 3; ++i)
+            {
+                palette[i * 4 + 0] = body[i * 3 + 0];
+                palette[i * 4 + 1] = body[i * 3 + 1];
+                palette[i * 4 + 2] = body[i * 3 + 2];
+            }
+            has_palette = true;
+        }
+        else if (type == chunkType('t', 'R', 'N', 'S'))
+        {
+            // Color-keyed gray/RGB transparency is rare enough to leave to stb_image
+            if (color_type != 3 || length > 256)
+            {
+                return false;
+            }
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                palette[i * 4 + 3] = body[i];
+            }
+            has_transparency = true;
+        }
+        else if (type == chunkType('I', 'D', 'A', 'T'))
+        {
+            idat.push_back({ body, length });
+            idat_size += length;
+        }
+        else if (type == chunkType('I', 'E', 'N', 'D'))
+        {
+            break;
+        }
+        else if (type == chunkType('C', 'g', 'B', 'I') || !(type & 0x20000000))
+        {
+            return false; // Apple's variant, or a critical chunk we don't know
+        }
+
+        p = body + length + 4; // Skip the CRC
+    }
+
+    if (color_type < 0 || idat.empty() || (color_type == 3 && !has_palette))
+    {
+        return false;
+    }
+
+    static const int raw_channel_counts[7] = { 1, 0, 3, 1, 2, 0, 4 };
+    const int bpp = raw_channel_counts[color_type];
+    const int out_channels = (color_type == 3) ? (has_transparency ? 4 : 3) : bpp;
+    const size_t stride = static_cast<size_t>(width) * bpp;
+    const size_t filtered_size = (stride + 1) * height;
+    const size_t out_stride = static_cast<size_t>(width) * out_channels;
+
+    if (filtered_size > (1ull << 31) || out_stride * height > (1ull << 31))
+    {
+        return false;
+    }
+
+    // Inflate straight from the file when there is only one IDAT chunk
+    std::vector<uint8_t> joined;
+    const uint8_t* compressed = idat[0].data;
+    if (idat.size() > 1)
+    {
+        joined.reserve(idat_size);
+        for (const auto& chunk : idat)
+        {
+            joined.insert(joined.end(), chunk.data, chunk.data + chunk.size);
+        }
+        compressed = joined.data();
+    }
+
+    // Both buffers are fully overwritten, so skip the zero fill a vector would do
+    std::unique_ptr<uint8_t[]> filtered(new uint8_t[filtered_size + INFLATE_SLACK]);
+    Inflater inflater(compressed, idat_size, filtered.get(), filtered_size);
+    if (!inflater.run())
+    {
+        return false;
+    }
+
+    out.width = static_cast<int>(width);
+    out.height = static_cast<int>(height);
+    out.channels = out_channels;
+    out.pixels.reset(new unsigned char[out_stride * height]);
+
+    std::vector<uint8_t> zero_row(stride, 0);
+    std::vector<uint8_t> index_rows(color_type == 3 ? stride * 2 : 0);
+    const uint8_t* prior = zero_row.data();
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* src = filtered.get() + y * (stride + 1);
+        uint8_t* dst_row = out.pixels.get() + (flip_vertically ? (height - 1 - y) : y) * out_stride;
+
+        // Palette indices need expanding, so they go through a two-row scratch buffer
+        uint8_t* target = (color_type == 3) ? index_rows.data() + (y & 1) * stride : dst_row;
+
+        if (!unfilterRow(src[0], src + 1, prior, target, stride, bpp))
+        {
+            out = PngImage();
+            return false;
+        }
+
+        if (color_type == 3)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                memcpy(dst_row + x * out_channels, palette + target[x] * 4, out_channels);
+            }
+        }
+
+        prior = target;
+    }
+
+    return true;
+}
+
+bool PngDecoder::decodeFile(const std::string& filename, PngImage& out, bool flip_vertically)
+{
+    // Decoded straight from the mapping (or archive entry), nothing is copied first
+    AssetFile file;
+    return file.open(filename) && decode(file.data(), file.size(), out, flip_vertically);
+}
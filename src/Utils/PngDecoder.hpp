@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <stddef.h>
+
+struct PngImage
+{
+    std::unique_ptr<unsigned char[]> pixels;    // Tightly packed rows, ready for upload
+    int width = 0;
+    int height = 0;
+    int channels = 0;                           // 1 = gray, 2 = gray+alpha, 3 = RGB, 4 = RGBA
+};
+
+// Fast path for the 8-bit, non-interlaced PNGs that make up almost all of our
+// textures. Inflate keeps 64 bits of input buffered so a whole length/distance
+// pair decodes from a single refill. Up, Sub and Average rows are unfiltered
+// with SSE2 and Paeth with a branch-free predictor. Rows are unfiltered
+// straight into their final (optionally flipped) position, so there is no
+// second pass before upload.
+//
+// Anything else (16-bit, sub-byte, interlaced, color-keyed) returns false and
+// the caller is expected to fall back to stb_image.
+class PngDecoder
+{
+public:
+    static bool isPng(const unsigned char* data, size_t size);
+
+    static bool decode(const unsigned char* data, size_t size, PngImage& out, bool flip_vertically = false);
+    static bool decodeFile(const std::string& filename, PngImage& out, bool flip_vertically = false);
+};
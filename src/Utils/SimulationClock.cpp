@@ -0,0 +1,49 @@
+#include "SimulationClock.hpp"
+#include <algorithm>
+#include <cmath>
+
+SimulationClock::SimulationClock(float tick_rate, int max_substeps)
+{
+    setTickRate(tick_rate);
+    setMaxSubsteps(max_substeps);
+}
+
+void SimulationClock::setTickRate(float rate)
+{
+    tick_rate = rate > 0.0f ? rate : 60.0f;
+    tick_seconds = 1.0f / tick_rate;
+    accumulator = std::min(accumulator, tick_seconds);
+}
+
+void SimulationClock::setMaxSubsteps(int count)
+{
+    max_substeps = std::max(count, 1);
+}
+
+int SimulationClock::advance(float frame_seconds)
+{
+    // The clock can step back or stall (a debugger, a dragged window)
+    if (!(frame_seconds > 0.0f))
+    {
+        return 0;
+    }
+
+    accumulator += frame_seconds;
+    const float due = std::floor(accumulator / tick_seconds);
+    int ticks = static_cast<int>(std::min(due, static_cast<float>(max_substeps)));
+    if (due > static_cast<float>(max_substeps))
+    {
+        // Keep only the part of a tick, so the next frame starts fresh
+        dropped_ticks += static_cast<uint64_t>(due) - static_cast<uint64_t>(max_substeps);
+        accumulator -= due * tick_seconds;
+    }
+    else
+    {
+        accumulator -= static_cast<float>(ticks) * tick_seconds;
+    }
+
+    // Rounding can leave a hair outside [0, tick_seconds)
+    accumulator = std::clamp(accumulator, 0.0f, tick_seconds * 0.9999f);
+    tick_count += static_cast<uint64_t>(ticks);
+    return ticks;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+// Turns frame times into fixed-length simulation ticks. Each frame's time is
+// banked and paid out a whole tick at a time, so the simulation advances at
+// the same rate whatever the frame rate. After a long frame (a hitch, or
+// ticks that cost more than they cover) at most max_substeps ticks run and
+// the rest of the time is dropped, instead of the backlog growing every
+// frame.
+class SimulationClock
+{
+public:
+    explicit SimulationClock(float tick_rate = 60.0f, int max_substeps = 8);
+
+    // Ticks per second of real time
+    void setTickRate(float rate);
+    float getTickRate() const { return tick_rate; }
+    float getTickSeconds() const { return tick_seconds; }
+
+    void setMaxSubsteps(int count);
+    int getMaxSubsteps() const { return max_substeps; }
+
+    // Banks frame_seconds of real time and returns how many ticks to run
+    int advance(float frame_seconds);
+
+    // How far the leftover time is into the next tick, in [0, 1). Drawing
+    // the last two tick states blended by this hides the ticks from the frames.
+    float getAlpha() const { return accumulator / tick_seconds; }
+
+    uint64_t getTickCount() const { return tick_count; }
+    uint64_t getDroppedTicks() const { return dropped_ticks; }      // Skipped to stay within max_substeps
+
+    // Forget the banked time, e.g. after loading
+    void reset() { accumulator = 0.0f; }
+
+private:
+    float tick_rate;
+    float tick_seconds;
+    int max_substeps;
+    float accumulator = 0.0f;
+    uint64_t tick_count = 0;
+    uint64_t dropped_ticks = 0;
+};
@@ -0,0 +1,290 @@
+#include "SpatialHashGrid.hpp"
+
+static int64_t getCellCoordinate(float value, float cell_size)
+{
+    return static_cast<int64_t>(std::floor(value / cell_size));
+}
+
+// Every bit of the key has to reach the low bits the table uses
+static size_t getSlot(uint64_t key, size_t mask)
+{
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDull;
+    key ^= key >> 33;
+    return static_cast<size_t>(key) & mask;
+}
+
+void SpatialHashGrid::update(const std::vector<BvhBounds>& bounds)
+{
+    pairs.clear();
+
+    // Ids have to name the same objects as last time
+    bool moved_all = bounds.size() != object_keys.size();
+    for (uint32_t i = 0; i < bounds.size() && !moved_all; ++i)
+    {
+        const int level = getLevel(bounds[i]);
+        if (level == MAX_LEVELS - 1)
+        {
+            // Might not fit the coarsest cells any more
+            const vector3f extent = bounds[i].bounds_max - bounds[i].bounds_min;
+            if (std::max(extent.X, std::max(extent.Y, extent.Z)) > cell_sizes[level])
+            {
+                moved_all = true;
+                break;
+            }
+        }
+
+        // Move only the boxes whose center left their cell
+        const uint64_t key = getCellKey(bounds[i], level);
+        if (key == object_keys[i])
+        {
+            continue;
+        }
+
+        // A new cell may need a slot; keep at most half of them taken
+        if ((used_slots + 1) * 2 > cells.size())
+        {
+            rehash();
+        }
+
+        unlink(i);
+        --level_counts[levels[i]];
+        object_keys[i] = key;
+        levels[i] = static_cast<uint8_t>(level);
+        ++level_counts[level];
+        link(i);
+    }
+
+    if (moved_all)
+    {
+        rebuild(bounds);
+    }
+
+    if (bounds.empty())
+    {
+        return;
+    }
+
+    uint32_t used_levels = 0;
+    for (int level = 0; level < MAX_LEVELS; ++level)
+    {
+        if (level_counts[level] > 0)
+        {
+            used_levels |= 1u << level;
+        }
+    }
+
+    // Each box looks for others on its own level and the coarser ones, so
+    // every pair is found once, from its finer box (or lower id). Boxes on a
+    // level are at most a cell wide, so their centers are within half a cell
+    // of anything they overlap, which is mostly 2 cells a side rather than 3.
+    for (uint32_t i = 0; i < bounds.size(); ++i)
+    {
+        const BvhBounds& box = bounds[i];
+
+        for (int level = levels[i]; level < MAX_LEVELS; ++level)
+        {
+            if (!(used_levels & (1u << level)))
+            {
+                continue;
+            }
+
+            const float cell_size = cell_sizes[level];
+            const float reach = cell_size * 0.5f;
+            const int64_t min_x = getCellCoordinate(box.bounds_min.X - reach, cell_size);
+            const int64_t min_y = getCellCoordinate(box.bounds_min.Y - reach, cell_size);
+            const int64_t min_z = getCellCoordinate(box.bounds_min.Z - reach, cell_size);
+            const int64_t max_x = getCellCoordinate(box.bounds_max.X + reach, cell_size);
+            const int64_t max_y = getCellCoordinate(box.bounds_max.Y + reach, cell_size);
+            const int64_t max_z = getCellCoordinate(box.bounds_max.Z + reach, cell_size);
+
+            for (int64_t z = min_z; z <= max_z; ++z)
+            {
+                for (int64_t y = min_y; y <= max_y; ++y)
+                {
+                    for (int64_t x = min_x; x <= max_x; ++x)
+                    {
+                        const Cell* cell = findCell(makeKey(level, x, y, z));
+                        if (!cell)
+                        {
+                            continue;
+                        }
+
+                        for (uint32_t other = cell->head; other != NO_OBJECT; other = next_in_cell[other])
+                        {
+                            if (level == levels[i] && other <= i)
+                            {
+                                continue;
+                            }
+
+                            const BvhBounds& other_box = bounds[other];
+                            if (box.bounds_min.X > other_box.bounds_max.X || other_box.bounds_min.X > box.bounds_max.X ||
+                                box.bounds_min.Y > other_box.bounds_max.Y || other_box.bounds_min.Y > box.bounds_max.Y ||
+                                box.bounds_min.Z > other_box.bounds_max.Z || other_box.bounds_min.Z > box.bounds_max.Z)
+                            {
+                                continue;
+                            }
+
+                            pairs.emplace_back(std::min(i, other), std::max(i, other));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SpatialHashGrid::rebuild(const std::vector<BvhBounds>& bounds)
+{
+    object_keys.resize(bounds.size());
+    levels.resize(bounds.size());
+    next_in_cell.resize(bounds.size());
+    previous_in_cell.resize(bounds.size());
+    std::fill(std::begin(level_counts), std::end(level_counts), 0u);
+    if (bounds.empty())
+    {
+        cells.clear();
+        used_slots = 0;
+        return;
+    }
+
+    // The smallest box sets the finest cells, as long as the biggest one
+    // still fits the coarsest
+    float smallest = 0.0f;
+    float largest = 0.0f;
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+        const vector3f extent = bounds[i].bounds_max - bounds[i].bounds_min;
+        const float size = std::max(extent.X, std::max(extent.Y, extent.Z));
+        smallest = i == 0 ? size : std::min(smallest, size);
+        largest = std::max(largest, size);
+    }
+    cell_sizes[0] = std::max(smallest, largest / static_cast<float>(1u << (MAX_LEVELS - 1)));
+    if (cell_sizes[0] <= 0.0f)
+    {
+        cell_sizes[0] = 1.0f;       // Every box is a point
+    }
+    for (int level = 1; level < MAX_LEVELS; ++level)
+    {
+        cell_sizes[level] = cell_sizes[level - 1] * 2.0f;
+    }
+
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+        const int level = getLevel(bounds[i]);
+        levels[i] = static_cast<uint8_t>(level);
+        object_keys[i] = getCellKey(bounds[i], level);
+        ++level_counts[level];
+    }
+    rehash();
+}
+
+void SpatialHashGrid::rehash()
+{
+    // At most one cell per object plus the one about to be added, at most
+    // half the slots taken
+    size_t slot_count = 16;
+    while (slot_count < (object_keys.size() + 1) * 2)
+    {
+        slot_count *= 2;
+    }
+    cells.assign(slot_count, Cell{ 0, NO_OBJECT });
+    used_slots = 0;
+
+    // Linked from the back, so each cell lists its objects by id
+    for (size_t i = object_keys.size(); i-- > 0;)
+    {
+        link(static_cast<uint32_t>(i));
+    }
+}
+
+int SpatialHashGrid::getLevel(const BvhBounds& box) const
+{
+    const vector3f extent = box.bounds_max - box.bounds_min;
+    const float size = std::max(extent.X, std::max(extent.Y, extent.Z));
+    int level = 0;
+    while (level < MAX_LEVELS - 1 && cell_sizes[level] < size)
+    {
+        ++level;
+    }
+    return level;
+}
+
+uint64_t SpatialHashGrid::getCellKey(const BvhBounds& box, int level) const
+{
+    const vector3f center = (box.bounds_min + box.bounds_max) * 0.5f;
+    const float cell_size = cell_sizes[level];
+    return makeKey(level, getCellCoordinate(center.X, cell_size), getCellCoordinate(center.Y, cell_size),
+                   getCellCoordinate(center.Z, cell_size));
+}
+
+void SpatialHashGrid::link(uint32_t object)
+{
+    Cell& cell = findSlot(object_keys[object]);
+    next_in_cell[object] = cell.head;
+    previous_in_cell[object] = NO_OBJECT;
+    if (cell.head != NO_OBJECT)
+    {
+        previous_in_cell[cell.head] = object;
+    }
+    cell.head = object;
+}
+
+void SpatialHashGrid::unlink(uint32_t object)
+{
+    const uint32_t next = next_in_cell[object];
+    const uint32_t previous = previous_in_cell[object];
+    if (previous != NO_OBJECT)
+    {
+        next_in_cell[previous] = next;
+    }
+    else
+    {
+        findSlot(object_keys[object]).head = next;
+    }
+    if (next != NO_OBJECT)
+    {
+        previous_in_cell[next] = previous;
+    }
+}
+
+uint64_t SpatialHashGrid::makeKey(int level, int64_t x, int64_t y, int64_t z)
+{
+    // Coordinates wrap at 2^19 cells; cells that end up sharing a key only
+    // cost a few more box tests. The top bit keeps keys away from 0.
+    const uint64_t mask = (1ull << 19) - 1;
+    return (1ull << 63) | (static_cast<uint64_t>(level) << 57) |
+        ((static_cast<uint64_t>(x) & mask) << 38) | ((static_cast<uint64_t>(y) & mask) << 19) |
+        (static_cast<uint64_t>(z) & mask);
+}
+
+SpatialHashGrid::Cell& SpatialHashGrid::findSlot(uint64_t key)
+{
+    const size_t mask = cells.size() - 1;
+    size_t slot = getSlot(key, mask);
+    while (cells[slot].key != 0 && cells[slot].key != key)
+    {
+        slot = (slot + 1) & mask;
+    }
+    if (cells[slot].key == 0)
+    {
+        cells[slot].key = key;
+        ++used_slots;
+    }
+    return cells[slot];
+}
+
+const SpatialHashGrid::Cell* SpatialHashGrid::findCell(uint64_t key) const
+{
+    const size_t mask = cells.size() - 1;
+    size_t slot = getSlot(key, mask);
+    while (cells[slot].key != 0)
+    {
+        if (cells[slot].key == key)
+        {
+            return &cells[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Bvh.hpp"
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+// Broadphase for many moving objects. Each box goes in one cell, by its
+// center, on the grid level whose cells are at least as big as the box, so
+// overlapping boxes are always in neighbouring cells of the coarser one's
+// level. Finding the pairs then takes time linear in the number of boxes
+// (plus pairs), however they are spread out.
+//
+// The grid is kept between updates: a box that stays in its cell costs one
+// key computation, and only boxes that cross into another cell (or level)
+// are moved. It is laid out again when the number of boxes changes or a box
+// outgrows the coarsest level.
+class SpatialHashGrid
+{
+public:
+    // Boxes by object id; finds every overlapping pair
+    void update(const std::vector<BvhBounds>& bounds);
+
+    // Pairs of overlapping boxes from the last update, lower id first
+    const std::vector<std::pair<uint32_t, uint32_t>>& getPairs() const { return pairs; }
+
+private:
+    static constexpr int MAX_LEVELS = 16;           // Each one's cells twice the size of the last
+    static constexpr uint32_t NO_OBJECT = 0xFFFFFFFF;
+
+    struct Cell
+    {
+        uint64_t key;           // 0 for free slots
+        uint32_t head;          // First object in the cell, NO_OBJECT once it emptied
+    };
+
+    // Hash table with linear probing. Cells that emptied keep their slot
+    // until the table fills up and is rebuilt from the objects.
+    std::vector<Cell> cells;
+    size_t used_slots = 0;
+
+    // Per object: its cell, its level and its neighbours in the cell's list
+    std::vector<uint64_t> object_keys;
+    std::vector<uint8_t> levels;
+    std::vector<uint32_t> next_in_cell;
+    std::vector<uint32_t> previous_in_cell;
+    uint32_t level_counts[MAX_LEVELS] = {};
+
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+
+    float cell_sizes[MAX_LEVELS] = {};
+
+    // Pick cell sizes for these boxes and put every one in its cell
+    void rebuild(const std::vector<BvhBounds>& bounds);
+
+    // Fresh table holding the objects' current cells
+    void rehash();
+
+    int getLevel(const BvhBounds& box) const;
+    uint64_t getCellKey(const BvhBounds& box, int level) const;
+    void link(uint32_t object);
+    void unlink(uint32_t object);
+
+    static uint64_t makeKey(int level, int64_t x, int64_t y, int64_t z);
+    Cell& findSlot(uint64_t key);
+    const Cell* findCell(uint64_t key) const;
+};
@@ -0,0 +1,128 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool& ThreadPool::get()
+{
+    static ThreadPool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1);
+    return pool;
+}
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    task_available.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (count == 1 || workers.empty())
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            body(i);
+        }
+        return;
+    }
+
+    // Helpers may only get scheduled after the caller has finished the whole
+    // range, so everything they touch lives in shared state, not on this stack
+    struct Range
+    {
+        std::atomic<size_t> next{0};
+        size_t count = 0;
+        size_t finished = 0;
+        const std::function<void(size_t)>* body = nullptr;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    auto range = std::make_shared<Range>();
+    range->count = count;
+    range->body = &body;
+
+    auto run = [](Range& r)
+    {
+        size_t completed = 0;
+        for (size_t i = r.next.fetch_add(1); i < r.count; i = r.next.fetch_add(1))
+        {
+            (*r.body)(i);
+            ++completed;
+        }
+
+        if (completed > 0)
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.finished += completed;
+            if (r.finished == r.count)
+            {
+                r.done.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        submit([range, run]() { run(*range); });
+    }
+
+    run(*range);
+
+    // body stays valid until every index has been processed; late helpers
+    // find the range exhausted and never dereference it
+    std::unique_lock<std::mutex> lock(range->mutex);
+    range->done.wait(lock, [&]() { return range->finished == range->count; });
+}
+
+void ThreadPool::workerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty())
+            {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stddef.h>
+
+// Fixed set of worker threads fed from one FIFO queue. Loaders use the
+// process-wide pool from get() for CPU-only work (decoding, normal
+// generation); nothing submitted here may touch the render API.
+class ThreadPool
+{
+public:
+    // Shared pool with one worker per hardware thread, minus the caller's
+    static ThreadPool& get();
+
+    explicit ThreadPool(size_t thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run task on a worker at some later point
+    void submit(std::function<void()> task);
+
+    // Call body(i) for every i in [0, count) and return once all calls have
+    // finished. The calling thread works through the range too, so this is
+    // safe to use from inside a pool task. Indices are handed out in order.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    size_t getThreadCount() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    bool stopping = false;
+
+    void workerLoop();
+};
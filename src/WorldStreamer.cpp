@@ -0,0 +1,388 @@
+#include "WorldStreamer.hpp"
+#include "Utils/AssetFile.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+WorldStreamer::WorldStreamer(IRenderAPI* render_api) : render_api(render_api)
+{
+}
+
+WorldStreamer::~WorldStreamer()
+{
+    close();
+}
+
+bool WorldStreamer::open(const std::string& filename)
+{
+    close();
+
+    AssetFile source;
+    if (!source.open(filename))
+    {
+        fprintf(stderr, "[World Streamer] Cannot open %s\n", filename.c_str());
+        return false;
+    }
+    std::istringstream file(std::string(reinterpret_cast<const char*>(source.data()), source.size()));
+
+    std::unordered_map<int64_t, WorldCell> parsed;
+    WorldCell* current = nullptr;
+    float parsed_cell_size = 64.0f;
+
+    std::string text;
+    for (int line_number = 1; std::getline(file, text); ++line_number)
+    {
+        std::istringstream line(text);
+        std::string keyword;
+        if (!(line >> keyword) || keyword[0] == '#')
+        {
+            continue;
+        }
+
+        std::string error;
+        if (keyword == "cell_size")
+        {
+            if (!(line >> parsed_cell_size) || parsed_cell_size <= 0.0f)
+            {
+                error = "cell_size needs a positive number";
+            }
+        }
+        else if (keyword == "cell")
+        {
+            int x, z;
+            if (line >> x >> z)
+            {
+                current = &parsed[makeCellKey(x, z)];
+                current->x = x;
+                current->z = z;
+            }
+            else
+            {
+                error = "cell needs two integer coordinates";
+            }
+        }
+        else if (keyword == "mesh" || keyword == "model" || keyword == "collider")
+        {
+            WorldObject object;
+            if (!current)
+            {
+                error = keyword + " outside of a cell";
+            }
+            else if (parseObject(keyword, line, object, error))
+            {
+                current->objects.push_back(std::move(object));
+            }
+        }
+        else
+        {
+            error = "unknown keyword '" + keyword + "'";
+        }
+
+        if (!error.empty())
+        {
+            fprintf(stderr, "[World Streamer] %s:%d: %s\n", filename.c_str(), line_number, error.c_str());
+            return false;
+        }
+    }
+
+    cells = std::move(parsed);
+    cell_size = parsed_cell_size;
+
+    size_t object_count = 0;
+    for (const auto& entry : cells)
+    {
+        object_count += entry.second.objects.size();
+    }
+    printf("[World Streamer] %s: %zu cells, %zu objects, cell size %.1f\n",
+           filename.c_str(), cells.size(), object_count, cell_size);
+    return true;
+}
+
+void WorldStreamer::close()
+{
+    // Cells still loading finish first; their loaders wait for the workers
+    loaded_cells.clear();
+    cells.clear();
+    rebuildLists();
+}
+
+void WorldStreamer::update(const vector3f& focus)
+{
+    if (cells.empty())
+    {
+        return;
+    }
+
+    // Nearest missing cells first, so the one under the camera is never last
+    std::vector<std::pair<float, const WorldCell*>> wanted;
+    for (const auto& entry : cells)
+    {
+        float distance = getCellDistance(entry.second, focus);
+        if (distance <= settings.load_radius && loaded_cells.find(entry.first) == loaded_cells.end())
+        {
+            wanted.emplace_back(distance, &entry.second);
+        }
+    }
+    std::sort(wanted.begin(), wanted.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    for (const auto& entry : wanted)
+    {
+        startCell(*entry.second);
+    }
+
+    // Spread the budget over the cells that are still loading
+    using clock = std::chrono::steady_clock;
+    const clock::time_point deadline = clock::now() +
+        std::chrono::microseconds(static_cast<long long>(settings.time_budget_ms * 1000.0f));
+
+    bool changed = false;
+    for (auto& entry : loaded_cells)
+    {
+        LoadedCell& loaded = *entry.second;
+        if (loaded.ready)
+        {
+            continue;
+        }
+
+        float remaining_ms = std::chrono::duration<float, std::milli>(deadline - clock::now()).count();
+        if (loaded.loader->update(std::max(remaining_ms, 0.0f)))
+        {
+            finishCell(loaded);
+            changed = true;
+        }
+    }
+
+    size_t loaded_before = loaded_cells.size();
+    evictCells(focus);
+    changed |= loaded_cells.size() != loaded_before;
+
+    if (changed)
+    {
+        rebuildLists();
+    }
+}
+
+size_t WorldStreamer::getLoadedCellCount() const
+{
+    size_t count = 0;
+    for (const auto& entry : loaded_cells)
+    {
+        count += entry.second->ready ? 1 : 0;
+    }
+    return count;
+}
+
+int64_t WorldStreamer::makeCellKey(int x, int z)
+{
+    return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(z);
+}
+
+float WorldStreamer::getCellDistance(const WorldCell& cell, const vector3f& focus) const
+{
+    float center_x = (cell.x + 0.5f) * cell_size;
+    float center_z = (cell.z + 0.5f) * cell_size;
+    float dx = center_x - focus.X;
+    float dz = center_z - focus.Z;
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+void WorldStreamer::startCell(const WorldCell& cell)
+{
+    auto loaded = std::make_unique<LoadedCell>();
+    loaded->cell = &cell;
+    loaded->loader = std::make_unique<LevelLoader>(render_api);
+
+    // Objects are named by index because a cell may place a file several times
+    LevelManifest manifest;
+    std::vector<std::string> textures;
+    for (size_t i = 0; i < cell.objects.size(); ++i)
+    {
+        const WorldObject& object = cell.objects[i];
+        gameObject& owner = loaded->objects.emplace_back();
+        owner.position = object.position;
+        owner.rotation = object.rotation;
+        owner.scale = object.scale;
+
+        if (object.kind == WorldObjectKind::Model)
+        {
+            LevelAsset& asset = manifest.addModel(object.filename, owner);
+            asset.name = "#" + std::to_string(i);
+            asset.gltf_config = settings.gltf_config;
+            asset.material_config = settings.material_config;
+            asset.fallback_texture = object.texture;
+        }
+        else
+        {
+            manifest.addMesh(object.filename, owner).name = "#" + std::to_string(i);
+            if (!object.texture.empty() && std::find(textures.begin(), textures.end(), object.texture) == textures.end())
+            {
+                textures.push_back(object.texture);
+                manifest.addTexture(object.texture);
+            }
+        }
+    }
+
+    if (!loaded->loader->begin(manifest))
+    {
+        fprintf(stderr, "[World Streamer] Could not start cell %d %d\n", cell.x, cell.z);
+        return;
+    }
+
+    loaded_cells[makeCellKey(cell.x, cell.z)] = std::move(loaded);
+}
+
+void WorldStreamer::finishCell(LoadedCell& loaded)
+{
+    const WorldCell& cell = *loaded.cell;
+    for (size_t i = 0; i < cell.objects.size(); ++i)
+    {
+        const WorldObject& object = cell.objects[i];
+        mesh* object_mesh = loaded.loader->getMesh("#" + std::to_string(i));
+        if (!object_mesh)
+        {
+            continue; // Reported by the loader
+        }
+
+        if (object.kind == WorldObjectKind::Collider)
+        {
+            object_mesh->visible = false;
+            loaded.colliders.push_back(std::make_unique<collider>(*object_mesh, object_mesh->obj));
+            continue;
+        }
+
+        if (object.kind == WorldObjectKind::Mesh && !object.texture.empty())
+        {
+            object_mesh->set_texture(loaded.loader->getTexture(object.texture));
+        }
+        object_mesh->transparent = object.transparent;
+        object_mesh->culling = object.culling;
+        loaded.meshes.push_back(object_mesh);
+    }
+
+    loaded.ready = true;
+    printf("[World Streamer] Cell %d %d loaded (%zu meshes, %zu colliders, %zu errors)\n", cell.x, cell.z,
+           loaded.meshes.size(), loaded.colliders.size(), loaded.loader->getErrors().size());
+}
+
+void WorldStreamer::evictCells(const vector3f& focus)
+{
+    // Cells that are still loading are left alone until they are done
+    std::vector<std::pair<float, int64_t>> candidates;
+    for (const auto& entry : loaded_cells)
+    {
+        if (entry.second->ready)
+        {
+            candidates.emplace_back(getCellDistance(*entry.second->cell, focus), entry.first);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    size_t loaded_count = loaded_cells.size();
+    for (const auto& candidate : candidates)
+    {
+        bool out_of_range = candidate.first > settings.unload_radius;
+        bool over_budget = settings.max_loaded_cells > 0 && loaded_count > settings.max_loaded_cells &&
+                           candidate.first > settings.load_radius;
+        if (!out_of_range && !over_budget)
+        {
+            continue;
+        }
+
+        const WorldCell& cell = *loaded_cells[candidate.second]->cell;
+        printf("[World Streamer] Cell %d %d unloaded\n", cell.x, cell.z);
+        loaded_cells.erase(candidate.second);
+        --loaded_count;
+    }
+}
+
+void WorldStreamer::rebuildLists()
+{
+    meshes.clear();
+    colliders.clear();
+    for (const auto& entry : loaded_cells)
+    {
+        const LoadedCell& loaded = *entry.second;
+        meshes.insert(meshes.end(), loaded.meshes.begin(), loaded.meshes.end());
+        for (const auto& cell_collider : loaded.colliders)
+        {
+            colliders.push_back(cell_collider.get());
+        }
+    }
+    ++revision;
+}
+
+bool WorldStreamer::parseObject(const std::string& kind, std::istream& line, WorldObject& object, std::string& error)
+{
+    object.kind = kind == "model" ? WorldObjectKind::Model
+                : kind == "collider" ? WorldObjectKind::Collider
+                : WorldObjectKind::Mesh;
+
+    if (!(line >> object.filename))
+    {
+        error = kind + " needs a file";
+        return false;
+    }
+
+    std::string option;
+    while (line >> option)
+    {
+        if (option == "texture")
+        {
+            if (!(line >> object.texture))
+            {
+                error = "texture needs a file";
+                return false;
+            }
+        }
+        else if (option == "position" || option == "rotation")
+        {
+            vector3f& value = option == "position" ? object.position : object.rotation;
+            if (!(line >> value.X >> value.Y >> value.Z))
+            {
+                error = option + " needs three numbers";
+                return false;
+            }
+        }
+        else if (option == "scale")
+        {
+            if (!(line >> object.scale.X))
+            {
+                error = "scale needs one or three numbers";
+                return false;
+            }
+
+            // Uniform unless two more numbers follow
+            std::streampos mark = line.tellg();
+            float y, z;
+            if (line >> y >> z)
+            {
+                object.scale.Y = y;
+                object.scale.Z = z;
+            }
+            else
+            {
+                line.clear();
+                line.seekg(mark);
+                object.scale.Y = object.scale.Z = object.scale.X;
+            }
+        }
+        else if (option == "transparent")
+        {
+            object.transparent = true;
+        }
+        else if (option == "no_culling")
+        {
+            object.culling = false;
+        }
+        else
+        {
+            error = "unknown option '" + option + "'";
+            return false;
+        }
+    }
+    return true;
+}
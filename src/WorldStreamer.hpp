@@ -0,0 +1,135 @@
+#pragma once
+
+#include "LevelLoader.hpp"
+#include "Components/collider.hpp"
+#include <deque>
+#include <istream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+// .gworld is a text file that splits a map into square cells on the XZ plane.
+// Every object belongs to exactly one cell and is loaded and unloaded with it:
+//
+//   # comment
+//   cell_size 64
+//   cell 0 -1
+//   mesh models/rocks.obj texture textures/rock.png position 10 0 -40
+//   model models/house.gltf position 20 0 -50 rotation 0 90 0 scale 2
+//   collider models/house_collider.obj position 20 0 -50 rotation 0 90 0 scale 2
+//
+// Object lines start with their kind (mesh, model or collider) and a file,
+// followed by any of: texture <file>, position <x y z>, rotation <x y z>
+// (degrees), scale <s> or scale <x y z>, transparent, no_culling.
+enum class WorldObjectKind
+{
+    Mesh,       // Rendered geometry, optionally with a texture
+    Model,      // glTF with its materials
+    Collider    // Collision geometry, never rendered
+};
+
+struct WorldObject
+{
+    WorldObjectKind kind = WorldObjectKind::Mesh;
+    std::string filename;
+    std::string texture;
+    vector3f position = vector3f(0.0f, 0.0f, 0.0f);
+    vector3f rotation = vector3f(0.0f, 0.0f, 0.0f);
+    vector3f scale = vector3f(1.0f, 1.0f, 1.0f);
+    bool transparent = false;
+    bool culling = true;
+};
+
+struct WorldCell
+{
+    int x = 0;
+    int z = 0;
+    std::vector<WorldObject> objects;
+};
+
+struct WorldStreamingSettings
+{
+    float load_radius = 96.0f;          // Cells whose center is this close to the focus get loaded
+    float unload_radius = 160.0f;       // and stay until it is further than this
+    size_t max_loaded_cells = 0;        // Evict the furthest cells beyond load_radius past this (0 = no limit)
+    float time_budget_ms = 4.0f;        // Main-thread work per update()
+
+    // Used for model objects
+    GltfLoaderConfig gltf_config;
+    MaterialLoaderConfig material_config;
+};
+
+// Keeps the cells around a focus point (usually the active camera) loaded.
+// Each cell streams in through its own LevelLoader, so files are read and
+// decoded on the ThreadPool and only uploads happen in update(). Cells are
+// evicted with hysteresis between load_radius and unload_radius, so walking
+// along a cell border does not reload it every frame; geometry and textures
+// shared with other cells stay alive through their reference counts.
+//
+// getMeshes() and getColliders() change only inside update(); compare
+// getRevision() to know when to rebuild render and physics lists.
+class WorldStreamer
+{
+public:
+    explicit WorldStreamer(IRenderAPI* render_api);
+    ~WorldStreamer();
+
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    void setSettings(const WorldStreamingSettings& new_settings) { settings = new_settings; }
+    const WorldStreamingSettings& getSettings() const { return settings; }
+
+    // Start loading cells around focus, finish loads within the time budget
+    // and evict cells that fell out of range
+    void update(const vector3f& focus);
+
+    const std::vector<mesh*>& getMeshes() const { return meshes; }
+    const std::vector<collider*>& getColliders() const { return colliders; }
+    uint64_t getRevision() const { return revision; }
+
+    bool isOpen() const { return !cells.empty(); }
+    float getCellSize() const { return cell_size; }
+    size_t getCellCount() const { return cells.size(); }
+    size_t getLoadedCellCount() const;
+    size_t getLoadingCellCount() const { return loaded_cells.size() - getLoadedCellCount(); }
+
+private:
+    // Member order matters: colliders point into the loader's meshes, and the
+    // meshes into objects
+    struct LoadedCell
+    {
+        const WorldCell* cell = nullptr;
+        std::deque<gameObject> objects;
+        std::unique_ptr<LevelLoader> loader;
+        std::vector<std::unique_ptr<collider>> colliders;
+        std::vector<mesh*> meshes;
+        bool ready = false;
+    };
+
+    IRenderAPI* render_api;
+    WorldStreamingSettings settings;
+    float cell_size = 64.0f;
+
+    std::unordered_map<int64_t, WorldCell> cells;
+    std::unordered_map<int64_t, std::unique_ptr<LoadedCell>> loaded_cells;
+
+    std::vector<mesh*> meshes;
+    std::vector<collider*> colliders;
+    uint64_t revision = 0;
+
+    static int64_t makeCellKey(int x, int z);
+    float getCellDistance(const WorldCell& cell, const vector3f& focus) const;
+
+    void startCell(const WorldCell& cell);
+    void finishCell(LoadedCell& loaded);
+    void evictCells(const vector3f& focus);
+    void rebuildLists();
+
+    static bool parseObject(const std::string& kind, std::istream& line, WorldObject& object, std::string& error);
+};
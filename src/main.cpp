@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <filesystem>
 
 #include "Application.hpp"
 
@@ -27,9 +28,15 @@
 #include "Components/playerRepresentation.hpp"
 #include "world.hpp"
 #include "Graphics/renderer.hpp"
+#include "Graphics/TextureManager.hpp"
 #include "AudioSystem.h"
 #include "Utils/GltfLoader.hpp"
 #include "Utils/GltfMaterialLoader.hpp"
+#include "LevelLoader.hpp"
+#include "AssetLoader.hpp"
+#include "WorldStreamer.hpp"
+#include "Utils/AssetCatalog.hpp"
+#include "Utils/AssetFile.hpp"
 
 #include "Utils/Log.hpp"
 
@@ -46,33 +53,9 @@ static void quit_game(int code)
     exit(code);
 }
 
-// TODO: move this to a better location
-// Helper function to get texture type name for logging
-std::string getTextureTypeName(TextureType type) {
-    switch (type) {
-        case TextureType::BASE_COLOR: return "Base Color";
-        case TextureType::METALLIC_ROUGHNESS: return "Metallic-Roughness";
-        case TextureType::NORMAL: return "Normal";
-        case TextureType::OCCLUSION: return "Occlusion";
-        case TextureType::EMISSIVE: return "Emissive";
-        case TextureType::DIFFUSE: return "Diffuse";
-        case TextureType::SPECULAR: return "Specular";
-        default: return "Unknown";
-    }
-}
-
-// TODO: move this to a better location
-// Function to load glTF
-mesh* loadGltfMeshWithMaterials(const std::string& filename, gameObject& obj, IRenderAPI* render_api)
+// Material setup shared by the glTF models of the level
+static MaterialLoaderConfig makeLevelMaterialConfig()
 {
-    // Configure geometry loading
-    GltfLoaderConfig gltf_config;
-    gltf_config.verbose_logging = true;
-    gltf_config.flip_uvs = true;
-    gltf_config.generate_normals_if_missing = true;
-    gltf_config.scale = 1.0f;
-
-    // Configure material loading with performance optimizations
     MaterialLoaderConfig material_config;
     material_config.verbose_logging = true;
     material_config.load_all_textures = false;  // Only load essential textures for better performance
@@ -85,75 +68,21 @@ mesh* loadGltfMeshWithMaterials(const std::string& filename, gameObject& obj, IR
     material_config.flip_textures_vertically = true;
     material_config.cache_textures = true;  // Prevent loading duplicate textures
     material_config.texture_base_path = "models/";
+    return material_config;
+}
 
-    // Load geometry and materials together
-    GltfLoadResult map_result = GltfLoader::loadGltfWithMaterials(filename, render_api, gltf_config, material_config);
-
-    if (!map_result.success) {
-        LOG_ENGINE_FATAL("Failed to load glTF file: {}", map_result.error_message.c_str());
-        return nullptr;
-    }
-
-    LOG_ENGINE_TRACE("Loaded glTF: {}", filename.c_str());
-    LOG_ENGINE_TRACE("Geometry loaded with {} vertices", map_result.vertex_count);
-    
-    if (map_result.materials_loaded) {
-		LOG_ENGINE_TRACE("Materials loaded: {}", map_result.material_data.total_materials);
-		LOG_ENGINE_TRACE("- Textures: {} loaded successfully, {} failed",
-            map_result.material_data.total_textures_loaded,
-            map_result.material_data.total_textures_failed);
-    }
-
-    // Create mesh from glTF data
-    mesh* gltf_mesh = new mesh(map_result.vertices, map_result.vertex_count, obj);
-
-    // Apply textures using the new material system
-    bool texture_applied = false;
-    
-    if (map_result.materials_loaded && !map_result.material_data.materials.empty()) {
-        // Try each material until we find one with a valid texture
-        for (const auto& material : map_result.material_data.materials) {
-            TextureHandle primary_texture = material.getPrimaryTextureHandle();
-            
-            if (primary_texture != INVALID_TEXTURE) {
-                gltf_mesh->set_texture(primary_texture);
-                printf("Applied texture from material: %s\n", material.properties.name.c_str());
-                texture_applied = true;
-                break;
-            }
-        }
-
-        // Print material information for debugging
-        if (material_config.verbose_logging) {
-            printf("Available materials:\n");
-            for (size_t i = 0; i < map_result.material_data.materials.size(); ++i) {
-                const auto& mat = map_result.material_data.materials[i];
-                printf("  [%zu] %s - %s\n", i, mat.properties.name.c_str(),
-                       mat.hasValidTextures() ? "has textures" : "no textures");
-                
-                // Show texture details
-                for (const auto& tex : mat.textures.textures) {
-                    printf("    %s: %s %s\n", 
-                           getTextureTypeName(tex.type).c_str(),
-                           tex.uri.c_str(),
-                           tex.is_loaded ? "(loaded)" : "(failed)");
-                }
-            }
-        }
-    }
-
-    // Fallback texture if no materials had valid textures
-    if (!texture_applied) {
-        printf("No valid textures found in materials, using fallback\n");
-        TextureHandle fallback_texture = render_api->loadTexture("textures/t_ground.png", true, true);
-        gltf_mesh->set_texture(fallback_texture);
-    }
-
-    // Transfer ownership to prevent cleanup
-    map_result.vertices = nullptr;
-    map_result.vertex_count = 0;
+// The trees are drawn untextured until their textures are in, which keeps
+// them out of the loading screen. The references are held for the rest of
+// the game, like the level's.
+static AssetTask<void> loadTreeTextures(AssetLoader& assets, mesh* trees, mesh* background_trees)
+{
+    std::vector<AssetTask<TextureHandle>> loads;
+    loads.push_back(assets.loadTexture("textures/t_tree_bark.png"));
+    loads.push_back(assets.loadTexture("textures/t_tree_leaves.png"));
+    std::vector<TextureHandle> textures = co_await whenAll(std::move(loads));
 
-    return gltf_mesh;
+    trees->set_texture(textures[0]);
+    background_trees->set_texture(textures[1]);
 }
 
 #if _WIN32
@@ -212,6 +141,9 @@ int main(int argc, char* argv[])
     /* Rigidbodies */
     rigidbody player_rb = rigidbody::rigidbody(player);
     player_rb.apply_gravity = false;
+    player_rb.ccd_radius = 1;
+    player_rb.shape = BodyShape::Sphere;
+    player_rb.radius = 1;
     std::vector<rigidbody*> rigidbodies;
     rigidbodies.push_back(&player_rb);
 
@@ -226,26 +158,92 @@ int main(int argc, char* argv[])
 
     _world.player_entity = &player_entity;
 
-    /* Meshes */
-    mesh sky_mesh = mesh("models/sky.obj", sky);
+    // Moved once per tick, drawn every frame
+    _world.add_interpolated(player);
+    _world.add_interpolated(_world.world_camera);
+    _world.add_interpolated(freecam_camera);
 
-    // Load glTF files
-    mesh* map_ground_mesh = loadGltfMeshWithMaterials("models/map.gltf", map, render_api);
-    mesh* player_rep_mesh = loadGltfMeshWithMaterials("models/Character.gltf", player_rep_obj, render_api);
+    /* Asset archive - Cooked by garden-cook, found before loose files */
+    bool cooked = std::filesystem::exists("assets.gpak") && AssetFileSystem::get().mount("assets.gpak");
 
-    // Continue with other mesh loading...
-    mesh map_trees_mesh = mesh::mesh("models/map_trees.obj", map);
-    map_trees_mesh.culling = false;
-    map_trees_mesh.transparent = true;
+    /* Asset catalog - Metadata of every asset, re-indexed only when a source changes */
+    if (!cooked)
+    {
+        AssetCatalog& catalog = AssetCatalog::get();
+        catalog.open("assets.gcat");
+        catalog.scan("models");
+        catalog.scan("textures");
+        catalog.save();
+    }
 
-    mesh map_bgtrees_mesh = mesh::mesh("models/map_bgtrees.obj", map);
-    map_bgtrees_mesh.transparent = true;
+    /* Level assets - Decoded on worker threads, uploaded here between loading frames */
+    GltfLoaderConfig gltf_config;
+    gltf_config.verbose_logging = true;
+    gltf_config.flip_uvs = true;
+    gltf_config.generate_normals_if_missing = true;
+    gltf_config.scale = 1.0f;
 
-    mesh map_collider_mesh = mesh::mesh("models/map_collider.obj", map);
+    LevelManifest manifest;
+    manifest.addMesh("models/sky.obj", sky);
+    LevelAsset& map_asset = manifest.addModel("models/map.gltf", map);
+    map_asset.gltf_config = gltf_config;
+    // Loaded flat: the exporter gave every node a +90 degree X rotation over
+    // vertices that are already Y-up, so applying node transforms would lay
+    // the level on its side
+    map_asset.material_config = makeLevelMaterialConfig();
+    map_asset.fallback_texture = "textures/t_ground.png";
+    LevelAsset& character_asset = manifest.addModel("models/Character.gltf", player_rep_obj);
+    character_asset.gltf_config = gltf_config;
+    character_asset.material_config = makeLevelMaterialConfig();
+    character_asset.fallback_texture = "textures/t_ground.png";
+    manifest.addMesh("models/map_trees.obj", map);
+    manifest.addMesh("models/map_bgtrees.obj", map);
+    manifest.addMesh("models/map_collider.obj", map);
+    manifest.addMesh("models/grasscube.obj", cube);
+    manifest.addTexture("textures/t_sky.png", false);
+    manifest.addTexture("textures/man.bmp");
+
+    LevelLoader level(render_api);
+    level.setProgressCallback([](const LevelLoadProgress& progress) {
+        LOG_ENGINE_TRACE("Loaded {} ({}/{})", progress.last_asset, progress.completed, progress.total);
+    });
+    if (!level.begin(manifest))
+    {
+        quit_game(1);
+    }
 
-    mesh cube_mesh = mesh::mesh("models/grasscube.obj", cube);
+    // Loading screen: fade the clear color while the workers run
+    while (!level.update(8.0f))
+    {
+        input_handler.process_events();
+        if (input_handler.should_quit_application())
+        {
+            quit_game(0);
+        }
+
+        float t = level.getProgress().getFraction();
+        render_api->clear(vector3f(0.05f + 0.15f * t, 0.05f + 0.25f * t, 0.1f + 0.7f * t));
+        app.swapBuffers();
+    }
+
+    mesh* sky_mesh = level.getMesh("models/sky.obj");
+    mesh* map_ground_mesh = level.getMesh("models/map.gltf");
+    mesh* player_rep_mesh = level.getMesh("models/Character.gltf");
+    mesh* map_trees_mesh = level.getMesh("models/map_trees.obj");
+    mesh* map_bgtrees_mesh = level.getMesh("models/map_bgtrees.obj");
+    mesh* map_collider_mesh = level.getMesh("models/map_collider.obj");
+    mesh* cube_mesh = level.getMesh("models/grasscube.obj");
+
+    if (!sky_mesh || !player_rep_mesh || !map_trees_mesh || !map_bgtrees_mesh || !map_collider_mesh || !cube_mesh)
+    {
+        LOG_ENGINE_FATAL("Failed to load the level ({} errors)", level.getErrors().size());
+        quit_game(1);
+    }
+
+    map_trees_mesh->culling = false;
+    map_trees_mesh->transparent = true;
+    map_bgtrees_mesh->transparent = true;
 
-    
     player_rep_obj.scale = vector3f(0.2f, 0.2f, 0.2f);
     player_rep_obj.position = vector3f(0, -20, 0);
 
@@ -253,40 +251,51 @@ int main(int argc, char* argv[])
     PlayerRepresentation player_representation = PlayerRepresentation(player_rep_mesh, &player_entity, player_rep_obj);
 
     std::vector<mesh*> meshes;
-    meshes.push_back(&sky_mesh);
+    meshes.push_back(sky_mesh);
     if (map_ground_mesh) {
         meshes.push_back(map_ground_mesh);
     }
-    meshes.push_back(&cube_mesh);
-    meshes.push_back(&map_bgtrees_mesh);
-    meshes.push_back(&map_trees_mesh);
+    meshes.push_back(cube_mesh);
+    meshes.push_back(map_bgtrees_mesh);
+    meshes.push_back(map_trees_mesh);
     meshes.push_back(player_rep_mesh);
 
     /* Colliders */
-    collider cube_collider = collider::collider(cube_mesh, cube);
-    collider map_collider = collider::collider(map_collider_mesh, map);
+    collider cube_collider = collider::collider(*cube_mesh, cube);
+    collider map_collider = collider::collider(*map_collider_mesh, map);
     std::vector<collider*> colliders;
     colliders.push_back(&cube_collider);
     colliders.push_back(&map_collider);
 
-    /* Textures - Using the abstracted render API */
-    TextureHandle sky_tex = render_api->loadTexture("textures/t_sky.png", false, true);
-    sky_mesh.set_texture(sky_tex);
-
-    TextureHandle ball_tex = render_api->loadTexture("textures/man.bmp", true, true);
-    cube_mesh.set_texture(ball_tex);
+    /* Textures - Uploaded by the level loader, which holds the references */
+    sky_mesh->set_texture(level.getTexture("textures/t_sky.png"));
+    cube_mesh->set_texture(level.getTexture("textures/man.bmp"));
+
+    /* World streaming - Cells around the active camera load in the background */
+    WorldStreamer world_streamer(render_api);
+    WorldStreamingSettings streaming_settings;
+    streaming_settings.gltf_config = gltf_config;
+    streaming_settings.material_config = makeLevelMaterialConfig();
+    world_streamer.setSettings(streaming_settings);
+    if (AssetFileSystem::get().exists("worlds/level.gworld"))
+    {
+        world_streamer.open("worlds/level.gworld");
+    }
 
-    TextureHandle tree_bark = render_api->loadTexture("textures/t_tree_bark.png", true, true);
-    TextureHandle tree_leaves = render_api->loadTexture("textures/t_tree_leaves.png", true, true);
+    /* On-demand assets - Coroutines started here resume between frames once their loads are done */
+    AssetLoader assets(render_api);
+    assets.start(loadTreeTextures(assets, map_trees_mesh, map_bgtrees_mesh));
 
-    map_trees_mesh.set_texture(tree_bark);
-    map_bgtrees_mesh.set_texture(tree_leaves);
+    // Streamed meshes and colliders are appended after the static ones
+    const size_t static_mesh_count = meshes.size();
+    const size_t static_collider_count = colliders.size();
+    uint64_t streamed_revision = world_streamer.getRevision();
 
     /* Renderer - Using the abstracted render API */
     _renderer = renderer::renderer(&meshes, render_api);
 
     /* Delta time */
-    Uint32 delta_last = 0;
+    Uint32 delta_last = SDL_GetTicks();     // Loading isn't simulated
     float delta_time = 0;
 
     printf("=== INPUT CONTROLS ===\n");
@@ -328,37 +337,63 @@ int main(int argc, char* argv[])
         delta_time = (frame_start_ticks - delta_last) / 1000.0f;
         delta_last = frame_start_ticks;
 
-        // physics and player collisions (only when controlling player)
-        if (!player_controller->isFreecamMode())
+        // stream world cells around the active camera
+        world_streamer.update(player_controller->getActiveCamera().position);
+        if (world_streamer.getRevision() != streamed_revision)
         {
-            _world.step_physics(rigidbodies);
-            _world.player_collisions(player_rb, 1, colliders);
+            meshes.resize(static_mesh_count);
+            meshes.insert(meshes.end(), world_streamer.getMeshes().begin(), world_streamer.getMeshes().end());
+            colliders.resize(static_collider_count);
+            colliders.insert(colliders.end(), world_streamer.getColliders().begin(), world_streamer.getColliders().end());
+            streamed_revision = world_streamer.getRevision();
         }
 
-        // Update currently possessed entity through player controller
-        player_controller->update(_world.fixed_delta);
+        // continue gameplay coroutines whose loads have finished
+        assets.update(2.0f);
 
-        // Update player representation visibility
-        player_representation.update(player_controller->isFreecamMode());
+        // fixed ticks for the time this frame took
+        const int ticks = _world.advance_clock(delta_time);
+        for (int tick = 0; tick < ticks; ++tick)
+        {
+            _world.begin_tick();
+
+            // physics and player collisions (only when controlling player)
+            if (!player_controller->isFreecamMode())
+            {
+                _world.step_physics(rigidbodies, colliders);
+                _world.player_collisions(player_rb, 1, colliders);
+            }
+
+            // Update currently possessed entity through player controller
+            player_controller->update(_world.fixed_delta);
+
+            _world.end_tick();
+        }
 
         // Fall detection (only when controlling player)
         if (!player_controller->isFreecamMode() && player_entity.obj.position.Y < -5)
             quit_game(0);
 
+        // draw the ticked objects between their last two ticks
+        _world.begin_render();
+
+        // Update player representation visibility
+        player_representation.update(player_controller->isFreecamMode());
+
         // render using the active camera (either player or freecam)
         camera& active_camera = player_controller->getActiveCamera();
         _renderer.render_scene(active_camera);
         app.swapBuffers();
 
+        _world.end_render();
+
+        // Free textures whose last reference was dropped this frame
+        TextureManager::get().collectGarbage();
+
         frame_end_ticks = SDL_GetTicks();
         app.lockFramerate(frame_start_ticks, frame_end_ticks);
     }
 
-    // Cleanup
-    if (map_ground_mesh) {
-        delete map_ground_mesh;
-    }
-
     crashHandler->Shutdown();
     exit(0);
 }
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "Components/collider.hpp"
 #include "Components/playerEntity.hpp"
 #include "PhysicsSystem.hpp"
+#include "Utils/SimulationClock.hpp"
+#include <algorithm>
 #include <vector>
 
 using namespace irr;
@@ -18,27 +20,116 @@ class world
 private:
     PhysicsSystem physics_system;
 
+    // An object whose drawn position is blended between ticks
+    struct interpolated_object
+    {
+        gameObject* object;
+        vector3f previous;      // Before the last tick
+        vector3f ticked;        // After it
+        vector3f simulated;     // Put back after rendering
+    };
+    vector<interpolated_object> interpolated_objects;
+
 public:
     camera world_camera;
     playerEntity* player_entity;
-    float fixed_delta; // Keep for compatibility, but physics system has its own
+    float fixed_delta; // Game time per tick; physics system has its own copy
+    SimulationClock simulation_clock;
 
     world()
     {
         world_camera = camera::camera(0, 0, -5);
         fixed_delta = 0.16f;
         physics_system = PhysicsSystem(vector3f(0, -1, 0), fixed_delta);
+        simulation_clock = SimulationClock(60.0f, 8);
         player_entity = nullptr;
     }
 
+    // Fixed timestep: each frame runs advance_clock(frame time) ticks, with
+    // begin_tick / end_tick around each, then draws between begin_render
+    // and end_render
+    int advance_clock(float frame_seconds)
+    {
+        return simulation_clock.advance(frame_seconds);
+    }
+
+    // Ticks per real second. Game time per tick scales to match, so the game
+    // runs at the same speed with more (finer, dearer) or fewer ticks.
+    void set_tick_rate(float rate)
+    {
+        if (!(rate > 0.0f))
+        {
+            return;
+        }
+        setFixedDelta(fixed_delta * simulation_clock.getTickRate() / rate);
+        simulation_clock.setTickRate(rate);
+    }
+
+    // Objects moved by ticks whose positions should be drawn smoothly; they
+    // have to outlive the world or be removed
+    void add_interpolated(gameObject& object)
+    {
+        interpolated_objects.push_back({ &object, object.position, object.position, object.position });
+    }
+
+    void remove_interpolated(gameObject& object)
+    {
+        interpolated_objects.erase(std::remove_if(interpolated_objects.begin(), interpolated_objects.end(),
+            [&object](const interpolated_object& entry) { return entry.object == &object; }),
+            interpolated_objects.end());
+    }
+
+    void begin_tick()
+    {
+        for (interpolated_object& entry : interpolated_objects)
+        {
+            entry.previous = entry.object->position;
+        }
+    }
+
+    void end_tick()
+    {
+        for (interpolated_object& entry : interpolated_objects)
+        {
+            entry.ticked = entry.object->position;
+        }
+    }
+
+    // Draws the objects the clock's alpha of the way from their previous to
+    // their latest tick. Rotations are left alone; nothing ticks them yet.
+    void begin_render()
+    {
+        const float alpha = simulation_clock.getAlpha();
+        for (interpolated_object& entry : interpolated_objects)
+        {
+            vector3f& position = entry.object->position;
+            entry.simulated = position;
+
+            // Moved outside a tick (a teleport): draw it where it is
+            if (position != entry.ticked)
+            {
+                entry.previous = entry.ticked = position;
+            }
+            position = entry.ticked.getInterpolated(entry.previous, alpha);
+        }
+    }
+
+    void end_render()
+    {
+        for (interpolated_object& entry : interpolated_objects)
+        {
+            entry.object->position = entry.simulated;
+        }
+    }
+
     // Physics system access
     PhysicsSystem& getPhysicsSystem() { return physics_system; }
     const PhysicsSystem& getPhysicsSystem() const { return physics_system; }
 
     // Simplified interface that delegates to physics system
-    void step_physics(vector<rigidbody*>& rigidbodies)
+    void step_physics(vector<rigidbody*>& rigidbodies, std::vector<collider*>& colliders)
     {
-        physics_system.stepPhysics(rigidbodies);
+        physics_system.stepPhysics(rigidbodies, colliders);
     }
 
     void player_collisions(rigidbody& player_rb, float sphere_radius, std::vector<collider*>& colliders)
@@ -0,0 +1,252 @@
+// Drives AssetTask coroutines the way AssetLoader does, with a main thread
+// queue and hops to the ThreadPool, and fails unless whenAll() hands back
+// every child's result in order, whether the children finish right away or
+// on workers. Destroying a whenAll() while its children are still suspended
+// has to free every coroutine frame it started and every child's locals.
+
+#include "Utils/AssetTask.hpp"
+#include "Utils/ThreadPool.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Every allocation, coroutine frames included
+static std::atomic<long> live_allocations{0};
+
+void* operator new(size_t size)
+{
+    void* memory = malloc(size ? size : 1);
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+    ++live_allocations;
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    if (memory)
+    {
+        --live_allocations;
+        free(memory);
+    }
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    operator delete(memory);
+}
+
+// Coroutines waiting for the main thread, resumed by pump()
+static std::deque<std::coroutine_handle<>> main_thread_queue;
+static std::mutex queue_mutex;
+
+struct MainThreadAwaiter
+{
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        main_thread_queue.push_back(handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct WorkerAwaiter
+{
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { ThreadPool::get().submit([handle]() { handle.resume(); }); }
+    void await_resume() const noexcept {}
+};
+
+static bool pump()
+{
+    std::coroutine_handle<> handle;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (main_thread_queue.empty())
+        {
+            return false;
+        }
+        handle = main_thread_queue.front();
+        main_thread_queue.pop_front();
+    }
+    handle.resume();
+    return true;
+}
+
+// Counts its instances, to see that cancelled children's locals go too
+struct Tracked
+{
+    static int alive;
+    Tracked() { ++alive; }
+    ~Tracked() { --alive; }
+};
+int Tracked::alive = 0;
+
+static AssetTask<int> finishRightAway(int value)
+{
+    co_return value;
+}
+
+static AssetTask<int> square(int value, bool on_worker)
+{
+    if (on_worker)
+    {
+        co_await WorkerAwaiter{};
+        value *= value;
+        co_await MainThreadAwaiter{};
+    }
+    else
+    {
+        value *= value;
+    }
+    co_return value;
+}
+
+// Parks on the main thread queue, which the cancel check never pumps
+static AssetTask<int> waitForever(int value)
+{
+    Tracked tracked;
+    co_await MainThreadAwaiter{};
+    co_return value;
+}
+
+static AssetTask<void> collect(std::vector<AssetTask<int>> tasks, std::vector<int>& results)
+{
+    results = co_await whenAll(std::move(tasks));
+}
+
+static AssetTask<void> nest(std::vector<AssetTask<void>> tasks)
+{
+    co_await whenAll(std::move(tasks));
+}
+
+static int checkCancelled()
+{
+    int failures = 0;
+    for (int round = 0; round < 3; ++round)
+    {
+        std::vector<int> results;
+        const long allocations_before = live_allocations;
+        {
+            std::vector<AssetTask<int>> children;
+            for (int i = 0; i < 8; ++i)
+            {
+                children.push_back(i % 3 == round ? finishRightAway(i) : waitForever(i));
+            }
+
+            // Nested, so a cancelled whenAll() is itself a child of one
+            std::vector<AssetTask<void>> outer;
+            outer.push_back(collect(std::move(children), results));
+            AssetTask<void> task = nest(std::move(outer));
+            task.start();
+
+            if (task.isDone() || Tracked::alive == 0)
+            {
+                printf("cancel round %d: the children did not wait\n", round);
+                ++failures;
+            }
+        }
+
+        // The parked handles belong to frames that are gone
+        main_thread_queue.clear();
+        main_thread_queue.shrink_to_fit();
+
+        if (Tracked::alive != 0 || live_allocations != allocations_before)
+        {
+            printf("cancel round %d: %d children and %ld allocations left over\n", round, Tracked::alive,
+                   live_allocations - allocations_before);
+            ++failures;
+        }
+    }
+
+    printf("whenAll destroyed while waiting: %d failures\n", failures);
+    return failures;
+}
+
+static int checkFinished()
+{
+    int failures = 0;
+    for (int count = 0; count < 6; ++count)
+    {
+        std::vector<AssetTask<int>> children;
+        for (int i = 0; i < count; ++i)
+        {
+            children.push_back(square(i, false));
+        }
+
+        std::vector<int> results;
+        AssetTask<void> task = collect(std::move(children), results);
+        task.start();
+        bool correct = task.isDone() && results.size() == static_cast<size_t>(count);
+        for (int i = 0; correct && i < count; ++i)
+        {
+            correct = results[i] == i * i;
+        }
+        if (!correct)
+        {
+            printf("%d children finishing right away: wrong results\n", count);
+            ++failures;
+        }
+    }
+
+    printf("whenAll over finished children: %d failures\n", failures);
+    return failures;
+}
+
+static int checkWorkers()
+{
+    int failures = 0;
+    const int rounds = 300;
+    for (int round = 0; round < rounds; ++round)
+    {
+        const int count = 1 + round % 24;
+        std::vector<AssetTask<int>> children;
+        for (int i = 0; i < count; ++i)
+        {
+            children.push_back(square(round + i, (i + round) % 5 != 0));
+        }
+
+        std::vector<int> results;
+        AssetTask<void> task = collect(std::move(children), results);
+        task.start();
+        while (!task.isDone())
+        {
+            if (!pump())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        bool correct = results.size() == static_cast<size_t>(count);
+        for (int i = 0; correct && i < count; ++i)
+        {
+            correct = results[i] == (round + i) * (round + i);
+        }
+        if (!correct && failures++ < 10)
+        {
+            printf("round %d, %d children on workers: wrong results\n", round, count);
+        }
+    }
+
+    printf("whenAll over children on workers: %d rounds, %d failures\n", rounds, failures);
+    return failures;
+}
+
+int main()
+{
+    // Before any worker runs, so the allocation count is this thread's alone
+    int failures = checkCancelled();
+    failures += checkFinished();
+    failures += checkWorkers();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// Cooks a models directory with garden-cook's AssetCooker, mounts the archive
+// next to the loose sources (the game's working directory after a checkout,
+// where every source has a new write time) and fails unless every OBJ is
+// served by its cooked .gmesh with the settings the mesh component loads
+// with, i.e. a cooked run parses no OBJ at all. A source that changed size
+// since the cook has to be rejected, and cooking again has to reuse every
+// bake except one whose contents were damaged.
+
+#include "tools/garden-cook/AssetCooker.hpp"
+#include "Utils/AssetFile.hpp"
+#include "Utils/BakedMesh.hpp"
+#include "Utils/GltfLoader.hpp"
+#include "Utils/ObjLoader.hpp"
+#include <stdio.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static bool writeObj(const fs::path& path, int quads)
+{
+    std::ofstream file(path);
+    for (int i = 0; i <= quads; ++i)
+    {
+        file << "v " << i << " 0 0\nv " << i << " 1 0\n";
+    }
+    file << "vt 0 0\nvt 1 1\nvn 0 0 1\n";
+    for (int i = 0; i < quads; ++i)
+    {
+        const int a = i * 2 + 1;
+        file << "f " << a << "/1/1 " << a + 2 << "/2/1 " << a + 3 << "/2/1 " << a + 1 << "/1/1\n";
+    }
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char** argv)
+{
+    const fs::path work = fs::temp_directory_path() / "garden-cook-test";
+    std::error_code ec;
+    fs::remove_all(work, ec);
+    fs::create_directories(work / "models");
+
+    std::vector<std::string> sources = { "models/strip.obj", "models/quad.obj" };
+    writeObj(work / sources[0], 64);
+    writeObj(work / sources[1], 1);
+    if (argc > 1)
+    {
+        // A real asset as well, when the test knows where the tree is
+        const fs::path collider = fs::path(argv[1]) / "models" / "map_collider.obj";
+        if (fs::copy_file(collider, work / "models" / "map_collider.obj", ec))
+        {
+            sources.push_back("models/map_collider.obj");
+        }
+    }
+    fs::current_path(work);
+
+    CookSettings settings;
+    settings.directories = { "models" };
+    int failures = 0;
+    AssetCooker cooker(settings);
+    if (!cooker.run() || cooker.getStats().cooked != sources.size())
+    {
+        printf("cook failed: %zu cooked, %zu failed\n", cooker.getStats().cooked, cooker.getStats().failed);
+        return 1;
+    }
+
+    // Cooking again reuses the bakes, except one whose vertices were damaged
+    const fs::path damaged = fs::path(settings.cache_directory) / BakedMesh::getCachePath(sources[0]);
+    {
+        std::fstream file(damaged, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(BakedMeshHeader) + 20);
+        file.put('\x7f');
+    }
+    AssetCooker recook(settings);
+    if (!recook.run() || recook.getStats().cooked != 1 || recook.getStats().up_to_date != sources.size() - 1)
+    {
+        printf("recook: %zu cooked, %zu up to date\n", recook.getStats().cooked, recook.getStats().up_to_date);
+        ++failures;
+    }
+
+    // Loose copies of the baked files must not be what gets found
+    fs::remove_all("cooked", ec);
+    for (const std::string& source : sources)
+    {
+        fs::last_write_time(source, fs::file_time_type::clock::now() + std::chrono::hours(1));
+    }
+    if (!AssetFileSystem::get().mount(settings.archive))
+    {
+        return 1;
+    }
+
+    const uint64_t config_hash = BakedMesh::hashConfig(ObjLoaderConfig());
+    for (const std::string& source : sources)
+    {
+        std::shared_ptr<BakedMesh> baked = BakedMesh::openIfCurrent(source, config_hash);
+        if (!baked || !(baked->getHeader().flags & BAKED_MESH_COOKED))
+        {
+            printf("%s: cooked mesh not used, the OBJ would be parsed\n", source.c_str());
+            ++failures;
+        }
+    }
+
+    // glTF bakes are cooked with validation on, the mesh component loads with it off
+    GltfLoaderConfig component_config;
+    component_config.validate_normals = false;
+    component_config.validate_texcoords = false;
+    if (BakedMesh::hashConfig(component_config) != BakedMesh::hashConfig(GltfLoaderConfig()))
+    {
+        printf("glTF validation changes the config hash, cooked glTF meshes would not be used\n");
+        ++failures;
+    }
+
+    // Edited after the cook
+    writeObj(sources[1], 2);
+    if (BakedMesh::openIfCurrent(sources[1], config_hash))
+    {
+        printf("%s: cooked mesh used although the source changed\n", sources[1].c_str());
+        ++failures;
+    }
+
+    printf("%zu OBJ sources cooked, %d failures\n", sources.size(), failures);
+    AssetFileSystem::get().unmountAll();
+    fs::current_path(fs::temp_directory_path());
+    fs::remove_all(work, ec);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+// Decodes meshopt streams whose contents are known and fails unless the
+// output matches byte for byte. The index streams are the reference streams
+// of meshoptimizer's own tests; the vertex stream is put together by hand from
+// the EXT_meshopt_compression spec, with one byte stream in each group mode,
+// escapes and a base vertex that isn't zero. The filters get values whose
+// decoded form is exact. Every truncation of the streams has to fail.
+
+#include "Utils/MeshoptDecoder.hpp"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+// Triangles 0 1 2, 2 1 3, 4 6 5, 7 8 9 with the index codec, version 0
+static const unsigned char INDEX_BUFFER_V0[] = {
+    0xe0, 0xf0, 0x10, 0xfe, 0xff, 0xf0, 0x0c, 0xff, 0x02, 0x02, 0x02, 0x00, 0x76, 0x87, 0x56, 0x67,
+    0x78, 0xa9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00,
+};
+static const uint32_t INDEX_BUFFER[] = { 0, 1, 2, 2, 1, 3, 4, 6, 5, 7, 8, 9 };
+
+// The index sequence codec, version 1
+static const unsigned char INDEX_SEQUENCE_V1[] = {
+    0xd1, 0x00, 0x04, 0xcd, 0x01, 0x04, 0x07, 0x98, 0x1f, 0x00, 0x00, 0x00, 0x00,
+};
+static const uint32_t INDEX_SEQUENCE[] = { 0, 1, 51, 2, 49, 1000 };
+
+// 16 vertices of 4 bytes in one block: every byte stream is one group of 16
+// zigzag deltas behind a header byte holding its mode, and the base vertex
+// is the last 4 bytes of the 32-byte tail
+static const unsigned char VERTEX_BUFFER_V0[] = {
+    0xa0,
+    0x00,                                                       // Byte 0: no deltas
+    0x01, 0x55, 0x00, 0xaa, 0xc0, 0x20,                         // Byte 1: 2-bit deltas, one escape
+    0x02, 0x02, 0x46, 0x8a, 0xce, 0x02, 0x46, 0x8a, 0xcf, 0xff, // Byte 2: 4-bit deltas, one escape
+    0x03, 0x01, 0x80, 0x7f, 0xfe, 0x10, 0x11, 0x00, 0x33,       // Byte 3: 8-bit deltas
+    0x02, 0x03, 0xc8, 0x09, 0x64, 0xff, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    10, 20, 30, 40,
+};
+static const unsigned char VERTEX_BUFFER[16][4] = {
+    { 10, 19, 30, 39 }, { 10, 18, 31, 103 }, { 10, 17, 33, 39 }, { 10, 16, 36, 166 },
+    { 10, 16, 40, 174 }, { 10, 16, 45, 165 }, { 10, 16, 51, 165 }, { 10, 16, 58, 139 },
+    { 10, 17, 58, 140 }, { 10, 18, 59, 138 }, { 10, 19, 61, 238 }, { 10, 20, 64, 233 },
+    { 10, 36, 68, 27 }, { 10, 36, 73, 155 }, { 10, 36, 79, 155 }, { 10, 36, 207, 154 },
+};
+
+static int failures = 0;
+
+static void check(bool passed, const char* what)
+{
+    if (!passed)
+    {
+        printf("%s: wrong output\n", what);
+        ++failures;
+    }
+}
+
+// Decodes count indices of index_size bytes and compares them with expected
+static bool decodesTo(MeshoptMode mode, size_t index_size, const unsigned char* data, size_t size,
+                      const uint32_t* expected, size_t count)
+{
+    std::vector<unsigned char> decoded(count * index_size + 1, 0xcc);
+    if (!MeshoptDecoder::decode(decoded.data(), count, index_size, data, size, mode) || decoded.back() != 0xcc)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t index = 0;
+        if (index_size == 2)
+        {
+            uint16_t narrow;
+            memcpy(&narrow, &decoded[i * 2], 2);
+            index = narrow;
+        }
+        else
+        {
+            memcpy(&index, &decoded[i * 4], 4);
+        }
+        if (index != expected[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every proper prefix of a stream has to be rejected
+static void checkTruncations(MeshoptMode mode, size_t stride, const unsigned char* data, size_t size, size_t count,
+                             const char* what)
+{
+    std::vector<unsigned char> decoded(count * stride);
+    for (size_t cut = 0; cut < size; ++cut)
+    {
+        std::vector<unsigned char> truncated(data, data + cut);
+        if (MeshoptDecoder::decode(decoded.data(), count, stride, truncated.data(), truncated.size(), mode))
+        {
+            printf("%s cut to %zu bytes: decoded anyway\n", what, cut);
+            ++failures;
+            return;
+        }
+    }
+}
+
+static void checkStreams()
+{
+    check(decodesTo(MeshoptMode::Triangles, 4, INDEX_BUFFER_V0, sizeof(INDEX_BUFFER_V0), INDEX_BUFFER, 12),
+          "index buffer, 32-bit");
+    check(decodesTo(MeshoptMode::Triangles, 2, INDEX_BUFFER_V0, sizeof(INDEX_BUFFER_V0), INDEX_BUFFER, 12),
+          "index buffer, 16-bit");
+    check(decodesTo(MeshoptMode::Indices, 4, INDEX_SEQUENCE_V1, sizeof(INDEX_SEQUENCE_V1), INDEX_SEQUENCE, 6),
+          "index sequence, 32-bit");
+    check(decodesTo(MeshoptMode::Indices, 2, INDEX_SEQUENCE_V1, sizeof(INDEX_SEQUENCE_V1), INDEX_SEQUENCE, 6),
+          "index sequence, 16-bit");
+
+    unsigned char vertices[17][4];
+    memset(vertices, 0xcc, sizeof(vertices));
+    check(MeshoptDecoder::decode(vertices, 16, 4, VERTEX_BUFFER_V0, sizeof(VERTEX_BUFFER_V0), MeshoptMode::Attributes) &&
+          memcmp(vertices, VERTEX_BUFFER, sizeof(VERTEX_BUFFER)) == 0 && vertices[16][0] == 0xcc,
+          "vertex buffer");
+
+    checkTruncations(MeshoptMode::Triangles, 4, INDEX_BUFFER_V0, sizeof(INDEX_BUFFER_V0), 12, "index buffer");
+    checkTruncations(MeshoptMode::Indices, 4, INDEX_SEQUENCE_V1, sizeof(INDEX_SEQUENCE_V1), 6, "index sequence");
+    checkTruncations(MeshoptMode::Attributes, 4, VERTEX_BUFFER_V0, sizeof(VERTEX_BUFFER_V0), 16, "vertex buffer");
+}
+
+static void checkFilters()
+{
+    // Octahedral: x and y with the third component as the scale; unit
+    // vectors along the axes come out exact
+    int8_t normals8[3][4] = { { 0, 0, 127, 5 }, { 127, 0, 127, 5 }, { 0, -127, 127, 5 } };
+    const int8_t expected_normals8[3][4] = { { 0, 0, 127, 5 }, { 127, 0, 0, 5 }, { 0, -127, 0, 5 } };
+    check(MeshoptDecoder::applyFilter(normals8, 3, 4, MeshoptFilter::Octahedral) &&
+          memcmp(normals8, expected_normals8, sizeof(normals8)) == 0, "octahedral filter, 8-bit");
+
+    int16_t normals16[2][4] = { { 0, 0, 32767, 9 }, { -32767, 0, 32767, 9 } };
+    const int16_t expected_normals16[2][4] = { { 0, 0, 32767, 9 }, { -32767, 0, 0, 9 } };
+    check(MeshoptDecoder::applyFilter(normals16, 2, 8, MeshoptFilter::Octahedral) &&
+          memcmp(normals16, expected_normals16, sizeof(normals16)) == 0, "octahedral filter, 16-bit");
+
+    // Quaternion: three components, then the scale with the index of the
+    // dropped largest one in the low bits
+    int16_t rotations[2][4] = { { 0, 0, 0, 8188 | 3 }, { 0, 0, 0, 8188 | 0 } };
+    const int16_t expected_rotations[2][4] = { { 0, 0, 0, 32767 }, { 32767, 0, 0, 0 } };
+    check(MeshoptDecoder::applyFilter(rotations, 2, 8, MeshoptFilter::Quaternion) &&
+          memcmp(rotations, expected_rotations, sizeof(rotations)) == 0, "quaternion filter");
+
+    // Exponential: 8-bit exponent over a 24-bit mantissa
+    uint32_t values[5] = { 0x00000001, 0xff000003, 0x02fffffe, 0x0a000001, 0xf6000400 };
+    const float expected_values[5] = { 1.0f, 1.5f, -8.0f, 1024.0f, 1.0f };
+    bool exact = MeshoptDecoder::applyFilter(values, 5, 4, MeshoptFilter::Exponential);
+    for (int i = 0; exact && i < 5; ++i)
+    {
+        float value;
+        memcpy(&value, &values[i], 4);
+        exact = value == expected_values[i];
+    }
+    check(exact, "exponential filter");
+}
+
+int main()
+{
+    checkStreams();
+    checkFilters();
+    printf("meshopt streams and filters against known output: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+// Checks getBodyContact for every pair of sphere, capsule and box against
+// sampling: random turned bodies are tested for overlap, and the test fails
+// when the two disagree on a clear case, when a normal is not unit length, or
+// when moving b along the normal by the reported depth (plus a little) leaves
+// any sample point inside both shapes.
+
+#include "Narrowphase.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+static const int SAMPLES_PER_AXIS = 28;
+static const float PUSH_MARGIN = 0.01f;     // Added to the depth when separating
+static const float CLEAR_DEPTH = 0.1f;      // Shallower contacts may fall between samples
+
+// A body's shape in world space, worked out once per test
+struct Probe
+{
+    BodyShape shape;
+    vector3f center;
+    vector3f axes[3];
+    float radius;
+    float half_height;
+    vector3f half_extents;
+};
+
+static Probe makeProbe(const rigidbody& body)
+{
+    Probe probe;
+    probe.shape = body.shape;
+    probe.center = body.obj.position;
+    probe.radius = body.radius;
+    probe.half_height = body.shape == BodyShape::Capsule ? body.half_height : 0.0f;
+    probe.half_extents = body.half_extents;
+
+    matrix4f rotation;
+    rotation.setRotationDegrees(body.obj.rotation);
+    probe.axes[0] = vector3f(1, 0, 0);
+    probe.axes[1] = vector3f(0, 1, 0);
+    probe.axes[2] = vector3f(0, 0, 1);
+    for (vector3f& axis : probe.axes)
+    {
+        rotation.rotateVect(axis);
+    }
+    return probe;
+}
+
+// Inside the shape shrunk by margin
+static bool isInside(const Probe& probe, const vector3f& point, float margin)
+{
+    const vector3f offset = point - probe.center;
+    const vector3f local(offset.dotProduct(probe.axes[0]), offset.dotProduct(probe.axes[1]), offset.dotProduct(probe.axes[2]));
+
+    if (probe.shape == BodyShape::Box)
+    {
+        return std::abs(local.X) <= probe.half_extents.X - margin &&
+               std::abs(local.Y) <= probe.half_extents.Y - margin &&
+               std::abs(local.Z) <= probe.half_extents.Z - margin;
+    }
+
+    const float y = std::clamp(local.Y, -probe.half_height, probe.half_height);
+    return (local - vector3f(0, y, 0)).getLength() <= probe.radius - margin;
+}
+
+// Whether a grid of points over the overlap of the bodies' bounds has one
+// inside both
+static bool sampleOverlap(const rigidbody& a, const rigidbody& b, float margin)
+{
+    const BvhBounds bounds_a = getBodyBounds(a);
+    const BvhBounds bounds_b = getBodyBounds(b);
+    const vector3f low(std::max(bounds_a.bounds_min.X, bounds_b.bounds_min.X),
+                       std::max(bounds_a.bounds_min.Y, bounds_b.bounds_min.Y),
+                       std::max(bounds_a.bounds_min.Z, bounds_b.bounds_min.Z));
+    const vector3f high(std::min(bounds_a.bounds_max.X, bounds_b.bounds_max.X),
+                        std::min(bounds_a.bounds_max.Y, bounds_b.bounds_max.Y),
+                        std::min(bounds_a.bounds_max.Z, bounds_b.bounds_max.Z));
+    if (low.X > high.X || low.Y > high.Y || low.Z > high.Z)
+    {
+        return false;
+    }
+
+    const Probe probe_a = makeProbe(a);
+    const Probe probe_b = makeProbe(b);
+    const vector3f step = (high - low) / static_cast<float>(SAMPLES_PER_AXIS);
+    for (int z = 0; z <= SAMPLES_PER_AXIS; ++z)
+    {
+        for (int y = 0; y <= SAMPLES_PER_AXIS; ++y)
+        {
+            for (int x = 0; x <= SAMPLES_PER_AXIS; ++x)
+            {
+                const vector3f point = low + vector3f(step.X * x, step.Y * y, step.Z * z);
+                if (isInside(probe_a, point, margin) && isInside(probe_b, point, margin))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+int main()
+{
+    const char* shape_names[] = { "none", "sphere", "capsule", "box" };
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> signed_unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.2f, 1.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+
+    int contacts[4][4] = {};
+    int failures[4][4] = {};
+    for (int k = 0; k < 30000; ++k)
+    {
+        gameObject object_a(signed_unit(rng), signed_unit(rng), signed_unit(rng));
+        gameObject object_b(signed_unit(rng) * 1.5f, signed_unit(rng) * 1.5f, signed_unit(rng) * 1.5f);
+        object_a.rotation = vector3f(angle(rng), angle(rng), angle(rng));
+        object_b.rotation = vector3f(angle(rng), angle(rng), angle(rng));
+
+        rigidbody a(object_a);
+        rigidbody b(object_b);
+        a.shape = BodyShape(1 + k % 3);
+        b.shape = BodyShape(1 + (k / 3) % 3);
+        a.radius = size(rng) * 0.6f;
+        b.radius = size(rng) * 0.6f;
+        a.half_height = size(rng) * 0.6f;
+        b.half_height = size(rng) * 0.6f;
+        a.half_extents = vector3f(size(rng), size(rng), size(rng)) * 0.6f;
+        b.half_extents = vector3f(size(rng), size(rng), size(rng)) * 0.6f;
+
+        BodyContact contact;
+        const bool hit = getBodyContact(a, b, contact);
+        int& failed = failures[static_cast<int>(a.shape)][static_cast<int>(b.shape)];
+
+        const char* problem = nullptr;
+        if (!hit)
+        {
+            if (sampleOverlap(a, b, PUSH_MARGIN))
+            {
+                problem = "overlap missed";
+            }
+        }
+        else
+        {
+            ++contacts[static_cast<int>(a.shape)][static_cast<int>(b.shape)];
+            if (std::abs(contact.normal.getLength() - 1.0f) > 1e-3f)
+            {
+                problem = "normal not unit length";
+            }
+            else if (contact.depth > CLEAR_DEPTH && !sampleOverlap(a, b, 0.0f))
+            {
+                problem = "contact without overlap";
+            }
+            else
+            {
+                object_b.position += contact.normal * (contact.depth + PUSH_MARGIN);
+                if (sampleOverlap(a, b, 0.0f))
+                {
+                    problem = "still overlapping after the push";
+                }
+            }
+        }
+
+        if (problem && failed++ < 3)
+        {
+            printf("%s-%s pair %d: %s (depth %f)\n", shape_names[static_cast<int>(a.shape)],
+                   shape_names[static_cast<int>(b.shape)], k, problem, hit ? contact.depth : 0.0f);
+        }
+    }
+
+    int total_failures = 0;
+    for (int i = 1; i < 4; ++i)
+    {
+        for (int j = 1; j < 4; ++j)
+        {
+            printf("%-7s %-7s %4d contacts, %d failures\n", shape_names[i], shape_names[j], contacts[i][j], failures[i][j]);
+            total_failures += failures[i][j] + (contacts[i][j] == 0 ? 1 : 0);
+        }
+    }
+    return total_failures == 0 ? 0 : 1;
+}
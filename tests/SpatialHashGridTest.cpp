@@ -0,0 +1,141 @@
+// Moves a crowd of boxes through a SpatialHashGrid for a few hundred updates
+// and fails unless every update reports exactly the overlapping pairs a
+// brute-force check finds. The boxes drift across cells and grow and shrink
+// across levels, which takes the incremental path and, as emptied cells pile
+// up, the table rehash; boxes are added and removed, one outgrows the coarsest
+// level and the crowd empties out, which lay the grid out again. Zero-size
+// boxes are mixed in throughout.
+
+#include "Utils/SpatialHashGrid.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+typedef std::set<std::pair<uint32_t, uint32_t>> PairSet;
+
+static bool overlaps(const BvhBounds& a, const BvhBounds& b)
+{
+    return a.bounds_min.X <= b.bounds_max.X && b.bounds_min.X <= a.bounds_max.X &&
+           a.bounds_min.Y <= b.bounds_max.Y && b.bounds_min.Y <= a.bounds_max.Y &&
+           a.bounds_min.Z <= b.bounds_max.Z && b.bounds_min.Z <= a.bounds_max.Z;
+}
+
+static PairSet findPairsBruteForce(const std::vector<BvhBounds>& bounds)
+{
+    PairSet pairs;
+    for (uint32_t i = 0; i < bounds.size(); ++i)
+    {
+        for (uint32_t j = i + 1; j < bounds.size(); ++j)
+        {
+            if (overlaps(bounds[i], bounds[j]))
+            {
+                pairs.insert({ i, j });
+            }
+        }
+    }
+    return pairs;
+}
+
+int main()
+{
+    std::mt19937 rng(49);
+    std::uniform_real_distribution<float> signed_unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> coordinate(0.0f, 40.0f);
+
+    std::vector<vector3f> positions;
+    std::vector<vector3f> velocities;
+    std::vector<float> half_sizes;
+    auto addBox = [&]() {
+        positions.push_back(vector3f(coordinate(rng), coordinate(rng) * 0.3f, coordinate(rng)));
+        velocities.push_back(vector3f(signed_unit(rng), signed_unit(rng), signed_unit(rng)) * 0.3f);
+        half_sizes.push_back(0.05f + unit(rng) * unit(rng) * 2.0f);
+    };
+    auto resize = [&](size_t count) {
+        positions.resize(count);
+        velocities.resize(count);
+        half_sizes.resize(count);
+    };
+
+    for (int i = 0; i < 1500; ++i)
+    {
+        addBox();
+    }
+
+    SpatialHashGrid grid;
+    std::vector<BvhBounds> bounds;
+    size_t total_pairs = 0;
+    int failures = 0;
+    const int steps = 400;
+
+    for (int step = 0; step < steps; ++step)
+    {
+        if (step % 50 == 10)
+        {
+            for (int i = 0; i < 20; ++i)
+            {
+                addBox();
+            }
+        }
+        if (step % 50 == 30)
+        {
+            resize(positions.size() - 35);
+        }
+        if (step == 100)
+        {
+            half_sizes[3] = 5000.0f;
+        }
+        if (step == 101)
+        {
+            half_sizes[3] = 0.2f;
+        }
+        if (step == 200)
+        {
+            resize(0);
+        }
+        if (step == 201)
+        {
+            for (int i = 0; i < 800; ++i)
+            {
+                addBox();
+            }
+        }
+
+        bounds.resize(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            positions[i] += velocities[i];
+            if (step % 7 == 0)
+            {
+                half_sizes[i] = std::max(0.0f, half_sizes[i] * (0.5f + unit(rng)));
+            }
+            if (i % 50 == 0)
+            {
+                half_sizes[i] = 0.0f;
+            }
+
+            const vector3f half(half_sizes[i], half_sizes[i], half_sizes[i]);
+            bounds[i].bounds_min = positions[i] - half;
+            bounds[i].bounds_max = positions[i] + half;
+        }
+
+        grid.update(bounds);
+
+        const PairSet expected = findPairsBruteForce(bounds);
+        const PairSet found(grid.getPairs().begin(), grid.getPairs().end());
+        total_pairs += expected.size();
+        if (found != expected || found.size() != grid.getPairs().size())
+        {
+            if (failures++ < 10)
+            {
+                printf("step %d, %zu boxes: %zu pairs (%zu distinct), expected %zu\n", step, bounds.size(),
+                       grid.getPairs().size(), found.size(), expected.size());
+            }
+        }
+    }
+
+    printf("Spatial hash grid against brute force: %d updates, %zu pairs, %d differ\n", steps, total_pairs, failures);
+    return failures == 0 && total_pairs > 0 ? 0 : 1;
+}
@@ -0,0 +1,304 @@
+// Checks the swept sphere queries against references that just step along
+// the sweep. sweepSphereTriangle must hit exactly when a sphere marched in
+// small steps touches the triangle, at the same distance, with the contact
+// point one radius from the center and the normal pointing from it to the
+// center; grazing sweeps that a step can skip are let through. spherecast
+// over a bumpy collider must find the closest of all the triangles' sweeps,
+// and bodies dropped fast onto a thin floor with a ccd_radius must never end
+// up below it.
+
+#include "PhysicsSystem.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+static const float REFERENCE_STEP = 0.001f;
+static const float DISTANCE_TOLERANCE = 1e-3f;
+
+// Closest point of the triangle to p, by its plane and edges
+static vector3f getClosestPoint(const vector3f& p, const PhysicsTriangle& triangle)
+{
+    const vector3f projected = p - triangle.normal * triangle.normal.dotProduct(p - triangle.v0);
+    const vector3f q = projected - triangle.v0;
+    const float d00 = triangle.edge1.dotProduct(triangle.edge1);
+    const float d01 = triangle.edge1.dotProduct(triangle.edge2);
+    const float d11 = triangle.edge2.dotProduct(triangle.edge2);
+    const float d20 = q.dotProduct(triangle.edge1);
+    const float d21 = q.dotProduct(triangle.edge2);
+    const float denominator = d00 * d11 - d01 * d01;
+    const float v = (d11 * d20 - d01 * d21) / denominator;
+    const float w = (d00 * d21 - d01 * d20) / denominator;
+    if (v >= 0.0f && w >= 0.0f && v + w <= 1.0f)
+    {
+        return projected;
+    }
+
+    const vector3f* corners[3] = { &triangle.v0, &triangle.v1, &triangle.v2 };
+    vector3f closest = triangle.v0;
+    float closest_distance = 1e30f;
+    for (int i = 0; i < 3; ++i)
+    {
+        const vector3f& a = *corners[i];
+        const vector3f edge = *corners[(i + 1) % 3] - a;
+        const float t = std::clamp((p - a).dotProduct(edge) / edge.getLengthSQ(), 0.0f, 1.0f);
+        const vector3f point = a + edge * t;
+        const float distance = (p - point).getLengthSQ();
+        if (distance < closest_distance)
+        {
+            closest_distance = distance;
+            closest = point;
+        }
+    }
+    return closest;
+}
+
+static float getDistance(const vector3f& p, const PhysicsTriangle& triangle)
+{
+    return (p - getClosestPoint(p, triangle)).getLength();
+}
+
+// First distance along the sweep at which the sphere touches the triangle,
+// -1 for none. The distance to a triangle is convex along a line, so the
+// touching part of the sweep is one interval: step until inside, then
+// bisect. min_distance is the closest the center came, for grazing sweeps.
+static float sweepByStepping(const vector3f& origin, float radius, const vector3f& direction, float max_distance,
+                             const PhysicsTriangle& triangle, float& min_distance)
+{
+    min_distance = getDistance(origin, triangle);
+    if (min_distance < radius)
+    {
+        // Already touching: a hit only when moving towards the triangle
+        return (getClosestPoint(origin, triangle) - origin).dotProduct(direction) > 0.0f ? 0.0f : -1.0f;
+    }
+
+    for (float s = REFERENCE_STEP; s <= max_distance; s += REFERENCE_STEP)
+    {
+        const float distance = getDistance(origin + direction * s, triangle);
+        min_distance = std::min(min_distance, distance);
+        if (distance > radius)
+        {
+            continue;
+        }
+
+        float outside = s - REFERENCE_STEP;
+        float inside = s;
+        for (int i = 0; i < 30; ++i)
+        {
+            const float middle = (outside + inside) * 0.5f;
+            (getDistance(origin + direction * middle, triangle) <= radius ? inside : outside) = middle;
+        }
+        return inside;
+    }
+    return -1.0f;
+}
+
+static int checkTriangleSweeps(PhysicsSystem& physics, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> coordinate(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> radius_range(0.05f, 1.0f);
+    auto randomPoint = [&]() { return vector3f(coordinate(rng), coordinate(rng), coordinate(rng)); };
+
+    int hits = 0;
+    int failures = 0;
+    const int sweeps = 6000;
+    for (int k = 0; k < sweeps; ++k)
+    {
+        const PhysicsTriangle triangle = collider::make_triangle(randomPoint(), randomPoint(), randomPoint());
+        const vector3f origin = randomPoint() * 2.0f;
+        const float radius = radius_range(rng);
+
+        // Half of them aimed at the triangle
+        vector3f direction = (k & 1) ? triangle.center - origin + randomPoint() * 0.25f : randomPoint();
+        direction.normalize();
+
+        const float max_distance = 8.0f;
+        float distance = 0.0f;
+        vector3f normal, point;
+        const bool hit = physics.sweepSphereTriangle(origin, radius, direction, max_distance, triangle, distance, normal, point);
+
+        float min_distance = 0.0f;
+        const float expected = sweepByStepping(origin, radius, direction, max_distance, triangle, min_distance);
+        const bool grazing = std::abs(min_distance - radius) < 2e-3f;
+
+        const char* problem = nullptr;
+        if (hit != (expected >= 0.0f))
+        {
+            problem = grazing ? nullptr : "hit differs";
+        }
+        else if (hit)
+        {
+            const vector3f center = origin + direction * distance;
+            if (std::abs(distance - expected) > DISTANCE_TOLERANCE && !grazing)
+            {
+                problem = "distance differs";
+            }
+            else if (std::abs(normal.getLength() - 1.0f) > 1e-3f)
+            {
+                problem = "normal not unit length";
+            }
+            else if (expected > 0.0f && (std::abs((center - point).getLength() - radius) > 1e-3f ||
+                                         (center - point).normalize().dotProduct(normal) < 0.999f))
+            {
+                problem = "contact point or normal off";
+            }
+        }
+
+        hits += hit ? 1 : 0;
+        if (problem && failures++ < 10)
+        {
+            printf("sweep %d: %s (hit %d at %f, stepping %f)\n", k, problem, hit, hit ? distance : -1.0f, expected);
+        }
+    }
+
+    printf("sweepSphereTriangle against stepping: %d sweeps, %d hits, %d failures\n", sweeps, hits, failures);
+    return failures + (hits == 0 ? 1 : 0);
+}
+
+// Height field of two triangles per cell, wound to face up
+static std::vector<vertex> makeTerrain(int cells, float cell_size, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> height(-1.5f, 1.5f);
+    std::vector<float> heights((cells + 1) * (cells + 1));
+    for (float& h : heights)
+    {
+        h = height(rng);
+    }
+
+    auto corner = [&](int x, int z) {
+        vertex v = {};
+        v.vx = x * cell_size;
+        v.vy = heights[z * (cells + 1) + x];
+        v.vz = z * cell_size;
+        v.ny = 1.0f;
+        return v;
+    };
+
+    std::vector<vertex> vertices;
+    for (int z = 0; z < cells; ++z)
+    {
+        for (int x = 0; x < cells; ++x)
+        {
+            const vertex quad[6] = { corner(x, z), corner(x, z + 1), corner(x + 1, z),
+                                     corner(x + 1, z), corner(x, z + 1), corner(x + 1, z + 1) };
+            vertices.insert(vertices.end(), quad, quad + 6);
+        }
+    }
+    return vertices;
+}
+
+static int checkSpherecasts(PhysicsSystem& physics, std::mt19937& rng)
+{
+    std::vector<vertex> vertices = makeTerrain(16, 2.0f, rng);
+    gameObject terrain_object(-16.0f, 0.0f, -16.0f);
+    terrain_object.rotation = vector3f(0.0f, 30.0f, 0.0f);
+    mesh terrain_mesh(vertices.data(), vertices.size(), terrain_object);
+    collider terrain(terrain_mesh, terrain_object);
+    std::vector<collider*> colliders = { &terrain };
+
+    std::uniform_real_distribution<float> horizontal(-24.0f, 24.0f);
+    std::uniform_real_distribution<float> vertical(-2.0f, 6.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    int hits = 0;
+    int failures = 0;
+    const int casts = 2000;
+    for (int k = 0; k < casts; ++k)
+    {
+        const vector3f origin(horizontal(rng), vertical(rng), horizontal(rng));
+        vector3f direction(unit(rng), unit(rng) - 0.5f, unit(rng));
+        direction.normalize();
+        const float radius = 0.2f + (k % 5) * 0.3f;
+        const float max_distance = 60.0f;
+
+        vector3f hit_point, hit_normal;
+        const bool hit = physics.spherecast(origin, radius, direction, max_distance, colliders, hit_point, hit_normal);
+
+        float closest = max_distance;
+        bool expected_hit = false;
+        for (const PhysicsTriangle& triangle : terrain.get_triangles())
+        {
+            float distance;
+            vector3f normal, point;
+            if (physics.sweepSphereTriangle(origin, radius, direction, closest, triangle, distance, normal, point))
+            {
+                closest = distance;
+                expected_hit = true;
+            }
+        }
+
+        hits += hit ? 1 : 0;
+        const vector3f expected_point = origin + direction * closest;
+        if ((hit != expected_hit || (hit && !hit_point.equals(expected_point, 1e-3f))) && failures++ < 10)
+        {
+            printf("cast %d: hit %d at (%f %f %f), closest triangle sweep %d at (%f %f %f)\n", k, hit,
+                   hit_point.X, hit_point.Y, hit_point.Z, expected_hit, expected_point.X, expected_point.Y, expected_point.Z);
+        }
+    }
+
+    printf("spherecast against every triangle: %d casts, %d hits, %d failures\n", casts, hits, failures);
+    return failures + (hits == 0 ? 1 : 0);
+}
+
+static int checkFastDrops(PhysicsSystem& physics, std::mt19937& rng)
+{
+    // One big quad, no thickness
+    const float extent = 100.0f;
+    vertex floor_vertices[6] = {};
+    const float corners[6][2] = { { -extent, -extent }, { -extent, extent }, { extent, -extent },
+                                  { extent, -extent }, { -extent, extent }, { extent, extent } };
+    for (int i = 0; i < 6; ++i)
+    {
+        floor_vertices[i].vx = corners[i][0];
+        floor_vertices[i].vz = corners[i][1];
+        floor_vertices[i].ny = 1.0f;
+    }
+    gameObject floor_object;
+    mesh floor_mesh(floor_vertices, 6, floor_object);
+    collider floor(floor_mesh, floor_object);
+    std::vector<collider*> colliders = { &floor };
+
+    gameObject ball;
+    rigidbody body(ball);
+    body.ccd_radius = 0.25f;
+    std::vector<rigidbody*> bodies = { &body };
+
+    physics.setGravity(vector3f(0.0f, -9.8f, 0.0f));
+    physics.setFixedDelta(0.16f);
+
+    std::uniform_real_distribution<float> horizontal(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    int tunnelled = 0;
+    const int drops = 2000;
+    for (int k = 0; k < drops; ++k)
+    {
+        ball.position = vector3f(horizontal(rng), 0.3f + (k % 10) * 0.7f, horizontal(rng));
+        body.velocity = vector3f(unit(rng) * 20.0f, -20.0f - (k % 7) * 15.0f, unit(rng) * 20.0f);
+        body.force = vector3f(0.0f, 0.0f, 0.0f);
+
+        for (int step = 0; step < 10; ++step)
+        {
+            physics.stepPhysics(bodies, colliders);
+        }
+        if (ball.position.Y < 0.0f && tunnelled++ < 10)
+        {
+            printf("drop %d ended below the floor at y %f\n", k, ball.position.Y);
+        }
+    }
+
+    printf("fast drops onto a thin floor: %d drops, %d tunnelled\n", drops, tunnelled);
+    return tunnelled;
+}
+
+int main()
+{
+    std::mt19937 rng(3);
+    PhysicsSystem physics;
+
+    int failures = checkTriangleSweeps(physics, rng);
+    failures += checkSpherecasts(physics, rng);
+    failures += checkFastDrops(physics, rng);
+    return failures == 0 ? 0 : 1;
+}
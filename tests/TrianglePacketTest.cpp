@@ -0,0 +1,183 @@
+// Runs the SIMD triangle packet kernels (SSE2 or NEON, whichever this build
+// compiles) and the scalar ones on the same packets and queries, and fails
+// unless hit masks and every hit's depth or distance agree bit for bit.
+// Besides random triangles it covers the cases where rounding decides the
+// answer: zero-area and sliver triangles, rays in a triangle's plane, and
+// queries that exactly touch an edge, a corner or the radius.
+
+#include "TrianglePacket.hpp"
+#include "Components/collider.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <vector>
+
+#if defined(TRIANGLE_PACKET_SSE2)
+static const char* KERNEL_NAME = "SSE2";
+#elif defined(TRIANGLE_PACKET_NEON)
+static const char* KERNEL_NAME = "NEON";
+#else
+static const char* KERNEL_NAME = "scalar only";
+#endif
+
+struct TestStats
+{
+    size_t queries = 0;
+    size_t hits = 0;
+    size_t failures = 0;
+};
+
+static bool sameBits(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static void checkSphere(const TrianglePacket& packet, const vector3f& center, float radius, TestStats& stats)
+{
+    float simd_depths[4] = {};
+    float scalar_depths[4] = {};
+    const uint32_t simd_mask = intersectSpherePacket(packet, center, radius, simd_depths);
+    const uint32_t scalar_mask = intersectSpherePacketScalar(packet, center, radius, scalar_depths);
+
+    ++stats.queries;
+    bool same = simd_mask == scalar_mask;
+    for (int lane = 0; lane < TRIANGLE_PACKET_WIDTH && same; ++lane)
+    {
+        if (scalar_mask & (1u << lane))
+        {
+            same = sameBits(simd_depths[lane], scalar_depths[lane]);
+            ++stats.hits;
+        }
+    }
+
+    if (!same && stats.failures++ < 10)
+    {
+        printf("sphere (%g %g %g) r %g: masks %x / %x\n", center.X, center.Y, center.Z, radius, simd_mask, scalar_mask);
+    }
+}
+
+static void checkRay(const TrianglePacket& packet, const vector3f& origin, vector3f direction, float max_distance,
+                     TestStats& stats)
+{
+    if (direction.getLengthSQ() == 0.0f)
+    {
+        return;
+    }
+    direction.normalize();
+
+    float simd_distances[4] = {};
+    float scalar_distances[4] = {};
+    const uint32_t simd_mask = intersectRayPacket(packet, origin, direction, max_distance, simd_distances);
+    const uint32_t scalar_mask = intersectRayPacketScalar(packet, origin, direction, max_distance, scalar_distances);
+
+    ++stats.queries;
+    bool same = simd_mask == scalar_mask;
+    for (int lane = 0; lane < TRIANGLE_PACKET_WIDTH && same; ++lane)
+    {
+        if (scalar_mask & (1u << lane))
+        {
+            same = sameBits(simd_distances[lane], scalar_distances[lane]);
+            ++stats.hits;
+        }
+    }
+
+    if (!same && stats.failures++ < 10)
+    {
+        printf("ray (%g %g %g) -> (%g %g %g) max %g: masks %x / %x\n", origin.X, origin.Y, origin.Z,
+               direction.X, direction.Y, direction.Z, max_distance, simd_mask, scalar_mask);
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(47);
+    std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto randomPoint = [&]() { return vector3f(coordinate(rng), coordinate(rng), coordinate(rng)); };
+
+    // Random triangles, then the degenerate ones
+    std::vector<PhysicsTriangle> triangles;
+    for (int i = 0; i < 400; ++i)
+    {
+        triangles.push_back(collider::make_triangle(randomPoint(), randomPoint(), randomPoint()));
+    }
+    for (int i = 0; i < 40; ++i)
+    {
+        const vector3f a = randomPoint();
+        const vector3f b = randomPoint();
+        triangles.push_back(collider::make_triangle(a, b, a + (b - a) * unit(rng)));       // Collinear
+        triangles.push_back(collider::make_triangle(a, a, a));                             // A point
+        triangles.push_back(collider::make_triangle(a, b, b));                             // Two corners shared
+        triangles.push_back(collider::make_triangle(a, b, a + (b - a) * 0.5f + vector3f(0, 1e-4f, 0)));   // Sliver
+    }
+    // Grid-aligned ones, so edge and corner queries land exactly on them
+    triangles.push_back(collider::make_triangle(vector3f(0, 0, 0), vector3f(0, 0, 1), vector3f(1, 0, 0)));
+    triangles.push_back(collider::make_triangle(vector3f(0, 0, 0), vector3f(1, 0, 0), vector3f(0, 1, 0)));
+    triangles.push_back(collider::make_triangle(vector3f(-2, 1, -2), vector3f(-2, 1, 2), vector3f(2, 1, -2)));
+
+    TestStats sphere_stats;
+    TestStats ray_stats;
+    std::uniform_int_distribution<size_t> pick(0, triangles.size() - 1);
+
+    for (int round = 0; round < 2000; ++round)
+    {
+        // Packets mix kinds of triangles, and some leave lanes empty
+        TrianglePacket packet;
+        packet.clear();
+        const int lanes = round % 5 == 0 ? 1 + round % TRIANGLE_PACKET_WIDTH : TRIANGLE_PACKET_WIDTH;
+        PhysicsTriangle lane_triangles[TRIANGLE_PACKET_WIDTH];
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            lane_triangles[lane] = triangles[round < 100 ? (triangles.size() - 1 - (round + lane) % 3) : pick(rng)];
+            packet.setLane(lane, lane_triangles[lane]);
+        }
+
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            const PhysicsTriangle& triangle = lane_triangles[lane];
+
+            // Points on the triangle: corners, edge midpoints, and random ones
+            // reaching past the extruded edges
+            const float weights[][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 0.5f, 0 }, { 0, 0.5f }, { 0.5f, 0.5f },
+                                         { unit(rng), unit(rng) }, { unit(rng) * 1.5f - 0.25f, unit(rng) * 1.5f - 0.25f } };
+            for (const auto& weight : weights)
+            {
+                const vector3f point = triangle.v0 + triangle.edge1 * weight[0] + triangle.edge2 * weight[1];
+                const float radius = 0.25f + unit(rng) * 2.0f;
+
+                checkSphere(packet, point, radius, sphere_stats);
+                checkSphere(packet, point + triangle.normal * radius, radius, sphere_stats);       // Touching
+                checkSphere(packet, point - triangle.normal * radius, radius, sphere_stats);       // Behind
+                checkSphere(packet, point + triangle.normal * ((unit(rng) * 2.0f - 1.0f) * radius), radius, sphere_stats);
+
+                // Toward the point from in front, behind and within the plane (edge-on)
+                const vector3f from_front = point + triangle.normal * (1.0f + unit(rng) * 5.0f) + randomPoint() * 0.1f;
+                checkRay(packet, from_front, point - from_front, 100.0f, ray_stats);
+                checkRay(packet, point - triangle.normal * 3.0f, triangle.normal, 100.0f, ray_stats);
+                checkRay(packet, point - triangle.edge1 * 2.0f, triangle.edge1, 100.0f, ray_stats);
+                checkRay(packet, point - triangle.edge2 * 2.0f, triangle.edge2, 100.0f, ray_stats);
+
+                // Exactly as far as the hit, and a hair shorter
+                float distances[4];
+                vector3f direction = point - from_front;
+                direction.normalize();
+                if (intersectRayPacketScalar(packet, from_front, direction, 100.0f, distances) & (1u << lane))
+                {
+                    checkRay(packet, from_front, direction, distances[lane], ray_stats);
+                    checkRay(packet, from_front, direction, distances[lane] * 0.999999f, ray_stats);
+                }
+            }
+        }
+
+        for (int i = 0; i < 20; ++i)
+        {
+            checkSphere(packet, randomPoint(), unit(rng) * 4.0f, sphere_stats);
+            checkRay(packet, randomPoint(), randomPoint(), coordinate(rng) + 10.0f, ray_stats);
+        }
+    }
+
+    printf("%s kernels against scalar: spheres %zu queries, %zu hits, %zu differ; rays %zu queries, %zu hits, %zu differ\n",
+           KERNEL_NAME, sphere_stats.queries, sphere_stats.hits, sphere_stats.failures,
+           ray_stats.queries, ray_stats.hits, ray_stats.failures);
+    return sphere_stats.failures == 0 && ray_stats.failures == 0 && sphere_stats.hits > 0 && ray_stats.hits > 0 ? 0 : 1;
+}
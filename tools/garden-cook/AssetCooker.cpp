@@ -0,0 +1,522 @@
+#include "AssetCooker.hpp"
+#include "Utils/AssetArchive.hpp"
+#include "Utils/AssetCatalog.hpp"
+#include "Utils/AssetFile.hpp"
+#include "Utils/BakedMesh.hpp"
+#include "Utils/GltfLoader.hpp"
+#include "Utils/Hash.hpp"
+#include "Utils/MappedFile.hpp"
+#include "Utils/ObjLoader.hpp"
+#include "Utils/ThreadPool.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    // Bump when the cooker itself changes what it produces
+    constexpr uint32_t COOK_VERSION = 1;
+    const char* const COOK_DATABASE_HEADER = "garden-cook 1";
+
+    std::string lowerExtension(const std::string& path)
+    {
+        std::string extension = fs::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
+    }
+
+    // Whole-mesh or per-primitive ranges, exactly as the mesh component bakes them
+    std::vector<BakedSubmeshSource> makeSubmeshes(const GltfLoadResult& result)
+    {
+        std::vector<BakedSubmeshSource> submeshes;
+        for (const auto& range : result.primitive_ranges)
+        {
+            BakedSubmeshSource submesh;
+            submesh.first = static_cast<uint32_t>(range.first_vertex);
+            submesh.count = static_cast<uint32_t>(range.vertex_count);
+            submesh.material_index = range.material_index;
+            if (range.material_index >= 0 && range.material_index < (int)result.material_names.size())
+            {
+                submesh.material_name = result.material_names[range.material_index];
+            }
+            submeshes.push_back(submesh);
+        }
+        return submeshes;
+    }
+}
+
+AssetCooker::AssetCooker(const CookSettings& settings) : settings(settings)
+{
+}
+
+bool AssetCooker::run()
+{
+    stats = CookStats();
+    items.clear();
+    item_keys.clear();
+
+    std::error_code ec;
+    fs::create_directories(settings.cache_directory, ec);
+    if (ec)
+    {
+        fprintf(stderr, "[Cook ERROR] Cannot create %s\n", settings.cache_directory.c_str());
+        return false;
+    }
+
+    if (!settings.force)
+    {
+        readDatabase();
+    }
+    collect();
+
+    // Decide serially (stamps and hashes only), then bake everything stale in parallel
+    std::vector<size_t> stale;
+    std::unordered_set<std::string> baked_paths;
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (items[i].action != CookAction::Bake)
+        {
+            continue;
+        }
+        baked_paths.insert(items[i].path);
+
+        auto it = database.find(items[i].path);
+        if (!settings.force && it != database.end() && isCurrent(items[i], it->second))
+        {
+            ++stats.up_to_date;
+            continue;
+        }
+        stale.push_back(i);
+    }
+
+    std::vector<CookRecord> records(stale.size());
+    std::vector<std::string> errors(stale.size());
+    std::vector<char> succeeded(stale.size(), 0);
+    ThreadPool::get().parallelFor(stale.size(), [&](size_t i)
+    {
+        succeeded[i] = bake(items[stale[i]], records[i], errors[i]) ? 1 : 0;
+    });
+
+    for (size_t i = 0; i < stale.size(); ++i)
+    {
+        CookItem& item = items[stale[i]];
+        if (succeeded[i])
+        {
+            printf("[Cook] Baked %s\n", item.path.c_str());
+            database[item.path] = records[i];
+            ++stats.cooked;
+        }
+        else
+        {
+            fprintf(stderr, "[Cook ERROR] %s: %s\n", item.path.c_str(), errors[i].c_str());
+            database.erase(item.path);
+            item.failed = true;
+            ++stats.failed;
+        }
+    }
+
+    // Forget sources that are gone
+    for (auto it = database.begin(); it != database.end();)
+    {
+        it = baked_paths.count(it->first) ? std::next(it) : database.erase(it);
+    }
+
+    bool packed = pack();
+    writeDatabase();
+    return packed && stats.failed == 0;
+}
+
+void AssetCooker::collect()
+{
+    // The catalog finds each asset's dependencies (mtllib, buffers, images)
+    // and re-indexes only what changed since the last cook
+    AssetCatalog& catalog = AssetCatalog::get();
+    catalog.open((fs::path(settings.cache_directory) / "assets.gcat").generic_string());
+
+    for (const std::string& directory : settings.directories)
+    {
+        std::error_code ec;
+        if (!fs::is_directory(directory, ec))
+        {
+            printf("[Cook] Skipping %s, not a directory\n", directory.c_str());
+            continue;
+        }
+
+        std::vector<std::string> paths;
+        for (fs::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+        {
+            if (it->is_regular_file(ec))
+            {
+                paths.push_back(AssetCatalog::makeKey(it->path().string()));
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+
+        for (const std::string& path : paths)
+        {
+            const std::string extension = lowerExtension(path);
+            switch (AssetCatalog::detectKind(path))
+            {
+            case AssetKind::Obj:
+                addItem(path, CookAction::Bake);
+                break;
+            case AssetKind::Gltf:
+            case AssetKind::Glb:
+                addItem(path, CookAction::Bake);
+                addItem(path, CookAction::Pack);
+                break;
+            case AssetKind::Texture:
+                addItem(path, CookAction::Pack);
+                break;
+            case AssetKind::BakedMesh:
+                // Caches the game wrote next to a source are replaced by the cooked ones
+                if (!fs::exists(path.substr(0, path.size() - 6), ec))
+                {
+                    addItem(path, CookAction::Pack);
+                }
+                break;
+            default:
+                if (extension == ".bin" || extension == ".gworld")
+                {
+                    addItem(path, CookAction::Pack);
+                }
+                break;
+            }
+        }
+    }
+
+    // Dependencies are packed too, wherever they live (items grows in the loop)
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const AssetKind kind = AssetCatalog::detectKind(items[i].path);
+        if (kind == AssetKind::Unknown || kind == AssetKind::BakedMesh)
+        {
+            continue;
+        }
+
+        const AssetRecord* record = catalog.update(items[i].path);
+        if (!record || !record->valid)
+        {
+            fprintf(stderr, "[Cook ERROR] %s cannot be loaded\n", items[i].path.c_str());
+            items[i].failed = true;
+            ++stats.failed;
+            continue;
+        }
+
+        items[i].dependencies = record->dependencies;
+        if (kind == AssetKind::Gltf && items[i].action == CookAction::Pack)
+        {
+            for (const std::string& dependency : record->dependencies)
+            {
+                addItem(dependency, CookAction::Pack);
+            }
+        }
+    }
+
+    catalog.save();
+}
+
+void AssetCooker::addItem(const std::string& path, CookAction action)
+{
+    if (!item_keys.insert((action == CookAction::Bake ? "bake:" : "pack:") + path).second)
+    {
+        return;
+    }
+
+    CookItem& item = items.emplace_back();
+    item.path = path;
+    item.action = action;
+    if (action == CookAction::Bake)
+    {
+        item.output = (fs::path(settings.cache_directory) / BakedMesh::getCachePath(path)).generic_string();
+    }
+}
+
+bool AssetCooker::isCurrent(const CookItem& item, CookRecord& record) const
+{
+    std::error_code ec;
+    if (item.failed || record.settings_hash != getSettingsHash(item.path) || !fs::exists(item.output, ec))
+    {
+        return false;
+    }
+
+    // A new stamp with the same content (a checkout, a touch) only refreshes the stamp
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if (!BakedMesh::getSourceStamp(item.path, size, mtime) || size != record.source_size)
+    {
+        return false;
+    }
+    if (mtime != record.source_mtime)
+    {
+        if (hashFile(item.path) != record.source_hash)
+        {
+            return false;
+        }
+        record.source_mtime = mtime;
+    }
+
+    uint64_t dependency_stamp = AssetCatalog::hashDependencies(item.dependencies);
+    if (dependency_stamp != record.dependency_stamp)
+    {
+        if (hashDependencyContents(item.dependencies) != record.dependency_hash)
+        {
+            return false;
+        }
+        record.dependency_stamp = dependency_stamp;
+    }
+
+    // The game only checks the layout of a cache it opens, a reused bake gets its content hash checked here
+    std::string error;
+    if (!BakedMesh::open(item.output, &error, true))
+    {
+        printf("[Cook] Baking %s again: %s\n", item.path.c_str(), error.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool AssetCooker::bake(const CookItem& item, CookRecord& record, std::string& error) const
+{
+    record = CookRecord();
+    record.settings_hash = getSettingsHash(item.path);
+    if (!BakedMesh::getSourceStamp(item.path, record.source_size, record.source_mtime))
+    {
+        error = "Cannot stat source";
+        return false;
+    }
+    record.source_hash = hashFile(item.path);
+    record.dependency_stamp = AssetCatalog::hashDependencies(item.dependencies);
+    record.dependency_hash = hashDependencyContents(item.dependencies);
+
+    // The stamp AssetFileSystem reports once the source is archived
+    BakedMeshHeader stamp = {};
+    stamp.source_size = record.source_size;
+    stamp.source_mtime = static_cast<int64_t>(record.source_hash);
+    stamp.flags = BAKED_MESH_COOKED;
+
+    std::error_code ec;
+    fs::create_directories(fs::path(item.output).parent_path(), ec);
+
+    if (AssetCatalog::detectKind(item.path) == AssetKind::Obj)
+    {
+        ObjLoaderConfig config;
+        config.verbose_logging = false;
+        ObjLoadResult result = ObjLoader::loadObj(item.path, config);
+        if (!result.success)
+        {
+            error = result.error_message;
+            return false;
+        }
+
+        BakedSubmeshSource whole_mesh;
+        whole_mesh.count = static_cast<uint32_t>(result.vertex_count);
+        stamp.config_hash = BakedMesh::hashConfig(config);
+        if (!BakedMesh::write(item.output, stamp, result.vertices, result.vertex_count,
+                              std::vector<uint32_t>(), { whole_mesh }, error))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        GltfLoaderConfig config;
+        GltfLoadResult result = GltfLoader::loadGltf(item.path, config);
+        if (!result.success)
+        {
+            error = result.error_message;
+            return false;
+        }
+
+        stamp.config_hash = BakedMesh::hashConfig(config);
+        if (!BakedMesh::write(item.output, stamp, result.vertices, result.vertex_count,
+                              std::vector<uint32_t>(), makeSubmeshes(result), error))
+        {
+            return false;
+        }
+    }
+
+    record.output_hash = hashFile(item.output);
+    return true;
+}
+
+bool AssetCooker::pack()
+{
+    // Sorted, so the same inputs always give the same archive
+    std::vector<std::pair<std::string, std::string>> entries;  // Archive path, file
+    for (const CookItem& item : items)
+    {
+        if (item.failed)
+        {
+            continue;
+        }
+        if (item.action == CookAction::Bake)
+        {
+            entries.emplace_back(BakedMesh::getCachePath(item.path), item.output);
+        }
+        else
+        {
+            entries.emplace_back(item.path, item.path);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    uint64_t hash = hashCombine(HASH_SEED, ASSET_ARCHIVE_VERSION);
+    for (const auto& entry : entries)
+    {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        BakedMesh::getSourceStamp(entry.second, size, mtime);
+        hash = hashCombine(hash, hashString(entry.first));
+        hash = hashCombine(hash, size);
+        hash = hashCombine(hash, static_cast<uint64_t>(mtime));
+    }
+
+    stats.packed = entries.size();
+    std::error_code ec;
+    if (!settings.force && hash == archive_hash && fs::exists(settings.archive, ec))
+    {
+        printf("[Cook] %s is up to date\n", settings.archive.c_str());
+        return true;
+    }
+
+    AssetArchiveWriter writer;
+    for (const auto& entry : entries)
+    {
+        writer.addFile(AssetFileSystem::normalizePath(entry.first), entry.second);
+    }
+
+    std::string error;
+    if (!writer.write(settings.archive, error))
+    {
+        fprintf(stderr, "[Cook ERROR] %s\n", error.c_str());
+        archive_hash = 0;
+        return false;
+    }
+
+    printf("[Cook] Wrote %s: %zu files, %.1f MB stored as %.1f MB (%zu compressed)\n", settings.archive.c_str(),
+           writer.getFileCount(), writer.getRawSize() / (1024.0 * 1024.0),
+           writer.getStoredSize() / (1024.0 * 1024.0), writer.getCompressedCount());
+    archive_hash = hash;
+    stats.archive_written = true;
+    return true;
+}
+
+bool AssetCooker::readDatabase()
+{
+    database.clear();
+    archive_hash = 0;
+
+    std::ifstream file(getDatabasePath());
+    std::string line;
+    if (!file || !std::getline(file, line) || line != COOK_DATABASE_HEADER)
+    {
+        return false; // Missing or from another version: everything is cooked
+    }
+
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        std::string tag;
+        if (line.compare(0, 8, "archive ") == 0)
+        {
+            fields >> tag >> std::hex >> archive_hash;
+            continue;
+        }
+
+        CookRecord record;
+        std::string path;
+        fields >> std::hex >> record.settings_hash >> std::dec >> record.source_size >> record.source_mtime
+               >> std::hex >> record.source_hash >> record.dependency_stamp >> record.dependency_hash
+               >> record.output_hash;
+        if (fields && std::getline(fields >> std::ws, path) && !path.empty())
+        {
+            database[path] = record;
+        }
+    }
+    return true;
+}
+
+bool AssetCooker::writeDatabase() const
+{
+    std::vector<std::string> paths;
+    for (const auto& entry : database)
+    {
+        paths.push_back(entry.first);
+    }
+    std::sort(paths.begin(), paths.end());
+
+    // Plain text: one line per baked source, the path last since it may contain spaces
+    std::string temp_path = getDatabasePath() + ".tmp";
+    FILE* file = fopen(temp_path.c_str(), "w");
+    if (!file)
+    {
+        fprintf(stderr, "[Cook ERROR] Cannot write %s\n", temp_path.c_str());
+        return false;
+    }
+
+    fprintf(file, "%s\n", COOK_DATABASE_HEADER);
+    fprintf(file, "archive %016llx\n", (unsigned long long)archive_hash);
+    for (const std::string& path : paths)
+    {
+        const CookRecord& record = database.at(path);
+        fprintf(file, "%016llx %llu %lld %016llx %016llx %016llx %016llx %s\n",
+                (unsigned long long)record.settings_hash, (unsigned long long)record.source_size,
+                (long long)record.source_mtime, (unsigned long long)record.source_hash,
+                (unsigned long long)record.dependency_stamp, (unsigned long long)record.dependency_hash,
+                (unsigned long long)record.output_hash, path.c_str());
+    }
+
+    bool ok = fclose(file) == 0;
+    std::error_code ec;
+    if (ok)
+    {
+        fs::rename(temp_path, getDatabasePath(), ec);
+    }
+    if (!ok || ec)
+    {
+        fs::remove(temp_path, ec);
+        fprintf(stderr, "[Cook ERROR] Cannot write %s\n", getDatabasePath().c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string AssetCooker::getDatabasePath() const
+{
+    return (fs::path(settings.cache_directory) / "cook.db").generic_string();
+}
+
+uint64_t AssetCooker::getSettingsHash(const std::string& path)
+{
+    uint64_t hash = hashCombine(HASH_SEED, COOK_VERSION);
+    if (AssetCatalog::detectKind(path) == AssetKind::Obj)
+    {
+        return hashCombine(hash, BakedMesh::hashConfig(ObjLoaderConfig()));
+    }
+    return hashCombine(hash, BakedMesh::hashConfig(GltfLoaderConfig()));
+}
+
+uint64_t AssetCooker::hashFile(const std::string& path)
+{
+    // Matches AssetArchiveEntry::content_hash; MappedFile refuses empty files
+    MappedFile file;
+    return file.open(path) ? hashBytes(file.data(), file.size()) : hashBytes("", 0);
+}
+
+uint64_t AssetCooker::hashDependencyContents(const std::vector<std::string>& dependencies)
+{
+    uint64_t hash = HASH_SEED;
+    for (const std::string& dependency : dependencies)
+    {
+        hash = hashCombine(hash, hashString(dependency));
+        hash = hashCombine(hash, hashFile(dependency));
+    }
+    return hash;
+}
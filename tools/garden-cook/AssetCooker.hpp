@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+struct CookSettings
+{
+    std::vector<std::string> directories = { "models", "textures", "worlds" };
+    std::string archive = "assets.gpak";
+    std::string cache_directory = "cooked";     // Baked meshes, the cook database and catalog
+    bool force = false;                         // Ignore the database and cook everything
+};
+
+struct CookStats
+{
+    size_t cooked = 0;
+    size_t up_to_date = 0;
+    size_t failed = 0;
+    size_t packed = 0;
+    bool archive_written = false;
+};
+
+// Turns the asset tree into what the game loads at startup: one archive
+// holding baked meshes (.gmesh, drawn in place) instead of OBJ sources, plus
+// the files that are used as they are (textures, glTF documents with their
+// buffers, worlds). glTF files keep their source in the archive, models are
+// imported from it.
+//
+// Meshes are baked with the default loader settings. They give the same
+// geometry and config hash as the mesh component's: it only turns off glTF
+// validation, which just logs and is not hashed. So BakedMesh::openIfCurrent()
+// accepts the bakes. Each bake is stamped with its source's size and content
+// hash, which is the stamp AssetFileSystem reports for archived files, and
+// flagged BAKED_MESH_COOKED so it is still accepted next to loose sources,
+// whose write times differ.
+//
+// The cook database (cook.db in the cache directory) records, per baked
+// source, the settings hash, the source's stamp and content hash and a
+// stamp and content hash of its dependencies. A source is cooked again only
+// when one of those changed; a changed stamp with unchanged content just
+// refreshes the stamp. Baking runs in parallel on the thread pool.
+class AssetCooker
+{
+public:
+    explicit AssetCooker(const CookSettings& settings);
+
+    // Returns false if any asset failed to cook or the archive couldn't be written
+    bool run();
+
+    const CookStats& getStats() const { return stats; }
+
+private:
+    enum class CookAction
+    {
+        Bake,       // Load through the engine's loader and write a .gmesh
+        Pack        // Goes into the archive as it is
+    };
+
+    struct CookItem
+    {
+        std::string path;
+        CookAction action = CookAction::Pack;
+        std::vector<std::string> dependencies;
+        std::string output;                     // Baked file in the cache directory
+        bool failed = false;
+    };
+
+    struct CookRecord
+    {
+        uint64_t settings_hash = 0;
+        uint64_t source_size = 0;
+        int64_t source_mtime = 0;
+        uint64_t source_hash = 0;
+        uint64_t dependency_stamp = 0;
+        uint64_t dependency_hash = 0;
+        uint64_t output_hash = 0;
+    };
+
+    CookSettings settings;
+    CookStats stats;
+    std::vector<CookItem> items;
+    std::unordered_set<std::string> item_keys;  // Action and path of every item
+    std::unordered_map<std::string, CookRecord> database;
+    uint64_t archive_hash = 0;                  // Of what went into the last archive
+
+    void collect();
+    void addItem(const std::string& path, CookAction action);
+
+    bool isCurrent(const CookItem& item, CookRecord& record) const;
+    bool bake(const CookItem& item, CookRecord& record, std::string& error) const;
+    bool pack();
+
+    bool readDatabase();
+    bool writeDatabase() const;
+    std::string getDatabasePath() const;
+
+    static uint64_t getSettingsHash(const std::string& path);
+    static uint64_t hashFile(const std::string& path);
+    static uint64_t hashDependencyContents(const std::vector<std::string>& dependencies);
+};
@@ -0,0 +1,3 @@
+// The game gets stb_image from OpenGLRenderAPI.cpp, which the cooker doesn't build
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
@@ -0,0 +1,68 @@
+#include "AssetCooker.hpp"
+#include <stdio.h>
+#include <string>
+
+static void printUsage()
+{
+    printf("Usage: garden-cook [options] [directories...]\n"
+           "\n"
+           "Bakes the meshes under the given directories (default: models textures worlds)\n"
+           "and packs everything the game loads into one archive. Run it from the game's\n"
+           "working directory; only sources that changed since the last run are cooked.\n"
+           "\n"
+           "  --archive <file>   Archive to write (default: assets.gpak)\n"
+           "  --cache <dir>      Baked meshes and the cook database (default: cooked)\n"
+           "  --force            Ignore the database and cook everything\n"
+           "  --help             Show this text\n");
+}
+
+int main(int argc, char** argv)
+{
+    CookSettings settings;
+    std::vector<std::string> directories;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == "--force")
+        {
+            settings.force = true;
+        }
+        else if (argument == "--archive" && i + 1 < argc)
+        {
+            settings.archive = argv[++i];
+        }
+        else if (argument == "--cache" && i + 1 < argc)
+        {
+            settings.cache_directory = argv[++i];
+        }
+        else if (argument == "--help" || argument == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (!argument.empty() && argument[0] == '-')
+        {
+            fprintf(stderr, "Unknown option: %s\n\n", argument.c_str());
+            printUsage();
+            return 2;
+        }
+        else
+        {
+            directories.push_back(argument);
+        }
+    }
+
+    if (!directories.empty())
+    {
+        settings.directories = directories;
+    }
+
+    AssetCooker cooker(settings);
+    bool ok = cooker.run();
+
+    const CookStats& stats = cooker.getStats();
+    printf("[Cook] %zu cooked, %zu up to date, %zu failed, %zu files in %s\n",
+           stats.cooked, stats.up_to_date, stats.failed, stats.packed, settings.archive.c_str());
+    return ok ? 0 : 1;
+}